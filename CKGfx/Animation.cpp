@@ -132,6 +132,21 @@ const Animation* AnimationSet::find(const char* name) const
     return &it->second;
 }
 
+size_t AnimationSet::memorySize() const
+{
+    size_t sz = _bones.size() * sizeof(Bone);
+    for (auto& anim : _animations) {
+        sz += sizeof(StateDefinition);
+        for (auto& channel : anim.second.channels) {
+            sz += sizeof(SequenceChannel);
+            for (auto& seq : channel.sequences) {
+                sz += seq.size() * sizeof(Keyframe);
+            }
+        }
+    }
+    return sz;
+}
+
 int AnimationSet::findBoneIndex(const char* name) const
 {
     auto it = std::find_if(_bones.begin(), _bones.end(),
@@ -97,6 +97,8 @@ namespace cinek {
         int findBoneIndex(const char* name) const;
         const Bone* boneFromIndex(int index) const;
         int boneCount() const { return (int)_bones.size(); }
+        //  approximate size in bytes of the bone and keyframe data
+        size_t memorySize() const;
         
     private:
         std::vector<StateDefinition, std_allocator<StateDefinition>> _animations;
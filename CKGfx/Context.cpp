@@ -13,11 +13,28 @@
 #include "Animation.hpp"
 #include "Light.hpp"
 #include "ModelSet.hpp"
+#include "Node.hpp"
+
+#include <cinek/debug.h>
+
+#include <algorithm>
+#include <cstdio>
 
 namespace cinek {
     namespace gfx {
     
+Context::Context()
+{
+    _meshes.setDelegate(this);
+    _lights.setDelegate(this);
+    _textures.setDelegate(this);
+    _materials.setDelegate(this);
+    _animationSets.setDelegate(this);
+    _modelSets.setDelegate(this);
+}
+    
 Context::Context(const ResourceInitParams& params) :
+    _residencyBudget(params.residencyBudget),
     _meshes(params.numMeshes),
     _materials(params.numMaterials),
     _textures(params.numTextures),
@@ -25,6 +42,29 @@ Context::Context(const ResourceInitParams& params) :
     _lights(params.numLights),
     _modelSets(params.numModelSets)
 {
+    _poolCounts[kPoolMesh].capacity = params.numMeshes;
+    _poolCounts[kPoolMaterial].capacity = params.numMaterials;
+    _poolCounts[kPoolTexture].capacity = params.numTextures;
+    _poolCounts[kPoolAnimationSet].capacity = params.numAnimations;
+    _poolCounts[kPoolLight].capacity = params.numLights;
+    _poolCounts[kPoolModelSet].capacity = params.numModelSets;
+    
+    _meshes.setDelegate(this);
+    _lights.setDelegate(this);
+    _textures.setDelegate(this);
+    _materials.setDelegate(this);
+    _animationSets.setDelegate(this);
+    _modelSets.setDelegate(this);
+}
+
+Context::~Context()
+{
+    //  release dictionary handles while residency state is still alive, as
+    //  the pools report releases back to the Context
+    _modelSetDictionary.clear();
+    _animationSetDictionary.clear();
+    _materialDictionary.clear();
+    _textureDictionary.clear();
 }
 
 void Context::setTextureLoadDelegate(TextureLoadDelegate delegate)
@@ -37,14 +77,29 @@ auto Context::textureLoadDelegate() const -> TextureLoadDelegate
     return _textureLoadDelegate;
 }
 
+static const char* kResourceTypeNames[] = {
+    "Texture",
+    "Material",
+    "AnimationSet",
+    "ModelSet"
+};
+
 MeshHandle Context::registerMesh(Mesh&& mesh)
 {
-    return _meshes.add(std::move(mesh));
+    auto handle = _meshes.add(std::move(mesh));
+    countRegistration(kPoolMesh, (bool)handle);
+    return handle;
 }
 
 TextureHandle Context::registerTexture(Texture&& texture, const char* name)
 {
-    return registerResource(std::move(texture), _textures, _textureDictionary, name);
+    auto handle = registerResource(std::move(texture), _textures, _textureDictionary, name);
+    countRegistration(kPoolTexture, (bool)handle);
+    if (handle) {
+        trackAsset(handle.resource(), ResourceType::kTexture, name,
+                   handle->memorySize(), {});
+    }
+    return handle;
 }
 
 TextureHandle Context::loadTexture(const char* pathname)
@@ -59,8 +114,24 @@ TextureHandle Context::loadTexture(const char* pathname)
     return registerTexture(std::move(texture), pathname);
 }
 
+TextureHandle Context::reloadTexture(Texture&& texture, const char* name)
+{
+    auto handle = findTexture(name);
+    if (!handle) {
+        return registerTexture(std::move(texture), name);
+    }
+    
+    refreshAsset(handle.resource(), texture.memorySize(), {});
+    
+    //  the replaced texture is destroyed on leaving scope
+    Texture oldTexture = std::move(*handle);
+    *handle = std::move(texture);
+    return handle;
+}
+
 void Context::unregisterTexture(const char* name)
 {
+    unregisterAsset(ResourceType::kTexture, name);
     unregisterResource(_textureDictionary, name);
 }
 
@@ -75,11 +146,22 @@ TextureHandle Context::findTexture(const char* name) const
 
 MaterialHandle Context::registerMaterial(Material&& material, const char* name)
 {
-    return registerResource(std::move(material), _materials, _materialDictionary, name);
+    auto handle = registerResource(std::move(material), _materials, _materialDictionary, name);
+    countRegistration(kPoolMaterial, (bool)handle);
+    if (handle) {
+        std::vector<const void*> dependencies;
+        if (handle->diffuseTex) {
+            dependencies.push_back(handle->diffuseTex.resource());
+        }
+        trackAsset(handle.resource(), ResourceType::kMaterial, name,
+                   sizeof(Material), dependencies);
+    }
+    return handle;
 }
 
 void Context::unregisterMaterial(const char* name)
 {
+    unregisterAsset(ResourceType::kMaterial, name);
     unregisterResource(_materialDictionary, name);
 }
 
@@ -100,11 +182,18 @@ AnimationSetHandle Context::registerAnimationSet
     const char* name
 )
 {
-    return registerResource(std::move(animation), _animationSets, _animationSetDictionary, name);
+    auto handle = registerResource(std::move(animation), _animationSets, _animationSetDictionary, name);
+    countRegistration(kPoolAnimationSet, (bool)handle);
+    if (handle) {
+        trackAsset(handle.resource(), ResourceType::kAnimationSet, name,
+                   handle->memorySize(), {});
+    }
+    return handle;
 }
 
 void Context::unregisterAnimationSet(const char* name)
 {
+    unregisterAsset(ResourceType::kAnimationSet, name);
     unregisterResource(_animationSetDictionary, name);
 }
 
@@ -120,7 +209,9 @@ AnimationSetHandle Context::findAnimationSet(const char* name) const
 
 LightHandle Context::registerLight(Light&& light)
 {
-    return _lights.add(std::move(light));
+    auto handle = _lights.add(std::move(light));
+    countRegistration(kPoolLight, (bool)handle);
+    return handle;
 }
 
 ModelSetHandle Context::registerModelSet
@@ -129,11 +220,78 @@ ModelSetHandle Context::registerModelSet
     const char* name
 )
 {
-    return registerResource(std::move(modelSet), _modelSets, _modelSetDictionary, name);
+    auto handle = registerResource(std::move(modelSet), _modelSets, _modelSetDictionary, name);
+    countRegistration(kPoolModelSet, (bool)handle);
+    if (handle && handle->nodeGraph().root()) {
+        //  meshes are unnamed and owned by the model set's graph, so they're
+        //  accounted for here.  materials and animations are dependencies.
+        std::vector<const void*> dependencies;
+        std::vector<const Mesh*> meshes;
+        visit(handle->nodeGraph().root(), [&dependencies, &meshes](NodeHandle node) -> bool {
+            if (node->elementType() == Node::kElementTypeMesh) {
+                for (auto element = node->mesh(); element; element = element->next) {
+                    if (element->mesh) {
+                        meshes.push_back(element->mesh.resource());
+                    }
+                    if (element->material) {
+                        dependencies.push_back(element->material.resource());
+                    }
+                }
+            }
+            else if (node->elementType() == Node::kElementTypeArmature) {
+                if (node->armature()->animSet) {
+                    dependencies.push_back(node->armature()->animSet.resource());
+                }
+            }
+            return true;
+        });
+        
+        std::sort(meshes.begin(), meshes.end());
+        meshes.erase(std::unique(meshes.begin(), meshes.end()), meshes.end());
+        size_t bytes = sizeof(ModelSet);
+        for (auto mesh : meshes) {
+            bytes += mesh->memorySize();
+        }
+        trackAsset(handle.resource(), ResourceType::kModelSet, name, bytes,
+                   dependencies);
+    }
+    else if (handle) {
+        trackAsset(handle.resource(), ResourceType::kModelSet, name,
+                   sizeof(ModelSet), {});
+    }
+    return handle;
+}
+
+ModelSetHandle Context::reloadModelSet(ModelSet&& modelSet, const char* name)
+{
+    //  preserve owner edges across the replacement.  the old set remains
+    //  resident until nodes cloned from it are released
+    std::vector<std::string> owners;
+    auto oldResource = findResource(ResourceType::kModelSet, name);
+    auto oldIt = _residentAssets.find(oldResource);
+    if (oldIt != _residentAssets.end()) {
+        const AssetRef oldRef = { oldResource, oldIt->second.generation };
+        for (auto& owner : _assetOwners) {
+            auto& assets = owner.second;
+            if (std::find(assets.begin(), assets.end(), oldRef) != assets.end()) {
+                owners.push_back(owner.first);
+            }
+        }
+    }
+    if (oldResource) {
+        unregisterModelSet(name);
+    }
+    
+    auto handle = registerModelSet(std::move(modelSet), name);
+    for (auto& owner : owners) {
+        addAssetOwner(owner.c_str(), ResourceType::kModelSet, name);
+    }
+    return handle;
 }
 
 void Context::unregisterModelSet(const char *name)
 {
+    unregisterAsset(ResourceType::kModelSet, name);
     unregisterResource(_modelSetDictionary, name);
 }
 
@@ -148,6 +306,444 @@ ModelSetHandle Context::findModelSet(const char* name) const
 
 void Context::update()
 {
+    ++_frameIndex;
+    
+    if (_residencyBudget && _residentBytes > _residencyBudget) {
+        evictUnreferencedAssets();
+    }
+}
+
+const char* Context::resourceName(const void* resource) const
+{
+    auto it = _residentAssets.find(resource);
+    if (it == _residentAssets.end() || it->second.name.empty())
+        return nullptr;
+    return it->second.name.c_str();
+}
+
+const void* Context::findResource(ResourceType type, const char* name) const
+{
+    switch (type) {
+    case ResourceType::kTexture: {
+            auto h = findTexture(name);
+            return h ? h.resource() : nullptr;
+        }
+    case ResourceType::kMaterial: {
+            auto h = findMaterial(name);
+            return h ? h.resource() : nullptr;
+        }
+    case ResourceType::kAnimationSet: {
+            auto h = findAnimationSet(name);
+            return h ? h.resource() : nullptr;
+        }
+    case ResourceType::kModelSet: {
+            auto h = findModelSet(name);
+            return h ? h.resource() : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+void Context::trackAsset
+(
+    const void* resource,
+    ResourceType type,
+    const char* name,
+    size_t bytes,
+    const std::vector<const void*>& dependencies
+)
+{
+    //  only named assets are managed
+    if (!name || !name[0])
+        return;
+    
+    if (_residentAssets.find(resource) != _residentAssets.end())
+        return;
+    
+    //  a previously tracked asset with the same name has been replaced in
+    //  its dictionary
+    for (auto& entry : _residentAssets) {
+        if (entry.second.registered && entry.second.type == type &&
+            entry.second.name == name) {
+            unregisterAsset(entry.second, entry.first);
+            break;
+        }
+    }
+    
+    auto dependencyRefs = makeDependencyRefs(dependencies);
+    
+    ResidentAsset& asset = _residentAssets[resource];
+    asset.type = type;
+    asset.name = name;
+    asset.bytes = bytes;
+    asset.generation = ++_assetGeneration;
+    asset.ownerCount = 0;
+    asset.dependentCount = 0;
+    asset.lastReleaseFrame = _frameIndex;
+    asset.registered = true;
+    asset.dependencies = std::move(dependencyRefs);
+    
+    _residentBytes += bytes;
+}
+
+void Context::refreshAsset
+(
+    const void* resource,
+    size_t bytes,
+    const std::vector<const void*>& dependencies
+)
+{
+    auto it = _residentAssets.find(resource);
+    if (it == _residentAssets.end())
+        return;
+    
+    ResidentAsset& asset = it->second;
+    _residentBytes -= asset.bytes;
+    asset.bytes = bytes;
+    _residentBytes += asset.bytes;
+    
+    //  reference the new dependencies before releasing the old, so that
+    //  dependencies common to both aren't released in between
+    auto dependencyRefs = makeDependencyRefs(dependencies);
+    std::swap(asset.dependencies, dependencyRefs);
+    releaseDependencyRefs(dependencyRefs);
+}
+
+std::vector<Context::AssetRef> Context::makeDependencyRefs
+(
+    const std::vector<const void*>& resources
+)
+{
+    //  only resident (named) dependencies pin memory
+    std::vector<AssetRef> refs;
+    refs.reserve(resources.size());
+    for (auto resource : resources) {
+        auto it = _residentAssets.find(resource);
+        if (it != _residentAssets.end()) {
+            refs.push_back({ resource, it->second.generation });
+        }
+    }
+    std::sort(refs.begin(), refs.end());
+    refs.erase(std::unique(refs.begin(), refs.end()), refs.end());
+    
+    for (auto& ref : refs) {
+        ++_residentAssets[ref.resource].dependentCount;
+    }
+    return refs;
+}
+
+void Context::releaseDependencyRefs(const std::vector<AssetRef>& refs)
+{
+    for (auto& ref : refs) {
+        auto dependency = findAsset(ref);
+        if (dependency) {
+            CK_ASSERT(dependency->dependentCount > 0);
+            --dependency->dependentCount;
+            releaseAssetReference(*dependency);
+        }
+    }
+}
+
+auto Context::findAsset(const AssetRef& ref) -> ResidentAsset*
+{
+    auto it = _residentAssets.find(ref.resource);
+    if (it == _residentAssets.end() || it->second.generation != ref.generation)
+        return nullptr;
+    return &it->second;
+}
+
+void Context::unregisterAsset(ResourceType type, const char* name)
+{
+    auto resource = findResource(type, name);
+    auto it = _residentAssets.find(resource);
+    if (it != _residentAssets.end() && it->second.registered) {
+        unregisterAsset(it->second, resource);
+    }
+}
+
+void Context::unregisterAsset(ResidentAsset& asset, const void* resource)
+{
+    //  unregistered assets can't be found by name, so owners no longer
+    //  reference them.  dependencies remain until the asset is released
+    //  since the asset still holds handles to them.
+    if (asset.ownerCount) {
+        const AssetRef ref = { resource, asset.generation };
+        for (auto& owner : _assetOwners) {
+            auto& assets = owner.second;
+            assets.erase(std::remove(assets.begin(), assets.end(), ref), assets.end());
+        }
+        asset.ownerCount = 0;
+    }
+    asset.registered = false;
+}
+
+void Context::releaseAsset(const void* resource)
+{
+    auto it = _residentAssets.find(resource);
+    if (it == _residentAssets.end())
+        return;
+    
+    if (it->second.registered) {
+        unregisterAsset(it->second, resource);
+    }
+    
+    _residentBytes -= it->second.bytes;
+    
+    auto dependencies = std::move(it->second.dependencies);
+    _residentAssets.erase(it);
+    releaseDependencyRefs(dependencies);
+}
+
+void Context::onReleaseManagedObject(Mesh& )
+{
+    countRelease(kPoolMesh);
+}
+
+void Context::onReleaseManagedObject(Light& )
+{
+    countRelease(kPoolLight);
+}
+
+void Context::onReleaseManagedObject(Texture& texture)
+{
+    countRelease(kPoolTexture);
+    releaseAsset(&texture);
+}
+
+void Context::onReleaseManagedObject(Material& material)
+{
+    countRelease(kPoolMaterial);
+    releaseAsset(&material);
+}
+
+void Context::onReleaseManagedObject(AnimationSet& animationSet)
+{
+    countRelease(kPoolAnimationSet);
+    releaseAsset(&animationSet);
+}
+
+void Context::onReleaseManagedObject(ModelSet& modelSet)
+{
+    countRelease(kPoolModelSet);
+    releaseAsset(&modelSet);
+}
+
+void Context::releaseAssetReference(ResidentAsset& asset)
+{
+    if (!asset.ownerCount && !asset.dependentCount) {
+        asset.lastReleaseFrame = _frameIndex;
+    }
+}
+
+void Context::addAssetOwner
+(
+    const char* owner,
+    ResourceType type,
+    const char* name
+)
+{
+    auto resource = findResource(type, name);
+    auto it = _residentAssets.find(resource);
+    if (it == _residentAssets.end() || !it->second.registered) {
+        CK_LOG_WARN("gfx", "addAssetOwner - %s %s is not resident",
+                    kResourceTypeNames[(int)type], name);
+        return;
+    }
+    
+    const AssetRef ref = { resource, it->second.generation };
+    auto& assets = _assetOwners[owner];
+    if (std::find(assets.begin(), assets.end(), ref) == assets.end()) {
+        assets.push_back(ref);
+        ++it->second.ownerCount;
+    }
+}
+
+void Context::releaseAssetOwner(const char* owner)
+{
+    auto ownerIt = _assetOwners.find(owner);
+    if (ownerIt == _assetOwners.end())
+        return;
+    
+    for (auto& ref : ownerIt->second) {
+        auto asset = findAsset(ref);
+        if (asset) {
+            CK_ASSERT(asset->ownerCount > 0);
+            --asset->ownerCount;
+            releaseAssetReference(*asset);
+        }
+    }
+    
+    _assetOwners.erase(ownerIt);
+}
+
+void Context::setResidencyBudget(size_t bytes)
+{
+    _residencyBudget = bytes;
+}
+
+void Context::countRegistration(int pool, bool registered)
+{
+    auto& counts = _poolCounts[pool];
+    if (registered) {
+        ++counts.registeredCount;
+        ++counts.liveCount;
+        counts.highWaterCount = std::max(counts.highWaterCount, counts.liveCount);
+    }
+    else {
+        ++counts.exhaustedCount;
+    }
+}
+
+void Context::countRelease(int pool)
+{
+    CK_ASSERT(_poolCounts[pool].liveCount > 0);
+    --_poolCounts[pool].liveCount;
+}
+
+std::vector<Context::PoolStats> Context::poolStats() const
+{
+    static const char* kPoolNames[kPoolCount] = {
+        "Meshes",
+        "Materials",
+        "Textures",
+        "Animation Sets",
+        "Lights",
+        "Model Sets"
+    };
+    
+    std::vector<PoolStats> stats;
+    stats.reserve(kPoolCount);
+    for (int pool = 0; pool < kPoolCount; ++pool) {
+        auto& counts = _poolCounts[pool];
+        stats.push_back(PoolStats {
+            kPoolNames[pool],
+            counts.capacity,
+            counts.liveCount,
+            counts.highWaterCount,
+            counts.registeredCount,
+            counts.exhaustedCount
+        });
+    }
+    return stats;
+}
+
+auto Context::residencyStats() const -> ResidencyStats
+{
+    ResidencyStats stats;
+    stats.residentBytes = _residentBytes;
+    stats.budgetBytes = _residencyBudget;
+    stats.residentCount = (uint32_t)_residentAssets.size();
+    stats.evictedCount = _evictedCount;
+    return stats;
+}
+
+void Context::evictUnreferencedAssets()
+{
+    std::vector<std::pair<uint32_t, const void*>> candidates;
+    
+    //  evicting an asset may release its dependencies, so iterate until
+    //  under budget or no further assets can be evicted
+    bool evicted;
+    do
+    {
+        evicted = false;
+        candidates.clear();
+        for (auto& entry : _residentAssets) {
+            auto& asset = entry.second;
+            if (asset.registered && !asset.ownerCount && !asset.dependentCount) {
+                candidates.emplace_back(asset.lastReleaseFrame, entry.first);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        
+        for (auto& candidate : candidates) {
+            if (_residentBytes <= _residencyBudget)
+                return;
+            
+            //  unregistering may release the asset (and its dependencies)
+            //  immediately if no other handles reference it
+            auto it = _residentAssets.find(candidate.second);
+            if (it == _residentAssets.end() || !it->second.registered)
+                continue;
+            
+            const ResourceType type = it->second.type;
+            const std::string name = it->second.name;
+            switch (type) {
+            case ResourceType::kTexture:
+                unregisterTexture(name.c_str());
+                break;
+            case ResourceType::kMaterial:
+                unregisterMaterial(name.c_str());
+                break;
+            case ResourceType::kAnimationSet:
+                unregisterAnimationSet(name.c_str());
+                break;
+            case ResourceType::kModelSet:
+                unregisterModelSet(name.c_str());
+                break;
+            }
+            ++_evictedCount;
+            evicted = true;
+        }
+    }
+    while (evicted && _residentBytes > _residencyBudget);
+}
+
+std::string Context::dumpResidency() const
+{
+    std::vector<std::pair<const void*, const ResidentAsset*>> assets;
+    assets.reserve(_residentAssets.size());
+    for (auto& entry : _residentAssets) {
+        assets.emplace_back(entry.first, &entry.second);
+    }
+    std::sort(assets.begin(), assets.end(),
+        [](const decltype(assets)::value_type& a0,
+           const decltype(assets)::value_type& a1) -> bool {
+            return a0.second->bytes > a1.second->bytes;
+        });
+    
+    std::string report;
+    char line[256];
+    
+    snprintf(line, sizeof(line), "Resident: %zu bytes in %zu assets (budget %zu, evicted %u)\n",
+             _residentBytes, _residentAssets.size(), _residencyBudget, _evictedCount);
+    report += line;
+    
+    for (auto& entry : assets) {
+        auto& asset = *entry.second;
+        snprintf(line, sizeof(line), "%-12s %-40s %10zu bytes",
+                 kResourceTypeNames[(int)asset.type], asset.name.c_str(),
+                 asset.bytes);
+        report += line;
+        
+        //  why the asset is resident
+        const AssetRef ref = { entry.first, asset.generation };
+        if (!asset.registered) {
+            report += "  [unregistered, handles remain]";
+        }
+        else if (!asset.ownerCount && !asset.dependentCount) {
+            report += "  [unreferenced]";
+        }
+        for (auto& owner : _assetOwners) {
+            auto& owned = owner.second;
+            if (std::find(owned.begin(), owned.end(), ref) != owned.end()) {
+                report += "  owner:";
+                report += owner.first;
+            }
+        }
+        if (asset.dependentCount) {
+            for (auto& other : _residentAssets) {
+                auto& deps = other.second.dependencies;
+                if (std::find(deps.begin(), deps.end(), ref) != deps.end()) {
+                    report += "  used by:";
+                    report += other.second.name;
+                }
+            }
+        }
+        report += "\n";
+    }
+    
+    return report;
 }
     
     }   // namespace gfx
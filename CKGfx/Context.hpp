@@ -14,6 +14,9 @@
 #include <cinek/managed_dictionary.hpp>
 
 #include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace cinek {
     namespace gfx {
@@ -29,10 +32,35 @@ public:
         uint32_t numAnimations;
         uint32_t numLights;
         uint32_t numModelSets;
+        //  byte budget for named assets before unreferenced assets are
+        //  evicted (0 = no budget)
+        size_t residencyBudget;
     };
     
-    Context() = default;
+    struct ResidencyStats
+    {
+        size_t residentBytes;
+        size_t budgetBytes;
+        uint32_t residentCount;
+        uint32_t evictedCount;
+    };
+    
+    //  Occupancy and registration counts for a resource pool.  Resources
+    //  are live until the pool reports their last handle released.
+    struct PoolStats
+    {
+        const char* name;
+        uint32_t capacity;
+        uint32_t liveCount;
+        uint32_t highWaterCount;
+        uint32_t registeredCount;
+        //  registrations that failed, i.e. the pool was full
+        uint32_t exhaustedCount;
+    };
+    
+    Context();
     explicit Context(const ResourceInitParams& params);
+    ~Context();
     
     //  Used for texture loading by an external system.  The external system
     //  uses the supplied name to load a Texture, and then to use the context
@@ -59,6 +87,10 @@ public:
     //  at a later time (i.e. asynchronously, if the underlying system supports
     //  async file IO.)
     TextureHandle loadTexture(const char* pathname);
+    //  Replaces the contents of a registered Texture in place so that
+    //  existing handles (i.e. from Materials) reference the new texture.
+    //  Registers the texture if no texture exists with the given name.
+    TextureHandle reloadTexture(Texture&& texture, const char* name);
     //  Unregisters the named Texture from the Context's dictionary
     void unregisterTexture(const char* name);
     //  Finds a texture from the Context's dictionary
@@ -81,11 +113,43 @@ public:
     LightHandle registerLight(Light&& light);
     //  Registers a NodeGraph Model with an noptinoal name
     ModelSetHandle registerModelSet(ModelSet&& modelSet, const char* name="");
+    //  Replaces a registered ModelSet with a new one, keeping its owners.
+    //  Nodes cloned from the old set are not modified (see RenderGraph.)
+    ModelSetHandle reloadModelSet(ModelSet&& modelSet, const char* name);
     //  Unregisters a Model
     void unregisterModelSet(const char *name);
     //  Finds a Model given its name
     ModelSetHandle findModelSet(const char* name) const;
     
+    //  Residency
+    //
+    //  Named assets are tracked with their size in bytes and their
+    //  dependencies (ModelSet -> Material, AnimationSet; Material -> Texture.)
+    //  Owners (i.e. asset manifests or scenes) reference assets by name.  An
+    //  asset with no owners and no resident dependents is unreferenced, and
+    //  is unregistered in least-recently-released order by update() when the
+    //  residency budget is exceeded.
+    //
+    //  Unregistering an asset doesn't free it while handles to it remain
+    //  (i.e. from cloned nodes), so an asset's bytes stay resident until its
+    //  last handle is released.
+    //
+    //  Adds a reference from the owner to the named asset
+    void addAssetOwner(const char* owner, ResourceType type, const char* name);
+    //  Drops all references held by the owner
+    void releaseAssetOwner(const char* owner);
+    //  Sets the resident byte budget (0 = no budget)
+    void setResidencyBudget(size_t bytes);
+    ResidencyStats residencyStats() const;
+    //  Returns a report of resident assets, their size and what keeps each
+    //  of them resident
+    std::string dumpResidency() const;
+    //  Returns the name a tracked resource was registered with, or nullptr
+    //  if the resource is unnamed (i.e. meshes and lights)
+    const char* resourceName(const void* resource) const;
+    //  Returns occupancy and registration counts for each resource pool
+    std::vector<PoolStats> poolStats() const;
+    
 private:
     //  restrict Context access to pointer and reference -
     //  copying of contexts is prohibited and move operations limited to
@@ -97,6 +161,101 @@ private:
     Context& operator=(Context&&);
     
 private:
+    enum
+    {
+        kPoolMesh,
+        kPoolMaterial,
+        kPoolTexture,
+        kPoolAnimationSet,
+        kPoolLight,
+        kPoolModelSet,
+        kPoolCount
+    };
+    
+    void countRegistration(int pool, bool registered);
+    void countRelease(int pool);
+    
+    //  invoked by the pools when a resource's last handle is released
+    friend MeshPool;
+    friend TexturePool;
+    friend MaterialPool;
+    friend AnimationSetPool;
+    friend LightPool;
+    friend ModelSetPool;
+    void onReleaseManagedObject(Mesh& mesh);
+    void onReleaseManagedObject(Light& light);
+    void onReleaseManagedObject(Texture& texture);
+    void onReleaseManagedObject(Material& material);
+    void onReleaseManagedObject(AnimationSet& animationSet);
+    void onReleaseManagedObject(ModelSet& modelSet);
+    
+    //  A reference to a tracked resource.  Pool slots are reused once a
+    //  resource is released, so references also carry the generation
+    //  assigned when the resource was tracked.
+    struct AssetRef
+    {
+        const void* resource;
+        uint32_t generation;
+        
+        bool operator==(const AssetRef& other) const {
+            return resource == other.resource && generation == other.generation;
+        }
+        bool operator<(const AssetRef& other) const {
+            return resource < other.resource ||
+                (resource == other.resource && generation < other.generation);
+        }
+    };
+    
+    struct ResidentAsset
+    {
+        ResourceType type;
+        std::string name;
+        size_t bytes;
+        uint32_t generation;
+        uint32_t ownerCount;
+        uint32_t dependentCount;
+        uint32_t lastReleaseFrame;
+        //  false once removed from its dictionary, while handles remain
+        bool registered;
+        std::vector<AssetRef> dependencies;
+    };
+    
+    void trackAsset(const void* resource, ResourceType type, const char* name,
+                    size_t bytes, const std::vector<const void*>& dependencies);
+    void refreshAsset(const void* resource, size_t bytes,
+                      const std::vector<const void*>& dependencies);
+    void unregisterAsset(ResourceType type, const char* name);
+    void unregisterAsset(ResidentAsset& asset, const void* resource);
+    void releaseAsset(const void* resource);
+    std::vector<AssetRef> makeDependencyRefs(const std::vector<const void*>& resources);
+    void releaseDependencyRefs(const std::vector<AssetRef>& refs);
+    ResidentAsset* findAsset(const AssetRef& ref);
+    void releaseAssetReference(ResidentAsset& asset);
+    const void* findResource(ResourceType type, const char* name) const;
+    void evictUnreferencedAssets();
+    
+    //  entries are erased when the pool releases the resource, so a live
+    //  resource's address identifies at most one entry.  residency state is
+    //  declared before the pools so that it outlives them, as releases
+    //  during pool teardown still report back to the Context
+    std::unordered_map<const void*, ResidentAsset> _residentAssets;
+    std::unordered_map<std::string, std::vector<AssetRef>> _assetOwners;
+    uint32_t _assetGeneration = 0;
+    size_t _residentBytes = 0;
+    size_t _residencyBudget = 0;
+    uint32_t _frameIndex = 0;
+    uint32_t _evictedCount = 0;
+    
+    struct PoolCounts
+    {
+        uint32_t capacity;
+        uint32_t liveCount;
+        uint32_t highWaterCount;
+        uint32_t registeredCount;
+        uint32_t exhaustedCount;
+    };
+    PoolCounts _poolCounts[kPoolCount] = {};
+    
     MeshPool _meshes;
     MaterialPool _materials;
     TexturePool _textures;
@@ -17,6 +17,7 @@
 #include "Node.hpp"
 #include "NodeGraph.hpp"
 #include "ModelSet.hpp"
+#include "Context.hpp"
 
 #include <ckm/math.hpp>
 #include <ckm/aabb.hpp>
@@ -37,22 +38,22 @@ namespace cinek {
     
 
     template class ObjectPool<gfx::Texture>;
-    template class ManagedObjectPool<gfx::Texture, void>;
-    template void ManagedHandle<gfx::Texture, ManagedObjectPool<gfx::Texture, void>>::acquire();
-    template void ManagedHandle<gfx::Texture, ManagedObjectPool<gfx::Texture, void>>::release();
-    template class ManagedObjectPoolBase<gfx::Texture, ManagedObjectPool<gfx::Texture, void>>;
+    template class ManagedObjectPool<gfx::Texture, gfx::Context*>;
+    template void ManagedHandle<gfx::Texture, ManagedObjectPool<gfx::Texture, gfx::Context*>>::acquire();
+    template void ManagedHandle<gfx::Texture, ManagedObjectPool<gfx::Texture, gfx::Context*>>::release();
+    template class ManagedObjectPoolBase<gfx::Texture, ManagedObjectPool<gfx::Texture, gfx::Context*>>;
     
     template class ObjectPool<gfx::Material>;
-    template class ManagedObjectPool<gfx::Material, void>;
-    template void ManagedHandle<gfx::Material, ManagedObjectPool<gfx::Material, void>>::acquire();
-    template void ManagedHandle<gfx::Material, ManagedObjectPool<gfx::Material, void>>::release();
-    template class ManagedObjectPoolBase<gfx::Material, ManagedObjectPool<gfx::Material, void>>;
+    template class ManagedObjectPool<gfx::Material, gfx::Context*>;
+    template void ManagedHandle<gfx::Material, ManagedObjectPool<gfx::Material, gfx::Context*>>::acquire();
+    template void ManagedHandle<gfx::Material, ManagedObjectPool<gfx::Material, gfx::Context*>>::release();
+    template class ManagedObjectPoolBase<gfx::Material, ManagedObjectPool<gfx::Material, gfx::Context*>>;
     
     template class ObjectPool<gfx::AnimationSet>;
-    template class ManagedObjectPool<gfx::AnimationSet, void>;
-    template void ManagedHandle<gfx::AnimationSet, ManagedObjectPool<gfx::AnimationSet, void>>::acquire();
-    template void ManagedHandle<gfx::AnimationSet, ManagedObjectPool<gfx::AnimationSet, void>>::release();
-    template class ManagedObjectPoolBase<gfx::AnimationSet, ManagedObjectPool<gfx::AnimationSet, void>>;
+    template class ManagedObjectPool<gfx::AnimationSet, gfx::Context*>;
+    template void ManagedHandle<gfx::AnimationSet, ManagedObjectPool<gfx::AnimationSet, gfx::Context*>>::acquire();
+    template void ManagedHandle<gfx::AnimationSet, ManagedObjectPool<gfx::AnimationSet, gfx::Context*>>::release();
+    template class ManagedObjectPoolBase<gfx::AnimationSet, ManagedObjectPool<gfx::AnimationSet, gfx::Context*>>;
     
     template class ObjectPool<gfx::AnimationController>;
     template class ManagedObjectPool<gfx::AnimationController, void>;
@@ -61,16 +62,16 @@ namespace cinek {
     template class ManagedObjectPoolBase<gfx::AnimationController, ManagedObjectPool<gfx::AnimationController, void>>;
     
     template class ObjectPool<gfx::Mesh>;
-    template class ManagedObjectPool<gfx::Mesh, void>;
-    template void ManagedHandle<gfx::Mesh, ManagedObjectPool<gfx::Mesh, void>>::acquire();
-    template void ManagedHandle<gfx::Mesh, ManagedObjectPool<gfx::Mesh, void>>::release();
-    template class ManagedObjectPoolBase<gfx::Mesh, ManagedObjectPool<gfx::Mesh, void>>;
+    template class ManagedObjectPool<gfx::Mesh, gfx::Context*>;
+    template void ManagedHandle<gfx::Mesh, ManagedObjectPool<gfx::Mesh, gfx::Context*>>::acquire();
+    template void ManagedHandle<gfx::Mesh, ManagedObjectPool<gfx::Mesh, gfx::Context*>>::release();
+    template class ManagedObjectPoolBase<gfx::Mesh, ManagedObjectPool<gfx::Mesh, gfx::Context*>>;
     
     template class ObjectPool<gfx::Light>;
-    template class ManagedObjectPool<gfx::Light, void>;
-    template void ManagedHandle<gfx::Light, ManagedObjectPool<gfx::Light, void>>::acquire();
-    template void ManagedHandle<gfx::Light, ManagedObjectPool<gfx::Light, void>>::release();
-    template class ManagedObjectPoolBase<gfx::Light, ManagedObjectPool<gfx::Light, void>>;
+    template class ManagedObjectPool<gfx::Light, gfx::Context*>;
+    template void ManagedHandle<gfx::Light, ManagedObjectPool<gfx::Light, gfx::Context*>>::acquire();
+    template void ManagedHandle<gfx::Light, ManagedObjectPool<gfx::Light, gfx::Context*>>::release();
+    template class ManagedObjectPoolBase<gfx::Light, ManagedObjectPool<gfx::Light, gfx::Context*>>;
     
     /* Use 16-byte alignment for nodes - matrix alignment conforms to SSE 128-bit ops */
     template class ObjectPool<gfx::Node, 16>;
@@ -80,10 +81,10 @@ namespace cinek {
     template class ManagedObjectPoolBase<gfx::Node, ManagedObjectPool<gfx::Node, gfx::NodeGraph*, 16>, 16>;
 
     template class ObjectPool<gfx::ModelSet>;
-    template class ManagedObjectPool<gfx::ModelSet, void>;
-    template void ManagedHandle<gfx::ModelSet, ManagedObjectPool<gfx::ModelSet, void>>::acquire();
-    template void ManagedHandle<gfx::ModelSet, ManagedObjectPool<gfx::ModelSet, void>>::release();
-    template class ManagedObjectPoolBase<gfx::ModelSet, ManagedObjectPool<gfx::ModelSet, void>>;
+    template class ManagedObjectPool<gfx::ModelSet, gfx::Context*>;
+    template void ManagedHandle<gfx::ModelSet, ManagedObjectPool<gfx::ModelSet, gfx::Context*>>::acquire();
+    template void ManagedHandle<gfx::ModelSet, ManagedObjectPool<gfx::ModelSet, gfx::Context*>>::release();
+    template class ManagedObjectPoolBase<gfx::ModelSet, ManagedObjectPool<gfx::ModelSet, gfx::Context*>>;
 
 
     namespace gfx {
@@ -35,6 +35,15 @@ enum class PrimitiveType
     kLines
 };
 
+//  Named resource types tracked by the Context's residency manager
+enum class ResourceType
+{
+    kTexture,
+    kMaterial,
+    kAnimationSet,
+    kModelSet
+};
+
 class Context;
 class Texture;
 class Mesh;
@@ -52,14 +61,14 @@ class ModelSet;
 
 using NodeId = uint64_t;
 
-using MeshPool = ManagedObjectPool<Mesh, void>;
-using TexturePool = ManagedObjectPool<Texture, void>;
-using MaterialPool = ManagedObjectPool<Material, void>;
-using AnimationSetPool = ManagedObjectPool<AnimationSet, void>;
+using MeshPool = ManagedObjectPool<Mesh, Context*>;
+using TexturePool = ManagedObjectPool<Texture, Context*>;
+using MaterialPool = ManagedObjectPool<Material, Context*>;
+using AnimationSetPool = ManagedObjectPool<AnimationSet, Context*>;
 using AnimationControllerPool = ManagedObjectPool<AnimationController, void>;
-using LightPool = ManagedObjectPool<Light, void>;
+using LightPool = ManagedObjectPool<Light, Context*>;
 using NodePool = ManagedObjectPool<Node, NodeGraph*, 16>;
-using ModelSetPool = ManagedObjectPool<ModelSet, void>;
+using ModelSetPool = ManagedObjectPool<ModelSet, Context*>;
 
 using MeshHandle = ManagedHandle<Mesh, MeshPool>;
 using TextureHandle = ManagedHandle<Texture, TexturePool>;
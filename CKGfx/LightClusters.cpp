@@ -0,0 +1,354 @@
+//
+//  LightClusters.cpp
+//  GfxPrototype
+//
+//  Created by Samir Sinha on 4/4/16.
+//
+//
+
+#include "LightClusters.hpp"
+#include "Light.hpp"
+
+#include "Shaders/ckgfx.sh"
+
+#include <cinek/debug.h>
+
+#include <bgfx/bgfx.h>
+#include <bx/fpumath.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace cinek {
+    namespace gfx {
+
+static const uint32_t kClusterCount = CKGFX_SHADERS_CLUSTER_X
+                                    * CKGFX_SHADERS_CLUSTER_Y
+                                    * CKGFX_SHADERS_CLUSTER_Z;
+static const uint32_t kLightDataWidth = CKGFX_SHADERS_CLUSTER_LIGHT_LIMIT
+                                      * CKGFX_SHADERS_CLUSTER_LIGHT_TEXELS;
+static const uint32_t kGridWidth = CKGFX_SHADERS_CLUSTER_X * CKGFX_SHADERS_CLUSTER_Y;
+static const uint32_t kIndexLimit = CKGFX_SHADERS_CLUSTER_INDEX_WIDTH
+                                  * CKGFX_SHADERS_CLUSTER_INDEX_HEIGHT;
+
+static const uint32_t kTextureFlags = BGFX_TEXTURE_MIN_POINT
+                                    | BGFX_TEXTURE_MAG_POINT
+                                    | BGFX_TEXTURE_MIP_POINT
+                                    | BGFX_TEXTURE_U_CLAMP
+                                    | BGFX_TEXTURE_V_CLAMP;
+
+//  A light's attenuation never reaches zero.  Its range is the distance at
+//  which its contribution falls below one 8-bit color step.
+static float lightRange(const Light& light)
+{
+    const float kAttenuationLimit = 256.0f;
+
+    const float c = light.coeff.x;
+    const float l = light.coeff.y;
+    const float e = light.coeff.z;
+
+    float range;
+    if (e > 0.0f) {
+        range = (-l + std::sqrt(l*l - 4.0f*e*(c - kAttenuationLimit))) / (2.0f*e);
+    }
+    else if (l > 0.0f) {
+        range = (kAttenuationLimit - c) / l;
+    }
+    else {
+        return FLT_MAX;
+    }
+    //  attenuation is relative to the light's distance
+    return std::max(range, 0.0f) * light.distance;
+}
+
+static bool sphereIntersectsBox
+(
+    const Vector3& center,
+    float radius,
+    const Vector3& bmin,
+    const Vector3& bmax
+)
+{
+    float distSq = 0.0f;
+    for (int i = 0; i < 3; ++i) {
+        float v = center.comp[i];
+        if (v < bmin.comp[i]) {
+            distSq += (bmin.comp[i] - v) * (bmin.comp[i] - v);
+        }
+        else if (v > bmax.comp[i]) {
+            distSq += (v - bmax.comp[i]) * (v - bmax.comp[i]);
+        }
+    }
+    return distSq <= radius*radius;
+}
+
+LightClusters::LightClusters() :
+    _lightLimitReported(false),
+    _boundsNear(0.0f),
+    _boundsFar(0.0f),
+    _currentView(-1)
+{
+    _lights.reserve(CKGFX_SHADERS_CLUSTER_LIGHT_LIMIT);
+    _lightData.resize(kLightDataWidth * 4, 0.0f);
+    _gridData.resize(kClusterCount * 4, 0.0f);
+    _indexData.resize(kIndexLimit * 4, 0.0f);
+    _cellLights.resize(kClusterCount * CKGFX_SHADERS_CLUSTER_CELL_LIMIT);
+    _cellCounts.resize(kClusterCount);
+    _params.x = _params.y = _params.z = _params.w = 0.0f;
+}
+
+void LightClusters::clear()
+{
+    _lights.clear();
+}
+
+void LightClusters::addLight(const Light& light, const Matrix4& worldMtx)
+{
+    if (light.type != LightType::kPoint && light.type != LightType::kSpot)
+        return;
+
+    if (_lights.size() >= CKGFX_SHADERS_CLUSTER_LIGHT_LIMIT) {
+        if (!_lightLimitReported) {
+            CK_LOG_WARN("gfx", "LightClusters - light limit (%u) exceeded",
+                        CKGFX_SHADERS_CLUSTER_LIGHT_LIMIT);
+            _lightLimitReported = true;
+        }
+        return;
+    }
+
+    _lights.push_back({ &light, worldMtx });
+}
+
+auto LightClusters::viewTextures(int viewIndex) -> ViewTextures&
+{
+    for (auto& textures : _viewTextures) {
+        if (textures.viewIndex == viewIndex)
+            return textures;
+    }
+
+    auto create = [](uint16_t w, uint16_t h) -> Texture {
+        bgfx::TextureHandle handle = bgfx::createTexture2D(w, h, 1,
+            bgfx::TextureFormat::RGBA32F, kTextureFlags);
+        return Texture(handle, bgfx::TextureFormat::RGBA32F, w * h * 16);
+    };
+
+    _viewTextures.emplace_back();
+    ViewTextures& textures = _viewTextures.back();
+    textures.viewIndex = viewIndex;
+    textures.lightData = create(kLightDataWidth, 1);
+    textures.grid = create(kGridWidth, CKGFX_SHADERS_CLUSTER_Z);
+    textures.indices = create(CKGFX_SHADERS_CLUSTER_INDEX_WIDTH,
+                              CKGFX_SHADERS_CLUSTER_INDEX_HEIGHT);
+    return textures;
+}
+
+void LightClusters::updateClusterBounds(const Camera& camera)
+{
+    if (!_clusterBounds.empty() &&
+        _boundsNear == camera.near && _boundsFar == camera.far &&
+        !memcmp(_boundsProjMtx.comp, camera.projMtx.comp, sizeof(_boundsProjMtx.comp))) {
+        return;
+    }
+
+    _boundsProjMtx = camera.projMtx;
+    _boundsNear = camera.near;
+    _boundsFar = camera.far;
+    _clusterBounds.resize(kClusterCount);
+
+    //  view space position of each tile corner on the far plane - for
+    //  perspective projections, scaled to unit depth
+    const bool perspective = camera.mode() == Camera::Mode::kPerspective;
+    const uint32_t cornerStride = CKGFX_SHADERS_CLUSTER_X + 1;
+    std::vector<Vector3> corners(cornerStride * (CKGFX_SHADERS_CLUSTER_Y + 1));
+
+    for (uint32_t y = 0; y <= CKGFX_SHADERS_CLUSTER_Y; ++y) {
+        for (uint32_t x = 0; x <= CKGFX_SHADERS_CLUSTER_X; ++x) {
+            Vector4 ndc;
+            ndc.x = -1.0f + 2.0f * x / CKGFX_SHADERS_CLUSTER_X;
+            ndc.y = -1.0f + 2.0f * y / CKGFX_SHADERS_CLUSTER_Y;
+            ndc.z = 1.0f;
+            ndc.w = 1.0f;
+            Vector4 view;
+            bx::vec4MulMtx(view.comp, ndc.comp, camera.invProjMtx.comp);
+
+            Vector3& corner = corners[y * cornerStride + x];
+            corner.x = view.x / view.w;
+            corner.y = view.y / view.w;
+            corner.z = view.z / view.w;
+            if (perspective && corner.z != 0.0f) {
+                corner.x /= corner.z;
+                corner.y /= corner.z;
+            }
+        }
+    }
+
+    const float depthRatio = camera.far / camera.near;
+
+    for (uint32_t z = 0; z < CKGFX_SHADERS_CLUSTER_Z; ++z) {
+        float zNear = camera.near * std::pow(depthRatio, (float)z / CKGFX_SHADERS_CLUSTER_Z);
+        float zFar = camera.near * std::pow(depthRatio, (float)(z+1) / CKGFX_SHADERS_CLUSTER_Z);
+
+        for (uint32_t y = 0; y < CKGFX_SHADERS_CLUSTER_Y; ++y) {
+            for (uint32_t x = 0; x < CKGFX_SHADERS_CLUSTER_X; ++x) {
+                ClusterBounds& bounds = _clusterBounds[(z * CKGFX_SHADERS_CLUSTER_Y + y)
+                                                       * CKGFX_SHADERS_CLUSTER_X + x];
+                bounds.min.x = bounds.min.y = FLT_MAX;
+                bounds.max.x = bounds.max.y = -FLT_MAX;
+                bounds.min.z = zNear;
+                bounds.max.z = zFar;
+
+                for (uint32_t c = 0; c < 4; ++c) {
+                    const Vector3& corner = corners[(y + (c >> 1)) * cornerStride
+                                                    + x + (c & 1)];
+                    for (float depth : { zNear, zFar }) {
+                        float scale = perspective ? depth : 1.0f;
+                        bounds.min.x = std::min(bounds.min.x, corner.x * scale);
+                        bounds.min.y = std::min(bounds.min.y, corner.y * scale);
+                        bounds.max.x = std::max(bounds.max.x, corner.x * scale);
+                        bounds.max.y = std::max(bounds.max.y, corner.y * scale);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void LightClusters::build(const Camera& camera)
+{
+    CK_ASSERT_RETURN(camera.near > 0.0f && camera.far > camera.near);
+
+    ViewTextures& textures = viewTextures(camera.viewIndex);
+    _currentView = (int32_t)(&textures - _viewTextures.data());
+
+    updateClusterBounds(camera);
+
+    const float logDepthRatio = std::log(camera.far / camera.near);
+    const float sliceScale = CKGFX_SHADERS_CLUSTER_Z / logDepthRatio;
+    const float sliceBias = -CKGFX_SHADERS_CLUSTER_Z * std::log(camera.near) / logDepthRatio;
+
+    _params.x = camera.near;
+    _params.y = camera.far;
+    _params.z = sliceScale;
+    _params.w = sliceBias;
+
+    auto sliceFromDepth = [sliceScale, sliceBias](float z) -> int {
+        int slice = (int)std::floor(std::log(z) * sliceScale + sliceBias);
+        return std::max(0, std::min(slice, CKGFX_SHADERS_CLUSTER_Z-1));
+    };
+
+    std::fill(_cellCounts.begin(), _cellCounts.end(), 0);
+
+    for (uint32_t i = 0; i < _lights.size(); ++i) {
+        const Light& l = *_lights[i].light;
+        const Matrix4& worldMtx = _lights[i].worldMtx;
+
+        //  light data texels - the same layout as the uniform arrays
+        float* texels = _lightData.data() + i * CKGFX_SHADERS_CLUSTER_LIGHT_TEXELS * 4;
+
+        Vector4 color = fromABGR(l.color);
+        memcpy(texels, color.comp, sizeof(float)*4);
+
+        texels[4] = l.ambientComp;
+        texels[5] = l.diffuseComp;
+        texels[6] = l.distance;
+        texels[7] = l.type == LightType::kSpot ? l.cutoff : 0.0f;
+
+        Vector4 dir = Vector4::kZero;
+        if (l.type == LightType::kSpot) {
+            bx::vec4MulMtx(dir.comp, Vector4::kUnitZ.comp, worldMtx.comp);
+            bx::vec3Neg(dir.comp, dir.comp);
+        }
+        memcpy(texels + 8, dir.comp, sizeof(float)*4);
+
+        texels[12] = l.coeff.x;
+        texels[13] = l.coeff.y;
+        texels[14] = l.coeff.z;
+        texels[15] = 0.0f;
+
+        texels[16] = worldMtx.comp[12];
+        texels[17] = worldMtx.comp[13];
+        texels[18] = worldMtx.comp[14];
+        texels[19] = 0.0f;
+
+        //  bin the light's bounding sphere.  spot lights use their full
+        //  sphere, which is conservative
+        float origin[3] = { worldMtx.comp[12], worldMtx.comp[13], worldMtx.comp[14] };
+        Vector3 center;
+        bx::vec3MulMtx(center.comp, origin, camera.viewMtx.comp);
+        float radius = std::min(lightRange(l), camera.far);
+
+        if (center.z + radius < camera.near || center.z - radius > camera.far)
+            continue;
+
+        int sliceStart = sliceFromDepth(std::max(center.z - radius, camera.near));
+        int sliceEnd = sliceFromDepth(std::min(center.z + radius, camera.far));
+
+        for (int z = sliceStart; z <= sliceEnd; ++z) {
+            uint32_t cluster = z * kGridWidth;
+            for (uint32_t tile = 0; tile < kGridWidth; ++tile, ++cluster) {
+                const ClusterBounds& bounds = _clusterBounds[cluster];
+                if (!sphereIntersectsBox(center, radius, bounds.min, bounds.max))
+                    continue;
+                uint16_t& count = _cellCounts[cluster];
+                if (count < CKGFX_SHADERS_CLUSTER_CELL_LIMIT) {
+                    _cellLights[cluster * CKGFX_SHADERS_CLUSTER_CELL_LIMIT + count] = i;
+                    ++count;
+                }
+            }
+        }
+    }
+
+    //  flatten cell lists into the index list
+    uint32_t indexCount = 0;
+    for (uint32_t cluster = 0; cluster < kClusterCount; ++cluster) {
+        uint32_t count = std::min((uint32_t)_cellCounts[cluster], kIndexLimit - indexCount);
+        const uint16_t* cell = _cellLights.data() + cluster * CKGFX_SHADERS_CLUSTER_CELL_LIMIT;
+        for (uint32_t i = 0; i < count; ++i) {
+            _indexData[(indexCount + i) * 4] = cell[i];
+        }
+        _gridData[cluster * 4] = (float)indexCount;
+        _gridData[cluster * 4 + 1] = (float)count;
+        indexCount += count;
+    }
+
+    //  upload
+    if (!_lights.empty()) {
+        uint16_t width = (uint16_t)(_lights.size() * CKGFX_SHADERS_CLUSTER_LIGHT_TEXELS);
+        bgfx::updateTexture2D(textures.lightData.bgfxHandle(), 0, 0, 0, width, 1,
+            bgfx::copy(_lightData.data(), width * sizeof(float) * 4));
+    }
+    bgfx::updateTexture2D(textures.grid.bgfxHandle(), 0, 0, 0,
+        kGridWidth, CKGFX_SHADERS_CLUSTER_Z,
+        bgfx::copy(_gridData.data(), _gridData.size() * sizeof(float)));
+    if (indexCount) {
+        uint16_t rows = (uint16_t)((indexCount + CKGFX_SHADERS_CLUSTER_INDEX_WIDTH - 1)
+                                   / CKGFX_SHADERS_CLUSTER_INDEX_WIDTH);
+        bgfx::updateTexture2D(textures.indices.bgfxHandle(), 0, 0, 0,
+            CKGFX_SHADERS_CLUSTER_INDEX_WIDTH, rows,
+            bgfx::copy(_indexData.data(),
+                       rows * CKGFX_SHADERS_CLUSTER_INDEX_WIDTH * sizeof(float) * 4));
+    }
+}
+
+void LightClusters::bind(const RenderUniformMap& uniforms, uint8_t firstStage) const
+{
+    CK_ASSERT_RETURN(_currentView >= 0);
+
+    const ViewTextures& textures = _viewTextures[_currentView];
+    bgfx::setTexture(firstStage, uniforms[kNodeUniformClusterLightData],
+                     textures.lightData.bgfxHandle(), kTextureFlags);
+    bgfx::setTexture(firstStage+1, uniforms[kNodeUniformClusterGrid],
+                     textures.grid.bgfxHandle(), kTextureFlags);
+    bgfx::setTexture(firstStage+2, uniforms[kNodeUniformClusterIndices],
+                     textures.indices.bgfxHandle(), kTextureFlags);
+}
+
+void LightClusters::setUniforms(const RenderUniformMap& uniforms) const
+{
+    bgfx::setUniform(uniforms[kNodeUniformClusterParams], _params.comp);
+}
+
+    }   // namespace gfx
+}   // namespace cinek
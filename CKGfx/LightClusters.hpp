@@ -0,0 +1,108 @@
+//
+//  LightClusters.hpp
+//  GfxPrototype
+//
+//  Created by Samir Sinha on 4/4/16.
+//
+//
+
+#ifndef CK_Graphics_LightClusters_hpp
+#define CK_Graphics_LightClusters_hpp
+
+#include "GfxTypes.hpp"
+#include "Camera.hpp"
+#include "Texture.hpp"
+#include "NodeRendererTypes.hpp"
+
+#include <vector>
+
+namespace cinek {
+    namespace gfx {
+
+//  Assigns point and spot lights to a view space froxel grid, for clustered
+//  forward shading.
+//
+//  The grid is CKGFX_SHADERS_CLUSTER_X x Y tiles in screen space, with
+//  CKGFX_SHADERS_CLUSTER_Z slices distributed logarithmically between the
+//  camera's near and far planes.  Each frame (per view), lights are added,
+//  binned by testing their bounding spheres against cluster bounds, and the
+//  results are uploaded as three textures.  Texture updates are applied at
+//  the start of a bgfx frame, so each view has its own set of textures:
+//
+//  - light data: CKGFX_SHADERS_CLUSTER_LIGHT_TEXELS texels per light
+//  - cluster grid: first index and light count per cluster
+//  - light indices: the concatenated per-cluster light lists
+//
+//  Fragment shaders locate their cluster and loop over its lights (see
+//  Shaders/cklights.sh)
+//
+class LightClusters
+{
+    CK_CLASS_NON_COPYABLE(LightClusters);
+
+public:
+    LightClusters();
+
+    void clear();
+    //  lights beyond CKGFX_SHADERS_CLUSTER_LIGHT_LIMIT are ignored.  the
+    //  light must remain valid until build
+    void addLight(const Light& light, const Matrix4& worldMtx);
+    //  bins lights for the given camera and uploads the cluster textures
+    //  for the camera's view
+    void build(const Camera& camera);
+    //  binds the last built view's cluster textures for the next submit,
+    //  starting at the given texture stage
+    void bind(const RenderUniformMap& uniforms, uint8_t firstStage) const;
+    //  sets the cluster parameters uniform (once per build)
+    void setUniforms(const RenderUniformMap& uniforms) const;
+
+    uint32_t lightCount() const { return (uint32_t)_lights.size(); }
+
+private:
+    struct LightEntry
+    {
+        const Light* light;
+        Matrix4 worldMtx;
+    };
+    struct ClusterBounds
+    {
+        Vector3 min;
+        Vector3 max;
+    };
+
+    struct ViewTextures
+    {
+        int viewIndex;
+        Texture lightData;
+        Texture grid;
+        Texture indices;
+    };
+
+    ViewTextures& viewTextures(int viewIndex);
+    void updateClusterBounds(const Camera& camera);
+
+    std::vector<LightEntry> _lights;
+    bool _lightLimitReported;
+
+    //  view space bounds per cluster, rebuilt when the projection changes
+    std::vector<ClusterBounds> _clusterBounds;
+    Matrix4 _boundsProjMtx;
+    float _boundsNear;
+    float _boundsFar;
+
+    std::vector<float> _lightData;
+    std::vector<float> _gridData;
+    std::vector<float> _indexData;
+    std::vector<uint16_t> _cellLights;
+    std::vector<uint16_t> _cellCounts;
+
+    Vector4 _params;
+
+    std::vector<ViewTextures> _viewTextures;
+    int32_t _currentView;
+};
+
+    }   // namespace gfx
+}   // namespace cinek
+
+#endif /* CK_Graphics_LightClusters_hpp */
@@ -524,7 +524,8 @@ Mesh::Mesh() :
     _indexType(VertexTypes::Index::kIndex0),
     _primitiveType(PrimitiveType::kUndefined),
     _vertBufH(BGFX_INVALID_HANDLE),
-    _idxBufH(BGFX_INVALID_HANDLE)
+    _idxBufH(BGFX_INVALID_HANDLE),
+    _memorySize(0)
 {
 }
 
@@ -540,7 +541,8 @@ Mesh::Mesh
     _indexType(indexType),
     _primitiveType(primitiveType),
     _vertBufH(BGFX_INVALID_HANDLE),
-    _idxBufH(BGFX_INVALID_HANDLE)
+    _idxBufH(BGFX_INVALID_HANDLE),
+    _memorySize(0)
 {
     bgfx::VertexBufferHandle vbh = bgfx::createVertexBuffer(
         vertexData,
@@ -561,6 +563,7 @@ Mesh::Mesh
     }
     _vertBufH = vbh;
     _idxBufH = ibh;
+    _memorySize = vertexData->size + indexData->size;
 }
 
 Mesh::~Mesh()
@@ -578,13 +581,15 @@ Mesh::Mesh(Mesh&& other) :
     _indexType(other._indexType),
     _primitiveType(other._primitiveType),
     _vertBufH(other._vertBufH),
-    _idxBufH(other._idxBufH)
+    _idxBufH(other._idxBufH),
+    _memorySize(other._memorySize)
 {
     other._format = VertexTypes::kInvalid;
     other._indexType = VertexTypes::Index::kIndex0;
     other._primitiveType = PrimitiveType::kUndefined;
     other._vertBufH = BGFX_INVALID_HANDLE;
     other._idxBufH = BGFX_INVALID_HANDLE;
+    other._memorySize = 0;
 }
 
 Mesh& Mesh::operator=(Mesh&& other)
@@ -594,12 +599,14 @@ Mesh& Mesh::operator=(Mesh&& other)
     _primitiveType = other._primitiveType;
     _vertBufH = other._vertBufH;
     _idxBufH = other._idxBufH;
+    _memorySize = other._memorySize;
     
     other._format = VertexTypes::kInvalid;
     other._indexType = VertexTypes::kIndex0;
     other._primitiveType = PrimitiveType::kUndefined;
     other._vertBufH = BGFX_INVALID_HANDLE;
     other._idxBufH = BGFX_INVALID_HANDLE;
+    other._memorySize = 0;
     
     return *this;
 }    
@@ -50,6 +50,11 @@ public:
     PrimitiveType primitiveType() const {
         return _primitiveType;
     }
+    
+    //  size in bytes of the vertex and index buffers
+    uint32_t memorySize() const {
+        return _memorySize;
+    }
 
 private:
     VertexTypes::Format _format;
@@ -58,6 +63,7 @@ private:
     
     bgfx::VertexBufferHandle _vertBufH;
     bgfx::IndexBufferHandle _idxBufH;
+    uint32_t _memorySize;
 };
 
 
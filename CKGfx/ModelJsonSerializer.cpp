@@ -13,6 +13,9 @@
 #include <cinek/debug.h>
 #include <bx/fpumath.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <vector>
 
 namespace cinek {
@@ -64,6 +67,124 @@ NodeElementCounts& enumerateNodeResourcesFromJSON
     return counts;
 }
 
+static JsonDecodeJobRunner s_jsonDecodeJobRunner;
+
+void setJsonDecodeJobRunner(JsonDecodeJobRunner runner)
+{
+    s_jsonDecodeJobRunner = std::move(runner);
+}
+
+void runJsonDecodeJobs
+(
+    uint32_t count,
+    const std::function<void(uint32_t)>& job
+)
+{
+    if (!count)
+        return;
+    
+    if (s_jsonDecodeJobRunner) {
+        s_jsonDecodeJobRunner(count, job);
+        return;
+    }
+    
+    uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+    threadCount = std::min(threadCount, count);
+    
+    std::atomic<uint32_t> nextJob(0);
+    auto worker = [&nextJob, &job, count]() {
+        for (uint32_t i = nextJob++; i < count; i = nextJob++) {
+            job(i);
+        }
+    };
+    
+    //  the calling thread participates as a worker
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount-1);
+    for (uint32_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+static void collectAnimationSetsFromJSON
+(
+    std::vector<const char*>& names,
+    const JsonValue& node
+)
+{
+    auto animIt = node.FindMember("animation");
+    if (animIt != node.MemberEnd() && animIt->value.IsString()) {
+        names.push_back(animIt->value.GetString());
+    }
+    auto childrenIt = node.FindMember("children");
+    if (childrenIt != node.MemberEnd() && childrenIt->value.IsArray()) {
+        for (auto it = childrenIt->value.Begin(); it != childrenIt->value.End(); ++it) {
+            collectAnimationSetsFromJSON(names, *it);
+        }
+    }
+}
+
+void NodeJsonLoader::stageResources(const JsonValue& root)
+{
+    //  meshes are staged unconditionally since each JSON mesh is unique to
+    //  this document.  animation sets are shared by name across documents,
+    //  so only decode those not yet registered (or refreshed.)
+    uint32_t meshCount = 0;
+    if (jsonMeshes != root.MemberEnd() && jsonMeshes->value.IsArray()) {
+        meshCount = jsonMeshes->value.Size();
+    }
+    
+    std::vector<const char*> animationNames;
+    auto nodesIt = root.FindMember("nodes");
+    if (jsonAnimations != root.MemberEnd() && nodesIt != root.MemberEnd()) {
+        collectAnimationSetsFromJSON(animationNames, nodesIt->value);
+    }
+    std::vector<JsonValue::ConstMemberIterator> animationJobs;
+    for (auto name : animationNames) {
+        auto objIt = jsonAnimations->value.FindMember(name);
+        if (objIt == jsonAnimations->value.MemberEnd())
+            continue;
+        if (std::find(animationJobs.begin(), animationJobs.end(), objIt) != animationJobs.end())
+            continue;
+        if (!refreshResources && context->findAnimationSet(name))
+            continue;
+        animationJobs.push_back(objIt);
+    }
+    
+    stagedMeshes.clear();
+    stagedMeshes.resize(meshCount);
+    stagedAnimationSets.clear();
+    stagedAnimationSetValid.clear();
+    if (!animationJobs.empty()) {
+        uint32_t animationCount = jsonAnimations->value.MemberEnd() -
+                                  jsonAnimations->value.MemberBegin();
+        stagedAnimationSets.resize(animationCount);
+        stagedAnimationSetValid.resize(animationCount, false);
+    }
+    
+    runJsonDecodeJobs(meshCount + (uint32_t)animationJobs.size(),
+        [this, meshCount, &animationJobs](uint32_t index) {
+            if (index < meshCount) {
+                stagedMeshes[index] = stageMeshFromJSON(jsonMeshes->value[index]);
+            }
+            else {
+                auto objIt = animationJobs[index - meshCount];
+                auto animIndex = objIt - jsonAnimations->value.MemberBegin();
+                stagedAnimationSets[animIndex] =
+                    loadAnimationSetFromJSON(*context, objIt->value);
+            }
+        });
+    
+    //  std::vector<bool> isn't safe for concurrent writes, so mark after
+    for (auto objIt : animationJobs) {
+        stagedAnimationSetValid[objIt - jsonAnimations->value.MemberBegin()] = true;
+    }
+}
+
 /*
 struct NodeJsonLoader
 {
@@ -117,20 +238,38 @@ NodeHandle NodeJsonLoader::operator()
                         // find or create material
                         const char* materialName = jsonMesh["material"].GetString();
                         auto materialHandle = context->findMaterial(materialName);
-                        if (!materialHandle) {
+                        if (!materialHandle ||
+                            (refreshResources && !refreshedResources.count(materialHandle.resource()))) {
                             auto jsonMaterialIt = jsonMaterials->value.FindMember(materialName);
                             if (jsonMaterialIt != jsonMaterials->value.MemberEnd()) {
-                                materialHandle = context->registerMaterial(
-                                    std::move(loadMaterialFromJSON(*context, jsonMaterialIt->value)),
-                                    jsonMaterialIt->name.GetString());
+                                if (materialHandle) {
+                                    *materialHandle = loadMaterialFromJSON(*context, jsonMaterialIt->value);
+                                    refreshedResources.insert(materialHandle.resource());
+                                }
+                                else {
+                                    materialHandle = context->registerMaterial(
+                                        std::move(loadMaterialFromJSON(*context, jsonMaterialIt->value)),
+                                        jsonMaterialIt->name.GetString());
+                                }
                             }
                         }
                         meshPair.second = materialHandle;
                     }
                     if (!meshPair.first) {
-                        meshPair.first =  context->registerMesh(
-                            std::move(loadMeshFromJSON(*context, jsonMesh))
-                        );
+                        if (meshIndex < stagedMeshes.size() &&
+                            stagedMeshes[meshIndex].format != VertexTypes::kInvalid) {
+                            meshPair.first = context->registerMesh(
+                                createMeshFromStaging(stagedMeshes[meshIndex])
+                            );
+                            if (!retainStagedMeshes) {
+                                stagedMeshes[meshIndex] = MeshStaging();
+                            }
+                        }
+                        else {
+                            meshPair.first =  context->registerMesh(
+                                std::move(loadMeshFromJSON(*context, jsonMesh))
+                            );
+                        }
                     }
                     meshElement->mesh = meshPair.first;
                     meshElement->material = meshPair.second;
@@ -144,14 +283,31 @@ NodeHandle NodeJsonLoader::operator()
         thisNode = nodeGraph.createArmatureNode();
         
         auto animationSetHandle = context->findAnimationSet(animationSetName);
-        if (!animationSetHandle) {
+        if (!animationSetHandle ||
+            (refreshResources && !refreshedResources.count(animationSetHandle.resource()))) {
             auto objIt = jsonAnimations->value.FindMember(animationSetName);
-            auto& jsonObject = objIt->value;
-            const char* name = objIt->name.GetString();
-            animationSetHandle = context->registerAnimationSet(
-                    std::move(loadAnimationSetFromJSON(*context, jsonObject)),
-                    name
-                );
+            if (objIt != jsonAnimations->value.MemberEnd()) {
+                auto animIndex = objIt - jsonAnimations->value.MemberBegin();
+                AnimationSet animationSet;
+                if (animIndex < stagedAnimationSetValid.size() &&
+                    stagedAnimationSetValid[animIndex]) {
+                    animationSet = std::move(stagedAnimationSets[animIndex]);
+                    stagedAnimationSetValid[animIndex] = false;
+                }
+                else {
+                    animationSet = loadAnimationSetFromJSON(*context, objIt->value);
+                }
+                if (animationSetHandle) {
+                    *animationSetHandle = std::move(animationSet);
+                    refreshedResources.insert(animationSetHandle.resource());
+                }
+                else {
+                    animationSetHandle = context->registerAnimationSet(
+                        std::move(animationSet),
+                        objIt->name.GetString()
+                    );
+                }
+            }
         }
 
         thisNode->armature()->animSet = animationSetHandle;
@@ -286,6 +442,10 @@ NodeGraph loadNodeGraphFromJSON
     if (loader.jsonLights != root.MemberEnd() && !loader.jsonLights->value.Empty()) {
         loader.lights.reserve(loader.jsonLights->value.Size());
     }
+    
+    //  decode the heavy sections up front across threads, leaving the graph
+    //  build below to register the results serially
+    loader.stageResources(root);
 
     ModelBuilderFromJSONFn buildFn(loader);
     
@@ -297,13 +457,15 @@ NodeGraph loadNodeGraphFromJSON
 ModelSet loadModelSetFromJSON
 (
     Context& context,
-    const JsonValue& root
+    const JsonValue& root,
+    bool refreshResources
 )
 {
     ModelSet modelSet;
     
     NodeJsonLoader loader;
     loader.context = &context;
+    loader.refreshResources = refreshResources;
     
     NodeGraph nodeGraph = loadNodeGraphFromJSON(loader, root);
     
@@ -336,13 +498,9 @@ NodeGraph loadNodeGraphFromJSON
     return std::move(nodeGraph);
 }
 
-Mesh loadMeshFromJSON
-(
-    Context& context,
-    const JsonValue& root
-)
+MeshStaging stageMeshFromJSON(const JsonValue& root)
 {
-    Mesh mesh;
+    MeshStaging mesh;
     
     const JsonValue& vertices = root["vertices"];
     
@@ -394,13 +552,21 @@ Mesh loadMeshFromJSON
     
     MeshBuilder::BuilderState meshBuilder;
     
+    int32_t vertexLimit = (int)vertices.Size();
     int32_t indexLimit = (int)triangles.Size() * 3;
     CK_ASSERT(indexLimit <= UINT16_MAX);
     
     meshBuilder.vertexDecl = &VertexTypes::declaration(vertexType);
     meshBuilder.indexType = VertexTypes::kIndex16;
     
-    MeshBuilder::create(meshBuilder, { (int)vertices.Size(), indexLimit });
+    //  build into our own buffers - bgfx memory is allocated when the mesh
+    //  is created
+    mesh.vertexData.resize(meshBuilder.vertexDecl->getSize(vertexLimit));
+    mesh.indexData.resize(sizeof(uint16_t) * indexLimit);
+    
+    MeshBuilder::createWithBuffers(meshBuilder,
+                                   mesh.vertexData.data(), 0, vertexLimit,
+                                   mesh.indexData.data(), 0, indexLimit);
     
     JsonValue::ConstValueIterator vertexIt = vertices.Begin();
     JsonValue::ConstValueIterator normalIt = nullptr;
@@ -454,12 +620,33 @@ Mesh loadMeshFromJSON
         meshBuilder.triangle<uint16_t>(i0,i1,i2);
     }
     
-    return Mesh(vertexType, meshBuilder.indexType,
-                    meshBuilder.vertexMemory,
-                    meshBuilder.indexMemory,
-                    PrimitiveType::kTriangles);
+    mesh.format = vertexType;
+    mesh.indexType = meshBuilder.indexType;
+    
+    return mesh;
 }
 
+Mesh createMeshFromStaging(const MeshStaging& staging)
+{
+    if (staging.format == VertexTypes::kInvalid)
+        return Mesh();
+    
+    return Mesh(staging.format, staging.indexType,
+                bgfx::copy(staging.vertexData.data(), (uint32_t)staging.vertexData.size()),
+                bgfx::copy(staging.indexData.data(), (uint32_t)staging.indexData.size()),
+                PrimitiveType::kTriangles);
+}
+
+Mesh loadMeshFromJSON
+(
+    Context& context,
+    const JsonValue& root
+)
+{
+    return createMeshFromStaging(stageMeshFromJSON(root));
+}
+
+
 Material loadMaterialFromJSON(Context& context, const JsonValue& root)
 {
     Material material;
@@ -18,11 +18,25 @@
 #include "Light.hpp"
 
 #include <ckjson/json.hpp>
+#include <functional>
+#include <string>
 #include <vector>
+#include <unordered_set>
 
 namespace cinek {
     namespace gfx {
 
+//  CPU side mesh data decoded from JSON.  Decoding doesn't touch bgfx or the
+//  Context, so meshes can be staged off the main thread and created later
+//  via createMeshFromStaging.
+struct MeshStaging
+{
+    VertexTypes::Format format = VertexTypes::kInvalid;
+    VertexTypes::Index indexType = VertexTypes::kIndex0;
+    std::vector<uint8_t> vertexData;
+    std::vector<uint8_t> indexData;
+};
+
 struct NodeJsonLoader
 {
     gfx::Context* context;
@@ -36,13 +50,47 @@ struct NodeJsonLoader
     std::vector<std::pair<MeshHandle, MaterialHandle>> meshes;
     std::vector<LightHandle> lights;
     
+    //  if true, named materials and animation sets already registered with
+    //  the context are overwritten in place (used when reloading models)
+    bool refreshResources = false;
+    std::unordered_set<const void*> refreshedResources;
+    
+    //  resources decoded in parallel by stageResources, consumed as nodes
+    //  referencing them are built.  indexed by the JSON mesh/animation index
+    std::vector<MeshStaging> stagedMeshes;
+    std::vector<AnimationSet> stagedAnimationSets;
+    std::vector<bool> stagedAnimationSetValid;
+    //  if true, staged meshes are kept after their Mesh is created so callers
+    //  can persist mesh data (bgfx doesn't allow reading it back)
+    bool retainStagedMeshes = false;
+    
+    //  decodes meshes and animation sets referenced by the document in
+    //  parallel.  the json iterators must be set prior to calling.  optional -
+    //  unstaged resources are decoded on demand.
+    void stageResources(const JsonValue& root);
+    
     NodeHandle operator()(NodeGraph& nodeGraph, const JsonValue& jsonNode);
 };
 
 NodeGraph loadNodeGraphFromJSON(Context& context, const JsonValue& root);
-ModelSet loadModelSetFromJSON(Context& context, const JsonValue& root);
+ModelSet loadModelSetFromJSON(Context& context, const JsonValue& root,
+                              bool refreshResources=false);
+
+
+//  runs job(0..count-1) across worker threads and the calling thread,
+//  returning when all jobs have finished.  used for decoding large documents
+void runJsonDecodeJobs(uint32_t count, const std::function<void(uint32_t)>& job);
+
+//  replaces the threads runJsonDecodeJobs spawns per call with an
+//  application supplied runner (i.e. a job system.)  the runner must not
+//  return until all jobs have finished.  pass an empty runner to restore
+//  the default
+using JsonDecodeJobRunner =
+    std::function<void(uint32_t, const std::function<void(uint32_t)>&)>;
+void setJsonDecodeJobRunner(JsonDecodeJobRunner runner);
 
-        
+MeshStaging stageMeshFromJSON(const JsonValue& root);
+Mesh createMeshFromStaging(const MeshStaging& staging);
 Mesh loadMeshFromJSON(Context& context, const JsonValue& root);
 Material loadMaterialFromJSON(Context& context, const JsonValue& root);
 AnimationSet loadAnimationSetFromJSON(Context& context, const JsonValue& root);
@@ -27,6 +27,11 @@ public:
     
     NodeHandle find(const std::string& name) const;
     
+    const NodeGraph& nodeGraph() const { return _nodeGraph; }
+    const std::vector<std::pair<std::string, NodeHandle>>& models() const {
+        return _models;
+    }
+    
 private:
     NodeGraph _nodeGraph;
     std::vector<std::pair<std::string, NodeHandle>> _models;
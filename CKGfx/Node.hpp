@@ -62,6 +62,9 @@ struct Node
 {
     enum
     {
+        //  the local transform changed since the last NodeTransformCache
+        //  update
+        kNodeFlagTransformDirty     = 0x00000001,
         kNodeFlagMask               = 0x00ffffff,
         kElementTypeMask            = 0xff000000
     };
@@ -90,8 +93,17 @@ struct Node
     }
     
     const Matrix4& transform() const { return _mtx; }
+    //  callers modifying the transform in place should call
+    //  markTransformDirty() so that cached world transforms are updated
     Matrix4& transform() { return _mtx; }
-    void setTransform(const Matrix4& mtx) { _mtx = mtx; }
+    void setTransform(const Matrix4& mtx) {
+        _mtx = mtx;
+        markTransformDirty();
+    }
+    
+    void markTransformDirty() { _flags |= kNodeFlagTransformDirty; }
+    void clearTransformDirty() { _flags &= ~kNodeFlagTransformDirty; }
+    bool isTransformDirty() const { return checkFlags(kNodeFlagTransformDirty); }
     
     const ckm::AABB<Vector3>& obb() const { return _obb; }
     ckm::AABB<Vector3>& obb() { return _obb; }
@@ -11,6 +11,8 @@
 #include <cinek/debug.h>
 #include <cinek/objectpool.inl>
 
+#include <algorithm>
+
 namespace cinek {
 
     template class ObjectPool<gfx::MeshElement>;
@@ -37,7 +39,8 @@ NodeGraph::NodeGraph(NodeGraph&& other) :
     _armatureElementPool(std::move(other._armatureElementPool)),
     _lightElementPool(std::move(other._lightElementPool)),
     _nodes(std::move(other._nodes)),
-    _root(std::move(other._root))
+    _root(std::move(other._root)),
+    _topologyVersion(other._topologyVersion + 1)
 {
     _nodes.setDelegate(this);
 }
@@ -49,6 +52,7 @@ NodeGraph& NodeGraph::operator=(NodeGraph&& other)
     _lightElementPool = std::move(other._lightElementPool);
     _nodes = std::move(other._nodes);
     _root = std::move(other._root);
+    _topologyVersion = std::max(_topologyVersion, other._topologyVersion) + 1;
     
     _nodes.setDelegate(this);
     
@@ -145,11 +149,13 @@ void NodeGraph::onReleaseManagedObject(cinek::gfx::Node &node)
 void NodeGraph::setRoot(NodeHandle node)
 {
     _root = node;
+    ++_topologyVersion;
 }
 
 void NodeGraph::clearRoot()
 {
     _root = nullptr;
+    ++_topologyVersion;
 }
 
 NodeHandle NodeGraph::addChildNodeToNode(NodeHandle child, NodeHandle node)
@@ -174,6 +180,8 @@ NodeHandle NodeGraph::addChildNodeToNode(NodeHandle child, NodeHandle node)
     
     //  update the parent's obb to reflect the new child
     node->obb().merge(child->calculateAABB());
+    
+    ++_topologyVersion;
 
     return child;
 }
@@ -207,6 +215,8 @@ NodeHandle NodeGraph::detachNode(NodeHandle child)
     child->_prevSibling = nullptr;
     child->_nextSibling = nullptr;
     
+    ++_topologyVersion;
+    
     return child;
 }
 
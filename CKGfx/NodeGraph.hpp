@@ -38,6 +38,10 @@ public:
     ~NodeGraph();
 
     NodeHandle root() const { return _root; }
+    //  incremented when nodes are attached to or detached from one another,
+    //  or when the root changes.  used to invalidate flattened views of the
+    //  graph (i.e. NodeTransformCache)
+    uint32_t topologyVersion() const { return _topologyVersion; }
     NodeHandle createObjectNode(NodeId nodeId);
     NodeHandle createMeshNode(uint32_t elementCnt);
     NodeHandle createArmatureNode();
@@ -68,6 +72,7 @@ private:
     ObjectPool<LightElement> _lightElementPool;
     NodePool _nodes;
     NodeHandle _root;
+    uint32_t _topologyVersion = 0;
 };
 
     }   // namespace gfx
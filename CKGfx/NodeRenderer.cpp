@@ -27,6 +27,8 @@
 #include <bgfx/bgfx_shader.sh>
 #include <bx/fpumath.h>
 
+#include <algorithm>
+
 namespace bx {
 
 	inline void mtxQuatRCS(float* __restrict _result, const float* __restrict _quat)
@@ -140,7 +142,94 @@ namespace cinek {
  *
  */
  
-NodeRenderer::NodeRenderer()
+const uint32_t NodeRenderer::kMinInstanceCount;
+
+//  texture stages 1-3 hold the light cluster textures (0 is diffuse)
+static const uint8_t kClusterTextureStage = 1;
+
+//  per instance data is the instance's world transform
+static const uint16_t kInstanceDataStride = sizeof(float) * 16;
+
+//  Draw sort keys, from most to least significant bits:
+//      view (8), program (5), material (16), mesh (16), depth (16)
+//
+//  Draws sharing a prefix through the mesh field differ only by transform,
+//  and are candidates for instancing.  Depth sorts front to back within a
+//  mesh to make the most of early-z.
+static const uint32_t kDrawKeyDepthBits = 16;
+static const uint32_t kDrawKeyMeshBits = 16;
+static const uint32_t kDrawKeyMaterialBits = 16;
+static const uint32_t kDrawKeyProgramBits = 5;
+static const uint32_t kDrawKeyViewBits = 8;
+
+static const uint32_t kDrawKeyDepthShift = 3;
+static const uint32_t kDrawKeyMeshShift = kDrawKeyDepthShift + kDrawKeyDepthBits;
+static const uint32_t kDrawKeyMaterialShift = kDrawKeyMeshShift + kDrawKeyMeshBits;
+static const uint32_t kDrawKeyProgramShift = kDrawKeyMaterialShift + kDrawKeyMaterialBits;
+static const uint32_t kDrawKeyViewShift = kDrawKeyProgramShift + kDrawKeyProgramBits;
+
+static_assert(kDrawKeyViewShift + kDrawKeyViewBits == 64, "Draw key must be 64 bits");
+static_assert(kNodeProgramLimit <= (1 << kDrawKeyProgramBits),
+              "Draw key program field is too small");
+
+//  LSD radix sort on 8-bit digits.  Stable, so equal keys retain traversal
+//  order.  Passes where every key shares the same digit are skipped, which
+//  in practice skips the view and most program passes.
+template<typename Keys>
+static void radixSortDrawKeys(Keys& keys, Keys& scratch)
+{
+    const size_t count = keys.size();
+    if (count < 2)
+        return;
+    
+    scratch.resize(count);
+    auto src = keys.data();
+    auto dst = scratch.data();
+    
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        uint32_t histogram[256] = { 0 };
+        for (size_t i = 0; i < count; ++i) {
+            ++histogram[(src[i].key >> shift) & 0xff];
+        }
+        if (histogram[(src[0].key >> shift) & 0xff] == count)
+            continue;
+        
+        uint32_t offset = 0;
+        for (uint32_t d = 0; d < 256; ++d) {
+            uint32_t digitCount = histogram[d];
+            histogram[d] = offset;
+            offset += digitCount;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            dst[histogram[(src[i].key >> shift) & 0xff]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    
+    if (src != keys.data()) {
+        memcpy(keys.data(), src, count * sizeof(*src));
+    }
+}
+
+static NodeProgramSlot instancedProgramSlot(NodeProgramSlot slot)
+{
+    switch (slot) {
+    case kNodeProgramMeshUV:
+        return kNodeProgramMeshUVInstanced;
+    case kNodeProgramMeshColor:
+        return kNodeProgramMeshColorInstanced;
+    default:
+        break;
+    }
+    return kNodeProgramNone;
+}
+
+NodeRenderer::NodeRenderer() :
+    _instancingEnabled(true),
+    _stats { 0, 0, 0, 0 },
+    _drawKeyIdCount(0),
+    _drawKeyMaterialCount(0),
+    _drawKeyMeshCount(0)
 {
     _nodeStack.reserve(32);
     _transformStack.reserve(32);
@@ -155,6 +244,9 @@ NodeRenderer::NodeRenderer()
     
     _globalLights.reserve(8);
     _directionalLights.reserve(64);
+    _meshDraws.reserve(256);
+    _drawKeys.reserve(256);
+    _drawKeyIds.resize(512, DrawKeyId { nullptr, 0 });
 }
 
 void NodeRenderer::setPlaceholderDiffuseTexture(TextureHandle diffuseTexHandle)
@@ -162,6 +254,11 @@ void NodeRenderer::setPlaceholderDiffuseTexture(TextureHandle diffuseTexHandle)
     _placeholderDiffuseTex = diffuseTexHandle;
 }
 
+void NodeRenderer::setInstancingEnabled(bool enabled)
+{
+    _instancingEnabled = enabled;
+}
+
 void NodeRenderer::operator()
 (
     const ProgramMap& programs,
@@ -197,31 +294,7 @@ void NodeRenderer::operator()
             bx::mtxIdentity(topTransform);
             pushTransform(topTransform);
         
-            switch (currentStage) {
-            case kStageFlagRender: {
-                    bgfx::setViewRect(_camera->viewIndex,
-                        _camera->viewportRect.x, _camera->viewportRect.y,
-                        _camera->viewportRect.w ,_camera->viewportRect.h);
-                
-                    if (renderTarget) {
-                        bgfx::setViewFrameBuffer(_camera->viewIndex, renderTarget.bgfxHandle());
-                    }
-
-                    bgfx::setViewTransform(_camera->viewIndex,
-                        _camera->viewMtx.comp,
-                        _camera->projMtx.comp);
-                
-                    memcpy(_viewProjMtx.comp, _camera->viewProjMtx.comp, sizeof(_viewProjMtx.comp));
-                }
-                break;
-            case kStageFlagLightEnum: {
-                    _globalLights.clear();
-                    _directionalLights.clear();
-                }
-                break;
-            default:
-                break;
-            }
+            beginStage(currentStage, renderTarget);
         
             while (!_nodeStack.empty() || node) {
                 if (node) {
@@ -231,18 +304,9 @@ void NodeRenderer::operator()
                         //  Lighting Pass
                         //
                         if (node->elementType() == Node::kElementTypeLight) {
-                            const LightElement* e = node->light();
-                            
                             Matrix4 lightMtx;
                             bx::mtxMul(lightMtx, node->transform(), _transformStack.back());
-                            
-                            if (e->light->type == LightType::kAmbient
-                                || e->light->type == LightType::kDirectional) {
-                                _globalLights.emplace_back(LightState{ lightMtx, e->light } );
-                            }
-                            else {
-                                _directionalLights.emplace_back(LightState{ lightMtx, e->light });
-                            }
+                            addLight(node->light()->light, lightMtx);
                         }
                     }
                     else if (currentStage == kStageFlagRender) {
@@ -255,14 +319,17 @@ void NodeRenderer::operator()
                                 ArmatureState state { armature };
                                 bx::mtxMul(state.armatureToWorldMtx, node->transform(),
                                            _transformStack.back());
+                                state.subtreeEnd = NodeTransformCache::kInvalidIndex;
                                 _armatureStack.emplace_back(state);
                             }
                             break;
                         
                         case Node::kElementTypeMesh: {
+                                Matrix4 worldMtx;
+                                bx::mtxMul(worldMtx, node->transform(), _transformStack.back());
                                 const MeshElement* mesh = node->mesh();
                                 while (mesh) {
-                                    renderMeshElement(programs, uniforms, node->transform(), *mesh);
+                                    queueMeshElement(worldMtx, *mesh);
                                     mesh = mesh->next;
                                 }
                             }
@@ -301,10 +368,11 @@ void NodeRenderer::operator()
                 }
             }
         
+            endStage(currentStage, programs, uniforms);
+            
+            popTransform();     // cleanup default top-level transform
         }
         
-        popTransform();     // cleanup default top-level transform
-        
         stages >>= 1;
         currentStage <<= 1;
     }
@@ -314,6 +382,204 @@ void NodeRenderer::operator()
     CK_ASSERT(_armatureStack.empty());
 }
 
+void NodeRenderer::operator()
+(
+    const ProgramMap& programs,
+    const UniformMap& uniforms,
+    const Camera& camera,
+    const NodeTransformCache& transforms,
+    uint32_t stages /*=kStageAll */
+)
+{
+    (*this)(programs, uniforms, RenderTarget(), camera, transforms, stages);
+}
+
+void NodeRenderer::operator()
+(
+    const ProgramMap& programs,
+    const UniformMap& uniforms,
+    const RenderTarget& renderTarget,
+    const Camera& camera,
+    const NodeTransformCache& transforms,
+    uint32_t stages /*=kStageAll */
+)
+{
+    uint32_t currentStage = 1;
+    
+    _camera = &camera;
+    
+    //  the cache is in parent-before-child order, so the same stages run as
+    //  a linear pass.  armature scope ends at the armature's subtree end.
+    const uint32_t nodeCount = transforms.size();
+    
+    while (stages) {
+        if ((stages & 0x01)!=0) {
+            beginStage(currentStage, renderTarget);
+            
+            for (uint32_t i = 0; i < nodeCount; ++i) {
+                const Node* node = transforms.node(i);
+                const Matrix4& worldMtx = transforms.worldTransform(i);
+                
+                if (currentStage == kStageFlagLightEnum) {
+                    if (node->elementType() == Node::kElementTypeLight) {
+                        addLight(node->light()->light, worldMtx);
+                    }
+                }
+                else if (currentStage == kStageFlagRender) {
+                    while (!_armatureStack.empty()
+                           && _armatureStack.back().subtreeEnd <= i) {
+                        _armatureStack.pop_back();
+                    }
+                    
+                    switch (node->elementType()) {
+                    case Node::kElementTypeArmature: {
+                            ArmatureState state { node->armature(), worldMtx,
+                                                  transforms.subtreeEnd(i) };
+                            _armatureStack.emplace_back(state);
+                        }
+                        break;
+                    
+                    case Node::kElementTypeMesh: {
+                            //  skinned meshes aren't culled since their
+                            //  bounds don't account for animation
+                            if (_armatureStack.empty()
+                                && !isVisible(transforms.worldAABB(i))) {
+                                ++_stats.culledNodeCount;
+                                break;
+                            }
+                            const MeshElement* mesh = node->mesh();
+                            while (mesh) {
+                                queueMeshElement(worldMtx, *mesh);
+                                mesh = mesh->next;
+                            }
+                        }
+                        break;
+                    
+                    default:
+                        break;
+                    }
+                }
+            }
+            
+            _armatureStack.clear();
+            
+            endStage(currentStage, programs, uniforms);
+        }
+        
+        stages >>= 1;
+        currentStage <<= 1;
+    }
+}
+
+void NodeRenderer::beginStage
+(
+    uint32_t stage,
+    const RenderTarget& renderTarget
+)
+{
+    switch (stage) {
+    case kStageFlagRender: {
+            bgfx::setViewRect(_camera->viewIndex,
+                _camera->viewportRect.x, _camera->viewportRect.y,
+                _camera->viewportRect.w ,_camera->viewportRect.h);
+        
+            if (renderTarget) {
+                bgfx::setViewFrameBuffer(_camera->viewIndex, renderTarget.bgfxHandle());
+            }
+
+            bgfx::setViewTransform(_camera->viewIndex,
+                _camera->viewMtx.comp,
+                _camera->projMtx.comp);
+            
+            //  draws are submitted in draw key order, which already sorts by
+            //  program, material, mesh and depth.  a sequential view keeps
+            //  that order, so uniforms set once for a run of draws apply to
+            //  every draw after it (bgfx's sort would reorder draws away
+            //  from the uniforms set before them.)
+            bgfx::setViewSeq(_camera->viewIndex, true);
+        
+            memcpy(_viewProjMtx.comp, _camera->viewProjMtx.comp, sizeof(_viewProjMtx.comp));
+            updateFrustumPlanes();
+            
+            _meshDraws.clear();
+            _drawKeys.clear();
+            
+            _stats = Stats { 0, 0, 0, 0 };
+        }
+        break;
+    case kStageFlagLightEnum: {
+            _globalLights.clear();
+            _directionalLights.clear();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void NodeRenderer::endStage
+(
+    uint32_t stage,
+    const ProgramMap& programs,
+    const UniformMap& uniforms
+)
+{
+    if (stage == kStageFlagRender) {
+        flushMeshDraws(programs, uniforms);
+    }
+}
+
+void NodeRenderer::addLight(LightHandle light, const Matrix4& worldMtx)
+{
+    if (light->type == LightType::kAmbient
+        || light->type == LightType::kDirectional) {
+        _globalLights.emplace_back(LightState{ worldMtx, light } );
+    }
+    else {
+        _directionalLights.emplace_back(LightState{ worldMtx, light });
+    }
+}
+
+void NodeRenderer::updateFrustumPlanes()
+{
+    //  planes are extracted from the view projection matrix columns (clip
+    //  space is v * M.)  near uses the -w <= z <= w convention, which is
+    //  conservative for renderers with a 0 <= z <= w clip space.
+    const float* m = _viewProjMtx.comp;
+    for (int i = 0; i < 3; ++i) {
+        Vector4& lower = _frustumPlanes[i*2];
+        Vector4& upper = _frustumPlanes[i*2+1];
+        lower.x = m[3] + m[i];
+        lower.y = m[7] + m[4+i];
+        lower.z = m[11] + m[8+i];
+        lower.w = m[15] + m[12+i];
+        upper.x = m[3] - m[i];
+        upper.y = m[7] - m[4+i];
+        upper.z = m[11] - m[8+i];
+        upper.w = m[15] - m[12+i];
+    }
+}
+
+bool NodeRenderer::isVisible(const AABB& worldAABB) const
+{
+    //  nodes without bounds are never culled
+    if (worldAABB.min.x > worldAABB.max.x
+        || worldAABB.min.y > worldAABB.max.y
+        || worldAABB.min.z > worldAABB.max.z) {
+        return true;
+    }
+    
+    for (auto& plane : _frustumPlanes) {
+        //  test the box corner furthest along the plane normal
+        float x = plane.x >= 0.0f ? worldAABB.max.x : worldAABB.min.x;
+        float y = plane.y >= 0.0f ? worldAABB.max.y : worldAABB.min.y;
+        float z = plane.z >= 0.0f ? worldAABB.max.z : worldAABB.min.z;
+        if (plane.x*x + plane.y*y + plane.z*z + plane.w < 0.0f)
+            return false;
+    }
+    return true;
+}
+
 void NodeRenderer::pushTransform(const Matrix4& mtx)
 {
     //  calculate new transform and set as current state.
@@ -337,139 +603,354 @@ void NodeRenderer::popTransform()
     _transformStack.pop_back();
 }
 
-void NodeRenderer::renderMeshElement
-(
-    const ProgramMap& programs,
-    const UniformMap& uniforms,
-    const Matrix4& localTransform,
-    const MeshElement& element
-)
+NodeProgramSlot NodeRenderer::meshProgramSlot(const Mesh& mesh) const
 {
-    //  determine program
     NodeProgramSlot programSlot = kNodeProgramNone;
-    const Mesh* mesh = element.mesh.resource();
-    const bgfx::VertexDecl& meshVertexDecl = VertexTypes::declaration(mesh->format());
     
     if (!_armatureStack.empty()) {
-        if (mesh->format() == VertexTypes::kVNormal_Tex0_Weights) {
+        if (mesh.format() == VertexTypes::kVNormal_Tex0_Weights) {
             programSlot = kNodeProgramBoneMeshUV;
         }
-        else if (mesh->format() == VertexTypes::kVNormal_Weights) {
+        else if (mesh.format() == VertexTypes::kVNormal_Weights) {
             programSlot = kNodeProgramBoneMeshColor;
         }
     }
     else {
-        if (mesh->format() == VertexTypes::kVPosition) {
+        if (mesh.format() == VertexTypes::kVPosition) {
             programSlot = kNodeProgramFlat;
         }
-        else if (mesh->format() == VertexTypes::kVPositionNormal) {
+        else if (mesh.format() == VertexTypes::kVPositionNormal) {
             programSlot = kNodeProgramMeshColor;
         }
-        else if (mesh->format() == VertexTypes::kVNormal_Tex0) {
+        else if (mesh.format() == VertexTypes::kVNormal_Tex0) {
             programSlot = kNodeProgramMeshUV;
         }
     }
     
-    CK_ASSERT_RETURN(programSlot != kNodeProgramNone);
-    
-    //  setup rendering state
-    bgfx::setUniform(uniforms[kNodeUniformColor], element.material->diffuseColor, 1);
+    return programSlot;
+}
+
+void NodeRenderer::setupMaterialUniforms
+(
+    const UniformMap& uniforms,
+    const Material* material
+)
+{
+    //  the render view is sequential (see beginStage), so uniforms persist
+    //  to the draws submitted after them and only material changes are
+    //  uploaded (material is null if unchanged from the prior draw.)
+    //  Texture bindings are reset by bgfx after every submit and must be set
+    //  per draw.
+    if (material) {
+        bgfx::setUniform(uniforms[kNodeUniformColor], material->diffuseColor, 1);
+        
+        //  TODO - include specular color?
+        Vector4 specular;
+        specular.x = material->specularIntensity;
+        specular.y = material->specularPower;
+        specular.z = 0;
+        specular.w = 0;
+        bgfx::setUniform(uniforms[kNodeUniformMatSpecular], specular);
+    }
+}
+
+uint64_t NodeRenderer::meshRenderState(const Mesh& mesh) const
+{
+    uint64_t state = BGFX_STATE_RGB_WRITE
+        | BGFX_STATE_ALPHA_WRITE
+        | BGFX_STATE_DEPTH_WRITE
+        | BGFX_STATE_DEPTH_TEST_LESS
+        | BGFX_STATE_MSAA;
     
-    //  diffuse texture selection
-    if (element.material->diffuseTex) {
-        bgfx::TextureHandle texDiffuse = element.material->diffuseTex->bgfxHandle();
-        bgfx::setTexture(0, uniforms[kNodeUniformTexDiffuse], texDiffuse,
-            BGFX_TEXTURE_MIN_POINT | BGFX_TEXTURE_MAG_ANISOTROPIC);
+    if (mesh.primitiveType() == PrimitiveType::kTriangles) {
+        state |= BGFX_STATE_CULL_CW;
+    }
+    else if (mesh.primitiveType() == PrimitiveType::kLines) {
+        state |= BGFX_STATE_PT_LINES;
     }
     else {
-        //  if our mesh has uvs but no material texture?  use a placeholder
-        //  texture
-        if (meshVertexDecl.has(bgfx::Attrib::TexCoord0)) {
-            bgfx::setTexture(0, uniforms[kNodeUniformTexDiffuse],
-                _placeholderDiffuseTex->bgfxHandle(),
-                BGFX_TEXTURE_MIN_POINT | BGFX_TEXTURE_MAG_ANISOTROPIC);
-        }
+        CK_ASSERT(false);
     }
-    //  TODO - include specular color?
-    Vector4 specular;
-    specular.x = element.material->specularIntensity;
-    specular.y = element.material->specularPower;
-    specular.z = 0;
-    specular.w = 0;
-    bgfx::setUniform(uniforms[kNodeUniformMatSpecular], specular);
     
-    Matrix4 worldTransform;
+    return state;
+}
+
+uint64_t NodeRenderer::makeDrawKey
+(
+    NodeProgramSlot programSlot,
+    const Mesh* mesh,
+    const Material* material,
+    const Matrix4& worldMtx
+)
+{
+    //  materials and meshes are assigned ids in order of appearance each
+    //  frame, so that their ids fit within the key
+    const uint32_t kMaterialIdLimit = 1 << kDrawKeyMaterialBits;
+    const uint32_t kMeshIdLimit = 1 << kDrawKeyMeshBits;
+    
+    const uint32_t materialId = drawKeyId(material, _drawKeyMaterialCount,
+                                          kMaterialIdLimit);
+    const uint32_t meshId = drawKeyId(mesh, _drawKeyMeshCount, kMeshIdLimit);
+    
+    //  view space depth of the draw's origin, quantized between the near
+    //  and far planes
+    const Matrix4& viewMtx = _camera->viewMtx;
+    float z = viewMtx.comp[2]*worldMtx.comp[12] + viewMtx.comp[6]*worldMtx.comp[13]
+            + viewMtx.comp[10]*worldMtx.comp[14] + viewMtx.comp[14];
+    float range = _camera->far - _camera->near;
+    float depth = range > 0.0f ? (z - _camera->near) / range : 0.0f;
+    depth = std::max(0.0f, std::min(depth, 1.0f));
+    
+    uint64_t key = (uint64_t)(_camera->viewIndex & 0xff) << kDrawKeyViewShift;
+    key |= (uint64_t)programSlot << kDrawKeyProgramShift;
+    key |= (uint64_t)materialId << kDrawKeyMaterialShift;
+    key |= (uint64_t)meshId << kDrawKeyMeshShift;
+    key |= (uint64_t)(depth * 0xffff) << kDrawKeyDepthShift;
+    return key;
+}
+
+static uint32_t drawKeyIdHash(const void* resource)
+{
+    //  resources are heap allocated, so the low bits carry little entropy
+    uint64_t v = (uint64_t)(uintptr_t)resource;
+    return (uint32_t)((v * 0x9e3779b97f4a7c15ULL) >> 32);
+}
+
+uint32_t NodeRenderer::drawKeyId
+(
+    const void* resource,
+    uint32_t& nextId,
+    uint32_t idLimit
+)
+{
+    //  keep the table at most half full
+    if ((_drawKeyIdCount + 1) * 2 > _drawKeyIds.size()) {
+        growDrawKeyIds();
+    }
+    
+    const uint32_t mask = (uint32_t)_drawKeyIds.size() - 1;
+    uint32_t index = drawKeyIdHash(resource) & mask;
+    while (_drawKeyIds[index].resource) {
+        if (_drawKeyIds[index].resource == resource)
+            return _drawKeyIds[index].id;
+        index = (index + 1) & mask;
+    }
+    
+    DrawKeyId& entry = _drawKeyIds[index];
+    entry.resource = resource;
+    entry.id = std::min(nextId++, idLimit-1);
+    ++_drawKeyIdCount;
+    return entry.id;
+}
+
+void NodeRenderer::growDrawKeyIds()
+{
+    std::vector<DrawKeyId, std_allocator<DrawKeyId>> entries;
+    entries.swap(_drawKeyIds);
+    _drawKeyIds.resize(std::max(entries.size() * 2, (size_t)64),
+                       DrawKeyId { nullptr, 0 });
+    
+    const uint32_t mask = (uint32_t)_drawKeyIds.size() - 1;
+    for (auto& entry : entries) {
+        if (!entry.resource)
+            continue;
+        uint32_t index = drawKeyIdHash(entry.resource) & mask;
+        while (_drawKeyIds[index].resource) {
+            index = (index + 1) & mask;
+        }
+        _drawKeyIds[index] = entry;
+    }
+}
 
-    //  setup lighting
-    setupLightUniforms(uniforms, worldTransform);
+void NodeRenderer::queueMeshElement
+(
+    const Matrix4& worldTransform,
+    const MeshElement& element
+)
+{
+    const Mesh* mesh = element.mesh.resource();
+    NodeProgramSlot programSlot = meshProgramSlot(*mesh);
     
-    //  setup mesh rendering
-    bgfx::setVertexBuffer(mesh->vertexBuffer());
-    bgfx::setIndexBuffer(mesh->indexBuffer());
+    CK_ASSERT_RETURN(programSlot != kNodeProgramNone);
+    
+    _meshDraws.emplace_back();
+    auto& draw = _meshDraws.back();
+    draw.programSlot = programSlot;
+    draw.mesh = mesh;
+    draw.material = element.material.resource();
+    draw.boneTransformIndex = -1;
+    draw.boneCount = 0;
     
     if (!_armatureStack.empty()) {
+        //  bone transforms depend on the current armature, so they're
+        //  generated now into bgfx's transform cache, which lives for the
+        //  frame
         const ArmatureState& armatureState = _armatureStack.back();
-
-        Matrix4 worldViewProjMtx;
-        bx::mtxMul(worldViewProjMtx, armatureState.armatureToWorldMtx,
-                                     _viewProjMtx);
+        draw.worldMtx = armatureState.armatureToWorldMtx;
         
-        bgfx::setUniform(uniforms[kNodeUniformWorldMtx],
-                         armatureState.armatureToWorldMtx.comp, 1);
-        bgfx::setUniform(uniforms[kNodeUniformWorldViewProjMtx],
-                         worldViewProjMtx.comp, 1);
-   
         bgfx::Transform boneTransforms;
-   
-        int transformCacheIndex =
-                        bgfx::allocTransform(&boneTransforms, BGFX_CONFIG_MAX_BONES);
+        draw.boneTransformIndex =
+            bgfx::allocTransform(&boneTransforms, BGFX_CONFIG_MAX_BONES);
+        draw.boneCount = armatureState.armature->animSet->boneCount();
         
-        //printf("Kf=%d\n", (int)(armatureState.armature->animController->animationTime() * 24));
-   
-        //  worldTransform in this case is to mesh to armature/skeleton transform
-        //  used as the basis for armature to bone transformations
-        //  we reuse rootTransform as both an intermediate matrix for calculation
-        //  and as the root bone transformation
+        //  the root transform is the basis for armature to bone
+        //  transformations
         Matrix4 rootTransform;
         bx::mtxIdentity(rootTransform);
-   
+        
         buildBoneTransforms(armatureState, 0, rootTransform, boneTransforms.data);
-        bgfx::setTransform(transformCacheIndex,
-                           armatureState.armature->animSet->boneCount());
     }
-    else
-    {
-        bx::mtxMul(worldTransform, localTransform, _transformStack.back());
-        bgfx::setTransform(worldTransform);
+    else {
+        draw.worldMtx = worldTransform;
     }
+    
+    _drawKeys.push_back({
+        makeDrawKey(programSlot, mesh, draw.material, draw.worldMtx),
+        (uint32_t)(_meshDraws.size() - 1)
+    });
+}
 
-    auto state = BGFX_STATE_RGB_WRITE
-        | BGFX_STATE_ALPHA_WRITE
-        | BGFX_STATE_DEPTH_WRITE
-        | BGFX_STATE_DEPTH_TEST_LESS
-        | BGFX_STATE_MSAA;
+void NodeRenderer::submitMeshDraw
+(
+    const ProgramMap& programs,
+    const UniformMap& uniforms,
+    const MeshDraw& draw
+)
+{
+    const Mesh& mesh = *draw.mesh;
     
+    bgfx::setVertexBuffer(mesh.vertexBuffer());
+    bgfx::setIndexBuffer(mesh.indexBuffer());
     
-    if (mesh->primitiveType() == PrimitiveType::kTriangles) {
-        state |= BGFX_STATE_CULL_CW;
-    }
-    else if (mesh->primitiveType() == PrimitiveType::kLines) {
-        state |= BGFX_STATE_PT_LINES;
+    if (draw.boneTransformIndex >= 0) {
+        Matrix4 worldViewProjMtx;
+        bx::mtxMul(worldViewProjMtx, draw.worldMtx, _viewProjMtx);
+        
+        bgfx::setUniform(uniforms[kNodeUniformWorldMtx], draw.worldMtx.comp, 1);
+        bgfx::setUniform(uniforms[kNodeUniformWorldViewProjMtx],
+                         worldViewProjMtx.comp, 1);
+        bgfx::setTransform(draw.boneTransformIndex, draw.boneCount);
     }
     else {
-        CK_ASSERT(false);
+        bgfx::setTransform(draw.worldMtx);
     }
     
-    bgfx::setState(state);
-
-    bgfx::submit(_camera->viewIndex, programs[programSlot]);
+    _lightClusters.bind(uniforms, kClusterTextureStage);
+    bgfx::setState(meshRenderState(mesh));
+    bgfx::submit(_camera->viewIndex, programs[draw.programSlot]);
+    ++_stats.drawCount;
 }
 
-void NodeRenderer::setupLightUniforms
+void NodeRenderer::flushMeshDraws
 (
-    const UniformMap& uniforms,
-    const Matrix4& objWorldMtx
+    const ProgramMap& programs,
+    const UniformMap& uniforms
 )
+{
+    if (_meshDraws.empty())
+        return;
+    
+    _stats.meshElementCount = (uint32_t)_meshDraws.size();
+    
+    radixSortDrawKeys(_drawKeys, _drawKeysScratch);
+    
+    const bool instancingSupported = _instancingEnabled &&
+        (bgfx::getCaps()->supported & BGFX_CAPS_INSTANCING) != 0;
+    
+    //  lights are shared by all draws in the view.  the view is sequential,
+    //  so uniforms set before the first draw apply to the rest
+    setupLightUniforms(uniforms);
+    
+    const uint64_t kInstanceKeyMask = ~((1ULL << kDrawKeyMeshShift) - 1);
+    const Material* currentMaterial = nullptr;
+    
+    auto it = _drawKeys.begin();
+    while (it != _drawKeys.end()) {
+        auto runEnd = it + 1;
+        const MeshDraw& first = _meshDraws[it->drawIndex];
+        
+        //  mesh and material ids saturate if there are too many, so the
+        //  run is also checked against the actual mesh and material
+        while (runEnd != _drawKeys.end() &&
+               (runEnd->key & kInstanceKeyMask) == (it->key & kInstanceKeyMask) &&
+               _meshDraws[runEnd->drawIndex].mesh == first.mesh &&
+               _meshDraws[runEnd->drawIndex].material == first.material) {
+            ++runEnd;
+        }
+        
+        const Mesh& mesh = *first.mesh;
+        const uint32_t count = (uint32_t)(runEnd - it);
+        
+        setupMaterialUniforms(uniforms,
+            first.material != currentMaterial ? first.material : nullptr);
+        currentMaterial = first.material;
+        
+        bgfx::TextureHandle texDiffuse = BGFX_INVALID_HANDLE;
+        if (first.material->diffuseTex) {
+            texDiffuse = first.material->diffuseTex->bgfxHandle();
+        }
+        else if (VertexTypes::declaration(mesh.format()).has(bgfx::Attrib::TexCoord0)) {
+            //  if our mesh has uvs but no material texture?  use a placeholder
+            //  texture
+            texDiffuse = _placeholderDiffuseTex->bgfxHandle();
+        }
+        
+        NodeProgramSlot instancedSlot = instancingSupported && count >= kMinInstanceCount
+                                      ? instancedProgramSlot(first.programSlot)
+                                      : kNodeProgramNone;
+        
+        if (instancedSlot != kNodeProgramNone &&
+            bgfx::isValid(programs[instancedSlot]) &&
+            bgfx::checkAvailInstanceDataBuffer(count, kInstanceDataStride)) {
+            
+            const bgfx::InstanceDataBuffer* idb =
+                bgfx::allocInstanceDataBuffer(count, kInstanceDataStride);
+            
+            uint8_t* data = idb->data;
+            for (auto drawKey = it; drawKey != runEnd; ++drawKey) {
+                memcpy(data, _meshDraws[drawKey->drawIndex].worldMtx.comp,
+                       kInstanceDataStride);
+                data += kInstanceDataStride;
+            }
+            
+            if (bgfx::isValid(texDiffuse)) {
+                bgfx::setTexture(0, uniforms[kNodeUniformTexDiffuse], texDiffuse,
+                    BGFX_TEXTURE_MIN_POINT | BGFX_TEXTURE_MAG_ANISOTROPIC);
+            }
+            bgfx::setVertexBuffer(mesh.vertexBuffer());
+            bgfx::setIndexBuffer(mesh.indexBuffer());
+            bgfx::setInstanceDataBuffer(idb, count);
+            _lightClusters.bind(uniforms, kClusterTextureStage);
+            bgfx::setState(meshRenderState(mesh));
+            bgfx::submit(_camera->viewIndex, programs[instancedSlot]);
+            ++_stats.drawCount;
+            ++_stats.instancedDrawCount;
+        }
+        else {
+            for (auto drawKey = it; drawKey != runEnd; ++drawKey) {
+                const MeshDraw& draw = _meshDraws[drawKey->drawIndex];
+                if (bgfx::isValid(texDiffuse)) {
+                    bgfx::setTexture(0, uniforms[kNodeUniformTexDiffuse], texDiffuse,
+                        BGFX_TEXTURE_MIN_POINT | BGFX_TEXTURE_MAG_ANISOTROPIC);
+                }
+                submitMeshDraw(programs, uniforms, draw);
+            }
+        }
+        
+        it = runEnd;
+    }
+    
+    _meshDraws.clear();
+    _drawKeys.clear();
+    if (_drawKeyIdCount) {
+        std::fill(_drawKeyIds.begin(), _drawKeyIds.end(), DrawKeyId { nullptr, 0 });
+        _drawKeyIdCount = 0;
+    }
+    _drawKeyMaterialCount = 0;
+    _drawKeyMeshCount = 0;
+}
+
+void NodeRenderer::setupLightUniforms(const UniformMap& uniforms)
 {
     //  reset uniforms generated during the stack traversal
     _lightColors.clear();
@@ -478,13 +959,17 @@ void NodeRenderer::setupLightUniforms
     _lightCoeffs.clear();
     _lightOrigins.clear();
     
+    //  ambient and directional lights affect every surface, and are passed
+    //  as uniform arrays
     for (auto& light : _globalLights) {
+        if (_lightColors.size() >= CKGFX_SHADERS_LIGHT_COUNT)
+            break;
+        
         const Light* l = light.light.resource();
         
         _lightCoeffs.emplace_back(0.0f, 0.0f, 0.0f, 0.0f);
         _lightOrigins.emplace_back(0.0f, 0.0f, 0.0f, 0.0f);
         
-        Vector4 color;
         _lightColors.emplace_back(fromABGR(l->color));
         _lightParams.emplace_back(l->ambientComp, l->diffuseComp, 0.0f, 0.0f);
     
@@ -500,56 +985,27 @@ void NodeRenderer::setupLightUniforms
         }
     }
     
-    for (auto& light : _directionalLights) {
-        const Light* l = light.light.resource();
-        float dist = 0.0f;
-        float span = 0.0f;
-        if (l->type == LightType::kPoint || l->type == LightType::kSpot) {
-            dist = l->distance;
-            
-            _lightOrigins.emplace_back(light.worldMtx[12],
-                light.worldMtx[13],
-                light.worldMtx[14],
-                0.0f);
-            
-            if (l->type == LightType::kSpot) {
-                span = l->cutoff;
-            }
-            
-            _lightCoeffs.emplace_back(l->coeff.x, l->coeff.y, l->coeff.z, 0.0f);
-        }
-        
-        Vector4 color;
-        _lightColors.emplace_back(fromABGR(l->color));
-        _lightParams.emplace_back(l->ambientComp, l->diffuseComp, dist, span);
-    
-        if (l->type == LightType::kSpot) {
-            Vector4 dir;
-            bx::vec4MulMtx(dir, Vector4::kUnitZ, light.worldMtx);
-            bx::vec3Neg(dir, dir);
-            _lightDirs.emplace_back(dir);
-        }
-        else {
-            _lightDirs.emplace_back(0.0f, 0.0f, 0.0f, 0.0f);
-        }
-    }
+    //  unused slots must be cleared since uniforms persist between frames
+    Vector4 zero = Vector4::kZero;
+    _lightColors.resize(CKGFX_SHADERS_LIGHT_COUNT, zero);
+    _lightParams.resize(CKGFX_SHADERS_LIGHT_COUNT, zero);
+    _lightDirs.resize(CKGFX_SHADERS_LIGHT_COUNT, zero);
+    _lightCoeffs.resize(CKGFX_SHADERS_LIGHT_COUNT, zero);
+    _lightOrigins.resize(CKGFX_SHADERS_LIGHT_COUNT, zero);
     
-    if (!_lightColors.empty()) {
-        bgfx::setUniform(uniforms[kNodeUniformLightColor], _lightColors.data(), (uint16_t)_lightColors.size());
-    }
-    if (!_lightParams.empty()) {
-        bgfx::setUniform(uniforms[kNodeUniformLightParam], _lightParams.data(), (uint16_t)_lightParams.size());
-    }
-    if (!_lightDirs.empty()) {
-        bgfx::setUniform(uniforms[kNodeUniformLightDir], _lightDirs.data(), (uint16_t)_lightDirs.size());
-    }
+    bgfx::setUniform(uniforms[kNodeUniformLightColor], _lightColors.data(), CKGFX_SHADERS_LIGHT_COUNT);
+    bgfx::setUniform(uniforms[kNodeUniformLightParam], _lightParams.data(), CKGFX_SHADERS_LIGHT_COUNT);
+    bgfx::setUniform(uniforms[kNodeUniformLightDir], _lightDirs.data(), CKGFX_SHADERS_LIGHT_COUNT);
+    bgfx::setUniform(uniforms[kNodeUniformLightOrigin], _lightOrigins.data(), CKGFX_SHADERS_LIGHT_COUNT);
+    bgfx::setUniform(uniforms[kNodeUniformLightCoeffs], _lightCoeffs.data(), CKGFX_SHADERS_LIGHT_COUNT);
     
-    if (!_lightOrigins.empty()) {
-        bgfx::setUniform(uniforms[kNodeUniformLightOrigin], _lightOrigins.data(), (uint16_t)_lightOrigins.size());
-    }
-    if (!_lightCoeffs.empty()) {
-        bgfx::setUniform(uniforms[kNodeUniformLightCoeffs], _lightCoeffs.data(), (uint16_t)_lightCoeffs.size());
+    //  point and spot lights are binned into clusters for the current view
+    _lightClusters.clear();
+    for (auto& light : _directionalLights) {
+        _lightClusters.addLight(*light.light.resource(), light.worldMtx);
     }
+    _lightClusters.build(*_camera);
+    _lightClusters.setUniforms(uniforms);
 }
 
 void NodeRenderer::buildBoneTransforms
@@ -14,6 +14,8 @@
 #include "NodeGraph.hpp"
 
 #include "NodeRendererTypes.hpp"
+#include "NodeTransformCache.hpp"
+#include "LightClusters.hpp"
 
 #include <ckm/geometry.hpp>
 #include <vector>
@@ -46,6 +48,29 @@ public:
     
     void setPlaceholderDiffuseTexture(TextureHandle diffuseTexHandle);
     
+    //  Static (non-skinned) mesh elements sharing a mesh, material and program
+    //  are drawn with a single instanced draw if the renderer supports
+    //  instancing and an instanced program is mapped for the mesh's program.
+    //  Enabled by default.
+    void setInstancingEnabled(bool enabled);
+    
+    /// Minimum number of identical elements required to draw using instancing
+    static const uint32_t kMinInstanceCount = 2;
+    
+    //  Counts from the most recent render stage
+    struct Stats
+    {
+        //  mesh elements queued for drawing
+        uint32_t meshElementCount;
+        //  mesh nodes skipped by frustum culling
+        uint32_t culledNodeCount;
+        //  bgfx submits, including instanced draws
+        uint32_t drawCount;
+        uint32_t instancedDrawCount;
+    };
+    
+    const Stats& stats() const { return _stats; }
+    
     void operator()(const ProgramMap& programs, const UniformMap& uniforms,
                     const Camera& camera,
                     NodeHandle root, uint32_t stages=kStageAll);
@@ -55,58 +80,135 @@ public:
                     const Camera& camera,
                     NodeHandle root, uint32_t stages=kStageAll);
     
+    //  Renders nodes using world transforms from an up-to-date transform
+    //  cache instead of traversing the graph.  Static meshes outside the
+    //  camera's frustum (by their cached world AABB) are culled.
+    void operator()(const ProgramMap& programs, const UniformMap& uniforms,
+                    const Camera& camera,
+                    const NodeTransformCache& transforms,
+                    uint32_t stages=kStageAll);
+    
+    void operator()(const ProgramMap& programs, const UniformMap& uniforms,
+                    const RenderTarget& renderTarget,
+                    const Camera& camera,
+                    const NodeTransformCache& transforms,
+                    uint32_t stages=kStageAll);
+    
 private:
     struct ArmatureState;
+    struct MeshDraw;
     
     void pushTransform(const Matrix4& mtx);
     void popTransform();
     
+    void beginStage(uint32_t stage, const RenderTarget& renderTarget);
+    void endStage(uint32_t stage, const ProgramMap& programs,
+                  const UniformMap& uniforms);
+    void addLight(LightHandle light, const Matrix4& worldMtx);
+    
+    void updateFrustumPlanes();
+    bool isVisible(const AABB& worldAABB) const;
 
-    void renderMeshElement
+    void queueMeshElement
     (
-        const ProgramMap& programs,
-        const UniformMap& uniforms,
-        const Matrix4& localTransform,
+        const Matrix4& worldTransform,
         const MeshElement& element
     );
     
+    void flushMeshDraws(const ProgramMap& programs, const UniformMap& uniforms);
+    void submitMeshDraw(const ProgramMap& programs, const UniformMap& uniforms,
+                        const MeshDraw& draw);
+    
+    uint64_t makeDrawKey(NodeProgramSlot programSlot, const Mesh* mesh,
+                         const Material* material, const Matrix4& worldMtx);
+    uint32_t drawKeyId(const void* resource, uint32_t& nextId, uint32_t idLimit);
+    void growDrawKeyIds();
+    
+    NodeProgramSlot meshProgramSlot(const Mesh& mesh) const;
+    void setupMaterialUniforms(const UniformMap& uniforms, const Material* material);
+    uint64_t meshRenderState(const Mesh& mesh) const;
+    
     void buildBoneTransforms(const ArmatureState& armatureState,
                              int boneIndex,
                              const Matrix4& parentBoneTransform,
                              float* outTransforms);
     
-    void setupLightUniforms(const UniformMap& uniforms, const Matrix4& objWorldMtx);
+    void setupLightUniforms(const UniformMap& uniforms);
     
 private:
     struct ArmatureState
     {
         const ArmatureElement* armature;
         Matrix4 armatureToWorldMtx;
+        //  transform cache index following the armature's subtree
+        uint32_t subtreeEnd;
     };
     struct LightState
     {
         Matrix4 worldMtx;
         LightHandle light;
     };
+    struct MeshDraw
+    {
+        NodeProgramSlot programSlot;
+        const Mesh* mesh;
+        const Material* material;
+        //  world transform, or the armature to world transform for skinned
+        //  meshes
+        Matrix4 worldMtx;
+        //  bgfx transform cache index of bone transforms (skinned meshes), or
+        //  -1 for static meshes
+        int boneTransformIndex;
+        uint16_t boneCount;
+    };
+    struct DrawKey
+    {
+        uint64_t key;
+        uint32_t drawIndex;
+    };
     
     //  Local State
     const Camera* _camera;
     Matrix4 _viewMtx;
     Matrix4 _projMtx;
     Matrix4 _viewProjMtx;
+    //  clip planes (xyz = normal, w = distance) extracted from _viewProjMtx
+    Vector4 _frustumPlanes[6];
     
     TextureHandle _placeholderDiffuseTex;
+    bool _instancingEnabled;
+    Stats _stats;
         
     //  Calculated State during Lighting Object Pass
     using Lights = std::vector<LightState, std_allocator<LightState>>;
     Lights _globalLights;
     Lights _directionalLights;
+    //  point and spot lights binned for the current view
+    LightClusters _lightClusters;
     
     //  various stacks used to store current rendering state during execution
     std::vector<NodeHandle, std_allocator<NodeHandle>> _nodeStack;
     std::vector<Matrix4, std_allocator<Matrix4>> _transformStack;
     std::vector<ArmatureState, std_allocator<ArmatureState>> _armatureStack;
     
+    //  mesh elements queued during traversal, drawn after traversal in
+    //  sort key order
+    std::vector<MeshDraw, std_allocator<MeshDraw>> _meshDraws;
+    std::vector<DrawKey, std_allocator<DrawKey>> _drawKeys;
+    std::vector<DrawKey, std_allocator<DrawKey>> _drawKeysScratch;
+    //  per-frame sort key ids for materials and meshes, in an open
+    //  addressed table (power of two size.)  cleared rather than freed
+    //  each frame, so steady state frames don't allocate
+    struct DrawKeyId
+    {
+        const void* resource;
+        uint32_t id;
+    };
+    std::vector<DrawKeyId, std_allocator<DrawKeyId>> _drawKeyIds;
+    uint32_t _drawKeyIdCount;
+    uint32_t _drawKeyMaterialCount;
+    uint32_t _drawKeyMeshCount;
+    
     std::vector<Vector4, std_allocator<Vector4>> _lightColors;
     std::vector<Vector4, std_allocator<Vector4>> _lightParams;
     std::vector<Vector4, std_allocator<Vector4>> _lightDirs;
@@ -25,6 +25,9 @@ enum NodeProgramSlot
     kNodeProgramBoneMeshColor,
     kNodeProgramColor,
     kNodeProgramDiffuse,
+    //  instanced variants of the above, with per-instance world transforms
+    kNodeProgramMeshUVInstanced,
+    kNodeProgramMeshColorInstanced,
     kNodeProgramLimit           = 16,
     
     kNodeProgramNone            = -1
@@ -66,6 +69,16 @@ enum NodeUniformSlot
     //  For flat shading (color)
     //
     kNodeUniformColor,
+    //  Clustered lighting (point and spot lights)
+    //      light data (sampler), per light texels:
+    //          color, param, dir, coeffs, origin
+    kNodeUniformClusterLightData,
+    //      cluster grid (sampler), per cluster: x = first index, y = count
+    kNodeUniformClusterGrid,
+    //      light index list (sampler)
+    kNodeUniformClusterIndices,
+    //      [0] = near, far, log slice scale, log slice bias
+    kNodeUniformClusterParams,
     
     kNodeUniformLimit,
     
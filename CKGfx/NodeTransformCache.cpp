@@ -0,0 +1,280 @@
+//
+//  NodeTransformCache.cpp
+//  GfxPrototype
+//
+//  Created by Samir Sinha on 4/5/16.
+//
+//
+
+#include "NodeTransformCache.hpp"
+#include "NodeGraph.hpp"
+
+#include <bx/fpumath.h>
+
+namespace cinek {
+    namespace gfx {
+
+const uint32_t NodeTransformCache::kInvalidIndex;
+
+//  nodes loaded without an "obb" have a default (degenerate) box.  flat
+//  meshes may have zero extent along one axis, but not along all three.
+static bool hasBounds(const AABB& aabb)
+{
+    if (aabb.min.x > aabb.max.x
+        || aabb.min.y > aabb.max.y
+        || aabb.min.z > aabb.max.z) {
+        return false;
+    }
+    return aabb.min.x < aabb.max.x
+        || aabb.min.y < aabb.max.y
+        || aabb.min.z < aabb.max.z;
+}
+
+//  the node's bounds in its local space.  falls back to its children's
+//  bounds if the node has none of its own.  returns false if no bounds are
+//  available
+static bool calculateLocalBounds(AABB& bounds, const Node& node)
+{
+    if (hasBounds(node.obb())) {
+        bounds = node.obb();
+        return true;
+    }
+    bool found = false;
+    for (const Node* child = node.firstChild();
+         child;
+         child = child->nextSibling()) {
+        if (!hasBounds(child->obb()))
+            continue;
+        if (found) {
+            bounds.merge(child->calculateAABB());
+        }
+        else {
+            bounds = child->calculateAABB();
+            found = true;
+        }
+    }
+    return found;
+}
+
+NodeTransformCache::NodeTransformCache() :
+    _root(nullptr),
+    _topologyVersion(0)
+{
+}
+
+void NodeTransformCache::clear()
+{
+    _nodes.clear();
+    _parents.clear();
+    _subtreeEnds.clear();
+    _worldMtxs.clear();
+    _worldAABBs.clear();
+    _dirty.clear();
+    _refresh.clear();
+    _indices.clear();
+    _root = nullptr;
+}
+
+uint32_t NodeTransformCache::update(const NodeGraph& graph)
+{
+    NodeHandle root = graph.root();
+    if (root.resource() != _root || graph.topologyVersion() != _topologyVersion) {
+        rebuild(root);
+        _topologyVersion = graph.topologyVersion();
+    }
+
+    //  parents precede their children, so a node's parent has been updated
+    //  (and its dirty state resolved) by the time the node is visited
+    uint32_t updateCount = 0;
+    const uint32_t count = size();
+    for (uint32_t i = 0; i < count; ++i) {
+        Node* node = _nodes[i].resource();
+        uint32_t parent = _parents[i];
+
+        const uint8_t refresh = _refresh[i];
+        _refresh[i] = kRefreshNone;
+
+        bool dirty = refresh == kRefreshTransform || node->isTransformDirty();
+        if (!dirty && parent != kInvalidIndex) {
+            dirty = _dirty[parent] != 0;
+        }
+        _dirty[i] = dirty;
+        if (!dirty) {
+            if (refresh == kRefreshBounds) {
+                updateWorldAABB(i);
+            }
+            continue;
+        }
+
+        node->clearTransformDirty();
+
+        if (parent != kInvalidIndex) {
+            bx::mtxMul(_worldMtxs[i], node->transform(), _worldMtxs[parent]);
+        }
+        else {
+            _worldMtxs[i] = node->transform();
+        }
+        updateWorldAABB(i);
+
+        ++updateCount;
+    }
+
+    return updateCount;
+}
+
+void NodeTransformCache::updateWorldAABB(uint32_t index)
+{
+    AABB localBounds;
+    if (calculateLocalBounds(localBounds, *_nodes[index])) {
+        _worldAABBs[index] = transformAABB(localBounds, _worldMtxs[index]);
+    }
+    else {
+        //  an inverted box, which NodeRenderer never culls
+        AABB& worldAABB = _worldAABBs[index];
+        worldAABB.min.x = worldAABB.min.y = worldAABB.min.z = 1.0f;
+        worldAABB.max.x = worldAABB.max.y = worldAABB.max.z = -1.0f;
+    }
+}
+
+void NodeTransformCache::rebuild(NodeHandle root)
+{
+    //  the previous flattening holds its nodes alive until the new one has
+    //  been built, so its node pointers can't be reused by new nodes
+    std::vector<NodeHandle> oldNodes;
+    std::vector<uint32_t> oldParents;
+    std::vector<Matrix4> oldWorldMtxs;
+    std::vector<AABB> oldWorldAABBs;
+    std::unordered_map<const Node*, uint32_t> oldIndices;
+    oldNodes.swap(_nodes);
+    oldParents.swap(_parents);
+    oldWorldMtxs.swap(_worldMtxs);
+    oldWorldAABBs.swap(_worldAABBs);
+    oldIndices.swap(_indices);
+
+    clear();
+
+    //  mirrors NodeRenderer's traversal, which includes the root's siblings
+    for (NodeHandle node = root; node; node = node->nextSiblingHandle()) {
+        addSubtree(node, kInvalidIndex);
+    }
+
+    const uint32_t count = size();
+    _worldMtxs.resize(count);
+    _worldAABBs.resize(count);
+    _dirty.resize(count, 0);
+    _refresh.resize(count, kRefreshNone);
+    _root = root.resource();
+
+    //  nodes under the same parent as before keep their cached values (any
+    //  local changes are picked up by their dirty flags.)  new and moved
+    //  nodes are recomputed along with their descendants, and their parents'
+    //  bounds refreshed
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint32_t parent = _parents[i];
+        const Node* parentNode = parent != kInvalidIndex
+            ? _nodes[parent].resource() : nullptr;
+
+        auto it = oldIndices.find(_nodes[i].resource());
+        if (it != oldIndices.end()) {
+            const uint32_t oldIndex = it->second;
+            const uint32_t oldParent = oldParents[oldIndex];
+            const Node* oldParentNode = oldParent != kInvalidIndex
+                ? oldNodes[oldParent].resource() : nullptr;
+            if (oldParentNode == parentNode) {
+                _worldMtxs[i] = oldWorldMtxs[oldIndex];
+                _worldAABBs[i] = oldWorldAABBs[oldIndex];
+                continue;
+            }
+        }
+        _refresh[i] = kRefreshTransform;
+        if (parent != kInvalidIndex && _refresh[parent] == kRefreshNone) {
+            _refresh[parent] = kRefreshBounds;
+        }
+    }
+
+    //  nodes that lost children also need their bounds refreshed
+    const uint32_t oldCount = (uint32_t)oldNodes.size();
+    for (uint32_t oldIndex = 0; oldIndex < oldCount; ++oldIndex) {
+        const uint32_t oldParent = oldParents[oldIndex];
+        if (oldParent == kInvalidIndex)
+            continue;
+        const uint32_t parent = indexOf(oldNodes[oldParent].resource());
+        if (parent == kInvalidIndex || _refresh[parent] != kRefreshNone)
+            continue;
+        const uint32_t index = indexOf(oldNodes[oldIndex].resource());
+        if (index == kInvalidIndex || _parents[index] != parent) {
+            _refresh[parent] = kRefreshBounds;
+        }
+    }
+}
+
+uint32_t NodeTransformCache::addNode(NodeHandle node, uint32_t parentIndex)
+{
+    uint32_t index = (uint32_t)_nodes.size();
+    _nodes.emplace_back(node);
+    _parents.emplace_back(parentIndex);
+    _subtreeEnds.emplace_back(index + 1);
+    _indices.emplace(node.resource(), index);
+    return index;
+}
+
+void NodeTransformCache::addSubtree(NodeHandle subtree, uint32_t parentIndex)
+{
+    //  pre-order walk using sibling links and the cached parent indices
+    //  instead of recursion, so deep graphs can't overflow the stack.
+    //  a node's subtree ends once the walk leaves it
+    const uint32_t subtreeIndex = addNode(subtree, parentIndex);
+    uint32_t index = subtreeIndex;
+    NodeHandle node = subtree;
+
+    for (;;) {
+        NodeHandle child = node->firstChildHandle();
+        if (child) {
+            index = addNode(child, index);
+            node = child;
+            continue;
+        }
+        for (;;) {
+            _subtreeEnds[index] = (uint32_t)_nodes.size();
+            if (index == subtreeIndex)
+                return;
+
+            uint32_t parent = _parents[index];
+            NodeHandle sibling = node->nextSiblingHandle();
+            if (sibling) {
+                index = addNode(sibling, parent);
+                node = sibling;
+                break;
+            }
+            index = parent;
+            node = _nodes[parent];
+        }
+    }
+}
+
+uint32_t NodeTransformCache::indexOf(const Node* node) const
+{
+    auto it = _indices.find(node);
+    if (it == _indices.end())
+        return kInvalidIndex;
+    return it->second;
+}
+
+const Matrix4* NodeTransformCache::findWorldTransform(const Node* node) const
+{
+    uint32_t index = indexOf(node);
+    if (index == kInvalidIndex)
+        return nullptr;
+    return &_worldMtxs[index];
+}
+
+const AABB* NodeTransformCache::findWorldAABB(const Node* node) const
+{
+    uint32_t index = indexOf(node);
+    if (index == kInvalidIndex)
+        return nullptr;
+    return &_worldAABBs[index];
+}
+
+    }   // namespace gfx
+}   // namespace cinek
@@ -0,0 +1,97 @@
+//
+//  NodeTransformCache.hpp
+//  GfxPrototype
+//
+//  Created by Samir Sinha on 4/5/16.
+//
+//
+
+#ifndef CK_Graphics_NodeTransformCache_hpp
+#define CK_Graphics_NodeTransformCache_hpp
+
+#include "GfxTypes.hpp"
+#include "Node.hpp"
+
+#include <vector>
+#include <unordered_map>
+
+namespace cinek {
+    namespace gfx {
+
+class NodeGraph;
+
+//  Stores world transforms and world AABBs for the nodes of a NodeGraph,
+//  flattened in parent-before-child (pre-order) order.
+//
+//  Writers to a Node's local transform mark the node dirty (see
+//  Node::markTransformDirty.)  Once per frame, update() recomputes world
+//  transforms and AABBs for dirty nodes and their descendants only.  The
+//  flattened order is rebuilt when the graph's topology changes, carrying
+//  over cached values for nodes whose parent is unchanged - only attached or
+//  moved subtrees are recomputed, and nodes that gained or lost children
+//  have their bounds refreshed.
+//
+//  Renderers and queries read the cached values instead of walking the tree
+//  and concatenating transforms.
+//
+class NodeTransformCache
+{
+    CK_CLASS_NON_COPYABLE(NodeTransformCache);
+
+public:
+    static const uint32_t kInvalidIndex = 0xffffffff;
+
+    NodeTransformCache();
+
+    //  updates the cache for the graph.  returns the number of nodes whose
+    //  world transforms were recomputed
+    uint32_t update(const NodeGraph& graph);
+    void clear();
+
+    uint32_t size() const { return (uint32_t)_nodes.size(); }
+
+    const Node* node(uint32_t index) const { return _nodes[index].resource(); }
+    const Matrix4& worldTransform(uint32_t index) const { return _worldMtxs[index]; }
+    const AABB& worldAABB(uint32_t index) const { return _worldAABBs[index]; }
+    uint32_t parentIndex(uint32_t index) const { return _parents[index]; }
+    //  the index following the last descendant of the node at index
+    uint32_t subtreeEnd(uint32_t index) const { return _subtreeEnds[index]; }
+
+    uint32_t indexOf(const Node* node) const;
+    //  returns null if the node isn't cached
+    const Matrix4* findWorldTransform(const Node* node) const;
+    const AABB* findWorldAABB(const Node* node) const;
+
+private:
+    void rebuild(NodeHandle root);
+    void updateWorldAABB(uint32_t index);
+    uint32_t addNode(NodeHandle node, uint32_t parentIndex);
+    void addSubtree(NodeHandle subtree, uint32_t parentIndex);
+
+    //  handles keep nodes alive until the next rebuild, in case nodes are
+    //  detached and released between updates
+    std::vector<NodeHandle> _nodes;
+    std::vector<uint32_t> _parents;
+    std::vector<uint32_t> _subtreeEnds;
+    std::vector<Matrix4> _worldMtxs;
+    std::vector<AABB> _worldAABBs;
+    //  nodes recomputed during the current update
+    std::vector<uint8_t> _dirty;
+    //  work scheduled by a rebuild for the next update
+    enum
+    {
+        kRefreshNone,
+        kRefreshBounds,
+        kRefreshTransform
+    };
+    std::vector<uint8_t> _refresh;
+    std::unordered_map<const Node*, uint32_t> _indices;
+
+    const Node* _root;
+    uint32_t _topologyVersion;
+};
+
+    }   // namespace gfx
+}   // namespace cinek
+
+#endif /* CK_Graphics_NodeTransformCache_hpp */
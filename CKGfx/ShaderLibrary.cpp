@@ -174,6 +174,53 @@ void ShaderLibrary::unloadProgram(ShaderProgramId programId)
     _programs.erase(itProgram);
 }
 
+std::vector<ShaderProgramId> ShaderLibrary::reloadShader(const char* path)
+{
+    struct ProgramSource
+    {
+        ShaderProgramId id;
+        std::string vsPath;
+        std::string fsPath;
+    };
+    std::vector<ProgramSource> sources;
+    
+    for (auto& program : _programs)
+    {
+        auto& vs = _shaders[program.second.vsIndex];
+        auto& fs = _shaders[program.second.fsIndex];
+        if (vs.path == path || fs.path == path)
+        {
+            sources.push_back({ program.first, vs.path, fs.path });
+        }
+    }
+    
+    //  unload all programs first so the shared shader refcounts drop to zero
+    //  and the binaries are read from file again
+    for (auto& source : sources)
+    {
+        unloadProgram(source.id);
+    }
+    
+    std::vector<ShaderProgramId> reloaded;
+    reloaded.reserve(sources.size());
+    
+    for (auto& source : sources)
+    {
+        if (loadProgram(source.id, source.vsPath.c_str(), source.fsPath.c_str()))
+        {
+            reloaded.push_back(source.id);
+        }
+        else
+        {
+            CK_LOG_WARN("gfx", "ShaderLibrary.reloadShader - failed to reload "
+                        "program %u (%s, %s)", source.id,
+                        source.vsPath.c_str(), source.fsPath.c_str());
+        }
+    }
+    
+    return reloaded;
+}
+
 bgfx::ProgramHandle ShaderLibrary::program(ShaderProgramId programId) const
 {
     auto itProgram = _programs.find(programId);
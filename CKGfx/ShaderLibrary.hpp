@@ -41,6 +41,14 @@ namespace cinek {
         
         void unloadProgram(ShaderProgramId progId);
         
+        //  Reloads programs using the shader at the given path by unloading
+        //  and calling loadProgram on each (so the shader binary is read
+        //  again.)  Program IDs are preserved, but their bgfx handles will
+        //  change - callers should refresh handles via program().
+        //
+        //  Returns the IDs of reloaded programs.
+        std::vector<ShaderProgramId> reloadShader(const char* path);
+        
     private:
         //  Loading a program will involve an O(n) search for existing
         //  shaders. Programs shouldn't be loaded during time-critical
@@ -9,10 +9,21 @@
 #ifndef CK_Graphics_Shaders_h
 #define CK_Graphics_Shaders_h
 
+//  ambient and directional lights, passed as uniform arrays
 #define CKGFX_SHADERS_LIGHT_COUNT   4
 
-#ifndef __cplusplus
-
-#endif
+//  point and spot lights are binned into a view space froxel grid
+//  (see gfx::LightClusters)
+#define CKGFX_SHADERS_CLUSTER_X             16
+#define CKGFX_SHADERS_CLUSTER_Y             8
+#define CKGFX_SHADERS_CLUSTER_Z             24
+//  lights per frame, and lights per cluster
+#define CKGFX_SHADERS_CLUSTER_LIGHT_LIMIT   256
+#define CKGFX_SHADERS_CLUSTER_CELL_LIMIT    32
+//  texels per light in the light data texture
+#define CKGFX_SHADERS_CLUSTER_LIGHT_TEXELS  5
+//  light index list texture dimensions (one index per texel)
+#define CKGFX_SHADERS_CLUSTER_INDEX_WIDTH   1024
+#define CKGFX_SHADERS_CLUSTER_INDEX_HEIGHT  8
 
 #endif /* CK_Graphics_Shaders_h */
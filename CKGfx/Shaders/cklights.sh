@@ -0,0 +1,237 @@
+//
+//  cklights.sh
+//  GfxPrototype
+//
+//  Created by Samir Sinha on 4/4/16.
+//
+//
+
+#ifndef CK_Graphics_Shaders_Lights_h
+#define CK_Graphics_Shaders_Lights_h
+
+/*  Direct Lighting Info
+
+    u_specularColor
+    ---------------
+
+    u_specularity
+    ---------------
+
+    u_lightParam
+    ---------------
+    For the basic lighting model, light param is an amalgam of:
+        x = ambient, y = diffuse, z = distance, w = cutoff
+        if z == 0, then directional
+        else
+            if w == 0, then point (omnidirectional)
+            else angle between light and extent of light on surface (spot)
+
+    u_lightCoeff
+    ---------------
+    For the basic lighting model point and spot lights
+        x = constant
+        y = linear
+        z = exp
+
+    u_lightColor
+    ---------------
+    The light color RGBA (A?)
+
+    u_lightDir
+    ---------------
+    Light direction (spot, point also require origin)
+
+    u_lightOrigin
+    ---------------
+    For the basic lighting model, the origin used in spot or point lights
+
+    The uniform arrays hold ambient and directional lights.  Point and spot
+    lights are read from the cluster textures, using the same components per
+    light (see gfx::LightClusters.)
+
+    u_clusterLightData
+    ---------------
+    CKGFX_SHADERS_CLUSTER_LIGHT_TEXELS texels per light:
+        color, param, dir, coeff, origin
+
+    u_clusterGrid
+    ---------------
+    One texel per cluster: x = first light index, y = light count
+
+    u_clusterIndices
+    ---------------
+    Light indices (x) for all clusters
+
+    u_clusterParams
+    ---------------
+    x = near, y = far, z = slice scale, w = slice bias
+    slice = log(view z) * scale + bias
+*/
+uniform vec4 u_lightColor[CKGFX_SHADERS_LIGHT_COUNT];
+uniform vec4 u_lightDir[CKGFX_SHADERS_LIGHT_COUNT];
+uniform vec4 u_lightParam[CKGFX_SHADERS_LIGHT_COUNT];
+uniform vec4 u_lightCoeff[CKGFX_SHADERS_LIGHT_COUNT];
+uniform vec4 u_lightOrigin[CKGFX_SHADERS_LIGHT_COUNT];
+uniform vec4 u_color;
+
+uniform vec4 u_clusterParams;
+
+SAMPLER2D(u_clusterLightData, 1);
+SAMPLER2D(u_clusterGrid, 2);
+SAMPLER2D(u_clusterIndices, 3);
+
+/*  Materials */
+uniform vec4 u_specularity;
+
+#define CKGFX_CLUSTER_TEXEL(_sampler, _index, _width, _height) \
+    texture2DLod(_sampler, vec2((mod(_index, _width) + 0.5) / _width, \
+                                (floor(_index / _width) + 0.5) / _height), 0.0)
+
+vec4 colorOfLightFromDirection(vec4 lightColor, vec4 lightParam,
+                               vec3 direction, vec3 position, vec3 normal)
+{
+    vec4 ambientColor = lightColor * lightParam.x;
+    vec4 diffuseColor = lightColor * lightParam.y * u_color;
+    vec4 specularColor = vec4(0,0,0,0);
+
+    float diffuseScalar = dot(normal, -direction);
+
+    if (diffuseScalar > 0.0) {
+        diffuseColor = diffuseColor * diffuseScalar;
+        if (u_specularity.x > 0.0) {
+          vec3 eyePos = u_invView[3].xyz;
+          vec3 toEye = normalize(eyePos - position);
+          vec3 reflectDir = normalize(reflect(direction, normal));
+          float specularScalar = dot(toEye, reflectDir);
+          if (specularScalar > 0.0) {
+              specularScalar = pow(specularScalar, u_specularity.y) * u_specularity.x;
+              specularColor = lightColor * specularScalar;
+              specularColor.a = 1.0;
+          }
+        }
+    }
+    else {
+        diffuseColor = vec4(0,0,0,0);
+    }
+
+    return ambientColor + diffuseColor + specularColor;
+}
+
+vec4 colorOfLight(vec4 lightColor, vec4 lightParam, vec4 lightDir,
+                  vec4 lightCoeff, vec4 lightOrigin,
+                  vec3 position, vec3 normal)
+{
+    if (lightParam.x <= 0.0 && lightParam.y <= 0.0) {
+        return vec4(0,0,0,0);
+    }
+
+    vec3 direction;
+    float lightCutoff = lightParam.w;
+    float lightOriginDist = lightParam.z;
+    float distance = 0.0;
+    float spotScalar = 0.0;
+
+    if (lightOriginDist > 0.0) {
+        //  point or spot
+        direction = position - lightOrigin.xyz;
+        distance = length(direction) / lightOriginDist;
+        direction = normalize(direction);
+
+        if (lightCutoff > 0.0) {
+            //  spot light
+            spotScalar = dot(direction, lightDir.xyz);
+        }
+    }
+    else {
+        // directional
+        direction = lightDir.xyz;
+    }
+
+    vec4 color;
+
+    if (lightCutoff == 0.0 || lightCutoff > 0.0 && spotScalar > lightCutoff) {
+      // directional || point || spot light within cutoff
+      color = colorOfLightFromDirection(lightColor, lightParam, direction,
+                                        position, normal);
+    }
+    else {
+      color = vec4(0,0,0,0);
+    }
+
+    if (lightOriginDist > 0.0 && color.a > 0.0) {
+      float attenuation = lightCoeff.x + lightCoeff.y * distance +
+                          lightCoeff.z * distance * distance;
+      color = color/attenuation;
+      if (lightCutoff > 0.0) {
+        // lightCutoff != 1 since 1 >= spotScalar > lightCutoff
+        color = color * (1.0 - (1.0 - spotScalar)/(1.0 - lightCutoff));
+      }
+    }
+    return color;
+}
+
+vec4 colorOfClusterLights(vec3 position, vec3 normal)
+{
+    //  locate the fragment's cluster
+    vec4 clipPos = mul(u_viewProj, vec4(position, 1.0));
+    vec2 ndc = clipPos.xy / clipPos.w;
+    float viewZ = mul(u_view, vec4(position, 1.0)).z;
+
+    vec2 tile = clamp(floor((ndc * 0.5 + 0.5) *
+                            vec2(CKGFX_SHADERS_CLUSTER_X, CKGFX_SHADERS_CLUSTER_Y)),
+                      vec2(0.0, 0.0),
+                      vec2(CKGFX_SHADERS_CLUSTER_X - 1, CKGFX_SHADERS_CLUSTER_Y - 1));
+    float slice = clamp(floor(log(max(viewZ, u_clusterParams.x)) * u_clusterParams.z
+                              + u_clusterParams.w),
+                        0.0, float(CKGFX_SHADERS_CLUSTER_Z - 1));
+
+    vec4 cluster = texture2DLod(u_clusterGrid,
+        vec2((tile.y * float(CKGFX_SHADERS_CLUSTER_X) + tile.x + 0.5) /
+                float(CKGFX_SHADERS_CLUSTER_X * CKGFX_SHADERS_CLUSTER_Y),
+             (slice + 0.5) / float(CKGFX_SHADERS_CLUSTER_Z)),
+        0.0);
+
+    float firstIndex = cluster.x;
+    int lightCount = int(cluster.y);
+
+    const float lightDataWidth = float(CKGFX_SHADERS_CLUSTER_LIGHT_LIMIT *
+                                       CKGFX_SHADERS_CLUSTER_LIGHT_TEXELS);
+    const float indexWidth = float(CKGFX_SHADERS_CLUSTER_INDEX_WIDTH);
+    const float indexHeight = float(CKGFX_SHADERS_CLUSTER_INDEX_HEIGHT);
+
+    vec4 totalColor = vec4(0,0,0,0);
+
+    for (int i = 0; i < CKGFX_SHADERS_CLUSTER_CELL_LIMIT; ++i) {
+        if (i >= lightCount)
+            break;
+
+        float lightIndex = CKGFX_CLUSTER_TEXEL(u_clusterIndices, firstIndex + float(i),
+                                               indexWidth, indexHeight).x;
+        float texel = lightIndex * float(CKGFX_SHADERS_CLUSTER_LIGHT_TEXELS);
+        vec4 lightColor = CKGFX_CLUSTER_TEXEL(u_clusterLightData, texel, lightDataWidth, 1.0);
+        vec4 lightParam = CKGFX_CLUSTER_TEXEL(u_clusterLightData, texel + 1.0, lightDataWidth, 1.0);
+        vec4 lightDir = CKGFX_CLUSTER_TEXEL(u_clusterLightData, texel + 2.0, lightDataWidth, 1.0);
+        vec4 lightCoeff = CKGFX_CLUSTER_TEXEL(u_clusterLightData, texel + 3.0, lightDataWidth, 1.0);
+        vec4 lightOrigin = CKGFX_CLUSTER_TEXEL(u_clusterLightData, texel + 4.0, lightDataWidth, 1.0);
+
+        totalColor += colorOfLight(lightColor, lightParam, lightDir, lightCoeff,
+                                   lightOrigin, position, normal);
+    }
+
+    return totalColor;
+}
+
+vec4 colorOfLights(vec3 position, vec3 normal)
+{
+    vec4 totalColor = vec4(0,0,0,0);
+
+    for (int i = 0; i < CKGFX_SHADERS_LIGHT_COUNT; ++i) {
+        totalColor += colorOfLight(u_lightColor[i], u_lightParam[i], u_lightDir[i],
+                                   u_lightCoeff[i], u_lightOrigin[i],
+                                   position, normal);
+    }
+
+    return totalColor + colorOfClusterLights(position, normal);
+}
+
+#endif /* CK_Graphics_Shaders_Lights_h */
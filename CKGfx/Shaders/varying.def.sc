@@ -5,6 +5,11 @@ vec2 a_texcoord0 : TEXCOORD0;
 vec4 a_indices   : TEXCOORD4;
 vec4 a_weight    : TEXCOORD5;
 
+vec4 i_data0     : TEXCOORD7;
+vec4 i_data1     : TEXCOORD6;
+vec4 i_data2     : TEXCOORD5;
+vec4 i_data3     : TEXCOORD4;
+
 vec3 v_position  : POSITION  = vec3(0.0, 0.0, 0.0);
 vec3 v_normal    : NORMAL    = vec3(0.0, 0.0, 1.0);
 vec4 v_color0    : COLOR0    = vec4(1.0, 0.0, 0.0, 1.0);
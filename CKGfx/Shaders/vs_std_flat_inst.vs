@@ -0,0 +1,25 @@
+$input a_position, a_normal, i_data0, i_data1, i_data2, i_data3
+$output v_normal, v_position
+
+/*
+ * Copyright 2011-2015 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include  <bgfx_shader.sh>
+#include "shaderlib.sh"
+#include "ckgfx.sh"
+
+void main()
+{
+    mat4 model;
+    model[0] = i_data0;
+    model[1] = i_data1;
+    model[2] = i_data2;
+    model[3] = i_data3;
+    
+    vec4 worldPos = instMul(model, vec4(a_position, 1.0) );
+    gl_Position = mul(u_viewProj, worldPos);
+    v_normal = instMul(model, vec4(a_normal, 0.0)).xyz;
+    v_position = worldPos.xyz;
+}
@@ -63,6 +63,7 @@ Texture Texture::loadTextureFromFile(const char* pathname)
                                 bgfx::copy(data, width*height*4)
                               );
         texture._bgfxFormat = bgfx::TextureFormat::RGBA8;
+        texture._memorySize = width*height*4;
         stbi_image_free(data);
     }
     
@@ -89,6 +90,7 @@ Texture Texture::loadTextureFromMemory(const uint8_t* data, size_t len)
                                 bgfx::copy(bmpMemory, width*height*4)
                               );
         texture._bgfxFormat = bgfx::TextureFormat::RGBA8;
+        texture._memorySize = width*height*4;
         stbi_image_free(bmpMemory);
     }
     
@@ -107,16 +109,19 @@ Texture Texture::loadTextureRaw(const bgfx::Memory* memory)
     }
     
     texture._bgfxFormat = info.format;
+    texture._memorySize = info.storageSize;
     return texture;
 }
 
 Texture::Texture
 (
     bgfx::TextureHandle handle,
-    bgfx::TextureFormat::Enum format
+    bgfx::TextureFormat::Enum format,
+    uint32_t memorySize
 ) :
     _bgfxHandle(handle),
-    _bgfxFormat(format)
+    _bgfxFormat(format),
+    _memorySize(memorySize)
 {
 }
 
@@ -135,18 +140,22 @@ Texture::~Texture()
 
 Texture::Texture(Texture&& other) :
     _bgfxHandle(other._bgfxHandle),
-    _bgfxFormat(other._bgfxFormat)
+    _bgfxFormat(other._bgfxFormat),
+    _memorySize(other._memorySize)
 {
     other._bgfxHandle = BGFX_INVALID_HANDLE;
     other._bgfxFormat = bgfx::TextureFormat::Unknown;
+    other._memorySize = 0;
 }
 
 Texture& Texture::operator=(Texture&& other)
 {
     _bgfxHandle = other._bgfxHandle;
     _bgfxFormat = other._bgfxFormat;
+    _memorySize = other._memorySize;
     other._bgfxHandle = BGFX_INVALID_HANDLE;
     other._bgfxFormat = bgfx::TextureFormat::Unknown;
+    other._memorySize = 0;
     return *this;
 }
 
@@ -155,6 +164,7 @@ bgfx::TextureHandle Texture::release()
     bgfx::TextureHandle h = _bgfxHandle;
     _bgfxHandle = BGFX_INVALID_HANDLE;
     _bgfxFormat = bgfx::TextureFormat::Unknown;
+    _memorySize = 0;
     return h;
 }
     
@@ -31,7 +31,8 @@ namespace cinek {
         static Texture loadTextureRaw(const bgfx::Memory* memory);
     
     public:
-        Texture(bgfx::TextureHandle handle, bgfx::TextureFormat::Enum format);
+        Texture(bgfx::TextureHandle handle, bgfx::TextureFormat::Enum format,
+                uint32_t memorySize=0);
         Texture();
         ~Texture();
         
@@ -42,6 +43,9 @@ namespace cinek {
         
         bgfx::TextureHandle bgfxHandle() const { return _bgfxHandle; }
         bgfx::TextureFormat::Enum bgfxFormat() const { return _bgfxFormat; }
+        //  size in bytes of the texture's storage (approximate for textures
+        //  created outside of the load functions)
+        uint32_t memorySize() const { return _memorySize; }
         
         //  releases the backend handle from management by the Texture
         bgfx::TextureHandle release();
@@ -49,6 +53,7 @@ namespace cinek {
     private:
         bgfx::TextureHandle _bgfxHandle;
         bgfx::TextureFormat::Enum _bgfxFormat;
+        uint32_t _memorySize;
     };
     
     }   // namespace gfx
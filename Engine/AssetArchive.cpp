@@ -0,0 +1,232 @@
+//
+//  AssetArchive.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 3/28/16.
+//
+//
+
+#include "AssetArchive.hpp"
+#include "Debug.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace cinek {
+    namespace ove {
+
+struct AssetArchive::Header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct AssetArchive::Entry
+{
+    uint32_t nameOffset;
+    uint32_t dataOffset;
+    uint32_t dataSize;
+    uint32_t reserved;
+};
+
+static const char kArchiveMagic[4] = { 'O', 'V', 'P', 'K' };
+
+std::shared_ptr<AssetArchive> AssetArchive::open(const char* path)
+{
+    auto file = std::allocate_shared<MappedFile>(std_allocator<MappedFile>(),
+                                                 path);
+    if (!*file) {
+        OVENGINE_LOG_ERROR("AssetArchive - failed to map %s\n", path);
+        return nullptr;
+    }
+    auto archive = std::allocate_shared<AssetArchive>(
+                        std_allocator<AssetArchive>(),
+                        path,
+                        std::move(file)
+                    );
+    if (!*archive) {
+        OVENGINE_LOG_ERROR("AssetArchive - %s is not a valid archive\n", path);
+        return nullptr;
+    }
+    return archive;
+}
+
+AssetArchive::AssetArchive
+(
+    std::string path,
+    std::shared_ptr<MappedFile> file
+) :
+    _path(std::move(path)),
+    _file(std::move(file)),
+    _entries(nullptr),
+    _entryCount(0),
+    _valid(false)
+{
+    const uint8_t* data = _file->data();
+    const uint32_t size = _file->size();
+
+    if (size < sizeof(Header))
+        return;
+
+    auto header = reinterpret_cast<const Header*>(data);
+    if (memcmp(header->magic, kArchiveMagic, sizeof(kArchiveMagic)) ||
+        header->version != kVersion) {
+        return;
+    }
+
+    const uint64_t tableEnd = sizeof(Header) + (uint64_t)header->entryCount * sizeof(Entry);
+    if (tableEnd > size)
+        return;
+
+    auto entries = reinterpret_cast<const Entry*>(data + sizeof(Header));
+    for (uint32_t i = 0; i < header->entryCount; ++i) {
+        const Entry& entry = entries[i];
+        if (entry.nameOffset < tableEnd || entry.nameOffset >= size)
+            return;
+        if (!memchr(data + entry.nameOffset, 0, size - entry.nameOffset))
+            return;
+        if ((uint64_t)entry.dataOffset + entry.dataSize > size)
+            return;
+    }
+
+    _entries = entries;
+    _entryCount = header->entryCount;
+    _valid = true;
+}
+
+const char* AssetArchive::entryName(const Entry& entry) const
+{
+    return reinterpret_cast<const char*>(_file->data() + entry.nameOffset);
+}
+
+auto AssetArchive::findEntry(const char* name) const -> const Entry*
+{
+    auto end = _entries + _entryCount;
+    auto it = std::lower_bound(_entries, end, name,
+        [this](const Entry& e, const char* n) -> bool {
+            return strcmp(entryName(e), n) < 0;
+        });
+    if (it == end || strcmp(entryName(*it), name))
+        return nullptr;
+    return it;
+}
+
+bool AssetArchive::contains(const char* name) const
+{
+    return findEntry(name) != nullptr;
+}
+
+MappedFile AssetArchive::openEntry
+(
+    const char* name,
+    MappedFile::Access access
+) const
+{
+    auto entry = findEntry(name);
+    if (!entry)
+        return MappedFile();
+
+    if (access == MappedFile::Access::kCopyOnWrite) {
+        //  written pages must not be shared with other entries' readers
+        if (!entry->dataSize)
+            return MappedFile();
+        return MappedFile(_path.c_str(), access, entry->dataOffset,
+                          entry->dataSize);
+    }
+    return MappedFile(_file, entry->dataOffset, entry->dataSize);
+}
+
+bool AssetArchive::pack
+(
+    const char* path,
+    const std::vector<std::string>& sources
+)
+{
+    std::vector<std::string> names = sources;
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+
+    std::vector<Entry> entries(names.size());
+
+    //  names follow the entry table
+    uint32_t offset = (uint32_t)(sizeof(Header) + entries.size() * sizeof(Entry));
+    for (size_t i = 0; i < names.size(); ++i) {
+        entries[i].nameOffset = offset;
+        entries[i].reserved = 0;
+        offset += (uint32_t)names[i].size() + 1;
+    }
+
+    //  read source data and assign offsets
+    std::vector<std::vector<uint8_t>> contents(names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        FILE* fp = fopen(names[i].c_str(), "rb");
+        if (!fp) {
+            OVENGINE_LOG_ERROR("AssetArchive.pack - cannot open %s\n", names[i].c_str());
+            return false;
+        }
+        fseek(fp, 0, SEEK_END);
+        long sz = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        auto& buffer = contents[i];
+        buffer.resize(sz > 0 ? (size_t)sz : 0);
+        bool ok = buffer.empty() || fread(buffer.data(), buffer.size(), 1, fp) == 1;
+        fclose(fp);
+        if (!ok) {
+            OVENGINE_LOG_ERROR("AssetArchive.pack - cannot read %s\n", names[i].c_str());
+            return false;
+        }
+
+        offset = (offset + kDataAlignment - 1) & ~(kDataAlignment - 1);
+        entries[i].dataOffset = offset;
+        entries[i].dataSize = (uint32_t)buffer.size();
+        offset += entries[i].dataSize + 1;
+    }
+
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        OVENGINE_LOG_ERROR("AssetArchive.pack - cannot create %s\n", path);
+        return false;
+    }
+
+    Header header;
+    memcpy(header.magic, kArchiveMagic, sizeof(kArchiveMagic));
+    header.version = kVersion;
+    header.entryCount = (uint32_t)entries.size();
+    header.reserved = 0;
+
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    if (ok && !entries.empty()) {
+        ok = fwrite(entries.data(), sizeof(Entry), entries.size(), out) == entries.size();
+    }
+    for (size_t i = 0; ok && i < names.size(); ++i) {
+        ok = fwrite(names[i].c_str(), names[i].size() + 1, 1, out) == 1;
+    }
+
+    const uint8_t padding[kDataAlignment] = { 0 };
+    for (size_t i = 0; ok && i < contents.size(); ++i) {
+        long pos = ftell(out);
+        if (pos < (long)entries[i].dataOffset) {
+            ok = fwrite(padding, entries[i].dataOffset - pos, 1, out) == 1;
+        }
+        if (ok && !contents[i].empty()) {
+            ok = fwrite(contents[i].data(), contents[i].size(), 1, out) == 1;
+        }
+        if (ok) {
+            ok = fwrite(padding, 1, 1, out) == 1;  // null terminator
+        }
+    }
+
+    fclose(out);
+
+    if (!ok) {
+        OVENGINE_LOG_ERROR("AssetArchive.pack - failed writing %s\n", path);
+        remove(path);
+    }
+    return ok;
+}
+
+    }  /* namespace ove */
+}  /* namespace cinek */
@@ -0,0 +1,92 @@
+//
+//  AssetArchive.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 3/28/16.
+//
+//
+
+#ifndef Overview_AssetArchive_hpp
+#define Overview_AssetArchive_hpp
+
+#include "EngineTypes.hpp"
+#include "MappedFile.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  @class  AssetArchive
+ *  @brief  A packed file of many small assets, mapped once into memory.
+ *
+ *  Layout (little endian):
+ *      Header      { 'OVPK', version, entryCount, reserved }
+ *      Entry[]     { nameOffset, dataOffset, dataSize, reserved }, sorted by name
+ *      Names       null terminated strings
+ *      Data        each entry aligned to kDataAlignment and followed by a
+ *                  null byte not included in its dataSize
+ *
+ *  Entries are looked up by the same path passed to LoadFile.
+ */
+class AssetArchive
+{
+    CK_CLASS_NON_COPYABLE(AssetArchive);
+
+public:
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kDataAlignment = 16;
+
+    /**
+     *  Maps the archive at the given path.
+     *
+     *  @param  path    The archive file
+     *  @return The archive or null if the file is missing or invalid
+     */
+    static std::shared_ptr<AssetArchive> open(const char* path);
+    /**
+     *  Builds an archive from a list of source files.
+     *
+     *  @param  path    The archive file to write
+     *  @param  sources Paths to the files to pack; also used as entry names
+     *  @return True on success
+     */
+    static bool pack(const char* path, const std::vector<std::string>& sources);
+
+    AssetArchive(std::string path, std::shared_ptr<MappedFile> file);
+
+    explicit operator bool() const { return _valid; }
+
+    uint32_t entryCount() const { return _entryCount; }
+    bool contains(const char* name) const;
+    /**
+     *  @param  name    The entry name
+     *  @param  access  Read-only entries are views onto the archive's
+     *                  mapping, which keep the archive mapped while alive.
+     *                  Copy-on-write entries are mapped separately.
+     *  @return The entry's bytes.  Evaluates to false if not found.
+     */
+    MappedFile openEntry(const char* name,
+                         MappedFile::Access access=MappedFile::Access::kReadOnly) const;
+
+private:
+    struct Header;
+    struct Entry;
+
+    const Entry* findEntry(const char* name) const;
+    const char* entryName(const Entry& entry) const;
+
+    std::string _path;
+    std::shared_ptr<MappedFile> _file;
+    const Entry* _entries;
+    uint32_t _entryCount;
+    bool _valid;
+};
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#endif /* Overview_AssetArchive_hpp */
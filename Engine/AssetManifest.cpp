@@ -11,6 +11,35 @@
 
 namespace cinek {
     namespace ove {
+
+//  rapidjson's GenericInsituStringStream bounded by length, since mapped
+//  files are not null terminated.  Peek returns '\0' past the end, which the
+//  reader treats as the end of input.
+class BoundedInsituStream
+{
+public:
+    typedef char Ch;
+
+    BoundedInsituStream(Ch* src, size_t size) :
+        _src(src), _dst(nullptr), _head(src), _end(src + size) {}
+
+    Ch Peek() const { return _src != _end ? *_src : '\0'; }
+    Ch Take() { return _src != _end ? *_src++ : '\0'; }
+    size_t Tell() const { return _src - _head; }
+
+    //  string parsing writes unescaped strings over the source, and a
+    //  string's terminator always lands on or before its closing quote
+    Ch* PutBegin() { return _dst = _src; }
+    void Put(Ch c) { *_dst++ = c; }
+    void Flush() {}
+    size_t PutEnd(Ch* begin) { return _dst - begin; }
+
+private:
+    Ch* _src;
+    Ch* _dst;
+    Ch* _head;
+    Ch* _end;
+};
     
 AssetManifest::AssetManifest(std::string name, std::vector<uint8_t>&& source) :
     _name(std::move(name)),
@@ -24,6 +53,21 @@ AssetManifest::AssetManifest(std::string name, std::vector<uint8_t>&& source) :
     }
 }
 
+AssetManifest::AssetManifest(std::string name, MappedFile&& source) :
+    _name(std::move(name)),
+    _mappedSource(std::move(source)),
+    _document()
+{
+    auto json = reinterpret_cast<char*>(_mappedSource.writableData());
+    CK_ASSERT_RETURN(json);
+    BoundedInsituStream stream(json, _mappedSource.size());
+    if (_document.ParseStream<rapidjson::kParseInsituFlag>(stream).HasParseError()) {
+        OVENGINE_LOG_ERROR("AssetManifest - failed to parse (%d) at %zu\n",
+                           _document.GetParseError(),
+                           _document.GetErrorOffset());
+    }
+}
+
 const JsonValue& AssetManifest::root(const char* name) const {
     if (name) {
         auto it = _document.FindMember(name);
@@ -10,6 +10,7 @@
 #define Overview_AssetManifest_hpp
 
 #include "EngineTypes.hpp"
+#include "MappedFile.hpp"
 
 #include <cinek/allocator.hpp>
 #include <ckjson/json.hpp>
@@ -24,6 +25,9 @@ class AssetManifest
 {
 public:
     AssetManifest(std::string name, std::vector<uint8_t>&& source);
+    //  Parses in situ from the mapped pages, which are retained for the
+    //  lifetime of the manifest.  The mapping must be copy-on-write.
+    AssetManifest(std::string name, MappedFile&& source);
     
     const JsonValue& root(const char* name=nullptr) const;
     
@@ -32,6 +36,7 @@ public:
 private:
     std::string _name;
     std::vector<uint8_t> _source;
+    MappedFile _mappedSource;
     JsonDocument _document;
 };
     
@@ -37,9 +37,16 @@ public:
     
     virtual ~AssetManfiestFactory() {}
     
+    /**
+     *  @param  assetType   The asset type to load
+     *  @param  name        The asset name
+     *  @param  owner       The name of the manifest referencing the asset
+     *  @param  cb          Invoked when the request completes
+     */
     virtual RequestId onAssetManifestRequest(
         AssetType assetType,
         const std::string& name,
+        const std::string& owner,
         RequestCb cb) = 0;
     
     virtual void onAssetManifestRequestCancelled(RequestId reqId) = 0;
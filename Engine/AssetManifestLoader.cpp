@@ -250,6 +250,7 @@ void AssetManifestLoader::requestAssetLoad
 )
 {
     _requestId = _listener->onAssetManifestRequest(assetType, name,
+        _manifest->name(),
         [this](const std::string&, AssetManfiestFactory::LoadResult r) {
             _requestId = 0;
         });
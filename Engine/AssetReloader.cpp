@@ -0,0 +1,198 @@
+//
+//  AssetReloader.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 3/30/16.
+//
+//
+
+#include "AssetReloader.hpp"
+#include "Debug.hpp"
+
+#include "Engine/Tasks/LoadTextureAsset.hpp"
+#include "Engine/Tasks/LoadAssetManifest.hpp"
+#include "Engine/Render/RenderGraph.hpp"
+
+#include "CKGfx/Context.hpp"
+#include "CKGfx/ShaderLibrary.hpp"
+#include "CKGfx/ModelSet.hpp"
+#include "CKGfx/ModelJsonSerializer.hpp"
+
+#include <cinek/taskscheduler.hpp>
+
+#include <algorithm>
+
+namespace cinek {
+    namespace ove {
+
+AssetReloader::AssetReloader(const InitParams& params) :
+    _params(params)
+{
+}
+
+AssetReloader::~AssetReloader()
+{
+    _params.taskScheduler->cancelAll(this);
+}
+
+void AssetReloader::watchTexture(const std::string& path)
+{
+    watchAsset(path, AssetKind::kTexture);
+}
+
+void AssetReloader::watchModelSet(const std::string& path)
+{
+    watchAsset(path, AssetKind::kModelSet);
+}
+
+void AssetReloader::watchShader(const std::string& path)
+{
+    watchAsset(path, AssetKind::kShader);
+}
+
+void AssetReloader::setProgramsReloadedCallback(ProgramsReloadedCb cb)
+{
+    _programsReloadedCb = std::move(cb);
+}
+
+void AssetReloader::watchAsset(const std::string& path, AssetKind kind)
+{
+    auto it = std::lower_bound(_assets.begin(), _assets.end(), path,
+        [](const decltype(_assets)::value_type& v, const std::string& p) -> bool {
+            return v.first < p;
+        });
+    if (it != _assets.end() && it->first == path)
+        return;
+
+    if (_watcher.watch(path)) {
+        _assets.emplace(it, path, kind);
+    }
+}
+
+void AssetReloader::update()
+{
+    _watcher.poll(_changed);
+
+    if (_changed.empty())
+        return;
+
+    //  a file may be reported more than once per poll, and deferred changes
+    //  may be reported again
+    std::sort(_changed.begin(), _changed.end());
+    _changed.erase(std::unique(_changed.begin(), _changed.end()), _changed.end());
+
+    //  changes to files with a reload in progress are deferred until that
+    //  reload finishes
+    auto deferredIt = std::remove_if(_changed.begin(), _changed.end(),
+        [this](const std::string& path) -> bool {
+            if (std::find(_inFlight.begin(), _inFlight.end(), path) != _inFlight.end())
+                return false;
+
+            auto it = std::lower_bound(_assets.begin(), _assets.end(), path,
+                [](const decltype(_assets)::value_type& v, const std::string& p) -> bool {
+                    return v.first < p;
+                });
+            if (it == _assets.end() || it->first != path)
+                return true;
+
+            bool started = false;
+            switch (it->second) {
+            case AssetKind::kTexture:
+                started = reloadTexture(path);
+                break;
+            case AssetKind::kModelSet:
+                started = reloadModelSet(path);
+                break;
+            case AssetKind::kShader:
+                reloadShader(path);
+                break;
+            }
+            if (started) {
+                _inFlight.push_back(path);
+            }
+            return true;
+        });
+
+    _changed.erase(deferredIt, _changed.end());
+}
+
+void AssetReloader::reloadFinished(const std::string& path)
+{
+    auto it = std::find(_inFlight.begin(), _inFlight.end(), path);
+    if (it != _inFlight.end()) {
+        _inFlight.erase(it);
+    }
+}
+
+bool AssetReloader::reloadTexture(const std::string& path)
+{
+    OVENGINE_LOG_INFO("AssetReloader - reloading texture %s\n", path.c_str());
+
+    auto task = allocate_unique<LoadTextureAsset>(
+        path,
+        [this, path](Task::State state, Task& t, void*) {
+            auto& task = static_cast<LoadTextureAsset&>(t);
+            if (state == Task::State::kEnded) {
+                auto name = task.acquireTextureName();
+                _params.gfxContext->reloadTexture(task.acquireTexture(), name.c_str());
+            }
+            else if (state == Task::State::kFailed) {
+                OVENGINE_LOG_WARN("AssetReloader - failed to reload %s\n", path.c_str());
+            }
+            reloadFinished(path);
+        });
+
+    return _params.taskScheduler->schedule(std::move(task), this) != 0;
+}
+
+bool AssetReloader::reloadModelSet(const std::string& path)
+{
+    OVENGINE_LOG_INFO("AssetReloader - reloading model set %s\n", path.c_str());
+
+    auto task = allocate_unique<LoadAssetManifest>(
+        path,
+        *_params.resourceFactory,
+        [this, path](Task::State state, Task& t, void*) {
+            auto& task = static_cast<LoadAssetManifest&>(t);
+            if (state == Task::State::kEnded) {
+                auto manifest = task.acquireManifest();
+                auto& context = *_params.gfxContext;
+
+                auto modelSet = context.reloadModelSet(
+                    gfx::loadModelSetFromJSON(context, manifest->root(), true),
+                    path.c_str());
+                context.releaseAssetOwner(manifest->name().c_str());
+
+                //  clones are keyed by model name, as the old set's nodes are
+                //  released once no longer cloned
+                uint32_t patchCount = 0;
+                for (auto& model : modelSet->models()) {
+                    patchCount += _params.renderGraph->replaceSourceNode(
+                        RenderGraph::makeSourceName(path.c_str(), model.first.c_str()).c_str(),
+                        model.second);
+                }
+                OVENGINE_LOG_INFO("AssetReloader - %s patched %u nodes\n",
+                                  path.c_str(), patchCount);
+            }
+            else if (state == Task::State::kFailed) {
+                OVENGINE_LOG_WARN("AssetReloader - failed to reload %s\n", path.c_str());
+            }
+            reloadFinished(path);
+        });
+
+    return _params.taskScheduler->schedule(std::move(task), this) != 0;
+}
+
+bool AssetReloader::reloadShader(const std::string& path)
+{
+    OVENGINE_LOG_INFO("AssetReloader - reloading shader %s\n", path.c_str());
+
+    auto programs = _params.shaderLibrary->reloadShader(path.c_str());
+    if (!programs.empty() && _programsReloadedCb) {
+        _programsReloadedCb(programs);
+    }
+    return !programs.empty();
+}
+
+    }  /* namespace ove */
+}  /* namespace cinek */
@@ -0,0 +1,110 @@
+//
+//  AssetReloader.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 3/30/16.
+//
+//
+
+#ifndef Overview_AssetReloader_hpp
+#define Overview_AssetReloader_hpp
+
+#include "EngineTypes.hpp"
+#include "FileWatcher.hpp"
+
+#include "CKGfx/GfxTypes.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace cinek {
+    class TaskScheduler;
+}
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  @class  AssetReloader
+ *  @brief  Reloads textures, model sets and shaders when their files change.
+ *
+ *  -   Textures are reloaded via LoadTextureAsset and replaced in place within
+ *      the gfx::Context, so materials pick up the new texture.
+ *  -   Model sets are reloaded via LoadAssetManifest.  Every RenderGraph
+ *      clone of a model from the old set is replaced by a clone of the same
+ *      model from the new set.
+ *  -   Shaders are reloaded via ShaderLibrary::loadProgram.  Since program
+ *      handles change, the owner of the renderer's program map is notified.
+ */
+class AssetReloader
+{
+    CK_CLASS_NON_COPYABLE(AssetReloader);
+
+public:
+    struct InitParams
+    {
+        gfx::Context* gfxContext;
+        gfx::ShaderLibrary* shaderLibrary;
+        TaskScheduler* taskScheduler;
+        AssetManfiestFactory* resourceFactory;
+        RenderGraph* renderGraph;
+    };
+
+    using ProgramsReloadedCb =
+        std::function<void(const std::vector<gfx::ShaderProgramId>&)>;
+
+    AssetReloader(const InitParams& params);
+    ~AssetReloader();
+
+    /**
+     *  @param  path    The texture file, as passed to LoadTextureAsset
+     */
+    void watchTexture(const std::string& path);
+    /**
+     *  @param  path    The model set file, also the registered ModelSet name
+     */
+    void watchModelSet(const std::string& path);
+    /**
+     *  @param  path    The shader binary, as passed to loadProgram
+     */
+    void watchShader(const std::string& path);
+    /**
+     *  @param  cb      Invoked with the IDs of programs reloaded after a
+     *                  shader binary changed
+     */
+    void setProgramsReloadedCallback(ProgramsReloadedCb cb);
+    /**
+     *  Polls for file changes and starts reloads.  Call once per frame.
+     */
+    void update();
+
+private:
+    enum class AssetKind
+    {
+        kTexture,
+        kModelSet,
+        kShader
+    };
+
+    void watchAsset(const std::string& path, AssetKind kind);
+    bool reloadTexture(const std::string& path);
+    bool reloadModelSet(const std::string& path);
+    bool reloadShader(const std::string& path);
+    void reloadFinished(const std::string& path);
+
+    InitParams _params;
+    FileWatcher _watcher;
+    ProgramsReloadedCb _programsReloadedCb;
+
+    //  sorted by path
+    std::vector<std::pair<std::string, AssetKind>> _assets;
+    //  changes waiting for an in-flight reload of the same file to finish
+    std::vector<std::string> _changed;
+    std::vector<std::string> _inFlight;
+};
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#endif /* Overview_AssetReloader_hpp */
@@ -13,6 +13,8 @@
 #include "Engine/Path/NavPathQuery.hpp"
 #include "Engine/Path/Pathfinder.hpp"
 #include "Engine/Debug.hpp"
+#include "Engine/Profiler.hpp"
+#include "Engine/MemoryTracker.hpp"
 
 #include <ckm/math.hpp>
 #include <algorithm>
@@ -68,6 +70,9 @@ void NavSystem::startFrame()
 
 void NavSystem::simulate(CKTimeDelta dt)
 {
+    OVENGINE_PROFILE_ZONE("NavSystem::simulate");
+    OVENGINE_MEMORY_TAG(kMemoryTagNav);
+    
     if (!_active || _bodies.empty())
         return;
     
@@ -23,6 +23,8 @@ namespace cinek {
         class ViewStack;
         class ViewController;
         
+        class JobSystem;
+        
         class RenderGraph;
         struct RenderContext;
         
@@ -31,11 +33,16 @@ namespace cinek {
         
         class Scene;
         struct SceneBody;
+        struct SceneContact;
+        class SceneBatch;
         class SceneFixedBodyHull;
         class SceneDataContext;
         class SceneMotionState;
         class SceneDebugDrawer;
+        class SceneQueryService;
+        class SceneListener;
         struct SceneObjectJsonLoader;
+        class SceneSnapshot;
         
         class Pathfinder;
         struct PathfinderDebug;
@@ -60,6 +67,10 @@ namespace cinek {
         class AssetManifest;
         class AssetManifestLoader;
         class AssetManfiestFactory;
+        class AssetArchive;
+        class AssetReloader;
+        class MappedFile;
+        class FileWatcher;
         
         enum class AssetType
         {
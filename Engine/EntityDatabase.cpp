@@ -10,6 +10,8 @@
 #include "AssetManifest.hpp"
 #include "Debug.hpp"
 
+#include <cstdio>
+
 namespace cinek {
     namespace ove {
 
@@ -23,15 +25,25 @@ EntityDatabase::EntityDatabase
     dictSz = std::min(dictSz, 256U);
     if (dictSz > 0) {
         _stores.reserve(dictSz);
+        _storeCounters.reserve(dictSz);
         
         for (auto& store : stores) {
             _stores.emplace_back(store);
+            
+            char name[32];
+            snprintf(name, sizeof(name), "Entity Store %u",
+                     (uint32_t)_storeCounters.size());
+            //  EntityStore doesn't expose its limit, so only usage is
+            //  reported
+            _storeCounters.emplace_back(
+                allocate_unique<PoolCounter>(name, kMemoryTagEntity, 0));
         }
     }
 }
     
 EntityDatabase::EntityDatabase(EntityDatabase&& other) :
     _stores(std::move(other._stores)),
+    _storeCounters(std::move(other._storeCounters)),
     _manifests(std::move(other._manifests)),
     _factory(other._factory)
 {
@@ -41,6 +53,7 @@ EntityDatabase::EntityDatabase(EntityDatabase&& other) :
 EntityDatabase& EntityDatabase::operator=(EntityDatabase&& other)
 {
     _stores = std::move(other._stores);
+    _storeCounters = std::move(other._storeCounters);
     _manifests = std::move(other._manifests);
     _factory = other._factory;
     other._factory = nullptr;
@@ -67,6 +80,26 @@ EntityStore& EntityDatabase::getStore(EntityContextType index)
     );
 }
 
+PoolCounter* EntityDatabase::storeCounter(EntityContextType index)
+{
+    if (index >= _storeCounters.size())
+        index = 0;
+    return index < _storeCounters.size() ? _storeCounters[index].get() : nullptr;
+}
+
+void EntityDatabase::entityCreated(EntityContextType context, Entity entity)
+{
+    PoolCounter* counter = storeCounter(context);
+    if (!counter)
+        return;
+    if (entity) {
+        counter->acquired();
+    }
+    else {
+        counter->exhausted();
+    }
+}
+
 Entity EntityDatabase::createEntity
 (
     EntityContextType context,
@@ -74,6 +107,8 @@ Entity EntityDatabase::createEntity
     const std::string& templateName
 )
 {
+    OVENGINE_MEMORY_TAG(kMemoryTagEntity);
+    
     Entity entity = 0;
     auto it = _manifests.find(ns);
     if (it != _manifests.end()) {
@@ -84,6 +119,7 @@ Entity EntityDatabase::createEntity
         if (templateIt != entityDefinitions.MemberEnd()) {
             auto& store = getStore(context);
             entity = store.create(context);
+            entityCreated(context, entity);
             
             //  create renderable component first if it exists. useful so that
             //  other components that reply on renderable have the data they
@@ -131,7 +167,10 @@ Entity EntityDatabase::cloneEntity
     Entity source
 )
 {
+    OVENGINE_MEMORY_TAG(kMemoryTagEntity);
+    
     Entity cloned = getStore(context).create(context);
+    entityCreated(context, cloned);
     _factory->onCustomComponentEntityCloneFn(cloned, source);
     
     return cloned;
@@ -139,7 +178,13 @@ Entity EntityDatabase::cloneEntity
 
 void EntityDatabase::destroyEntity(Entity entity)
 {
+    OVENGINE_MEMORY_TAG(kMemoryTagEntity);
+    
     getStore(cinek_entity_context(entity)).destroy(entity);
+    PoolCounter* counter = storeCounter(cinek_entity_context(entity));
+    if (counter) {
+        counter->released();
+    }
     
     //  TODO - consider delaying this until the gc() phase
     //  need a way to flag an entity as dead and group them together so
@@ -150,6 +195,8 @@ void EntityDatabase::destroyEntity(Entity entity)
 
 void EntityDatabase::gc()
 {
+    OVENGINE_MEMORY_TAG(kMemoryTagEntity);
+    
     for (auto& store : _stores) {
         store.gc();
     }
@@ -11,6 +11,7 @@
 
 #include "EngineTypes.hpp"
 #include "AssetManifest.hpp"
+#include "MemoryTracker.hpp"
 
 #include <ckentity/entitystore.hpp>
 #include <cinek/allocator.hpp>
@@ -186,7 +187,12 @@ public:
     void unlinkIdentityFromEntity(Entity entity);
     
 private:
+    PoolCounter* storeCounter(EntityContextType index);
+    void entityCreated(EntityContextType context, Entity entity);
+    
     std::vector<EntityStore> _stores;
+    //  live entity counts per store, reported to the MemoryTracker
+    std::vector<unique_ptr<PoolCounter>> _storeCounters;
     std::unordered_map<std::string, std::shared_ptr<AssetManifest>> _manifests;
     std::unordered_map<Entity, std::string> _entityToIdentityMap;
     EntityComponentFactory* _factory;
@@ -0,0 +1,178 @@
+//
+//  FileWatcher.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 3/30/16.
+//
+//
+
+#include "FileWatcher.hpp"
+#include "Debug.hpp"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace cinek {
+    namespace ove {
+
+void FileWatcher::splitPath
+(
+    const std::string& path,
+    std::string& dir,
+    std::string& file
+)
+{
+    auto sep = path.find_last_of("/\\");
+    if (sep == std::string::npos) {
+        dir.clear();
+        file = path;
+    }
+    else {
+        dir = path.substr(0, sep);
+        file = path.substr(sep+1);
+    }
+}
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher() :
+    _inotifyFd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+    if (_inotifyFd < 0) {
+        OVENGINE_LOG_ERROR("FileWatcher - inotify unavailable (%d)\n", errno);
+    }
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (_inotifyFd >= 0) {
+        close(_inotifyFd);
+    }
+}
+
+bool FileWatcher::watch(const std::string& path)
+{
+    if (_inotifyFd < 0)
+        return false;
+
+    std::string dir, file;
+    splitPath(path, dir, file);
+
+    int wd = inotify_add_watch(_inotifyFd, dir.empty() ? "." : dir.c_str(),
+                               IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0) {
+        OVENGINE_LOG_WARN("FileWatcher - cannot watch %s (%d)\n", path.c_str(), errno);
+        return false;
+    }
+
+    //  multiple files in a directory share the same watch descriptor, as do
+    //  different spellings of the directory (i.e. "./data" and "data/")
+    auto& directory = _directories[wd];
+    auto it = std::find_if(directory.files.begin(), directory.files.end(),
+        [&path](const WatchedName& watched) -> bool {
+            return watched.path == path;
+        });
+    if (it == directory.files.end()) {
+        directory.files.push_back({ std::move(file), path });
+    }
+    return true;
+}
+
+size_t FileWatcher::poll(std::vector<std::string>& changed)
+{
+    if (_inotifyFd < 0)
+        return 0;
+
+    const size_t startCount = changed.size();
+
+    alignas(struct inotify_event) char buffer[4096];
+    for (;;) {
+        ssize_t len = read(_inotifyFd, buffer, sizeof(buffer));
+        if (len <= 0)
+            break;
+
+        for (char* p = buffer; p < buffer + len; ) {
+            auto event = reinterpret_cast<const struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                OVENGINE_LOG_WARN("FileWatcher - event queue overflow\n");
+                continue;
+            }
+            if (!event->len)
+                continue;
+
+            auto dirIt = _directories.find(event->wd);
+            if (dirIt == _directories.end())
+                continue;
+
+            for (auto& watched : dirIt->second.files) {
+                if (watched.name != event->name)
+                    continue;
+                if (std::find(changed.begin() + startCount, changed.end(),
+                              watched.path) == changed.end()) {
+                    changed.push_back(watched.path);
+                }
+            }
+        }
+    }
+
+    return changed.size() - startCount;
+}
+
+#else
+
+static int64_t fileModifiedTime(const std::string& path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st))
+        return -1;
+    return (int64_t)st.st_mtime;
+}
+
+FileWatcher::FileWatcher()
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+}
+
+bool FileWatcher::watch(const std::string& path)
+{
+    auto it = std::find_if(_files.begin(), _files.end(),
+        [&path](const WatchedFile& f) -> bool {
+            return f.path == path;
+        });
+    if (it != _files.end())
+        return true;
+
+    _files.push_back({ path, fileModifiedTime(path) });
+    return true;
+}
+
+size_t FileWatcher::poll(std::vector<std::string>& changed)
+{
+    size_t count = 0;
+    for (auto& file : _files) {
+        int64_t mtime = fileModifiedTime(file.path);
+        if (mtime >= 0 && mtime != file.modifiedTime) {
+            file.modifiedTime = mtime;
+            changed.push_back(file.path);
+            ++count;
+        }
+    }
+    return count;
+}
+
+#endif
+
+    }  /* namespace ove */
+}  /* namespace cinek */
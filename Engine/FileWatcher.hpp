@@ -0,0 +1,86 @@
+//
+//  FileWatcher.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 3/30/16.
+//
+//
+
+#ifndef Overview_FileWatcher_hpp
+#define Overview_FileWatcher_hpp
+
+#include "EngineTypes.hpp"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  @class  FileWatcher
+ *  @brief  Reports modifications to a set of watched files.
+ *
+ *  On Linux, uses inotify on the directories containing watched files, which
+ *  handles editors that save by writing a temporary and renaming it.  Other
+ *  platforms fall back to polling modification times.
+ */
+class FileWatcher
+{
+    CK_CLASS_NON_COPYABLE(FileWatcher);
+
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    /**
+     *  @param  path    The file to watch.  Watching a file more than once is
+     *                  allowed.
+     *  @return False if the file's directory could not be watched
+     */
+    bool watch(const std::string& path);
+    /**
+     *  Appends files modified since the last poll to the supplied vector.
+     *  Each file is reported at most once per poll.
+     *
+     *  @param  changed The list of changed files (as passed to watch)
+     *  @return The number of files appended
+     */
+    size_t poll(std::vector<std::string>& changed);
+
+private:
+    //  a file as passed to watch.  different spellings of a directory share
+    //  a watch descriptor, so changes are reported under each path a file
+    //  was watched with
+    struct WatchedName
+    {
+        std::string name;                   // file name without directory
+        std::string path;
+    };
+    struct Directory
+    {
+        std::vector<WatchedName> files;
+    };
+
+    static void splitPath(const std::string& path, std::string& dir,
+                          std::string& file);
+
+#ifdef __linux__
+    int _inotifyFd;
+    //  keyed by inotify watch descriptor
+    std::unordered_map<int, Directory> _directories;
+#else
+    struct WatchedFile
+    {
+        std::string path;
+        int64_t modifiedTime;
+    };
+    std::vector<WatchedFile> _files;
+#endif
+};
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#endif /* Overview_FileWatcher_hpp */
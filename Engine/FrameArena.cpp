@@ -0,0 +1,177 @@
+//
+//  FrameArena.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#include "FrameArena.hpp"
+#include "Debug.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+namespace cinek {
+    namespace ove {
+
+//  the calling thread's block, registered with the arena whose instance id
+//  is tlsFrameArenaId.  ids aren't reused, unlike addresses, so the cache
+//  stays correct with several live arenas or when an arena is destroyed
+//  and another created in its place
+static thread_local uint64_t tlsFrameArenaId = 0;
+static thread_local void* tlsThreadBlock = nullptr;
+
+std::atomic<FrameArena*> FrameArena::s_current(nullptr);
+std::atomic<uint64_t> FrameArena::s_nextInstanceId(1);
+
+void FrameArena::setCurrent(FrameArena* arena)
+{
+    s_current.store(arena, std::memory_order_release);
+}
+
+FrameArena::FrameArena(const InitParams& params) :
+    _params(params),
+    _instanceId(s_nextInstanceId.fetch_add(1, std::memory_order_relaxed)),
+    _frameIndex(0),
+    _threadCount(0),
+    _overflowBytes { 0, 0 },
+    _overflowWarned(false),
+    _stats { 0, 0, 0, 0, 0 }
+{
+    _params.threadLimit = std::max(_params.threadLimit, 1U);
+    _threads.resize(_params.threadLimit);
+}
+
+FrameArena::~FrameArena()
+{
+    FrameArena* self = this;
+    s_current.compare_exchange_strong(self, nullptr);
+
+    freeOverflow(0);
+    freeOverflow(1);
+}
+
+auto FrameArena::threadBlock() -> ThreadBlock*
+{
+    if (tlsFrameArenaId == _instanceId)
+        return reinterpret_cast<ThreadBlock*>(tlsThreadBlock);
+
+    std::lock_guard<std::mutex> lock(_registerMutex);
+
+    //  the thread may have registered already and since used another arena
+    const std::thread::id threadId = std::this_thread::get_id();
+    uint32_t index = _threadCount.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < index; ++i) {
+        if (_threads[i]->owner == threadId) {
+            tlsFrameArenaId = _instanceId;
+            tlsThreadBlock = _threads[i].get();
+            return _threads[i].get();
+        }
+    }
+    if (index >= _params.threadLimit) {
+        return nullptr;
+    }
+
+    auto block = new ThreadBlock;
+    block->owner = threadId;
+    for (int i = 0; i < 2; ++i) {
+        block->data[i].reset(new uint8_t[_params.bytesPerThread]);
+        block->offset[i] = 0;
+    }
+    _threads[index].reset(block);
+    _threadCount.store(index + 1, std::memory_order_release);
+
+    tlsFrameArenaId = _instanceId;
+    tlsThreadBlock = block;
+    return block;
+}
+
+void* FrameArena::allocate(size_t size, size_t align)
+{
+    const uint32_t buffer = _frameIndex.load(std::memory_order_acquire) & 1;
+
+    ThreadBlock* block = threadBlock();
+    if (block) {
+        uint8_t* base = block->data[buffer].get();
+        const uintptr_t start = reinterpret_cast<uintptr_t>(base) + block->offset[buffer];
+        const uintptr_t aligned = (start + align - 1) & ~(uintptr_t)(align - 1);
+        const size_t end = (aligned - reinterpret_cast<uintptr_t>(base)) + size;
+        if (end <= _params.bytesPerThread) {
+            block->offset[buffer] = end;
+            return reinterpret_cast<void*>(aligned);
+        }
+    }
+
+    return overflow(size, align, buffer);
+}
+
+void* FrameArena::overflow(size_t size, size_t align, uint32_t buffer)
+{
+    //  keep the original pointer so the allocation can be freed on reset
+    void* p = ::operator new(size + align);
+    const uintptr_t aligned = (reinterpret_cast<uintptr_t>(p) + align - 1)
+        & ~(uintptr_t)(align - 1);
+
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    if (!_overflowWarned) {
+        _overflowWarned = true;
+        OVENGINE_LOG_WARN("FrameArena: %zu byte allocation overflowed the "
+                          "thread's %u byte block\n",
+                          size, _params.bytesPerThread);
+    }
+    _overflow[buffer].push_back(p);
+    _overflowBytes[buffer] += size;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void FrameArena::freeOverflow(uint32_t buffer)
+{
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    for (auto p : _overflow[buffer]) {
+        ::operator delete(p);
+    }
+    _overflow[buffer].clear();
+    _overflowBytes[buffer] = 0;
+}
+
+void FrameArena::endFrame()
+{
+    const uint32_t frameIndex = _frameIndex.load(std::memory_order_relaxed);
+    const uint32_t buffer = frameIndex & 1;
+    const uint32_t nextBuffer = buffer ^ 1;
+    const uint32_t threadCount = _threadCount.load(std::memory_order_acquire);
+
+    //  record the ending frame
+    size_t frameBytes = 0;
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        const size_t threadBytes = _threads[i]->offset[buffer];
+        frameBytes += threadBytes;
+        _stats.peakThreadBytes = std::max(_stats.peakThreadBytes, threadBytes);
+    }
+    {
+        std::lock_guard<std::mutex> lock(_overflowMutex);
+        frameBytes += _overflowBytes[buffer];
+        _stats.overflowCount = (uint32_t)_overflow[buffer].size();
+    }
+    _stats.capacity = (size_t)_params.bytesPerThread * threadCount;
+    _stats.frameBytes = frameBytes;
+    _stats.peakFrameBytes = std::max(_stats.peakFrameBytes, frameBytes);
+
+    //  the next frame reuses the buffer from two frames ago
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        _threads[i]->offset[nextBuffer] = 0;
+    }
+    freeOverflow(nextBuffer);
+
+    _frameIndex.store(frameIndex + 1, std::memory_order_release);
+}
+
+auto FrameArena::stats() const -> Stats
+{
+    return _stats;
+}
+
+    }  /* namespace ove */
+}  /* namespace cinek */
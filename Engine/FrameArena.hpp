@@ -0,0 +1,199 @@
+//
+//  FrameArena.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#ifndef Overview_FrameArena_hpp
+#define Overview_FrameArena_hpp
+
+#include "Engine/EngineTypes.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  @class  FrameArena
+ *  @brief  Per-thread bump allocators for memory that lives for a frame.
+ *
+ *  Each thread allocates from its own block without locking.  Blocks are
+ *  double buffered - memory allocated during a frame remains valid until
+ *  the end of the following frame, so results produced by jobs in one
+ *  frame can be consumed in the next.  Memory is never freed individually;
+ *  the arena is reset in bulk by endFrame.
+ *
+ *  Allocations that don't fit in the thread's block (or made by threads
+ *  beyond the arena's thread limit) fall back to the heap and are freed
+ *  when their frame's buffer is reset.  Stats report these so the block
+ *  size can be tuned.
+ */
+class FrameArena
+{
+    CK_CLASS_NON_COPYABLE(FrameArena);
+
+public:
+    struct InitParams
+    {
+        /** Size of each thread's block, per frame buffer */
+        uint32_t bytesPerThread;
+        /** Maximum number of threads with their own blocks */
+        uint32_t threadLimit;
+    };
+
+    struct Stats
+    {
+        /** Bytes reserved for each frame buffer, over all threads */
+        size_t capacity;
+        /** Bytes allocated over the last completed frame */
+        size_t frameBytes;
+        size_t peakFrameBytes;
+        /** The most bytes allocated by one thread in one frame */
+        size_t peakThreadBytes;
+        /** Allocations over the last completed frame that used the heap */
+        uint32_t overflowCount;
+    };
+
+    /**
+     *  @return The arena used by FrameAllocator by default, or null
+     */
+    static FrameArena* current() { return s_current.load(std::memory_order_acquire); }
+    /**
+     *  @param  arena       The arena to use by default (or null)
+     */
+    static void setCurrent(FrameArena* arena);
+
+    FrameArena(const InitParams& params);
+    ~FrameArena();
+
+    /**
+     *  Allocates from the calling thread's block.  Thread safe, though not
+     *  while endFrame is running.
+     *
+     *  @param  size        Bytes to allocate
+     *  @param  align       Alignment (a power of two)
+     *  @return The allocation - never null
+     */
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+    /**
+     *  @param  count       Number of objects
+     *  @return Uninitialized storage for count objects of type T
+     */
+    template<typename T> T* allocateArray(size_t count)
+    {
+        return reinterpret_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+    /**
+     *  Switches to the other frame buffer, discarding everything allocated
+     *  in it two frames ago.  Call once per frame from the main thread when
+     *  no jobs are running.
+     */
+    void endFrame();
+
+    Stats stats() const;
+
+private:
+    struct ThreadBlock
+    {
+        std::unique_ptr<uint8_t[]> data[2];
+        size_t offset[2];
+        std::thread::id owner;
+    };
+
+    ThreadBlock* threadBlock();
+    void* overflow(size_t size, size_t align, uint32_t buffer);
+    void freeOverflow(uint32_t buffer);
+
+    static std::atomic<FrameArena*> s_current;
+    static std::atomic<uint64_t> s_nextInstanceId;
+
+    InitParams _params;
+    //  identifies this arena in threads' cached block registrations
+    const uint64_t _instanceId;
+    std::atomic<uint32_t> _frameIndex;
+
+    std::mutex _registerMutex;
+    std::vector<std::unique_ptr<ThreadBlock>> _threads;
+    std::atomic<uint32_t> _threadCount;
+
+    std::mutex _overflowMutex;
+    std::vector<void*> _overflow[2];
+    size_t _overflowBytes[2];
+    bool _overflowWarned;
+
+    Stats _stats;
+};
+
+/**
+ *  @class  FrameAllocator
+ *  @brief  An STL allocator backed by a FrameArena.
+ *
+ *  Containers using it must be discarded (or cleared and not reused) by the
+ *  end of the frame after the one they allocated in.  deallocate is a no-op,
+ *  so growing a container abandons its old storage until the arena resets.
+ *  Without an arena the allocator uses the heap.
+ */
+template<typename T>
+class FrameAllocator
+{
+public:
+    using value_type = T;
+    //  so a container can be replaced with one allocated from this frame
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    FrameAllocator() : _arena(FrameArena::current()) {}
+    explicit FrameAllocator(FrameArena* arena) : _arena(arena) {}
+    template<typename U> FrameAllocator(const FrameAllocator<U>& other) :
+        _arena(other.arena())
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        if (_arena)
+            return _arena->allocateArray<T>(count);
+        return reinterpret_cast<T*>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t)
+    {
+        if (!_arena) {
+            ::operator delete(p);
+        }
+    }
+
+    FrameArena* arena() const { return _arena; }
+
+private:
+    FrameArena* _arena;
+};
+
+template<typename T, typename U>
+bool operator==(const FrameAllocator<T>& a, const FrameAllocator<U>& b)
+{
+    return a.arena() == b.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const FrameAllocator<T>& a, const FrameAllocator<U>& b)
+{
+    return a.arena() != b.arena();
+}
+
+template<typename T> using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#endif /* Overview_FrameArena_hpp */
@@ -0,0 +1,285 @@
+//
+//  JobSystem.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/6/16.
+//
+//
+
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+
+#include <cstdio>
+
+namespace cinek {
+    namespace ove {
+
+//  identifies the calling thread's queue.  threads not created by the job
+//  system (including the main thread) use queue 0.
+static thread_local const JobSystem* tlsJobSystem = nullptr;
+static thread_local uint32_t tlsQueueIndex = 0;
+
+uint32_t JobSystem::defaultWorkerCount()
+{
+    uint32_t hwThreadCount = std::thread::hardware_concurrency();
+    return hwThreadCount > 1 ? hwThreadCount - 1 : 0;
+}
+
+JobSystem::Job::Job(Job&& other) noexcept :
+    _invoke(other._invoke),
+    _relocate(other._relocate)
+{
+    if (_relocate) {
+        _relocate(&_storage, &other._storage);
+        other._invoke = nullptr;
+        other._relocate = nullptr;
+    }
+}
+
+JobSystem::Job& JobSystem::Job::operator=(Job&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    reset();
+    _invoke = other._invoke;
+    _relocate = other._relocate;
+    if (_relocate) {
+        _relocate(&_storage, &other._storage);
+        other._invoke = nullptr;
+        other._relocate = nullptr;
+    }
+    return *this;
+}
+
+JobSystem::Job::~Job()
+{
+    reset();
+}
+
+void JobSystem::Job::reset()
+{
+    if (_relocate) {
+        _relocate(nullptr, &_storage);
+    }
+    _invoke = nullptr;
+    _relocate = nullptr;
+}
+
+JobSystem::JobSystem(const InitParams& params) :
+    _queuedCount(0),
+    _deferredCount(0),
+    _stopping(false)
+{
+    _queues.reserve(params.workerCount + 1);
+    for (uint32_t i = 0; i < params.workerCount + 1; ++i) {
+        _queues.emplace_back(new Queue());
+    }
+
+    _workers.reserve(params.workerCount);
+    for (uint32_t i = 0; i < params.workerCount; ++i) {
+        _workers.emplace_back(&JobSystem::workerMain, this, i + 1);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    //  finish outstanding jobs, since their counters may be referenced by
+    //  other systems
+    while (_queuedCount.load(std::memory_order_acquire) > 0
+           || _deferredCount.load(std::memory_order_acquire) > 0) {
+        if (!runOneJob(0)) {
+            std::this_thread::yield();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stopping = true;
+    }
+    _wakeCondition.notify_all();
+
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+uint32_t JobSystem::queueIndex() const
+{
+    return tlsJobSystem == this ? tlsQueueIndex : 0;
+}
+
+void JobSystem::run
+(
+    Job job,
+    Counter* counter,
+    const Counter* dependency
+)
+{
+    if (counter) {
+        counter->_value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (dependency && !dependency->done()) {
+        //  the thread finishing the dependency's last job decrements it, then
+        //  checks the deferred count.  ordered against the increment and load
+        //  here, either that thread sees this job, or this thread sees the
+        //  dependency as done
+        std::lock_guard<std::mutex> lock(_deferredMutex);
+        _deferredCount.fetch_add(1, std::memory_order_seq_cst);
+        if (dependency->_value.load(std::memory_order_seq_cst) != 0) {
+            _deferredJobs.emplace_back(QueuedJob { std::move(job), counter, dependency });
+            return;
+        }
+        _deferredCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    pushJob(queueIndex(), QueuedJob { std::move(job), counter, nullptr });
+    wakeWorker();
+}
+
+void JobSystem::wakeWorker()
+{
+    //  acquiring the sleep mutex ensures a worker that found no jobs is
+    //  either waiting on the condition, or will see the incremented count
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _wakeCondition.notify_one();
+}
+
+void JobSystem::wait(const Counter& counter)
+{
+    uint32_t index = queueIndex();
+    while (!counter.done()) {
+        if (!runOneJob(index)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::pushJob(uint32_t queueIndex, QueuedJob&& job)
+{
+    Queue& queue = *_queues[queueIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.emplace_back(std::move(job));
+    }
+    _queuedCount.fetch_add(1, std::memory_order_release);
+}
+
+bool JobSystem::popJob(uint32_t queueIndex, QueuedJob& job)
+{
+    //  owners pop the most recently queued job, which is likely to share
+    //  data with the job that queued it
+    Queue& queue = *_queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty())
+        return false;
+
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    _queuedCount.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::stealJob(uint32_t queueIndex, QueuedJob& job)
+{
+    //  thieves take the oldest job from a victim's queue
+    const uint32_t queueCount = (uint32_t)_queues.size();
+    for (uint32_t i = 1; i < queueCount; ++i) {
+        Queue& queue = *_queues[(queueIndex + i) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty())
+            continue;
+
+        job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+        _queuedCount.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::runOneJob(uint32_t queueIndex)
+{
+    QueuedJob job;
+    if (!popJob(queueIndex, job) && !stealJob(queueIndex, job))
+        return false;
+
+    {
+        OVENGINE_PROFILE_ZONE("Job");
+        job.job();
+    }
+
+    if (job.counter) {
+        if (job.counter->_value.fetch_sub(1, std::memory_order_seq_cst) == 1
+            && _deferredCount.load(std::memory_order_seq_cst) > 0) {
+            releaseDeferredJobs(queueIndex);
+        }
+    }
+    return true;
+}
+
+void JobSystem::releaseDeferredJobs(uint32_t queueIndex)
+{
+    uint32_t releasedCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(_deferredMutex);
+        auto it = _deferredJobs.begin();
+        while (it != _deferredJobs.end()) {
+            if (it->dependency->done()) {
+                it->dependency = nullptr;
+                pushJob(queueIndex, std::move(*it));
+                it = _deferredJobs.erase(it);
+                ++releasedCount;
+            }
+            else {
+                ++it;
+            }
+        }
+        _deferredCount.fetch_sub(releasedCount, std::memory_order_release);
+    }
+
+    if (releasedCount > 1) {
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+        }
+        _wakeCondition.notify_all();
+    }
+    else if (releasedCount == 1) {
+        wakeWorker();
+    }
+}
+
+void JobSystem::workerMain(uint32_t queueIndex)
+{
+    tlsJobSystem = this;
+    tlsQueueIndex = queueIndex;
+    
+    Profiler* profiler = Profiler::current();
+    if (profiler) {
+        char name[32];
+        snprintf(name, sizeof(name), "Job Worker %u", queueIndex);
+        profiler->setThreadName(name);
+    }
+
+    for (;;) {
+        if (runOneJob(queueIndex))
+            continue;
+
+        {
+            std::unique_lock<std::mutex> lock(_sleepMutex);
+            _wakeCondition.wait(lock, [this]() -> bool {
+                return _stopping || _queuedCount.load(std::memory_order_acquire) > 0;
+            });
+            if (_stopping)
+                break;
+        }
+    }
+
+    tlsJobSystem = nullptr;
+}
+
+    }  /* namespace ove */
+}  /* namespace cinek */
@@ -0,0 +1,270 @@
+//
+//  JobSystem.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/6/16.
+//
+//
+
+#ifndef Overview_JobSystem_hpp
+#define Overview_JobSystem_hpp
+
+#include "Engine/EngineTypes.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  @class  JobSystem
+ *  @brief  Runs jobs across a fixed pool of worker threads.
+ *
+ *  Unlike the TaskScheduler, which runs cooperative tasks on the main thread,
+ *  jobs are short-lived functions executed in parallel.  Each thread owns a
+ *  job queue - jobs are pushed to and popped from the back of the running
+ *  thread's queue, and idle threads steal from the front of other threads'
+ *  queues.
+ *
+ *  Completion is tracked by Counters.  A job's counter is incremented when
+ *  the job is queued and decremented when it finishes.  Jobs can depend on
+ *  a counter, in which case they're held outside of the queues until that
+ *  counter reaches zero, so idle workers sleep rather than poll deferred
+ *  jobs.  Threads waiting on a counter (see wait) run queued jobs while
+ *  waiting.
+ *
+ *  Jobs store their function inline (see Job), so queueing a job doesn't
+ *  allocate.
+ *
+ *  The thread creating the JobSystem participates as queue 0.  Other
+ *  threads that aren't workers also use queue 0.
+ */
+class JobSystem
+{
+    CK_CLASS_NON_COPYABLE(JobSystem);
+
+public:
+    struct InitParams
+    {
+        /** Number of worker threads (not including the calling thread.)
+         *  If zero, jobs run only on threads waiting on counters. */
+        uint32_t workerCount;
+    };
+
+    /**
+     *  @class  Job
+     *  @brief  A move-only function object with fixed inline storage.
+     *
+     *  Functions must fit within kStorageSize bytes - jobs should capture
+     *  pointers to their data rather than the data itself.
+     */
+    class Job
+    {
+    public:
+        enum { kStorageSize = 48 };
+
+        Job() : _invoke(nullptr), _relocate(nullptr) {}
+        template<typename Fn,
+                 typename = typename std::enable_if<
+                    !std::is_same<typename std::decay<Fn>::type, Job>::value
+                 >::type>
+        Job(Fn&& fn);
+        Job(Job&& other) noexcept;
+        Job& operator=(Job&& other) noexcept;
+        ~Job();
+
+        explicit operator bool() const { return _invoke != nullptr; }
+        void operator()() { _invoke(&_storage); }
+
+    private:
+        using InvokeFn = void (*)(void* fn);
+        //  moves the function at src into dest (if not null), and destroys
+        //  the function at src
+        using RelocateFn = void (*)(void* dest, void* src);
+
+        template<typename Fn> static void invokeFn(void* fn);
+        template<typename Fn> static void relocateFn(void* dest, void* src);
+
+        void reset();
+
+        typename std::aligned_storage<kStorageSize,
+                                      alignof(std::max_align_t)>::type _storage;
+        InvokeFn _invoke;
+        RelocateFn _relocate;
+    };
+
+    class Counter
+    {
+        CK_CLASS_NON_COPYABLE(Counter);
+
+    public:
+        Counter() : _value(0) {}
+        bool done() const { return _value.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+        std::atomic<uint32_t> _value;
+    };
+
+    /**
+     *  @return The number of worker threads suited to this machine, leaving
+     *          one hardware thread for the caller.
+     */
+    static uint32_t defaultWorkerCount();
+
+    JobSystem(const InitParams& params);
+    ~JobSystem();
+
+    /**
+     *  Queues a job on the calling thread's queue.
+     *
+     *  @param  job         The job to run
+     *  @param  counter     (Optional) Counter tracking the job's completion.
+     *                      Must outlive the job.
+     *  @param  dependency  (Optional) The job is deferred until this counter
+     *                      reaches zero.  Must outlive the job.  Jobs the
+     *                      dependency tracks should be queued first.  The
+     *                      deferred job is queued by the thread finishing
+     *                      the dependency's last job.
+     */
+    void run(Job job, Counter* counter=nullptr,
+             const Counter* dependency=nullptr);
+    /**
+     *  Runs queued jobs on the calling thread until the counter reaches zero.
+     *
+     *  @param  counter     The counter to wait on
+     */
+    void wait(const Counter& counter);
+    /**
+     *  Invokes fn(index) for every index within [begin, end), split into
+     *  jobs of up to grainSize indices.  Returns when all indices have been
+     *  processed.
+     *
+     *  @param  begin       First index
+     *  @param  end         One past the last index
+     *  @param  grainSize   Indices per job
+     *  @param  fn          The function to run per index
+     */
+    template<typename Fn>
+    void parallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, Fn&& fn);
+    /**
+     *  @return The number of worker threads
+     */
+    uint32_t workerCount() const { return (uint32_t)_workers.size(); }
+    /**
+     *  @return Total threads that run jobs (workers plus the caller)
+     */
+    uint32_t threadCount() const { return (uint32_t)_queues.size(); }
+
+private:
+    struct QueuedJob
+    {
+        Job job;
+        Counter* counter;
+        const Counter* dependency;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<QueuedJob> jobs;
+    };
+
+    uint32_t queueIndex() const;
+    void pushJob(uint32_t queueIndex, QueuedJob&& job);
+    bool popJob(uint32_t queueIndex, QueuedJob& job);
+    bool stealJob(uint32_t queueIndex, QueuedJob& job);
+    //  returns false if no job was run
+    bool runOneJob(uint32_t queueIndex);
+    //  queues deferred jobs whose dependencies are done
+    void releaseDeferredJobs(uint32_t queueIndex);
+    void wakeWorker();
+    void workerMain(uint32_t queueIndex);
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _workers;
+
+    //  runnable jobs only.  workers sleep while this is zero
+    std::atomic<uint32_t> _queuedCount;
+
+    std::mutex _deferredMutex;
+    std::vector<QueuedJob> _deferredJobs;
+    std::atomic<uint32_t> _deferredCount;
+
+    std::mutex _sleepMutex;
+    std::condition_variable _wakeCondition;
+    bool _stopping;
+};
+
+template<typename Fn, typename>
+JobSystem::Job::Job(Fn&& fn) :
+    _invoke(&invokeFn<typename std::decay<Fn>::type>),
+    _relocate(&relocateFn<typename std::decay<Fn>::type>)
+{
+    using Function = typename std::decay<Fn>::type;
+    static_assert(sizeof(Function) <= kStorageSize,
+                  "Job function is too large - capture pointers instead");
+    static_assert(alignof(Function) <= alignof(std::max_align_t),
+                  "Job function alignment is unsupported");
+
+    ::new(&_storage) Function(std::forward<Fn>(fn));
+}
+
+template<typename Fn>
+void JobSystem::Job::invokeFn(void* fn)
+{
+    (*reinterpret_cast<Fn*>(fn))();
+}
+
+template<typename Fn>
+void JobSystem::Job::relocateFn(void* dest, void* src)
+{
+    Fn* srcFn = reinterpret_cast<Fn*>(src);
+    if (dest) {
+        ::new(dest) Fn(std::move(*srcFn));
+    }
+    srcFn->~Fn();
+}
+
+template<typename Fn>
+void JobSystem::parallelFor
+(
+    uint32_t begin,
+    uint32_t end,
+    uint32_t grainSize,
+    Fn&& fn
+)
+{
+    if (begin >= end)
+        return;
+    if (grainSize == 0)
+        grainSize = 1;
+
+    Counter counter;
+    for (uint32_t first = begin; first < end; ) {
+        uint32_t last = (end - first > grainSize) ? first + grainSize : end;
+        run([&fn, first, last]() {
+                for (uint32_t i = first; i < last; ++i) {
+                    fn(i);
+                }
+            },
+            &counter);
+        first = last;
+    }
+    wait(counter);
+}
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#endif /* Overview_JobSystem_hpp */
@@ -0,0 +1,213 @@
+//
+//  MappedFile.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 3/28/16.
+//
+//
+
+#include "MappedFile.hpp"
+#include "Debug.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace cinek {
+    namespace ove {
+
+MappedFile::MappedFile() :
+    _data(nullptr),
+    _size(0),
+    _writable(false),
+    _mapping(nullptr),
+    _mappingSize(0)
+{
+}
+
+MappedFile::MappedFile(const char* path, Access access) :
+    MappedFile()
+{
+    map(path, access, 0, 0);
+}
+
+MappedFile::MappedFile
+(
+    const char* path,
+    Access access,
+    uint32_t offset,
+    uint32_t size
+) :
+    MappedFile()
+{
+    CK_ASSERT_RETURN(size > 0);
+    map(path, access, offset, size);
+}
+
+//  size of zero maps from offset to the end of the file
+void MappedFile::map
+(
+    const char* path,
+    Access access,
+    uint32_t offset,
+    uint32_t size
+)
+{
+    const bool writable = access == Access::kCopyOnWrite;
+    uint64_t fileSize = 0;
+    uint32_t alignment = 0;
+
+#ifdef _WIN32
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    alignment = systemInfo.dwAllocationGranularity;
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER fileSizeInfo;
+    if (GetFileSizeEx(file, &fileSizeInfo) && fileSizeInfo.QuadPart > 0) {
+        fileSize = (uint64_t)fileSizeInfo.QuadPart;
+    }
+#else
+    alignment = (uint32_t)::sysconf(_SC_PAGESIZE);
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    if (!::fstat(fd, &st) && st.st_size > 0) {
+        fileSize = (uint64_t)st.st_size;
+    }
+#endif
+
+    if (!size && offset < fileSize) {
+        size = fileSize - offset <= UINT32_MAX ?
+                (uint32_t)(fileSize - offset) : 0;
+    }
+
+    //  mappings must start on the platform's boundary, so map from the
+    //  boundary preceding the region
+    const uint32_t mappingOffset = offset - (offset % alignment);
+    const size_t mappingSize = (size_t)(offset - mappingOffset) + size;
+
+    if (size && (uint64_t)offset + size <= fileSize) {
+#ifdef _WIN32
+        HANDLE fileMapping = CreateFileMappingA(file, NULL,
+                                writable ? PAGE_WRITECOPY : PAGE_READONLY,
+                                0, 0, NULL);
+        if (fileMapping) {
+            _mapping = MapViewOfFile(fileMapping,
+                                     writable ? FILE_MAP_COPY : FILE_MAP_READ,
+                                     0, mappingOffset, mappingSize);
+            CloseHandle(fileMapping);
+        }
+#else
+        void* mapping = ::mmap(nullptr, mappingSize,
+                               writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                               MAP_PRIVATE, fd, (off_t)mappingOffset);
+        if (mapping != MAP_FAILED) {
+            _mapping = mapping;
+            ::madvise(_mapping, mappingSize, MADV_WILLNEED);
+        }
+#endif
+    }
+
+#ifdef _WIN32
+    CloseHandle(file);
+#else
+    ::close(fd);
+#endif
+
+    if (_mapping) {
+        _mappingSize = mappingSize;
+        _data = reinterpret_cast<const uint8_t*>(_mapping) + (offset - mappingOffset);
+        _size = size;
+        _writable = writable;
+    }
+}
+
+MappedFile::MappedFile
+(
+    std::shared_ptr<MappedFile> parent,
+    uint32_t offset,
+    uint32_t size
+) :
+    MappedFile()
+{
+    CK_ASSERT_RETURN(parent && *parent);
+    CK_ASSERT_RETURN(offset <= parent->size() && size <= parent->size() - offset);
+
+    _data = parent->data() + offset;
+    _size = size;
+    _parent = std::move(parent);
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) :
+    _data(other._data),
+    _size(other._size),
+    _writable(other._writable),
+    _mapping(other._mapping),
+    _mappingSize(other._mappingSize),
+    _parent(std::move(other._parent))
+{
+    other._data = nullptr;
+    other._size = 0;
+    other._writable = false;
+    other._mapping = nullptr;
+    other._mappingSize = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+    unmap();
+
+    _data = other._data;
+    _size = other._size;
+    _writable = other._writable;
+    _mapping = other._mapping;
+    _mappingSize = other._mappingSize;
+    _parent = std::move(other._parent);
+
+    other._data = nullptr;
+    other._size = 0;
+    other._writable = false;
+    other._mapping = nullptr;
+    other._mappingSize = 0;
+
+    return *this;
+}
+
+void MappedFile::unmap()
+{
+    if (_mapping) {
+#ifdef _WIN32
+        UnmapViewOfFile(_mapping);
+#else
+        ::munmap(_mapping, _mappingSize);
+#endif
+        _mapping = nullptr;
+        _mappingSize = 0;
+    }
+    _parent = nullptr;
+    _data = nullptr;
+    _size = 0;
+    _writable = false;
+}
+
+    }  /* namespace ove */
+}  /* namespace cinek */
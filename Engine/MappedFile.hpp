@@ -0,0 +1,106 @@
+//
+//  MappedFile.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 3/28/16.
+//
+//
+
+#ifndef Overview_MappedFile_hpp
+#define Overview_MappedFile_hpp
+
+#include "EngineTypes.hpp"
+
+#include <memory>
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  @class  MappedFile
+ *  @brief  A memory mapping of a file (or a region of one.)
+ *
+ *  Parsers can work on the mapped pages directly, avoiding the heap copy made
+ *  by the streaming LoadFile path.  Copy-on-write mappings are private to the
+ *  process and writable, so that in situ parsers can modify them without
+ *  touching the file - only the pages written to are copied.
+ *
+ *  A MappedFile may also reference a region within another mapping (i.e. an
+ *  entry in an AssetArchive), in which case the parent mapping is kept alive
+ *  for the lifetime of the region.
+ */
+class MappedFile
+{
+    CK_CLASS_NON_COPYABLE(MappedFile);
+
+public:
+    enum class Access
+    {
+        kReadOnly,
+        kCopyOnWrite
+    };
+
+    MappedFile();
+    /**
+     *  Maps the file at the specified path.  On failure the object evaluates
+     *  to false.
+     *
+     *  @param  path    The file to map
+     *  @param  access  Whether pages are read-only or copy-on-write
+     */
+    explicit MappedFile(const char* path, Access access=Access::kReadOnly);
+    /**
+     *  Maps a region of the file at the specified path.  On failure the
+     *  object evaluates to false.
+     *
+     *  @param  path    The file to map
+     *  @param  access  Whether pages are read-only or copy-on-write
+     *  @param  offset  Offset in bytes from the start of the file
+     *  @param  size    Size in bytes of the region
+     */
+    MappedFile(const char* path, Access access, uint32_t offset,
+               uint32_t size);
+    /**
+     *  Creates a view into a region of a parent mapping
+     *
+     *  @param  parent  The mapping containing the region
+     *  @param  offset  Offset in bytes from the start of the parent
+     *  @param  size    Size in bytes of the region
+     */
+    MappedFile(std::shared_ptr<MappedFile> parent, uint32_t offset,
+               uint32_t size);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+
+    explicit operator bool() const { return _data != nullptr; }
+
+    const uint8_t* data() const { return _data; }
+    /**
+     *  @return The mapped bytes if the mapping is copy-on-write, else null
+     */
+    uint8_t* writableData() const {
+        return _writable ? const_cast<uint8_t*>(_data) : nullptr;
+    }
+    uint32_t size() const { return _size; }
+
+private:
+    void map(const char* path, Access access, uint32_t offset, uint32_t size);
+    void unmap();
+
+    const uint8_t* _data;
+    uint32_t _size;
+    bool _writable;
+
+    //  platform mapping - null if this object is a view into _parent
+    void* _mapping;
+    size_t _mappingSize;
+
+    std::shared_ptr<MappedFile> _parent;
+};
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#endif /* Overview_MappedFile_hpp */
@@ -0,0 +1,605 @@
+//
+//  MemoryTracker.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#include "MemoryTracker.hpp"
+#include "Debug.hpp"
+
+#include "Engine/Contrib/Recast/DetourAlloc.h"
+#include "Engine/Contrib/Recast/RecastAlloc.h"
+
+#include <bullet/LinearMath/btAlignedAllocator.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace cinek {
+    namespace ove {
+
+static const char* kMemoryTagNames[kMemoryTagCount] = {
+    "General",
+    "Gfx",
+    "Render",
+    "Scene",
+    "Nav",
+    "Entity",
+    "Pathfinder"
+};
+
+const char* memoryTagName(MemoryTag tag)
+{
+    return tag < kMemoryTagCount ? kMemoryTagNames[tag] : "Unknown";
+}
+
+static thread_local MemoryTag tlsMemoryTag = kMemoryTagGeneral;
+
+//  heap statistics as of the last endFrame.  main thread only
+static MemoryTracker::HeapStats s_heapStats[kMemoryTagCount];
+
+#if OVE_MEMORY_TRACKING
+
+//  per-tag heap counters, cumulative over the life of the process.
+//  frees are counted by the freeing thread, so a thread's currentBytes may
+//  go negative - only the sum over all threads is meaningful
+struct HeapCounters
+{
+    std::atomic<int64_t> currentBytes;
+    std::atomic<uint64_t> allocCount;
+    std::atomic<uint64_t> allocBytes;
+};
+
+//  a thread's counters.  written by the owning thread only, and read by
+//  endFrame.  blocks are never freed - a block released by an exiting
+//  thread is reused by the next thread that needs one, keeping its counts
+struct HeapBlock
+{
+    HeapCounters counters[kMemoryTagCount];
+    HeapBlock* next;
+    std::atomic<bool> inUse;
+};
+
+//  all blocks ever created, pushed to the head
+static std::atomic<HeapBlock*> s_heapBlocks(nullptr);
+
+//  counts for threads without a block of their own (i.e. an exiting
+//  thread's final frees.)  updated from any thread.  zero initialized before
+//  any dynamic initialization, so allocations made by static constructors
+//  are counted
+static HeapBlock s_sharedHeapBlock;
+
+static thread_local HeapBlock* tlsHeapBlock = nullptr;
+static thread_local bool tlsHeapBlockReleased = false;
+
+static HeapBlock* acquireHeapBlock()
+{
+    for (HeapBlock* block = s_heapBlocks.load(std::memory_order_acquire);
+         block;
+         block = block->next) {
+        bool inUse = false;
+        if (!block->inUse.load(std::memory_order_relaxed) &&
+            block->inUse.compare_exchange_strong(inUse, true,
+                std::memory_order_acquire)) {
+            return block;
+        }
+    }
+
+    //  calloc rather than new, which would recurse into the tracker
+    auto block = reinterpret_cast<HeapBlock*>(calloc(1, sizeof(HeapBlock)));
+    if (!block)
+        return nullptr;
+    block->inUse.store(true, std::memory_order_relaxed);
+    block->next = s_heapBlocks.load(std::memory_order_relaxed);
+    while (!s_heapBlocks.compare_exchange_weak(block->next, block,
+                std::memory_order_release,
+                std::memory_order_relaxed)) {
+    }
+    return block;
+}
+
+//  returns the thread's block to the free list on thread exit
+struct HeapBlockOwner
+{
+    HeapBlock* block = nullptr;
+
+    ~HeapBlockOwner()
+    {
+        tlsHeapBlock = nullptr;
+        tlsHeapBlockReleased = true;
+        if (block) {
+            block->inUse.store(false, std::memory_order_release);
+        }
+    }
+};
+
+static thread_local HeapBlockOwner tlsHeapBlockOwner;
+
+static HeapBlock* threadHeapBlock()
+{
+    HeapBlock* block = tlsHeapBlock;
+    if (block || tlsHeapBlockReleased)
+        return block;
+
+    block = acquireHeapBlock();
+    tlsHeapBlockOwner.block = block;
+    tlsHeapBlock = block;
+    return block;
+}
+
+//  the owning thread is the only writer, so a block's counters need no
+//  read-modify-write.  the shared block's do
+template<typename T>
+static void addToCounter(std::atomic<T>& counter, T value, bool owned)
+{
+    if (owned) {
+        counter.store(counter.load(std::memory_order_relaxed) + value,
+                      std::memory_order_relaxed);
+    }
+    else {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+}
+
+static void countAlloc(size_t size, MemoryTag tag)
+{
+    HeapBlock* block = threadHeapBlock();
+    const bool owned = block != nullptr;
+    HeapCounters& counters = (owned ? block : &s_sharedHeapBlock)->counters[tag];
+    addToCounter<int64_t>(counters.currentBytes, (int64_t)size, owned);
+    addToCounter<uint64_t>(counters.allocCount, 1, owned);
+    addToCounter<uint64_t>(counters.allocBytes, size, owned);
+}
+
+static void countFree(size_t size, MemoryTag tag)
+{
+    HeapBlock* block = threadHeapBlock();
+    const bool owned = block != nullptr;
+    HeapCounters& counters = (owned ? block : &s_sharedHeapBlock)->counters[tag];
+    addToCounter<int64_t>(counters.currentBytes, -(int64_t)size, owned);
+}
+
+//  prefixes each allocation.  sized to preserve the alignment malloc
+//  guarantees.  over-aligned allocations pad ahead of the header, and
+//  offset locates the start of the malloc'd block
+struct alignas(16) AllocationHeader
+{
+    size_t size;
+    uint32_t tag;
+    uint32_t offset;
+};
+
+static void* trackedAlloc(size_t size, size_t alignment, MemoryTag tag)
+{
+    const size_t padding = alignment > alignof(AllocationHeader)
+        ? alignment - alignof(AllocationHeader) : 0;
+    void* block = malloc(sizeof(AllocationHeader) + padding + size);
+    if (!block)
+        return nullptr;
+
+    uintptr_t p = reinterpret_cast<uintptr_t>(block) + sizeof(AllocationHeader);
+    if (padding) {
+        p = (p + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+
+    auto header = reinterpret_cast<AllocationHeader*>(p) - 1;
+    header->size = size;
+    header->tag = tag;
+    header->offset = (uint32_t)(p - reinterpret_cast<uintptr_t>(block));
+
+    countAlloc(size, tag);
+
+    return reinterpret_cast<void*>(p);
+}
+
+static void* trackedAlloc(size_t size, MemoryTag tag)
+{
+    return trackedAlloc(size, alignof(AllocationHeader), tag);
+}
+
+static void trackedFree(void* p)
+{
+    if (!p)
+        return;
+
+    auto header = reinterpret_cast<AllocationHeader*>(p) - 1;
+    countFree(header->size, (MemoryTag)header->tag);
+    free(reinterpret_cast<uint8_t*>(p) - header->offset);
+}
+
+static void* trackedAlloc(size_t size)
+{
+    return trackedAlloc(size, tlsMemoryTag);
+}
+
+#if defined(__cpp_aligned_new)
+static void* trackedAlignedAlloc(size_t size, size_t alignment)
+{
+    return trackedAlloc(size, alignment, tlsMemoryTag);
+}
+#endif
+
+//  Bullet, Detour and Recast allocate through their own hooks rather than
+//  operator new.  Each library has a single owning subsystem, so its
+//  allocations are accounted to that subsystem regardless of scope.
+static void* bulletAlloc(size_t size)
+{
+    return trackedAlloc(size, kMemoryTagScene);
+}
+
+static void* detourAlloc(size_t size, dtAllocHint )
+{
+    return trackedAlloc(size, kMemoryTagPathfinder);
+}
+
+static void* recastAlloc(size_t size, rcAllocHint )
+{
+    return trackedAlloc(size, kMemoryTagPathfinder);
+}
+
+//  installed during static initialization, as with the global allocation
+//  functions, so that no library allocation predates the hooks
+static struct LibraryAllocators
+{
+    LibraryAllocators()
+    {
+        btAlignedAllocSetCustom(&bulletAlloc, &trackedFree);
+        dtAllocSetCustom(&detourAlloc, &trackedFree);
+        rcAllocSetCustom(&recastAlloc, &trackedFree);
+    }
+} s_libraryAllocators;
+
+#endif  /* OVE_MEMORY_TRACKING */
+
+////////////////////////////////////////////////////////////////////////////////
+
+MemoryTagScope::MemoryTagScope(MemoryTag tag) :
+    _prevTag(MemoryTracker::currentTag())
+{
+    MemoryTracker::setCurrentTag(tag);
+}
+
+MemoryTagScope::~MemoryTagScope()
+{
+    MemoryTracker::setCurrentTag(_prevTag);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+PoolCounter::PoolCounter
+(
+    const char* name,
+    MemoryTag tag,
+    uint32_t capacity
+) :
+    _tag(tag),
+    _capacity(capacity),
+    _used(0),
+    _highWater(0),
+    _acquires(0),
+    _exhausted(0),
+    _frameAcquires(0)
+{
+    strncpy(_name, name, sizeof(_name) - 1);
+    _name[sizeof(_name) - 1] = 0;
+    MemoryTracker::registerPool(this);
+}
+
+PoolCounter::~PoolCounter()
+{
+    MemoryTracker::unregisterPool(this);
+}
+
+void PoolCounter::acquired()
+{
+    const uint32_t used = _used.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint32_t highWater = _highWater.load(std::memory_order_relaxed);
+    while (used > highWater &&
+           !_highWater.compare_exchange_weak(highWater, used,
+                std::memory_order_relaxed)) {
+    }
+    _acquires.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PoolCounter::released()
+{
+    _used.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void PoolCounter::exhausted()
+{
+    if (_exhausted.fetch_add(1, std::memory_order_relaxed) == 0) {
+        OVENGINE_LOG_WARN("%s pool (%s) exhausted with %u objects in use\n",
+                          _name, memoryTagName(_tag),
+                          _used.load(std::memory_order_relaxed));
+    }
+}
+
+void PoolCounter::setUsed(uint32_t used)
+{
+    const uint32_t prevUsed = _used.exchange(used, std::memory_order_relaxed);
+    if (used > prevUsed) {
+        _acquires.fetch_add(used - prevUsed, std::memory_order_relaxed);
+    }
+    if (used > _highWater.load(std::memory_order_relaxed)) {
+        _highWater.store(used, std::memory_order_relaxed);
+    }
+}
+
+auto PoolCounter::stats() const -> Stats
+{
+    Stats stats;
+    stats.name = _name;
+    stats.tag = _tag;
+    stats.capacity = _capacity;
+    stats.used = _used.load(std::memory_order_relaxed);
+    stats.highWater = _highWater.load(std::memory_order_relaxed);
+    stats.frameAcquires = _frameAcquires;
+    stats.exhaustedCount = _exhausted.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void PoolCounter::endFrame()
+{
+    _frameAcquires = _acquires.exchange(0, std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct PoolRegistry
+{
+    std::mutex mutex;
+    std::vector<PoolCounter*> counters;
+};
+
+//  never destroyed, since counters owned by static objects may unregister
+//  after static destruction begins
+static PoolRegistry& poolRegistry()
+{
+    static PoolRegistry* registry = new PoolRegistry;
+    return *registry;
+}
+
+MemoryTag MemoryTracker::currentTag()
+{
+    return tlsMemoryTag;
+}
+
+void MemoryTracker::setCurrentTag(MemoryTag tag)
+{
+    tlsMemoryTag = tag;
+}
+
+bool MemoryTracker::heapTracking()
+{
+    return OVE_MEMORY_TRACKING != 0;
+}
+
+auto MemoryTracker::heapStats(MemoryTag tag) -> HeapStats
+{
+    return s_heapStats[tag];
+}
+
+auto MemoryTracker::heapTotals() -> HeapStats
+{
+    HeapStats totals = { 0, 0, 0, 0, 0, 0 };
+    for (int tag = 0; tag < kMemoryTagCount; ++tag) {
+        HeapStats stats = heapStats((MemoryTag)tag);
+        totals.currentBytes += stats.currentBytes;
+        //  sum of per-tag peaks, an upper bound of the actual peak
+        totals.highWaterBytes += stats.highWaterBytes;
+        totals.allocCount += stats.allocCount;
+        totals.allocBytes += stats.allocBytes;
+        totals.frameAllocCount += stats.frameAllocCount;
+        totals.frameAllocBytes += stats.frameAllocBytes;
+    }
+    return totals;
+}
+
+#if OVE_MEMORY_TRACKING
+static void sumHeapCounters(MemoryTracker::HeapStats* sums, const HeapBlock& block)
+{
+    for (int tag = 0; tag < kMemoryTagCount; ++tag) {
+        const HeapCounters& counters = block.counters[tag];
+        sums[tag].currentBytes += counters.currentBytes.load(std::memory_order_relaxed);
+        sums[tag].allocCount += counters.allocCount.load(std::memory_order_relaxed);
+        sums[tag].allocBytes += counters.allocBytes.load(std::memory_order_relaxed);
+    }
+}
+#endif
+
+void MemoryTracker::endFrame()
+{
+#if OVE_MEMORY_TRACKING
+    HeapStats sums[kMemoryTagCount] = {};
+    sumHeapCounters(sums, s_sharedHeapBlock);
+    for (HeapBlock* block = s_heapBlocks.load(std::memory_order_acquire);
+         block;
+         block = block->next) {
+        sumHeapCounters(sums, *block);
+    }
+
+    for (int tag = 0; tag < kMemoryTagCount; ++tag) {
+        HeapStats& stats = s_heapStats[tag];
+        const HeapStats& sum = sums[tag];
+        stats.frameAllocCount = (uint32_t)(sum.allocCount - stats.allocCount);
+        stats.frameAllocBytes = sum.allocBytes - stats.allocBytes;
+        stats.currentBytes = sum.currentBytes;
+        stats.highWaterBytes = std::max(stats.highWaterBytes, sum.currentBytes);
+        stats.allocCount = sum.allocCount;
+        stats.allocBytes = sum.allocBytes;
+    }
+#endif
+
+    PoolRegistry& registry = poolRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto counter : registry.counters) {
+        counter->endFrame();
+    }
+}
+
+void MemoryTracker::enumeratePools
+(
+    const std::function<void(const PoolCounter::Stats&)>& fn
+)
+{
+    PoolRegistry& registry = poolRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto counter : registry.counters) {
+        fn(counter->stats());
+    }
+}
+
+void MemoryTracker::registerPool(PoolCounter* counter)
+{
+    PoolRegistry& registry = poolRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.counters.push_back(counter);
+}
+
+void MemoryTracker::unregisterPool(PoolCounter* counter)
+{
+    PoolRegistry& registry = poolRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = std::find(registry.counters.begin(), registry.counters.end(), counter);
+    if (it != registry.counters.end()) {
+        registry.counters.erase(it);
+    }
+}
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#if OVE_MEMORY_TRACKING
+
+////////////////////////////////////////////////////////////////////////////////
+//  replaces the global allocation functions
+
+void* operator new(size_t size)
+{
+    void* p = cinek::ove::trackedAlloc(size);
+    //  built without exceptions
+    if (!p)
+        abort();
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    void* p = cinek::ove::trackedAlloc(size);
+    //  built without exceptions
+    if (!p)
+        abort();
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return cinek::ove::trackedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return cinek::ove::trackedAlloc(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    cinek::ove::trackedFree(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    cinek::ove::trackedFree(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    cinek::ove::trackedFree(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    cinek::ove::trackedFree(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    cinek::ove::trackedFree(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    cinek::ove::trackedFree(p);
+}
+
+#if defined(__cpp_aligned_new)
+//  over-aligned types allocate through these in C++17 and later.  without
+//  them, the standard library's versions would allocate outside the tracker
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    void* p = cinek::ove::trackedAlignedAlloc(size, (size_t)alignment);
+    //  built without exceptions
+    if (!p)
+        abort();
+    return p;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    void* p = cinek::ove::trackedAlignedAlloc(size, (size_t)alignment);
+    //  built without exceptions
+    if (!p)
+        abort();
+    return p;
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return cinek::ove::trackedAlignedAlloc(size, (size_t)alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return cinek::ove::trackedAlignedAlloc(size, (size_t)alignment);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    cinek::ove::trackedFree(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    cinek::ove::trackedFree(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    cinek::ove::trackedFree(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+    cinek::ove::trackedFree(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    cinek::ove::trackedFree(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    cinek::ove::trackedFree(p);
+}
+#endif
+
+#endif  /* OVE_MEMORY_TRACKING */
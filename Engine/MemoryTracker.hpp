@@ -0,0 +1,215 @@
+//
+//  MemoryTracker.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#ifndef Overview_MemoryTracker_hpp
+#define Overview_MemoryTracker_hpp
+
+#include "Engine/EngineTypes.hpp"
+
+#include <atomic>
+#include <functional>
+
+/**
+ *  Heap accounting replaces the global operator new and delete, so it is
+ *  opt-in.  Define OVE_MEMORY_TRACKING as 1 to enable it (the Debug
+ *  configurations do.)  Pool counters and memory tags are always available.
+ */
+#ifndef OVE_MEMORY_TRACKING
+#define OVE_MEMORY_TRACKING 0
+#endif
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  Subsystems that heap allocations and pools are accounted to.  Heap
+ *  allocations are accounted to the calling thread's current tag (see
+ *  MemoryTagScope.)
+ */
+enum MemoryTag
+{
+    kMemoryTagGeneral,
+    kMemoryTagGfx,
+    kMemoryTagRender,
+    kMemoryTagScene,
+    kMemoryTagNav,
+    kMemoryTagEntity,
+    kMemoryTagPathfinder,
+    kMemoryTagCount
+};
+
+/**
+ *  @param  tag     The tag
+ *  @return The tag's display name
+ */
+const char* memoryTagName(MemoryTag tag);
+
+/**
+ *  @class  MemoryTagScope
+ *  @brief  Sets the calling thread's memory tag for the enclosing scope.
+ *
+ *  Use OVENGINE_MEMORY_TAG.  Scopes nest - the prior tag is restored when
+ *  the scope exits.
+ */
+class MemoryTagScope
+{
+    CK_CLASS_NON_COPYABLE(MemoryTagScope);
+
+public:
+    MemoryTagScope(MemoryTag tag);
+    ~MemoryTagScope();
+
+private:
+    MemoryTag _prevTag;
+};
+
+#define OVENGINE_MEMORY_TAG_CONCAT2(_a_, _b_) _a_##_b_
+#define OVENGINE_MEMORY_TAG_CONCAT(_a_, _b_) OVENGINE_MEMORY_TAG_CONCAT2(_a_, _b_)
+
+#define OVENGINE_MEMORY_TAG(_tag_) \
+    ::cinek::ove::MemoryTagScope OVENGINE_MEMORY_TAG_CONCAT(_ovMemTag, __LINE__)(_tag_)
+
+/**
+ *  @class  PoolCounter
+ *  @brief  Tracks occupancy of a fixed size pool.
+ *
+ *  Counters register themselves with the MemoryTracker on construction.
+ *  Owners either report each acquire and release, or (for pools whose
+ *  objects are freed outside of the owner's control) set the used count
+ *  directly.
+ */
+class PoolCounter
+{
+    CK_CLASS_NON_COPYABLE(PoolCounter);
+
+public:
+    struct Stats
+    {
+        /** Valid while the counter exists */
+        const char* name;
+        MemoryTag tag;
+        uint32_t capacity;
+        uint32_t used;
+        uint32_t highWater;
+        /** Acquires over the last completed frame */
+        uint32_t frameAcquires;
+        /** Acquires that failed because the pool was full */
+        uint32_t exhaustedCount;
+    };
+
+    /**
+     *  @param  name        The pool's display name (copied)
+     *  @param  tag         The subsystem owning the pool
+     *  @param  capacity    The pool's object limit, or 0 if the limit isn't
+     *                      known to the owner
+     */
+    PoolCounter(const char* name, MemoryTag tag, uint32_t capacity);
+    ~PoolCounter();
+
+    void acquired();
+    void released();
+    /**
+     *  Records a failed acquire.  The first failure is logged.
+     */
+    void exhausted();
+    /**
+     *  @param  used        The number of objects in use
+     */
+    void setUsed(uint32_t used);
+
+    Stats stats() const;
+
+private:
+    friend class MemoryTracker;
+
+    void endFrame();
+
+    char _name[32];
+    MemoryTag _tag;
+    uint32_t _capacity;
+    std::atomic<uint32_t> _used;
+    std::atomic<uint32_t> _highWater;
+    std::atomic<uint32_t> _acquires;
+    std::atomic<uint32_t> _exhausted;
+    uint32_t _frameAcquires;
+};
+
+/**
+ *  @class  MemoryTracker
+ *  @brief  Accounts heap allocations and pool occupancy by subsystem.
+ *
+ *  When built with OVE_MEMORY_TRACKING, the engine replaces the global
+ *  operator new and delete (including the aligned forms), and installs
+ *  allocation hooks for Bullet (accounted to Scene) and Detour and Recast
+ *  (accounted to Pathfinder.)  Each allocation carries a small header
+ *  recording its size and the tag that was current when it was made, so
+ *  frees are accounted to the allocating subsystem regardless of the thread
+ *  or scope that frees them.
+ *
+ *  Each thread counts into its own block of counters, which endFrame sums.
+ *  Heap statistics are as of the last endFrame - per-frame counts cover the
+ *  interval between calls to endFrame, and peaks are sampled once per frame.
+ */
+class MemoryTracker
+{
+public:
+    struct HeapStats
+    {
+        int64_t currentBytes;
+        int64_t highWaterBytes;
+        uint64_t allocCount;
+        uint64_t allocBytes;
+        /** Allocations made over the last completed frame */
+        uint32_t frameAllocCount;
+        uint64_t frameAllocBytes;
+    };
+
+    /**
+     *  @return True if built with OVE_MEMORY_TRACKING.  Otherwise heap
+     *          statistics are always zero
+     */
+    static bool heapTracking();
+    /**
+     *  @param  tag     The subsystem tag
+     *  @return Heap statistics for the tag.  Main thread only
+     */
+    static HeapStats heapStats(MemoryTag tag);
+    /**
+     *  @return Heap statistics summed over all tags.  Main thread only
+     */
+    static HeapStats heapTotals();
+    /**
+     *  Sums the threads' heap counters into the heap statistics, and rolls
+     *  the current frame's allocation and pool acquire counts into the
+     *  per-frame statistics.  Call once per frame from the main thread.
+     */
+    static void endFrame();
+    /**
+     *  Invokes a delegate for every registered pool counter.
+     *
+     *  @param  fn      Called with each pool's statistics
+     */
+    static void enumeratePools(const std::function<void(const PoolCounter::Stats&)>& fn);
+    /**
+     *  @return The calling thread's memory tag
+     */
+    static MemoryTag currentTag();
+
+private:
+    friend class MemoryTagScope;
+    friend class PoolCounter;
+
+    static void setCurrentTag(MemoryTag tag);
+    static void registerPool(PoolCounter* counter);
+    static void unregisterPool(PoolCounter* counter);
+};
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#endif /* Overview_MemoryTracker_hpp */
@@ -20,7 +20,8 @@ namespace ove {
     
 NavPathQueryPool::NavPathQueryPool(const InitParams& initParams) :
     _mesh(initParams.navMesh),
-    _defaultQueryPool(initParams.numQueries)
+    _defaultQueryPool(initParams.numQueries),
+    _counter("Path Queries", kMemoryTagPathfinder, initParams.numQueries)
 {
     _defaultQueries.reserve(initParams.numQueries);
     
@@ -32,10 +33,14 @@ NavPathQueryPool::NavPathQueryPool(const InitParams& initParams) :
 
 NavPathQueryPtr NavPathQueryPool::acquire()
 {
-    CK_ASSERT_RETURN_VALUE(!_defaultQueries.empty(), nullptr);
+    if (_defaultQueries.empty()) {
+        _counter.exhausted();
+        return nullptr;
+    }
     
     NavPathQuery* query = _defaultQueries.back();
     _defaultQueries.pop_back();
+    _counter.acquired();
     return NavPathQueryPtr(query, NavPathQueryDeleter(this));
 }
 
@@ -44,6 +49,7 @@ void NavPathQueryPool::release(NavPathQuery* query)
     CK_ASSERT_RETURN(_defaultQueryPool.verify(query));
     
     _defaultQueries.emplace_back(query);
+    _counter.released();
 }
     
 } /* namespace ove */
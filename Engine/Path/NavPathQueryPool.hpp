@@ -10,6 +10,7 @@
 #define Overview_NavPathQueryPool_hpp
 
 #include "PathTypes.hpp"
+#include "Engine/MemoryTracker.hpp"
 
 #include <cinek/objectpool.hpp>
 
@@ -39,6 +40,7 @@ private:
     const NavMesh* _mesh;
     ObjectPool<NavPathQuery> _defaultQueryPool;
     std::vector<NavPathQuery*> _defaultQueries;
+    PoolCounter _counter;
 };
     
     } /* namespace ove */
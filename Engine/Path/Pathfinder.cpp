@@ -18,6 +18,10 @@
 #include "Tasks/GenerateNavPath.hpp"
 
 #include "Engine/Contrib/Recast/DetourNavMeshQuery.h"
+#include "Engine/Contrib/Recast/DetourAlloc.h"
+#include "Engine/Debug.hpp"
+#include "Engine/Profiler.hpp"
+#include "Engine/MemoryTracker.hpp"
 
 #include "Engine/Path/Tasks/GenerateRecastMesh.hpp"
 #include "Engine/Path/Tasks/GenerateNavMesh.hpp"
@@ -26,6 +30,7 @@
 #include "Engine/Physics/SceneMotionState.hpp"
 
 #include <cinek/taskscheduler.hpp>
+#include <cstring>
 #include <vector>
 
 namespace cinek {
@@ -116,6 +121,10 @@ class Pathfinder::Impl
     RecastMeshConfig _navMeshConfig;
     RecastMesh _recastMesh;
     NavMesh _navMesh;
+    //  incremented when _navMesh is replaced.  debug geometry is rebuilt
+    //  when it falls behind
+    uint32_t _navMeshRevision;
+    uint32_t _debugNavMeshRevision;
     
     //  query filter used by the main thread owning Pathfinder
     dtQueryFilter _dtDefaultQueryFilter;
@@ -257,7 +266,9 @@ private:
 public:
     Impl() :
         _scheduler(16),
-        _generateTaskId(0)
+        _generateTaskId(0),
+        _navMeshRevision(0),
+        _debugNavMeshRevision(0)
     {
         //  TODO - magic numbers! consolidate into an InitParams
         _tasks.reserve(32);
@@ -362,6 +373,7 @@ public:
                     if (endState == Task::State::kEnded) {
                         auto& thisTask = reinterpret_cast<GenerateNavMesh&>(task);
                         _navMesh = thisTask.acquireGeneratedMesh();
+                        ++_navMeshRevision;
                         
                         NavPathQueryPool::InitParams initParams;
                         initParams.navMesh = &_navMesh;
@@ -382,6 +394,60 @@ public:
         _generateTaskId = _scheduler.schedule(std::move(task), this);
     }
 
+    ////////////////////////////////////////////////////////////////////////////
+    //  Persists and restores the generated nav mesh.  Generated meshes are
+    //  single tile meshes (see GenerateNavMesh.)
+    //
+    bool saveNavMeshData(std::vector<uint8_t>& data) const
+    {
+        const dtNavMesh* mesh = _navMesh.detourMesh();
+        if (!mesh)
+            return false;
+        
+        const dtMeshTile* tile = mesh->getTile(0);
+        if (!tile || !tile->header || !tile->dataSize)
+            return false;
+        
+        data.assign(tile->data, tile->data + tile->dataSize);
+        return true;
+    }
+    
+    bool loadNavMeshData(const uint8_t* data, size_t size)
+    {
+        if (_generateTaskId) {
+            _scheduler.cancel(_generateTaskId);
+            signalGenerateComplete(false);
+        }
+        
+        //  the nav mesh takes ownership of a Detour allocated copy
+        auto navData = reinterpret_cast<unsigned char*>(dtAlloc((int)size, DT_ALLOC_PERM));
+        if (!navData)
+            return false;
+        memcpy(navData, data, size);
+        
+        auto navmesh = detour_nav_mesh_unique_ptr(dtAllocNavMesh());
+        if (!navmesh) {
+            dtFree(navData);
+            return false;
+        }
+        dtStatus status = navmesh->init(navData, (int)size, DT_TILE_FREE_DATA);
+        if (dtStatusFailed(status)) {
+            OVENGINE_LOG_ERROR("Pathfinder.loadNavMeshData - invalid nav mesh data\n");
+            dtFree(navData);
+            return false;
+        }
+        
+        _queryPool = nullptr;
+        _navMesh = NavMesh(std::move(navmesh));
+        ++_navMeshRevision;
+        
+        NavPathQueryPool::InitParams initParams;
+        initParams.navMesh = &_navMesh;
+        initParams.numQueries = 32;
+        _queryPool = allocate_unique<NavPathQueryPool>(initParams);
+        return true;
+    }
+
     ////////////////////////////////////////////////////////////////////////////
     //  instantiate a path query task
     //
@@ -451,7 +517,15 @@ public:
     //
     void updateDebug(PathfinderDebug& debugger)
     {
-        _navMesh.debugDraw(debugger);
+        //  the navmesh is static between loads, so its tessellation is
+        //  cached rather than rebuilt every frame
+        if (_debugNavMeshRevision != _navMeshRevision) {
+            debugger.beginCache();
+            _navMesh.debugDraw(debugger);
+            debugger.endCache();
+            _debugNavMeshRevision = _navMeshRevision;
+        }
+        debugger.drawCache();
     }
 };
 
@@ -472,6 +546,8 @@ void Pathfinder::cancelByListener(PathfinderListener* listener)
 
 void Pathfinder::simulate(CKTimeDelta dt)
 {
+    OVENGINE_PROFILE_ZONE("Pathfinder::simulate");
+    OVENGINE_MEMORY_TAG(kMemoryTagPathfinder);
     _impl->simulate(dt);
 }
 
@@ -481,9 +557,21 @@ void Pathfinder::generateFromScene
     GenerateCb callback
 )
 {
+    OVENGINE_MEMORY_TAG(kMemoryTagPathfinder);
     _impl->generateFromScene(scene, std::move(callback));
 }
 
+bool Pathfinder::saveNavMeshData(std::vector<uint8_t>& data) const
+{
+    return _impl->saveNavMeshData(data);
+}
+
+bool Pathfinder::loadNavMeshData(const uint8_t* data, size_t size)
+{
+    OVENGINE_MEMORY_TAG(kMemoryTagPathfinder);
+    return _impl->loadNavMeshData(data, size);
+}
+
 void Pathfinder::simulateDebug(PathfinderDebug& debugger)
 {
     _impl->updateDebug(debugger);
@@ -502,6 +590,7 @@ void Pathfinder::generatePath
     ckm::vector3 endPos
 )
 {
+    OVENGINE_MEMORY_TAG(kMemoryTagPathfinder);
     _impl->generatePath(listener, entity, startPos, endPos);
 }
     
@@ -13,6 +13,7 @@
 
 #include <cinek/allocator.hpp>
 #include <functional>
+#include <vector>
 
 namespace cinek {
     namespace ove {
@@ -30,6 +31,13 @@ public:
     using GenerateCb = std::function<void(bool)>;
     void generateFromScene(const Scene& scene, GenerateCb callback);
     
+    //  copies the generated Detour navigation mesh data for persistence.
+    //  returns false if there is no generated mesh
+    bool saveNavMeshData(std::vector<uint8_t>& data) const;
+    //  replaces the navigation mesh with previously saved data, bypassing
+    //  generation.
+    bool loadNavMeshData(const uint8_t* data, size_t size);
+    
     NavPathQueryPtr acquireQuery();
     
     //  sends a request to generate a path between two points.
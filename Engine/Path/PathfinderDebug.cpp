@@ -24,6 +24,8 @@ PathfinderDebug::PathfinderDebug(uint32_t primBufSize) :
     _tvblimit(0),
     _vindex(-1),
     _textureEnabled(false),
+    _caching(false),
+    _cacheVB(BGFX_INVALID_HANDLE),
     _programs(nullptr),
     _uniforms(nullptr),
     _camera(nullptr)
@@ -32,6 +34,9 @@ PathfinderDebug::PathfinderDebug(uint32_t primBufSize) :
 
 PathfinderDebug::~PathfinderDebug()
 {
+    if (bgfx::isValid(_cacheVB)) {
+        bgfx::destroyVertexBuffer(_cacheVB);
+    }
 }
 	
 void PathfinderDebug::depthMask(bool state)
@@ -84,7 +89,17 @@ void PathfinderDebug::begin(duDebugDrawPrimitives prim, float size)
     
     //printf("Begin\n");
     
-    allocateTransientBuffer();
+    if (_caching) {
+        CK_ASSERT(!_textureEnabled);
+        CacheBatch batch;
+        batch.drawState = _drawState;
+        batch.firstVertex = (uint32_t)_cacheVertices.size();
+        batch.vertexCount = 0;
+        _cacheBatches.push_back(batch);
+    }
+    else {
+        allocateTransientBuffer();
+    }
 }
 
 bool PathfinderDebug::allocateTransientBuffer()
@@ -130,18 +145,26 @@ void PathfinderDebug::vertex
 )
 {
     CK_ASSERT(!_textureEnabled);
-    if (!_tvb.data)
-        return;
     
     uint32_t needed = _vindex < 0 ? 1 : _vindex == 3 ? 6 : 0;
-    if (_tvbidx + needed > _tvblimit) {
-        flushBuffers();
-        if (!allocateTransientBuffer())
+    gfx::VertexTypes::PositionColor* vtx;
+    if (_caching) {
+        const size_t first = _cacheVertices.size();
+        _cacheVertices.resize(first + needed);
+        vtx = _cacheVertices.data() + first;
+    }
+    else {
+        if (!_tvb.data)
             return;
+        if (_tvbidx + needed > _tvblimit) {
+            flushBuffers();
+            if (!allocateTransientBuffer())
+                return;
+        }
+        vtx = reinterpret_cast<gfx::VertexTypes::PositionColor*>(_tvb.data) + _tvbidx;
     }
     
     if (_vindex < 0) {
-        auto vtx = reinterpret_cast<gfx::VertexTypes::PositionColor*>(_tvb.data) + _tvbidx;
         vtx->x = x;
         vtx->y = y;
         vtx->z = z;
@@ -159,7 +182,6 @@ void PathfinderDebug::vertex
         
         if (_vindex >= 4) {
             //  make two tris given a clockwise (recast winding order) quad
-            auto vtx = reinterpret_cast<gfx::VertexTypes::PositionColor*>(_tvb.data) + _tvbidx;
             const VertexInput& v0 = _vcache[0];
             const VertexInput& v1 = _vcache[1];
             const VertexInput& v2 = _vcache[2];
@@ -188,7 +210,9 @@ void PathfinderDebug::vertex
         }
     }
     
-    _tvbidx += needed;
+    if (!_caching) {
+        _tvbidx += needed;
+    }
 }
 
 void PathfinderDebug::vertex
@@ -210,7 +234,7 @@ void PathfinderDebug::vertex
 {
     CK_ASSERT(_textureEnabled);
     
-    if (!_tvb.data)
+    if (_caching || !_tvb.data)
         return;
     
     uint32_t needed = _vindex < 0 ? 1 : _vindex == 3 ? 6 : 0;
@@ -283,7 +307,24 @@ void PathfinderDebug::vertex
 
 void PathfinderDebug::end()
 {
-    flushBuffers();
+    if (_caching) {
+        CacheBatch& batch = _cacheBatches.back();
+        batch.vertexCount = (uint32_t)_cacheVertices.size() - batch.firstVertex;
+        if (!batch.vertexCount) {
+            _cacheBatches.pop_back();
+        }
+        else if (_cacheBatches.size() > 1) {
+            //  consecutive primitives with the same state draw as one
+            CacheBatch& prev = _cacheBatches[_cacheBatches.size() - 2];
+            if (prev.drawState == batch.drawState) {
+                prev.vertexCount += batch.vertexCount;
+                _cacheBatches.pop_back();
+            }
+        }
+    }
+    else {
+        flushBuffers();
+    }
     
     _drawState &= ~BGFX_STATE_PT_MASK;
     _drawState &= ~BGFX_STATE_POINT_SIZE_MASK;
@@ -312,28 +353,74 @@ void PathfinderDebug::flushBuffers()
     CK_ASSERT_RETURN(_camera != nullptr);
     if (!_tvb.data)
         return;
+    
+    bgfx::setVertexBuffer(&_tvb, 0, _tvbidx);
+    submit(_drawState, _textureEnabled);
+}
+
+void PathfinderDebug::beginCache()
+{
+    CK_ASSERT(_vindex < 0);
+    _caching = true;
+    _cacheVertices.clear();
+    _cacheBatches.clear();
+}
+
+void PathfinderDebug::endCache()
+{
+    _caching = false;
+    
+    if (bgfx::isValid(_cacheVB)) {
+        bgfx::destroyVertexBuffer(_cacheVB);
+        _cacheVB = BGFX_INVALID_HANDLE;
+    }
+    if (!_cacheVertices.empty()) {
+        const bgfx::Memory* mem = bgfx::copy(_cacheVertices.data(),
+            (uint32_t)(_cacheVertices.size() * sizeof(gfx::VertexTypes::PositionColor)));
+        _cacheVB = bgfx::createVertexBuffer(mem,
+            gfx::VertexTypes::declaration(gfx::VertexTypes::kVPositionColor));
+    }
+    
+    //  the batches remain to draw the buffer
+    _cacheVertices.clear();
+    _cacheVertices.shrink_to_fit();
+}
+
+void PathfinderDebug::drawCache()
+{
+    CK_ASSERT_RETURN(_camera != nullptr);
+    if (!bgfx::isValid(_cacheVB))
+        return;
+    
+    for (auto& batch : _cacheBatches) {
+        bgfx::setVertexBuffer(_cacheVB, batch.firstVertex, batch.vertexCount);
+        submit(batch.drawState, false);
+    }
+}
+
+void PathfinderDebug::submit(uint64_t drawState, bool textured)
+{
     bgfx::setViewRect(_camera->viewIndex,
         _camera->viewportRect.x, _camera->viewportRect.y,
         _camera->viewportRect.w ,_camera->viewportRect.h);
  
     gfx::Matrix4 mainTransform = gfx::Matrix4::kIdentity;
     
-    if (_drawTexture && _textureEnabled) {
+    if (_drawTexture && textured) {
         bgfx::setTexture(0, (*_uniforms)[gfx::kNodeUniformTexDiffuse], _drawTexture->bgfxHandle());
     }
     
     bgfx::setViewTransform(_camera->viewIndex, _camera->viewMtx, _camera->projMtx);
     bgfx::setTransform(mainTransform);
-    bgfx::setVertexBuffer(&_tvb, 0, _tvbidx);
     
     bgfx::setState(
-        _drawState
+        drawState
       | BGFX_STATE_RGB_WRITE
       | BGFX_STATE_MSAA
       | BGFX_STATE_CULL_CCW
     );
     
-    if (_textureEnabled) {
+    if (textured) {
         bgfx::submit(_camera->viewIndex, (*_programs)[gfx::kNodeProgramDiffuse]);
     }
     else {
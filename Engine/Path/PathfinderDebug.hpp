@@ -13,6 +13,9 @@
 
 #include "Engine/Contrib/Recast/DebugDraw.h"
 #include "CKGfx/NodeRendererTypes.hpp"
+#include "CKGfx/VertexTypes.hpp"
+
+#include <vector>
 
 namespace cinek {
     namespace ove {
@@ -62,6 +65,14 @@ struct PathfinderDebug : duDebugDraw
         gfx::TextureHandle drawTexture
     );
     
+    //  geometry drawn between beginCache and endCache is stored in a vertex
+    //  buffer instead of being submitted, and is drawn by drawCache until
+    //  the next beginCache.  for static geometry (i.e. the navmesh.)  only
+    //  untextured primitives are cached
+    void beginCache();
+    void endCache();
+    void drawCache();
+    
 private:
     uint32_t _primBufSize;
     uint64_t _drawState;
@@ -86,6 +97,19 @@ private:
     
     bool allocateTransientBuffer();
     void flushBuffers();
+    void submit(uint64_t drawState, bool textured);
+    
+    struct CacheBatch
+    {
+        uint64_t drawState;
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+    };
+    
+    bool _caching;
+    std::vector<gfx::VertexTypes::PositionColor> _cacheVertices;
+    std::vector<CacheBatch> _cacheBatches;
+    bgfx::VertexBufferHandle _cacheVB;
     
     const cinek::gfx::RenderProgramMap* _programs;
     const cinek::gfx::RenderUniformMap* _uniforms;
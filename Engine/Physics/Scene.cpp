@@ -8,11 +8,18 @@
 
 #include "Scene.hpp"
 #include "SceneDataContext.hpp"
+#include "SceneDebugDrawer.hpp"
+#include "SceneQueryService.hpp"
+#include "SceneListener.hpp"
+#include "Engine/Profiler.hpp"
+#include "Engine/MemoryTracker.hpp"
 
 #include <cinek/objectpool.inl>
 
 #include <bullet/BulletCollision/NarrowPhaseCollision/btRaycastCallback.h>
 
+#include <algorithm>
+
 namespace cinek {
 
     template class ObjectPool<ove::SceneBody>;
@@ -46,13 +53,20 @@ auto Scene::sceneContainerLowerBound
 Scene::Scene
 (
     const InitParams& initParams, 
-    btIDebugDraw* debugDrawer
+    SceneDebugDrawer* debugDrawer
 ) :
     _simulateDynamics(true),
+    _sleepLinearThreshold2(initParams.sleepLinearThreshold * initParams.sleepLinearThreshold),
+    _sleepAngularThreshold2(initParams.sleepAngularThreshold * initParams.sleepAngularThreshold),
+    _sleepTicks((uint32_t)std::max(initParams.sleepTicks, 1)),
     _btCollisionDispatcher(&_btCollisionConfig),
     _btWorld(&_btCollisionDispatcher,
              &_btBroadphase,
-             &_btCollisionConfig)
+             &_btCollisionConfig),
+    _characters(_btWorld),
+    _debugDrawer(debugDrawer),
+    _staticDebugChanged(true),
+    _queryService(nullptr)
 {
     int count = initParams.staticLimit;
     
@@ -65,8 +79,12 @@ Scene::Scene
         }
     }
     _bodies.reserve(count);
+    _awakeBodies.reserve(count);
     
+    //  only awake bodies have their bounds refreshed
+    _btWorld.setForceUpdateAllAabbs(false);
     _btWorld.setDebugDrawer(debugDrawer);
+    _btCollisionDispatcher.setJobRunner(initParams.jobRunner);
 }
 
 Scene::~Scene()
@@ -75,17 +93,34 @@ Scene::~Scene()
     
 void Scene::simulate(CKTimeDelta dt)
 {
+    OVENGINE_PROFILE_ZONE("Scene::simulate");
+    OVENGINE_MEMORY_TAG(kMemoryTagScene);
+    
+    waitForQueries();
+    
     _btWorld.performDiscreteCollisionDetection();
+    updateContacts();
 
-    if (_simulateDynamics) {
-    
-        for (auto& body : _bodies) {
-            if (body->checkFlags(SceneBody::kIsDynamic)) {
-                if (body->transformChanged || body->velocityChanged) {
+    //  sleeping bodies are skipped, so tick cost follows the number of
+    //  moving bodies
+    size_t index = 0;
+    while (index < _awakeBodies.size()) {
+        SceneBody* body = _awakeBodies[index];
+        bool moving = false;
+        if (body->checkFlags(SceneBody::kIsDynamic)) {
+            if (_simulateDynamics) {
+                if (body->characterIndex >= 0) {
+                    _characterMoves.push_back(body);
+                }
+                else if (body->transformChanged || body->velocityChanged) {
                     btTransform& transform = body->btBody->getWorldTransform();
                     
                     // set btBody translate
                     btVector3 nextPos = transform.getOrigin() + body->linearVelocity;
+                    if (body->hasContinuousCollision() &&
+                        body->linearVelocity.length2() > body->btBody->getCcdSquareMotionThreshold()) {
+                        nextPos = sweepBody(body, transform.getOrigin(), nextPos);
+                    }
                     transform.setOrigin(nextPos);
                     
                     // set btBody basis (TODO: optimize)
@@ -107,8 +142,323 @@ void Scene::simulate(CKTimeDelta dt)
                     body->motionState->setWorldTransform(transform);
                 }
             }
+            moving = body->linearVelocity.length2() > _sleepLinearThreshold2 ||
+                     body->angularVelocity.length2() > _sleepAngularThreshold2;
         }
+        if (moving) {
+            body->sleepTicks = 0;
+        }
+        else if (++body->sleepTicks >= _sleepTicks) {
+            //  replaces this entry with the last awake body
+            sleepBody(body);
+            continue;
+        }
+        ++index;
+    }
+    
+    if (!_sweptContacts.empty()) {
+        addSweptContacts();
+    }
+    
+    if (!_characterMoves.empty()) {
+        _characters.move(_characterMoves);
+        _characterMoves.clear();
+    }
+}
+
+void Scene::wakeBody(SceneBody* body)
+{
+    //  static bodies are woken when moved
+    invalidateStaticDebug(body);
     
+    body->sleepTicks = 0;
+    if (body->awakeIndex >= 0)
+        return;
+    
+    body->awakeIndex = (int32_t)_awakeBodies.size();
+    _awakeBodies.push_back(body);
+    body->btBody->setActivationState(ACTIVE_TAG);
+}
+
+void Scene::sleepBody(SceneBody* body)
+{
+    removeAwakeBody(body);
+    body->btBody->setActivationState(ISLAND_SLEEPING);
+    
+    //  bounds are refreshed for awake bodies only, at the start of the next
+    //  simulate.  the body may have moved (below the sleep threshold) since
+    //  the last refresh, so refresh its bounds before it's skipped
+    if (body->btBody->getBroadphaseHandle()) {
+        _btWorld.updateSingleAabb(body->btBody);
+    }
+}
+
+void Scene::removeAwakeBody(SceneBody* body)
+{
+    if (body->awakeIndex < 0)
+        return;
+    
+    SceneBody* last = _awakeBodies.back();
+    _awakeBodies[body->awakeIndex] = last;
+    last->awakeIndex = body->awakeIndex;
+    _awakeBodies.pop_back();
+    body->awakeIndex = -1;
+}
+
+static bool sceneContactPairLess(const SceneContact& c0, const SceneContact& c1)
+{
+    return c0.entityA < c1.entityA ||
+        (c0.entityA == c1.entityA && c0.entityB < c1.entityB);
+}
+
+static bool sceneContactPairEqual(const SceneContact& c0, const SceneContact& c1)
+{
+    return c0.entityA == c1.entityA && c0.entityB == c1.entityB;
+}
+
+//  gap kept between a swept body and the surface it stopped against
+static const btScalar kSweepSkinWidth = btScalar(0.01);
+
+struct SceneBodySweepCallback : btCollisionWorld::ClosestConvexResultCallback
+{
+    const btCollisionObject* self;
+    btVector3 direction;
+    
+    SceneBodySweepCallback
+    (
+        const btCollisionObject* self,
+        const btVector3& from,
+        const btVector3& to
+    ) :
+        btCollisionWorld::ClosestConvexResultCallback(from, to),
+        self(self),
+        direction(to - from)
+    {
+        //  collide with whatever the body collides with during the
+        //  discrete pass
+        const btBroadphaseProxy* proxy = self->getBroadphaseHandle();
+        if (proxy) {
+            m_collisionFilterGroup = proxy->m_collisionFilterGroup;
+            m_collisionFilterMask = proxy->m_collisionFilterMask;
+        }
+    }
+    
+    btScalar addSingleResult
+    (
+        btCollisionWorld::LocalConvexResult& result,
+        bool normalInWorldSpace
+    )
+    override
+    {
+        if (result.m_hitCollisionObject == self)
+            return m_closestHitFraction;
+        
+        btVector3 normal = result.m_hitNormalLocal;
+        if (!normalInWorldSpace) {
+            normal = result.m_hitCollisionObject->getWorldTransform().getBasis() * normal;
+        }
+        //  surfaces the body is leaving (i.e. ones it's resting against)
+        //  don't stop it
+        if (normal.dot(direction) >= 0)
+            return m_closestHitFraction;
+        
+        return btCollisionWorld::ClosestConvexResultCallback::addSingleResult(
+            result, normalInWorldSpace);
+    }
+};
+
+btVector3 Scene::sweepBody
+(
+    SceneBody* body,
+    const btVector3& from,
+    const btVector3& to
+)
+{
+    OVENGINE_PROFILE_ZONE("Scene::sweepBody");
+    
+    //  the sphere is swept from the shape's center, which may be offset
+    //  from the body's origin (i.e. by a compound shape's child transform.)
+    //  both move by the same displacement, so the hit fraction applies to
+    //  the origin as well
+    btVector3 aabbMin, aabbMax;
+    body->btBody->getCollisionShape()->getAabb(btTransform::getIdentity(),
+                                                aabbMin, aabbMax);
+    const btVector3 centerOffset = body->btBody->getWorldTransform().getBasis()
+        * ((aabbMin + aabbMax) * btScalar(0.5));
+    const btVector3 sweepFrom = from + centerOffset;
+    const btVector3 sweepTo = to + centerOffset;
+    
+    btSphereShape sphere(body->btBody->getCcdSweptSphereRadius());
+    SceneBodySweepCallback cb(body->btBody, sweepFrom, sweepTo);
+    _btWorld.convexSweepTest(&sphere,
+                             btTransform(btQuaternion::getIdentity(), sweepFrom),
+                             btTransform(btQuaternion::getIdentity(), sweepTo),
+                             cb);
+    if (!cb.hasHit())
+        return to;
+    
+    auto hitBody = reinterpret_cast<SceneBody*>(cb.m_hitCollisionObject->getUserPointer());
+    if (!hitBody)
+        return to;
+    
+    //  time of impact, less the skin width
+    const btVector3 displacement = to - from;
+    const btScalar length = displacement.length();
+    const btScalar dist = std::max(cb.m_closestHitFraction * length - kSweepSkinWidth,
+                                   btScalar(0));
+    
+    //  the normal points from the surface to the swept body
+    SceneContact contact;
+    contact.phase = SceneContact::kBegin;
+    contact.position = cb.m_hitPointWorld;
+    contact.normal = cb.m_hitNormalWorld;
+    contact.depth = 0;
+    SceneBody* bodyA = body;
+    SceneBody* bodyB = hitBody;
+    if (bodyB->entity < bodyA->entity) {
+        std::swap(bodyA, bodyB);
+        contact.normal = -contact.normal;
+    }
+    contact.entityA = bodyA->entity;
+    contact.entityB = bodyB->entity;
+    contact.categoryMaskA = bodyA->categoryMask;
+    contact.categoryMaskB = bodyB->categoryMask;
+    _sweptContacts.push_back(contact);
+    
+    if (!hitBody->isAwake() && hitBody->checkFlags(SceneBody::kIsDynamic)) {
+        wakeBody(hitBody);
+    }
+    
+    //  keep only the motion along the surface, so the body doesn't sweep
+    //  into it again every tick
+    const btScalar approach = body->linearVelocity.dot(cb.m_hitNormalWorld);
+    if (approach < 0) {
+        body->linearVelocity -= cb.m_hitNormalWorld * approach;
+    }
+    
+    return from + displacement * (dist / length);
+}
+
+void Scene::addSweptContacts()
+{
+    //  a swept body stops short of what it hit, so the next discrete pass
+    //  may not find the pair touching.  the pair is recorded as touching
+    //  this tick, so that the next tick reports it as persisting or ended
+    std::sort(_sweptContacts.begin(), _sweptContacts.end(), sceneContactPairLess);
+    _sweptContacts.erase(std::unique(_sweptContacts.begin(), _sweptContacts.end(),
+                                     sceneContactPairEqual),
+                         _sweptContacts.end());
+    
+    for (auto& swept : _sweptContacts) {
+        auto pairIt = std::lower_bound(_contactPairs.begin(), _contactPairs.end(),
+                                       swept, sceneContactPairLess);
+        if (pairIt != _contactPairs.end() && sceneContactPairEqual(*pairIt, swept))
+            continue;   // already touching
+        
+        _contactPairs.insert(pairIt, swept);
+        
+        auto it = std::lower_bound(_contacts.begin(), _contacts.end(),
+                                   swept, sceneContactPairLess);
+        if (it != _contacts.end() && sceneContactPairEqual(*it, swept)) {
+            //  the discrete pass ended the contact, but the bodies met again
+            *it = swept;
+            it->phase = SceneContact::kPersist;
+        }
+        else {
+            _contacts.insert(it, swept);
+        }
+    }
+    _sweptContacts.clear();
+}
+
+void Scene::updateContacts()
+{
+    OVENGINE_PROFILE_ZONE("Scene::updateContacts");
+    
+    _prevContactPairs.swap(_contactPairs);
+    _contactPairs.clear();
+    _contacts.clear();
+    
+    //  collect the deepest touching point of every manifold
+    const int manifoldCount = _btCollisionDispatcher.getNumManifolds();
+    for (int i = 0; i < manifoldCount; ++i) {
+        const btPersistentManifold* manifold =
+            _btCollisionDispatcher.getManifoldByIndexInternal(i);
+        
+        int deepest = -1;
+        btScalar distance = 0;
+        for (int p = 0; p < manifold->getNumContacts(); ++p) {
+            btScalar d = manifold->getContactPoint(p).getDistance();
+            if (d <= 0 && (deepest < 0 || d < distance)) {
+                deepest = p;
+                distance = d;
+            }
+        }
+        if (deepest < 0)
+            continue;
+        
+        auto bodyA = reinterpret_cast<SceneBody*>(manifold->getBody0()->getUserPointer());
+        auto bodyB = reinterpret_cast<SceneBody*>(manifold->getBody1()->getUserPointer());
+        if (!bodyA || !bodyB)
+            continue;
+        
+        //  awake bodies wake the dynamic bodies they touch
+        if (bodyA->isAwake() != bodyB->isAwake()) {
+            SceneBody* sleeper = bodyA->isAwake() ? bodyB : bodyA;
+            if (sleeper->checkFlags(SceneBody::kIsDynamic)) {
+                wakeBody(sleeper);
+            }
+        }
+        
+        const btManifoldPoint& point = manifold->getContactPoint(deepest);
+        
+        SceneContact contact;
+        contact.phase = SceneContact::kBegin;
+        contact.position = (point.getPositionWorldOnA() + point.getPositionWorldOnB()) * 0.5f;
+        contact.normal = point.m_normalWorldOnB;
+        contact.depth = -distance;
+        if (bodyB->entity < bodyA->entity) {
+            std::swap(bodyA, bodyB);
+            contact.normal = -contact.normal;
+        }
+        contact.entityA = bodyA->entity;
+        contact.entityB = bodyB->entity;
+        contact.categoryMaskA = bodyA->categoryMask;
+        contact.categoryMaskB = bodyB->categoryMask;
+        _contactPairs.push_back(contact);
+    }
+    
+    //  a pair may have several manifolds (compound shapes) - keep the deepest
+    std::sort(_contactPairs.begin(), _contactPairs.end(),
+        [](const SceneContact& c0, const SceneContact& c1) -> bool {
+            if (sceneContactPairEqual(c0, c1))
+                return c0.depth > c1.depth;
+            return sceneContactPairLess(c0, c1);
+        });
+    _contactPairs.erase(std::unique(_contactPairs.begin(), _contactPairs.end(),
+                                    sceneContactPairEqual),
+                        _contactPairs.end());
+    
+    //  diff against the prior tick
+    auto it = _contactPairs.begin();
+    auto prevIt = _prevContactPairs.begin();
+    while (it != _contactPairs.end() || prevIt != _prevContactPairs.end()) {
+        if (prevIt == _prevContactPairs.end() ||
+            (it != _contactPairs.end() && sceneContactPairLess(*it, *prevIt))) {
+            _contacts.push_back(*it);
+            ++it;
+        }
+        else if (it == _contactPairs.end() || sceneContactPairLess(*prevIt, *it)) {
+            _contacts.push_back(*prevIt);
+            _contacts.back().phase = SceneContact::kEnd;
+            ++prevIt;
+        }
+        else {
+            it->phase = SceneContact::kPersist;
+            _contacts.push_back(*it);
+            ++it;
+            ++prevIt;
+        }
     }
 }
 
@@ -128,6 +478,9 @@ void Scene::activate()
     if (!_simulateDynamics) {
         for (auto& obj : _bodies) {
             ove::activate(*obj);
+            if (obj->checkFlags(SceneBody::kIsDynamic)) {
+                wakeBody(obj);
+            }
         }
     
         _simulateDynamics = true;
@@ -141,7 +494,92 @@ bool Scene::isActive() const
 
 void Scene::debugRender()
 {
-    _btWorld.debugDrawWorld();
+    if (!_debugDrawer)
+        return;
+    
+    const btIDebugDraw::DefaultColors colors = _debugDrawer->getDefaultColors();
+    
+    //  static bodies don't simulate, so they're drawn as deactivated
+    if (_staticDebugChanged) {
+        _debugDrawer->beginStaticLines();
+        for (auto body : _bodies) {
+            if (body->btBody->isStaticObject()) {
+                debugDrawBody(body, colors.m_deactivatedObject);
+            }
+        }
+        _debugDrawer->endStaticLines();
+        _staticDebugChanged = false;
+    }
+    _debugDrawer->drawStaticLines();
+    
+    for (auto body : _bodies) {
+        if (body->btBody->isStaticObject())
+            continue;
+        
+        btVector3 color;
+        switch (body->btBody->getActivationState()) {
+        case ACTIVE_TAG:
+            color = colors.m_activeObject;
+            break;
+        case ISLAND_SLEEPING:
+            color = colors.m_deactivatedObject;
+            break;
+        case WANTS_DEACTIVATION:
+            color = colors.m_wantsDeactivationObject;
+            break;
+        case DISABLE_DEACTIVATION:
+            color = colors.m_disabledDeactivationObject;
+            break;
+        case DISABLE_SIMULATION:
+            color = colors.m_disabledSimulationObject;
+            break;
+        default:
+            color.setValue(1, 0, 0);
+            break;
+        }
+        debugDrawBody(body, color);
+    }
+    _debugDrawer->flushLines();
+}
+
+void Scene::debugDrawBody(SceneBody* body, const btVector3& color)
+{
+    btCollisionObject* btBody = body->btBody;
+    const int debugMode = _debugDrawer->getDebugMode();
+    
+    if (debugMode & btIDebugDraw::DBG_DrawWireframe) {
+        _btWorld.debugDrawObject(btBody->getWorldTransform(),
+                                 btBody->getCollisionShape(),
+                                 color);
+    }
+    if (debugMode & btIDebugDraw::DBG_DrawAabb) {
+        btBroadphaseProxy* proxy = btBody->getBroadphaseHandle();
+        if (proxy) {
+            _debugDrawer->drawAabb(proxy->m_aabbMin, proxy->m_aabbMax,
+                                   _debugDrawer->getDefaultColors().m_aabb);
+        }
+    }
+}
+
+void Scene::invalidateStaticDebug(SceneBody* body)
+{
+    if (body->btBody->isStaticObject()) {
+        _staticDebugChanged = true;
+    }
+}
+
+void Scene::addListener(SceneListener* listener)
+{
+    CK_ASSERT(std::find(_listeners.begin(), _listeners.end(), listener) == _listeners.end());
+    _listeners.push_back(listener);
+}
+
+void Scene::removeListener(SceneListener* listener)
+{
+    auto it = std::find(_listeners.begin(), _listeners.end(), listener);
+    if (it != _listeners.end()) {
+        _listeners.erase(it);
+    }
 }
 
 SceneBody* Scene::attachBody
@@ -157,23 +595,11 @@ SceneBody* Scene::attachBody
         CK_ASSERT(false);
         return *it;
     }
-    //  reflect current simulation state
-    if (!_simulateDynamics) {
-        ove::deactivate(*body);
-    }
-
-    body->btBody->setUserPointer(body);
     
-    if (body->motionState) {
-        btTransform btTransform;
-        body->motionState->getWorldTransform(btTransform);
-        body->btBody->setWorldTransform(btTransform);
-    }
-    
-    body->categoryMask = 0;
+    prepareBodyForAttach(body);
     
     uint32_t category = 0;
-    while (categories) {
+    while (categories && category < SceneBody::kNumCategories) {
         if ((categories & 1) != 0) {
             addCategoryToBody(body, category);
         }
@@ -186,19 +612,45 @@ SceneBody* Scene::attachBody
     
     //  update btWorld
     addBodyToBtWorld(body);
+    wakeBody(body);
+    
+    for (auto listener : _listeners) {
+        listener->onSceneBodyAttached(body);
+    }
     
     return body;
 }
 
+void Scene::prepareBodyForAttach(SceneBody* body)
+{
+    //  reflect current simulation state
+    if (!_simulateDynamics) {
+        ove::deactivate(*body);
+    }
+
+    body->btBody->setUserPointer(body);
+    
+    if (body->motionState) {
+        btTransform btTransform;
+        body->motionState->getWorldTransform(btTransform);
+        body->btBody->setWorldTransform(btTransform);
+    }
+    
+    body->categoryMask = 0;
+    body->scene = this;
+}
+
 SceneBody* Scene::addCategoryToBody(Entity entity, uint32_t category)
 {
     CK_ASSERT_RETURN_VALUE(category < SceneBody::kNumCategories, nullptr);
 
     SceneBody* body = findBody(entity);
     if (body) {
-        removeBodyFromBtWorld(body);
         addCategoryToBody(body, category);
-        addBodyToBtWorld(body);
+        updateBodyInBtWorld(body);
+        for (auto listener : _listeners) {
+            listener->onSceneBodyCategoriesChanged(body);
+        }
     }
     return body;
 }
@@ -218,11 +670,15 @@ SceneBody* Scene::addCategoryToBody(SceneBody* body, uint32_t category)
 
 SceneBody* Scene::removeCategoryFromBody(Entity entity, uint32_t category)
 {
+    CK_ASSERT_RETURN_VALUE(category < SceneBody::kNumCategories, nullptr);
+    
     SceneBody* body = findBody(entity);
     if (body) {
-        removeBodyFromBtWorld(body);
         removeCategoryFromBody(body, category);
-        addBodyToBtWorld(body);
+        updateBodyInBtWorld(body);
+        for (auto listener : _listeners) {
+            listener->onSceneBodyCategoriesChanged(body);
+        }
     }
     return body;
 }
@@ -254,6 +710,10 @@ SceneBody* Scene::detachBody
     CK_ASSERT_RETURN_VALUE(it != _bodies.end() && (*it)->entity == entity, nullptr);
     body = *it;
     
+    for (auto listener : _listeners) {
+        listener->onSceneBodyDetached(body);
+    }
+    
     //  remove from all categories
     uint32_t categoryMask = body->getCategoryMask();
     uint32_t category = 0;
@@ -266,11 +726,37 @@ SceneBody* Scene::detachBody
     }
     
     removeBodyFromBtWorld(body);
+    removeAwakeBody(body);
+    _characters.detach(body);
+    body->scene = nullptr;
     _bodies.erase(it);
     
     return body;
 }
 
+SceneBody* Scene::attachCharacter
+(
+    Entity entity,
+    const SceneCharacterParams& params
+)
+{
+    SceneBody* body = findBody(entity);
+    if (body) {
+        _characters.attach(body, params);
+        wakeBody(body);
+    }
+    return body;
+}
+
+SceneBody* Scene::detachCharacter(Entity entity)
+{
+    SceneBody* body = findBody(entity);
+    if (body) {
+        _characters.detach(body);
+    }
+    return body;
+}
+
 SceneBody* Scene::findBody
 (
     Entity entity,
@@ -349,18 +835,334 @@ const
     return result;
 }
 
-void Scene::addBodyToBtWorld(SceneBody* body)
+////////////////////////////////////////////////////////////////////////////////
+
+static bool shapeCastHitLess(const SceneShapeCastHit& h0, const SceneShapeCastHit& h1)
 {
-    auto categoryMask = body->getCategoryMask();
-    if ((categoryMask & SceneBody::kIsDynamic) != 0) {
-        body->btBody->setCollisionFlags(0);
+    return h0.fraction < h1.fraction ||
+        (h0.fraction == h1.fraction && h0.body->entity < h1.body->entity);
+}
+
+//  inserts a hit into a sorted buffer, keeping the nearest hit per body.
+//  returns the new hit count
+static int addShapeCastHit
+(
+    SceneShapeCastHit* hits,
+    int count,
+    int limit,
+    const SceneShapeCastHit& hit
+)
+{
+    //  a body may report several hits (i.e. triangles of a mesh)
+    for (int i = 0; i < count; ++i) {
+        if (hits[i].body == hit.body) {
+            if (!shapeCastHitLess(hit, hits[i]))
+                return count;
+            std::move(hits + i + 1, hits + count, hits + i);
+            --count;
+            break;
+        }
     }
-    else {
-        body->btBody->setCollisionFlags(btCollisionObject::CF_STATIC_OBJECT);
+    
+    int index = count;
+    while (index > 0 && shapeCastHitLess(hit, hits[index-1])) {
+        --index;
     }
+    if (index >= limit)
+        return count;
     
-    short btGroup = 0;
-    short btMask = SceneBody::kAllFilter;
+    const int last = std::min(count, limit-1);
+    std::move_backward(hits + index, hits + last, hits + last + 1);
+    hits[index] = hit;
+    return std::min(count + 1, limit);
+}
+
+//  inserts a body into a buffer sorted by entity.  returns the new count
+static int addOverlapBody
+(
+    SceneBody** bodies,
+    int count,
+    int limit,
+    SceneBody* body
+)
+{
+    auto it = std::lower_bound(bodies, bodies + count, body->entity,
+        [](const SceneBody* obj0, Entity e) -> bool {
+            return obj0->entity < e;
+        });
+    if (it != bodies + count && (*it)->entity == body->entity)
+        return count;
+    
+    const int index = (int)(it - bodies);
+    if (index >= limit)
+        return count;
+    
+    const int last = std::min(count, limit-1);
+    std::move_backward(bodies + index, bodies + last, bodies + last + 1);
+    bodies[index] = body;
+    return std::min(count + 1, limit);
+}
+
+struct SceneShapeCastCallback : btCollisionWorld::ConvexResultCallback
+{
+    SceneShapeCastHit* hits;
+    int limit;
+    int count;
+    
+    btScalar addSingleResult
+    (
+        btCollisionWorld::LocalConvexResult& result,
+        bool normalInWorldSpace
+    )
+    override
+    {
+        SceneShapeCastHit hit;
+        hit.body = reinterpret_cast<SceneBody*>(result.m_hitCollisionObject->getUserPointer());
+        if (!hit.body)
+            return m_closestHitFraction;
+        
+        if (normalInWorldSpace) {
+            hit.normal = result.m_hitNormalLocal;
+        }
+        else {
+            hit.normal = result.m_hitCollisionObject->getWorldTransform().getBasis()
+                * result.m_hitNormalLocal;
+        }
+        //  for sweeps bullet reports the hit point in world space
+        hit.position = result.m_hitPointLocal;
+        hit.fraction = result.m_hitFraction;
+        
+        count = addShapeCastHit(hits, count, limit, hit);
+        
+        //  once full, hits beyond the farthest kept hit can be skipped
+        if (count == limit) {
+            m_closestHitFraction = hits[count-1].fraction;
+        }
+        return m_closestHitFraction;
+    }
+};
+
+int Scene::convexCast
+(
+    const btConvexShape& shape,
+    const btTransform& from,
+    const btTransform& to,
+    SceneShapeCastHit* hits,
+    int hitLimit,
+    uint16_t includeFilters,
+    uint16_t excludeFilters
+)
+const
+{
+    if (hitLimit <= 0)
+        return 0;
+    
+    SceneShapeCastCallback cb;
+    cb.hits = hits;
+    cb.limit = hitLimit;
+    cb.count = 0;
+    cb.m_collisionFilterMask = includeFilters ^ excludeFilters;
+    
+    _btWorld.convexSweepTest(&shape, from, to, cb);
+    
+    return cb.count;
+}
+
+int Scene::sphereCast
+(
+    const btVector3& from,
+    const btVector3& to,
+    btScalar radius,
+    SceneShapeCastHit* hits,
+    int hitLimit,
+    uint16_t includeFilters,
+    uint16_t excludeFilters
+)
+const
+{
+    btSphereShape shape(radius);
+    return convexCast(shape,
+                      btTransform(btQuaternion::getIdentity(), from),
+                      btTransform(btQuaternion::getIdentity(), to),
+                      hits, hitLimit, includeFilters, excludeFilters);
+}
+
+int Scene::capsuleCast
+(
+    const btVector3& from,
+    const btVector3& to,
+    btScalar radius,
+    btScalar height,
+    SceneShapeCastHit* hits,
+    int hitLimit,
+    uint16_t includeFilters,
+    uint16_t excludeFilters
+)
+const
+{
+    btCapsuleShape shape(radius, height);
+    return convexCast(shape,
+                      btTransform(btQuaternion::getIdentity(), from),
+                      btTransform(btQuaternion::getIdentity(), to),
+                      hits, hitLimit, includeFilters, excludeFilters);
+}
+
+int Scene::boxCast
+(
+    const btVector3& from,
+    const btVector3& to,
+    const btVector3& halfExtents,
+    const btQuaternion& rotation,
+    SceneShapeCastHit* hits,
+    int hitLimit,
+    uint16_t includeFilters,
+    uint16_t excludeFilters
+)
+const
+{
+    btBoxShape shape(halfExtents);
+    return convexCast(shape,
+                      btTransform(rotation, from),
+                      btTransform(rotation, to),
+                      hits, hitLimit, includeFilters, excludeFilters);
+}
+
+struct SceneOverlapCallback : btCollisionWorld::ContactResultCallback
+{
+    SceneBody** bodies;
+    int limit;
+    int count;
+    
+    btScalar addSingleResult
+    (
+        btManifoldPoint& cp,
+        const btCollisionObjectWrapper* colObj0Wrap,
+        int partId0,
+        int index0,
+        const btCollisionObjectWrapper* colObj1Wrap,
+        int partId1,
+        int index1
+    )
+    override
+    {
+        //  points within the contact breaking threshold are reported too
+        if (cp.getDistance() > 0)
+            return 0;
+        
+        //  the query object is always first
+        auto body = reinterpret_cast<SceneBody*>(
+            colObj1Wrap->getCollisionObject()->getUserPointer());
+        if (body) {
+            count = addOverlapBody(bodies, count, limit, body);
+        }
+        return 0;
+    }
+};
+
+int Scene::overlapConvex
+(
+    const btConvexShape& shape,
+    const btTransform& transform,
+    SceneBody** bodies,
+    int bodyLimit,
+    uint16_t includeFilters,
+    uint16_t excludeFilters
+)
+{
+    if (bodyLimit <= 0)
+        return 0;
+    
+    btCollisionObject queryObject;
+    queryObject.setCollisionShape(const_cast<btConvexShape*>(&shape));
+    queryObject.setWorldTransform(transform);
+    
+    SceneOverlapCallback cb;
+    cb.bodies = bodies;
+    cb.limit = bodyLimit;
+    cb.count = 0;
+    cb.m_collisionFilterMask = includeFilters ^ excludeFilters;
+    
+    _btWorld.contactTest(&queryObject, cb);
+    
+    return cb.count;
+}
+
+int Scene::overlapSphere
+(
+    const btVector3& center,
+    btScalar radius,
+    SceneBody** bodies,
+    int bodyLimit,
+    uint16_t includeFilters,
+    uint16_t excludeFilters
+)
+{
+    btSphereShape shape(radius);
+    return overlapConvex(shape,
+                         btTransform(btQuaternion::getIdentity(), center),
+                         bodies, bodyLimit, includeFilters, excludeFilters);
+}
+
+struct SceneAabbOverlapCallback : btBroadphaseAabbCallback
+{
+    SceneBody** bodies;
+    int limit;
+    int count;
+    short filterGroup;
+    short filterMask;
+    
+    bool process(const btBroadphaseProxy* proxy) override
+    {
+        //  same test as btCollisionWorld's query callbacks
+        if ((proxy->m_collisionFilterGroup & filterMask) == 0 ||
+            (proxy->m_collisionFilterMask & filterGroup) == 0)
+            return true;
+        
+        auto object = reinterpret_cast<const btCollisionObject*>(proxy->m_clientObject);
+        auto body = reinterpret_cast<SceneBody*>(object->getUserPointer());
+        if (body) {
+            count = addOverlapBody(bodies, count, limit, body);
+        }
+        return true;
+    }
+};
+
+int Scene::overlapAABB
+(
+    const btVector3& aabbMin,
+    const btVector3& aabbMax,
+    SceneBody** bodies,
+    int bodyLimit,
+    uint16_t includeFilters,
+    uint16_t excludeFilters
+)
+{
+    if (bodyLimit <= 0)
+        return 0;
+    
+    SceneAabbOverlapCallback cb;
+    cb.bodies = bodies;
+    cb.limit = bodyLimit;
+    cb.count = 0;
+    cb.filterGroup = btBroadphaseProxy::DefaultFilter;
+    cb.filterMask = includeFilters ^ excludeFilters;
+    
+    _btBroadphase.aabbTest(aabbMin, aabbMax, cb);
+    
+    return cb.count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void btFilterFromCategories
+(
+    uint32_t categoryMask,
+    short& btGroup,
+    short& btMask
+)
+{
+    btGroup = 0;
+    btMask = SceneBody::kAllFilter;
     
     if ((categoryMask & SceneBody::kIsStaging) != 0) {
         //  staged bodies collide with everything
@@ -376,6 +1178,32 @@ void Scene::addBodyToBtWorld(SceneBody* body)
         btGroup = SceneBody::kStaticFilter;
         btMask = btMask ^ SceneBody::kStaticFilter;
     }
+}
+
+static int btCollisionFlagsFromCategories(uint32_t categoryMask)
+{
+    if ((categoryMask & SceneBody::kIsDynamic) != 0)
+        return 0;
+    return btCollisionObject::CF_STATIC_OBJECT;
+}
+
+void Scene::waitForQueries()
+{
+    if (_queryService) {
+        _queryService->wait();
+    }
+}
+
+void Scene::addBodyToBtWorld(SceneBody* body)
+{
+    waitForQueries();
+    
+    auto categoryMask = body->getCategoryMask();
+    body->btBody->setCollisionFlags(btCollisionFlagsFromCategories(categoryMask));
+    invalidateStaticDebug(body);
+    
+    short btGroup, btMask;
+    btFilterFromCategories(categoryMask, btGroup, btMask);
     
     _btWorld.addCollisionObject(body->btBody, btGroup, btMask);
 }
@@ -383,22 +1211,344 @@ void Scene::addBodyToBtWorld(SceneBody* body)
 void Scene::removeBodyFromBtWorld(SceneBody* body)
 {
     auto btBody = body->btBody;
+    invalidateStaticDebug(body);
+    
+    //  the body's owner may free its shape once detached
+    waitForQueries();
     
     _btWorld.removeCollisionObject(btBody);
 }
-/*
-void Scene::updateBodyInBtWorld(SceneBody* body, bool addToWorld)
+
+void Scene::removeBodiesFromBtWorld(const std::vector<SceneBody*>& bodies)
 {
+    if (bodies.empty())
+        return;
+    
+    //  the bodies' owners may free their shapes once detached
+    waitForQueries();
+    
+    //  removes the bodies as btCollisionWorld::removeCollisionObject does,
+    //  but compacts the world's object array in one pass instead of
+    //  searching it for each body.  objects without a broadphase proxy are
+    //  the ones being removed
+    auto pairCache = _btBroadphase.getOverlappingPairCache();
+    for (auto body : bodies) {
+        invalidateStaticDebug(body);
+        btCollisionObject* btBody = body->btBody;
+        btBroadphaseProxy* proxy = btBody->getBroadphaseHandle();
+        if (proxy) {
+            pairCache->cleanProxyFromPairs(proxy, &_btCollisionDispatcher);
+            _btBroadphase.destroyProxy(proxy, &_btCollisionDispatcher);
+            btBody->setBroadphaseHandle(nullptr);
+        }
+#if BT_BULLET_VERSION >= 285
+        btBody->setWorldArrayIndex(-1);
+#endif
+    }
+    
+    btCollisionObjectArray& objects = _btWorld.getCollisionObjectArray();
+    int count = 0;
+    for (int i = 0; i < objects.size(); ++i) {
+        btCollisionObject* object = objects[i];
+        if (!object->getBroadphaseHandle())
+            continue;
+#if BT_BULLET_VERSION >= 285
+        //  later removals locate objects by their array index
+        object->setWorldArrayIndex(count);
+#endif
+        objects[count++] = object;
+    }
+    objects.resize(count);
+}
+
+void Scene::updateBodyInBtWorld(SceneBody* body)
+{
+    waitForQueries();
+    
+    wakeBody(body);
+    
     auto categoryMask = body->getCategoryMask();
+    body->btBody->setCollisionFlags(btCollisionFlagsFromCategories(categoryMask));
+    invalidateStaticDebug(body);
+    
+    short btGroup, btMask;
+    btFilterFromCategories(categoryMask, btGroup, btMask);
+    
+    btBroadphaseProxy* proxy = body->btBody->getBroadphaseHandle();
+    if (!proxy)
+        return;
+    if (proxy->m_collisionFilterGroup == btGroup &&
+        proxy->m_collisionFilterMask == btMask)
+        return;
+    
+    proxy->m_collisionFilterGroup = btGroup;
+    proxy->m_collisionFilterMask = btMask;
+    
+    //  drop pairs found under the old filter and collide the proxy again,
+    //  keeping the proxy instead of destroying and recreating it
+    _btBroadphase.getOverlappingPairCache()->removeOverlappingPairsContainingProxy(
+        proxy, &_btCollisionDispatcher);
+    const btVector3 aabbMin = proxy->m_aabbMin;
+    const btVector3 aabbMax = proxy->m_aabbMax;
+    _btBroadphase.setAabbForceUpdate(proxy, aabbMin, aabbMax, &_btCollisionDispatcher);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void SceneBatch::attach(SceneBody* body, uint32_t categoryMask)
+{
+    _attaches.push_back({ body, categoryMask });
+}
+
+void SceneBatch::detach(Entity entity)
+{
+    _detaches.push_back(entity);
+}
+
+void SceneBatch::addCategory(Entity entity, uint32_t category)
+{
+    _categoryChanges.push_back({ entity, category, true });
+}
+
+void SceneBatch::removeCategory(Entity entity, uint32_t category)
+{
+    _categoryChanges.push_back({ entity, category, false });
+}
+
+bool SceneBatch::empty() const
+{
+    return _attaches.empty() && _detaches.empty() && _categoryChanges.empty();
+}
+
+void SceneBatch::clear()
+{
+    _attaches.clear();
+    _detaches.clear();
+    _categoryChanges.clear();
+    _detached.clear();
+}
+
+static bool sceneBodyEntityLess(const SceneBody* b0, const SceneBody* b1)
+{
+    return b0->entity < b1->entity;
+}
+
+void Scene::applyBatch(SceneBatch& batch)
+{
+    OVENGINE_PROFILE_ZONE("Scene::applyBatch");
+    OVENGINE_MEMORY_TAG(kMemoryTagScene);
+    
+    batch._detached.clear();
+    
+    if (!batch._detaches.empty()) {
+        applyBatchDetaches(batch);
+    }
+    if (!batch._attaches.empty()) {
+        applyBatchAttaches(batch);
+    }
+    if (!batch._categoryChanges.empty()) {
+        applyBatchCategoryChanges(batch);
+    }
+    
+    batch._attaches.clear();
+    batch._detaches.clear();
+    batch._categoryChanges.clear();
+}
+
+void Scene::applyBatchDetaches(SceneBatch& batch)
+{
+    auto& entities = batch._detaches;
+    std::sort(entities.begin(), entities.end());
+    entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
     
-    if (body->btBody->getCollisionFlags())
+    uint32_t categoryMask = 0;
+    for (auto entity : entities) {
+        auto it = sceneContainerLowerBound(_bodies, entity);
+        if (it == _bodies.end() || (*it)->entity != entity) {
+            CK_ASSERT(false);
+            continue;
+        }
+        SceneBody* body = *it;
+        for (auto listener : _listeners) {
+            listener->onSceneBodyDetached(body);
+        }
+        removeAwakeBody(body);
+        _characters.detach(body);
+        body->scene = nullptr;
+        categoryMask |= body->categoryMask;
+        body->categoryMask = 0;
+        batch._detached.push_back(body);
+    }
     
+    removeBodiesFromBtWorld(batch._detached);
     
+    //  detached bodies have no categories left, and are sorted by entity
+    for (uint32_t category = 0; category < SceneBody::kNumCategories; ++category) {
+        const uint32_t categoryFlag = 1 << category;
+        if ((categoryMask & categoryFlag) == 0)
+            continue;
+        auto& container = _containers[category];
+        container.erase(std::remove_if(container.begin(), container.end(),
+            [categoryFlag](const SceneBody* body) -> bool {
+                return (body->categoryMask & categoryFlag) == 0;
+            }),
+            container.end());
+    }
     
- 
+    auto& detached = batch._detached;
+    _bodies.erase(std::remove_if(_bodies.begin(), _bodies.end(),
+        [&detached](const SceneBody* body) -> bool {
+            return std::binary_search(detached.begin(), detached.end(), body,
+                                      sceneBodyEntityLess);
+        }),
+        _bodies.end());
+}
+
+void Scene::applyBatchAttaches(SceneBatch& batch)
+{
+    auto& attaches = batch._attaches;
+    std::sort(attaches.begin(), attaches.end(),
+        [](const SceneBatch::Attach& a0, const SceneBatch::Attach& a1) -> bool {
+            return a0.body->entity < a1.body->entity;
+        });
+    
+    const auto bodiesEnd = _bodies.size();
+    std::array<size_t, SceneBody::kNumCategories> containerEnds;
+    for (size_t i = 0; i < containerEnds.size(); ++i) {
+        containerEnds[i] = _containers[i].size();
+    }
+    
+    //  append to the containers in entity order, then merge once.  rejected
+    //  attaches are dropped from the list, leaving the bodies attached
+    const uint32_t kAllCategoriesMask = (1 << SceneBody::kNumCategories) - 1;
+    const SceneBody* prevBody = nullptr;
+    size_t attachedCount = 0;
+    for (auto& attach : attaches) {
+        SceneBody* body = attach.body;
+        if (prevBody && prevBody->entity == body->entity) {
+            CK_ASSERT(false);
+            continue;
+        }
+        auto it = std::lower_bound(_bodies.begin(), _bodies.begin() + bodiesEnd,
+                                   body, sceneBodyEntityLess);
+        if (it != _bodies.begin() + bodiesEnd && (*it)->entity == body->entity) {
+            CK_ASSERT(false);
+            continue;
+        }
+        prevBody = body;
+        
+        prepareBodyForAttach(body);
+        body->categoryMask = attach.categoryMask & kAllCategoriesMask;
+        
+        for (uint32_t category = 0; category < SceneBody::kNumCategories; ++category) {
+            if ((body->categoryMask & (1 << category)) != 0) {
+                _containers[category].push_back(body);
+            }
+        }
+        _bodies.push_back(body);
+        
+        addBodyToBtWorld(body);
+        wakeBody(body);
         
- 
+        attaches[attachedCount++] = attach;
+    }
+    attaches.resize(attachedCount);
+    
+    std::inplace_merge(_bodies.begin(), _bodies.begin() + bodiesEnd, _bodies.end(),
+                       sceneBodyEntityLess);
+    for (size_t i = 0; i < containerEnds.size(); ++i) {
+        auto& container = _containers[i];
+        if (container.size() > containerEnds[i]) {
+            std::inplace_merge(container.begin(), container.begin() + containerEnds[i],
+                               container.end(), sceneBodyEntityLess);
+        }
+    }
+    
+    //  after merging, so that listeners may look up the new bodies
+    if (!_listeners.empty()) {
+        for (auto& attach : attaches) {
+            for (auto listener : _listeners) {
+                listener->onSceneBodyAttached(attach.body);
+            }
+        }
+    }
 }
- */
+
+void Scene::applyBatchCategoryChanges(SceneBatch& batch)
+{
+    auto& changes = batch._categoryChanges;
+    std::stable_sort(changes.begin(), changes.end(),
+        [](const SceneBatch::CategoryChange& c0, const SceneBatch::CategoryChange& c1) -> bool {
+            return c0.entity < c1.entity;
+        });
+    
+    //  resolve each body's final mask.  bodies are collected in entity order
+    //  along with their prior masks
+    struct ChangedBody
+    {
+        SceneBody* body;
+        uint32_t prevCategoryMask;
+    };
+    std::vector<ChangedBody> changedBodies;
+    
+    auto it = changes.begin();
+    while (it != changes.end()) {
+        const Entity entity = it->entity;
+        SceneBody* body = findBody(entity);
+        uint32_t categoryMask = body ? body->categoryMask : 0;
+        for (; it != changes.end() && it->entity == entity; ++it) {
+            if (it->category >= SceneBody::kNumCategories) {
+                CK_ASSERT(false);
+                continue;
+            }
+            if (it->add) {
+                categoryMask |= (1 << it->category);
+            }
+            else {
+                categoryMask &= ~(1 << it->category);
+            }
+        }
+        if (body && categoryMask != body->categoryMask) {
+            changedBodies.push_back({ body, body->categoryMask });
+            body->categoryMask = categoryMask;
+        }
+    }
+    
+    for (uint32_t category = 0; category < SceneBody::kNumCategories; ++category) {
+        const uint32_t categoryFlag = 1 << category;
+        auto& container = _containers[category];
+        const auto containerEnd = container.size();
+        bool removed = false;
+        for (auto& changed : changedBodies) {
+            const bool had = (changed.prevCategoryMask & categoryFlag) != 0;
+            const bool has = (changed.body->categoryMask & categoryFlag) != 0;
+            if (has && !had) {
+                container.push_back(changed.body);
+            }
+            else if (had && !has) {
+                removed = true;
+            }
+        }
+        if (container.size() > containerEnd) {
+            std::inplace_merge(container.begin(), container.begin() + containerEnd,
+                               container.end(), sceneBodyEntityLess);
+        }
+        if (removed) {
+            container.erase(std::remove_if(container.begin(), container.end(),
+                [categoryFlag](const SceneBody* body) -> bool {
+                    return (body->categoryMask & categoryFlag) == 0;
+                }),
+                container.end());
+        }
+    }
+    
+    for (auto& changed : changedBodies) {
+        updateBodyInBtWorld(changed.body);
+        for (auto listener : _listeners) {
+            listener->onSceneBodyCategoriesChanged(changed.body);
+        }
+    }
+}
+
     }   /* namespace ove */
 }   /* namespace cinek */
\ No newline at end of file
@@ -11,6 +11,8 @@
 #define Overview_Scene_hpp
 
 #include "SceneTypes.hpp"
+#include "SceneCharacterController.hpp"
+#include "SceneCollisionDispatcher.hpp"
 
 #include <cinek/objectpool.hpp>
 #include <cinek/allocator.hpp>
@@ -22,6 +24,55 @@
 namespace cinek {
     namespace ove {
     
+/**
+ *  @class  SceneBatch
+ *  @brief  Body attach, detach and category changes applied by the Scene
+ *          in one pass.
+ *
+ *  Scene::applyBatch applies detaches first, then attaches, then category
+ *  changes (which may refer to bodies attached by the same batch.)  Category
+ *  changes to an entity are applied in the order they were added.
+ */
+class SceneBatch
+{
+public:
+    void attach(SceneBody* body, uint32_t categoryMask);
+    void detach(Entity entity);
+    void addCategory(Entity entity, uint32_t category);
+    void removeCategory(Entity entity, uint32_t category);
+    
+    bool empty() const;
+    /**
+     *  Clears pending changes and the detached body list.  Capacity is
+     *  retained so that batches can be reused.
+     */
+    void clear();
+    /**
+     *  @return Bodies removed by the last applyBatch, sorted by entity.  The
+     *          caller owns these as with Scene::detachBody.
+     */
+    const std::vector<SceneBody*>& detachedBodies() const { return _detached; }
+    
+private:
+    friend class Scene;
+    
+    struct Attach
+    {
+        SceneBody* body;
+        uint32_t categoryMask;
+    };
+    struct CategoryChange
+    {
+        Entity entity;
+        uint32_t category;
+        bool add;
+    };
+    
+    std::vector<Attach> _attaches;
+    std::vector<Entity> _detaches;
+    std::vector<CategoryChange> _categoryChanges;
+    std::vector<SceneBody*> _detached;
+};
 
 /**
  *  @class  Scene
@@ -39,14 +90,25 @@ public:
     {
         int staticLimit;
         std::array<int, SceneBody::kNumCategories> limits;
+        //  bodies moving less than these per tick for sleepTicks ticks are
+        //  put to sleep
+        btScalar sleepLinearThreshold;
+        btScalar sleepAngularThreshold;
+        int sleepTicks;
+        //  runs narrow phase jobs on other threads.  if empty, collision
+        //  pairs are processed on the thread calling simulate
+        SceneJobRunner jobRunner;
         
         InitParams() {
             staticLimit = 0;
             limits.fill(0);
+            sleepLinearThreshold = btScalar(0.0005);
+            sleepAngularThreshold = btScalar(0.0005);
+            sleepTicks = 30;
         }
     };
         
-    Scene(const InitParams& initParams, btIDebugDraw* debugDrawer=nullptr);
+    Scene(const InitParams& initParams, SceneDebugDrawer* debugDrawer=nullptr);
     ~Scene();
 
     /**
@@ -75,6 +137,22 @@ public:
      *  @return Simulation activation status
      */
     bool isActive() const;
+    /**
+     *  @return The number of bodies simulated per tick (bodies that are not
+     *          sleeping.)
+     */
+    size_t awakeBodyCount() const { return _awakeBodies.size(); }
+    /**
+     *  Listeners may not be added or removed from within a notification.
+     *
+     *  @param  listener    Notified when bodies are attached, detached or
+     *                      change categories
+     */
+    void addListener(SceneListener* listener);
+    /**
+     *  @param  listener    A listener passed to addListener
+     */
+    void removeListener(SceneListener* listener);
     /**
      *   Adds a fixed body to the Scene.  The hull is managed by the Scene.
      */
@@ -83,6 +161,22 @@ public:
      *  Removes the body from the Scene.
      */
     SceneBody* detachBody(Entity entity);
+    /**
+     *  Moves a dynamic body as a kinematic character.  Rather than applying
+     *  its velocity directly, the Scene sweeps the body's character capsule
+     *  along its velocity each tick, sliding along obstacles and stepping
+     *  over ledges.  All characters are moved in one batch after other
+     *  bodies.
+     *
+     *  @param  entity  The body's entity
+     *  @param  params  The character's properties
+     *  @return The body, or null if not found
+     */
+    SceneBody* attachCharacter(Entity entity, const SceneCharacterParams& params);
+    /**
+     *  Returns the body to being moved directly by its velocity.
+     */
+    SceneBody* detachCharacter(Entity entity);
     /**
      *  @param  entity  What entity to find a body for
      */
@@ -95,6 +189,15 @@ public:
      *  Remove categories from a body
      */
     SceneBody* removeCategoryFromBody(Entity entity, uint32_t category);
+    /**
+     *  Applies a batch of changes.  Bodies are merged into the Scene's
+     *  containers in one pass, and category changes update collision
+     *  filters in place rather than re-adding bodies to the collision world.
+     *  The batch's changes are consumed.
+     *
+     *  @param  batch   The changes to apply
+     */
+    void applyBatch(SceneBatch& batch);
     /**
      *  Retrieve the closest hit point with a given ray.
      *  
@@ -107,6 +210,100 @@ public:
         btScalar dist,
         uint16_t includeFilters = SceneBody::kAllFilter,
         uint16_t excludeFilters = 0) const;
+    /**
+     *  Sweeps a convex shape through the scene, retrieving every body hit
+     *  along the way.  Hits are sorted nearest first, one per body.  If
+     *  there are more hits than the buffer holds, the nearest are kept.
+     *
+     *  @param  shape       The shape to sweep
+     *  @param  from        The shape's starting transform
+     *  @param  to          The shape's ending transform (rotation is
+     *                      interpolated)
+     *  @param  hits        The buffer receiving hits
+     *  @param  hitLimit    The hit buffer's capacity
+     *  @return The number of hits written
+     */
+    int convexCast(const btConvexShape& shape,
+        const btTransform& from,
+        const btTransform& to,
+        SceneShapeCastHit* hits,
+        int hitLimit,
+        uint16_t includeFilters = SceneBody::kAllFilter,
+        uint16_t excludeFilters = 0) const;
+    /**
+     *  Sweeps a sphere.  See convexCast.
+     */
+    int sphereCast(const btVector3& from,
+        const btVector3& to,
+        btScalar radius,
+        SceneShapeCastHit* hits,
+        int hitLimit,
+        uint16_t includeFilters = SceneBody::kAllFilter,
+        uint16_t excludeFilters = 0) const;
+    /**
+     *  Sweeps an upright (Y axis) capsule.  See convexCast.
+     *
+     *  @param  height      The distance between the capsule's end caps
+     */
+    int capsuleCast(const btVector3& from,
+        const btVector3& to,
+        btScalar radius,
+        btScalar height,
+        SceneShapeCastHit* hits,
+        int hitLimit,
+        uint16_t includeFilters = SceneBody::kAllFilter,
+        uint16_t excludeFilters = 0) const;
+    /**
+     *  Sweeps an oriented box.  See convexCast.
+     */
+    int boxCast(const btVector3& from,
+        const btVector3& to,
+        const btVector3& halfExtents,
+        const btQuaternion& rotation,
+        SceneShapeCastHit* hits,
+        int hitLimit,
+        uint16_t includeFilters = SceneBody::kAllFilter,
+        uint16_t excludeFilters = 0) const;
+    /**
+     *  Retrieves bodies touching a convex shape.  Bodies are sorted by
+     *  entity.  If there are more bodies than the buffer holds, those with
+     *  the lowest entity values are kept.
+     *
+     *  Overlap tests use the collision dispatcher, so unlike casts they
+     *  must not run concurrently with other overlap tests or simulate.
+     *
+     *  @param  shape       The shape to test
+     *  @param  transform   The shape's transform
+     *  @param  bodies      The buffer receiving bodies
+     *  @param  bodyLimit   The body buffer's capacity
+     *  @return The number of bodies written
+     */
+    int overlapConvex(const btConvexShape& shape,
+        const btTransform& transform,
+        SceneBody** bodies,
+        int bodyLimit,
+        uint16_t includeFilters = SceneBody::kAllFilter,
+        uint16_t excludeFilters = 0);
+    /**
+     *  Retrieves bodies touching a sphere.  See overlapConvex.
+     */
+    int overlapSphere(const btVector3& center,
+        btScalar radius,
+        SceneBody** bodies,
+        int bodyLimit,
+        uint16_t includeFilters = SceneBody::kAllFilter,
+        uint16_t excludeFilters = 0);
+    /**
+     *  Retrieves bodies whose bounding boxes overlap the box.  This tests
+     *  the broadphase only, so it's cheaper (and coarser) than the other
+     *  overlap tests.  See overlapConvex.
+     */
+    int overlapAABB(const btVector3& aabbMin,
+        const btVector3& aabbMax,
+        SceneBody** bodies,
+        int bodyLimit,
+        uint16_t includeFilters = SceneBody::kAllFilter,
+        uint16_t excludeFilters = 0);
     
     /**
      *  Retrieve body objects using a filter and category mask.
@@ -115,13 +312,37 @@ public:
      */
     template<typename Fn>
     void iterateBodies(uint32_t catagoryMask, Fn filterFn) const;
+    
+    /**
+     *  Contacts that began, persisted or ended over the last simulate.
+     *  Records are sorted by entity pair, so their order doesn't depend on
+     *  the order bodies were attached.  Includes hits from continuous
+     *  collision sweeps (see SceneBody::setContinuousCollision), which have
+     *  zero depth.
+     *
+     *  @return The contact records
+     */
+    const std::vector<SceneContact>& contacts() const { return _contacts; }
+    /**
+     *  Retrieve contacts from the last simulate involving a body in one of
+     *  the categories in the mask.  The function should have the following
+     *  prototype:
+     *      fn(const SceneContact& contact)
+     */
+    template<typename Fn>
+    void iterateContacts(uint32_t categoryMask, Fn fn) const;
         
     /**
-     *  Executes per render frame updates.
+     *  Executes per render frame updates.  Static bodies are drawn from
+     *  lines cached by the debug drawer, which are rebuilt when a static
+     *  body is attached, detached or moved.
      */
     void debugRender();
     
 private:
+    friend struct SceneBody;
+    friend class SceneQueryService;
+    
     using SceneBodyContainer = std::vector<SceneBody*>;
     
     SceneBodyContainer _bodies;
@@ -137,15 +358,64 @@ private:
     SceneBody* addCategoryToBody(SceneBody* body, uint32_t category);
     SceneBody* removeCategoryFromBody(SceneBody* body, uint32_t category);
     
+    void prepareBodyForAttach(SceneBody* body);
+    void applyBatchDetaches(SceneBatch& batch);
+    void applyBatchAttaches(SceneBatch& batch);
+    void applyBatchCategoryChanges(SceneBatch& batch);
+    
+    //  running queries read the broadphase, and bodies' shapes and
+    //  transforms.  called before any of those change
+    void waitForQueries();
     void addBodyToBtWorld(SceneBody* body);
     void removeBodyFromBtWorld(SceneBody* body);
+    //  waits for queries once, then removes the bodies in one pass
+    void removeBodiesFromBtWorld(const std::vector<SceneBody*>& bodies);
+    void updateBodyInBtWorld(SceneBody* body);
+    
+    void updateContacts();
+    //  returns where the body's origin stops, and removes the body's
+    //  velocity into any surface hit
+    btVector3 sweepBody(SceneBody* body, const btVector3& from, const btVector3& to);
+    void addSweptContacts();
+    
+    void debugDrawBody(SceneBody* body, const btVector3& color);
+    void invalidateStaticDebug(SceneBody* body);
+    
+    void wakeBody(SceneBody* body);
+    void sleepBody(SceneBody* body);
+    void removeAwakeBody(SceneBody* body);
     
     bool _simulateDynamics;
     
-    btDefaultCollisionConfiguration _btCollisionConfig;
-    btCollisionDispatcher _btCollisionDispatcher;
+    //  bodies whose collision bounds are refreshed each tick, in no
+    //  particular order.  dynamic bodies in this list are simulated
+    SceneBodyContainer _awakeBodies;
+    btScalar _sleepLinearThreshold2;
+    btScalar _sleepAngularThreshold2;
+    uint32_t _sleepTicks;
+    
+    //  touching pairs from this and the prior tick, sorted by entity pair
+    std::vector<SceneContact> _contactPairs;
+    std::vector<SceneContact> _prevContactPairs;
+    std::vector<SceneContact> _contacts;
+    //  hits from this tick's continuous collision sweeps
+    std::vector<SceneContact> _sweptContacts;
+    
+    SceneCollisionConfiguration _btCollisionConfig;
+    SceneCollisionDispatcher _btCollisionDispatcher;
     btDbvtBroadphase _btBroadphase;
     btCollisionWorld _btWorld;
+    
+    SceneCharacterController _characters;
+    //  characters moved this tick
+    SceneBodyContainer _characterMoves;
+    
+    SceneDebugDrawer* _debugDrawer;
+    bool _staticDebugChanged;
+    
+    //  reads body shapes from job threads
+    SceneQueryService* _queryService;
+    std::vector<SceneListener*> _listeners;
 };
 
 template<typename Fn>
@@ -195,6 +465,21 @@ const
     }
 }
 
+template<typename Fn>
+void Scene::iterateContacts
+(
+    uint32_t categoryMask,
+    Fn fn
+)
+const
+{
+    for (auto& contact : _contacts) {
+        if (((contact.categoryMaskA | contact.categoryMaskB) & categoryMask) != 0) {
+            fn(contact);
+        }
+    }
+}
+
     
     } /* namespace ove */
 } /* namespace cinek  */
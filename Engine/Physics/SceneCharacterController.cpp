@@ -0,0 +1,249 @@
+//
+//  SceneCharacterController.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#include "SceneCharacterController.hpp"
+#include "SceneMotionState.hpp"
+#include "Engine/Profiler.hpp"
+
+#include <bullet/btBulletCollisionCommon.h>
+
+#include <algorithm>
+
+namespace cinek {
+    namespace ove {
+
+//  gap kept between a character and the surfaces it stops against, so the
+//  next tick's sweeps don't start in contact
+static const btScalar kSkinWidth = btScalar(0.01);
+static const int kSlideIterations = 3;
+
+struct SceneCharacterSweepCallback : btCollisionWorld::ClosestConvexResultCallback
+{
+    const btCollisionObject* self;
+    btVector3 direction;
+    
+    SceneCharacterSweepCallback
+    (
+        const btCollisionObject* self,
+        const btVector3& from,
+        const btVector3& to
+    ) :
+        btCollisionWorld::ClosestConvexResultCallback(from, to),
+        self(self),
+        direction(to - from)
+    {
+        //  characters walk through staged (editor) bodies
+        m_collisionFilterGroup = SceneBody::kDefaultFilter;
+        m_collisionFilterMask = SceneBody::kAllFilter ^ SceneBody::kStagingFilter;
+    }
+    
+    btScalar addSingleResult
+    (
+        btCollisionWorld::LocalConvexResult& result,
+        bool normalInWorldSpace
+    )
+    override
+    {
+        if (result.m_hitCollisionObject == self)
+            return m_closestHitFraction;
+        
+        btVector3 normal = result.m_hitNormalLocal;
+        if (!normalInWorldSpace) {
+            normal = result.m_hitCollisionObject->getWorldTransform().getBasis() * normal;
+        }
+        //  surfaces the sweep moves along or away from (i.e. the ground
+        //  while walking) don't block it
+        if (normal.dot(direction) >= 0)
+            return m_closestHitFraction;
+        
+        return btCollisionWorld::ClosestConvexResultCallback::addSingleResult(
+            result, normalInWorldSpace);
+    }
+};
+
+//  distance travelled by a sweep of the given length, stopping short of
+//  any hit by the skin width
+static btScalar sweepDistance(btScalar fraction, btScalar length)
+{
+    if (fraction >= btScalar(1))
+        return length;
+    return std::max(fraction * length - kSkinWidth, btScalar(0));
+}
+
+SceneCharacterController::SceneCharacterController(btCollisionWorld& world) :
+    _world(world)
+{
+}
+
+SceneCharacterController::~SceneCharacterController()
+{
+}
+
+const btCapsuleShape* SceneCharacterController::acquireShape
+(
+    btScalar radius,
+    btScalar height
+)
+{
+    for (auto& shape : _shapes) {
+        if (shape->getRadius() == radius && shape->getHalfHeight()*2 == height)
+            return shape.get();
+    }
+    _shapes.emplace_back(new btCapsuleShape(radius, height));
+    return _shapes.back().get();
+}
+
+void SceneCharacterController::attach
+(
+    SceneBody* body,
+    const SceneCharacterParams& params
+)
+{
+    Character character;
+    character.body = body;
+    character.params = params;
+    character.shape = acquireShape(params.radius, params.height);
+    
+    if (body->characterIndex >= 0) {
+        _characters[body->characterIndex] = character;
+    }
+    else {
+        body->characterIndex = (int32_t)_characters.size();
+        _characters.push_back(character);
+    }
+}
+
+void SceneCharacterController::detach(SceneBody* body)
+{
+    if (body->characterIndex < 0)
+        return;
+    
+    Character& last = _characters.back();
+    last.body->characterIndex = body->characterIndex;
+    _characters[body->characterIndex] = last;
+    _characters.pop_back();
+    body->characterIndex = -1;
+}
+
+btScalar SceneCharacterController::sweep
+(
+    const Character& character,
+    const btVector3& from,
+    const btVector3& to,
+    btVector3* hitNormal
+)
+const
+{
+    if ((to - from).fuzzyZero())
+        return btScalar(1);
+    
+    SceneCharacterSweepCallback cb(character.body->btBody, from, to);
+    _world.convexSweepTest(character.shape,
+                           btTransform(btQuaternion::getIdentity(), from),
+                           btTransform(btQuaternion::getIdentity(), to),
+                           cb);
+    if (!cb.hasHit())
+        return btScalar(1);
+    
+    if (hitNormal) {
+        *hitNormal = cb.m_hitNormalWorld;
+    }
+    return cb.m_closestHitFraction;
+}
+
+btTransform SceneCharacterController::moveCharacter
+(
+    const Character& character
+)
+const
+{
+    const SceneBody* body = character.body;
+    const SceneCharacterParams& params = character.params;
+    const btTransform& transform = body->btBody->getWorldTransform();
+    const btVector3 up(0, 1, 0);
+    
+    const btVector3& displacement = body->linearVelocity;
+    const btScalar climb = displacement.dot(up);
+    
+    //  capsule center
+    btVector3 position = transform.getOrigin() + up * params.centerHeight;
+    
+    //  step up, so that the slide passes over ledges below the step height
+    btScalar fraction = sweep(character, position, position + up * params.stepHeight,
+                              nullptr);
+    const btScalar steppedUp = sweepDistance(fraction, params.stepHeight);
+    position += up * steppedUp;
+    
+    //  slide horizontally along obstacles
+    btVector3 remaining = displacement - up * climb;
+    for (int i = 0; i < kSlideIterations && !remaining.fuzzyZero(); ++i) {
+        btVector3 normal;
+        const btScalar length = remaining.length();
+        fraction = sweep(character, position, position + remaining, &normal);
+        position += remaining * (sweepDistance(fraction, length) / length);
+        if (fraction >= btScalar(1))
+            break;
+        
+        remaining *= (btScalar(1) - fraction);
+        normal -= up * normal.dot(up);
+        if (normal.fuzzyZero())
+            break;
+        normal.normalize();
+        remaining -= normal * remaining.dot(normal);
+    }
+    
+    //  step down onto walkable ground, or follow the intended climb if
+    //  there's none within a step
+    const btScalar rise = climb - steppedUp;
+    if (rise > 0) {
+        fraction = sweep(character, position, position + up * rise, nullptr);
+        position += up * sweepDistance(fraction, rise);
+    }
+    else {
+        const btScalar fall = -rise;
+        const btScalar drop = fall + params.stepHeight;
+        btVector3 normal;
+        fraction = sweep(character, position, position - up * drop, &normal);
+        btScalar distance = sweepDistance(fraction, drop);
+        if (fraction >= btScalar(1) || normal.dot(up) < params.maxSlopeCos) {
+            distance = std::min(distance, fall);
+        }
+        position -= up * distance;
+    }
+    
+    btTransform result(transform.getBasis(), position - up * params.centerHeight);
+    if (!body->angularVelocity.fuzzyZero()) {
+        btVector3 rotAxis = body->angularVelocity.normalized();
+        btScalar rotAngle = body->angularVelocity.length();
+        btMatrix3x3 rotMtx(btQuaternion(rotAxis, rotAngle));
+        result.setBasis(rotMtx * transform.getBasis());
+    }
+    return result;
+}
+
+void SceneCharacterController::move(const std::vector<SceneBody*>& bodies)
+{
+    OVENGINE_PROFILE_ZONE("SceneCharacterController::move");
+    
+    _results.resize(bodies.size());
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        _results[i] = moveCharacter(_characters[bodies[i]->characterIndex]);
+    }
+    
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        SceneBody* body = bodies[i];
+        //  updates revision
+        body->btBody->setWorldTransform(_results[i]);
+        if (body->motionState) {
+            body->motionState->setWorldTransform(_results[i]);
+        }
+    }
+}
+
+    } /* namespace ove */
+} /* namespace cinek */
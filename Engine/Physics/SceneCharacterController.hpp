@@ -0,0 +1,83 @@
+//
+//  SceneCharacterController.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#ifndef Overview_SceneCharacterController_hpp
+#define Overview_SceneCharacterController_hpp
+
+#include "SceneTypes.hpp"
+
+#include <bullet/LinearMath/btTransform.h>
+
+#include <memory>
+#include <vector>
+
+class btCapsuleShape;
+class btCollisionWorld;
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  @class  SceneCharacterController
+ *  @brief  Moves kinematic characters through a collision world.
+ *
+ *  Each character's per-tick velocity is swept as an upright capsule.  The
+ *  capsule steps up, slides along obstacles and steps back down onto
+ *  walkable ground.  Characters are moved as a batch - all sweeps see the
+ *  other characters at their positions from the start of the batch, and
+ *  results are written back (through the body's motion state) once every
+ *  character has been swept.
+ */
+class SceneCharacterController
+{
+    CK_CLASS_NON_COPYABLE(SceneCharacterController);
+    
+public:
+    SceneCharacterController(btCollisionWorld& world);
+    ~SceneCharacterController();
+    
+    /**
+     *  @param  body        The body to move as a character
+     *  @param  params      The character's capsule and stepping properties
+     */
+    void attach(SceneBody* body, const SceneCharacterParams& params);
+    /**
+     *  @param  body        The body to stop moving as a character
+     */
+    void detach(SceneBody* body);
+    /**
+     *  Moves characters by their velocities.
+     *
+     *  @param  bodies      Character bodies to move
+     */
+    void move(const std::vector<SceneBody*>& bodies);
+    
+private:
+    struct Character
+    {
+        SceneBody* body;
+        SceneCharacterParams params;
+        const btCapsuleShape* shape;
+    };
+    
+    const btCapsuleShape* acquireShape(btScalar radius, btScalar height);
+    btScalar sweep(const Character& character, const btVector3& from,
+                   const btVector3& to, btVector3* hitNormal) const;
+    btTransform moveCharacter(const Character& character) const;
+    
+    btCollisionWorld& _world;
+    std::vector<Character> _characters;
+    //  shared by characters with the same dimensions
+    std::vector<std::unique_ptr<btCapsuleShape>> _shapes;
+    std::vector<btTransform> _results;
+};
+
+    } /* namespace ove */
+} /* namespace cinek */
+
+#endif /* Overview_SceneCharacterController_hpp */
@@ -0,0 +1,240 @@
+//
+//  SceneCollisionDispatcher.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#include "SceneCollisionDispatcher.hpp"
+#include "Engine/Profiler.hpp"
+#include "Engine/MemoryTracker.hpp"
+
+#include <bullet/BulletCollision/CollisionDispatch/btConvexConvexAlgorithm.h>
+#include <bullet/BulletCollision/NarrowPhaseCollision/btVoronoiSimplexSolver.h>
+
+#include <algorithm>
+#include <new>
+
+namespace cinek {
+    namespace ove {
+
+//  below this many pairs, job overhead outweighs the gain
+static const int kParallelPairThreshold = 128;
+static const int kPairsPerJob = 32;
+
+#if BT_BULLET_VERSION < 285
+
+//  later Bullet versions keep the simplex solver local to processCollision
+class SceneConvexConvexAlgorithm : public btConvexConvexAlgorithm
+{
+public:
+    SceneConvexConvexAlgorithm
+    (
+        btPersistentManifold* manifold,
+        const btCollisionAlgorithmConstructionInfo& ci,
+        const btCollisionObjectWrapper* body0Wrap,
+        const btCollisionObjectWrapper* body1Wrap,
+        const btConvexConvexAlgorithm::CreateFunc& params
+    ) :
+        //  the base only stores the solver's address during construction
+        btConvexConvexAlgorithm(manifold, ci, body0Wrap, body1Wrap,
+                                &_simplexSolver,
+                                params.m_pdSolver,
+                                params.m_numPerturbationIterations,
+                                params.m_minimumPointsPerturbationThreshold)
+    {
+    }
+
+private:
+    btVoronoiSimplexSolver _simplexSolver;
+};
+
+class SceneConvexConvexCreateFunc : public btCollisionAlgorithmCreateFunc
+{
+public:
+    SceneConvexConvexCreateFunc(const btConvexConvexAlgorithm::CreateFunc* params) :
+        _params(params)
+    {
+    }
+
+    btCollisionAlgorithm* CreateCollisionAlgorithm
+    (
+        btCollisionAlgorithmConstructionInfo& ci,
+        const btCollisionObjectWrapper* body0Wrap,
+        const btCollisionObjectWrapper* body1Wrap
+    )
+    override
+    {
+        void* mem = ci.m_dispatcher1->allocateCollisionAlgorithm(
+            sizeof(SceneConvexConvexAlgorithm));
+        return new(mem) SceneConvexConvexAlgorithm(ci.m_manifold, ci,
+                                                   body0Wrap, body1Wrap,
+                                                   *_params);
+    }
+
+private:
+    //  owned by the configuration - multipoint iteration settings are
+    //  read from here
+    const btConvexConvexAlgorithm::CreateFunc* _params;
+};
+
+static btDefaultCollisionConstructionInfo collisionConstructionInfo()
+{
+    btDefaultCollisionConstructionInfo info;
+    info.m_customCollisionAlgorithmMaxElementSize = sizeof(SceneConvexConvexAlgorithm);
+    return info;
+}
+
+SceneCollisionConfiguration::SceneCollisionConfiguration() :
+    btDefaultCollisionConfiguration(collisionConstructionInfo()),
+    _convexConvexCreateFunc(new SceneConvexConvexCreateFunc(
+        static_cast<btConvexConvexAlgorithm::CreateFunc*>(m_convexConvexCreateFunc)))
+{
+}
+
+#else
+
+SceneCollisionConfiguration::SceneCollisionConfiguration() :
+    _convexConvexCreateFunc(nullptr)
+{
+}
+
+#endif
+
+SceneCollisionConfiguration::~SceneCollisionConfiguration()
+{
+    delete _convexConvexCreateFunc;
+}
+
+btCollisionAlgorithmCreateFunc* SceneCollisionConfiguration::getCollisionAlgorithmCreateFunc
+(
+    int proxyType0,
+    int proxyType1
+)
+{
+    btCollisionAlgorithmCreateFunc* createFunc =
+        btDefaultCollisionConfiguration::getCollisionAlgorithmCreateFunc(
+            proxyType0, proxyType1);
+    if (_convexConvexCreateFunc && createFunc == m_convexConvexCreateFunc)
+        return _convexConvexCreateFunc;
+    return createFunc;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SceneCollisionDispatcher::SceneCollisionDispatcher
+(
+    btCollisionConfiguration* config
+) :
+    btCollisionDispatcher(config)
+{
+}
+
+void SceneCollisionDispatcher::setJobRunner(SceneJobRunner runner)
+{
+    _jobRunner = std::move(runner);
+}
+
+void SceneCollisionDispatcher::dispatchAllCollisionPairs
+(
+    btOverlappingPairCache* pairCache,
+    const btDispatcherInfo& dispatchInfo,
+    btDispatcher* dispatcher
+)
+{
+    const int pairCount = pairCache->getNumOverlappingPairs();
+    if (!_jobRunner || pairCount < kParallelPairThreshold) {
+        btCollisionDispatcher::dispatchAllCollisionPairs(pairCache, dispatchInfo,
+                                                         dispatcher);
+        //  a serial dispatch still leaves manifolds in creation order, which
+        //  differs from the threaded path's
+        orderManifolds(pairCache);
+        return;
+    }
+
+    OVENGINE_PROFILE_ZONE("SceneCollisionDispatcher::dispatch");
+
+    //  the pair cache isn't modified during dispatch - pairs are only
+    //  removed by the broadphase or when bodies leave the world
+    btBroadphasePair* pairs = pairCache->getOverlappingPairArrayPtr();
+    btNearCallback nearCallback = getNearCallback();
+    const uint32_t jobCount = (uint32_t)((pairCount + kPairsPerJob - 1) / kPairsPerJob);
+
+    _jobRunner(jobCount,
+        [this, pairs, pairCount, nearCallback, &dispatchInfo](uint32_t job) {
+            OVENGINE_PROFILE_ZONE("SceneCollisionDispatcher::job");
+            OVENGINE_MEMORY_TAG(kMemoryTagScene);
+
+            const int begin = (int)job * kPairsPerJob;
+            const int end = std::min(begin + kPairsPerJob, pairCount);
+            for (int i = begin; i < end; ++i) {
+                nearCallback(pairs[i], *this, dispatchInfo);
+            }
+        });
+
+    orderManifolds(pairCache);
+}
+
+void SceneCollisionDispatcher::orderManifolds(btOverlappingPairCache* pairCache)
+{
+    //  jobs create and release manifolds in whatever order they run.  place
+    //  them in pair order so that consumers (contact generation, the debug
+    //  drawer) see the same sequence every run, threaded or not
+    btPersistentManifold** manifolds = getInternalManifoldPointer();
+    btBroadphasePair* pairs = pairCache->getOverlappingPairArrayPtr();
+    const int pairCount = pairCache->getNumOverlappingPairs();
+    int next = 0;
+
+    for (int i = 0; i < pairCount; ++i) {
+        btCollisionAlgorithm* algorithm = pairs[i].m_algorithm;
+        if (!algorithm)
+            continue;
+
+        _pairManifolds.resize(0);
+        algorithm->getAllContactManifolds(_pairManifolds);
+        for (int j = 0; j < _pairManifolds.size(); ++j) {
+            btPersistentManifold* manifold = _pairManifolds[j];
+            const int index = manifold->m_index1a;
+            //  already placed
+            if (index < next)
+                continue;
+
+            std::swap(manifolds[next], manifolds[index]);
+            manifolds[index]->m_index1a = index;
+            manifold->m_index1a = next;
+            ++next;
+        }
+    }
+}
+
+btPersistentManifold* SceneCollisionDispatcher::getNewManifold
+(
+    const btCollisionObject* body0,
+    const btCollisionObject* body1
+)
+{
+    std::lock_guard<std::mutex> lock(_allocMutex);
+    return btCollisionDispatcher::getNewManifold(body0, body1);
+}
+
+void SceneCollisionDispatcher::releaseManifold(btPersistentManifold* manifold)
+{
+    std::lock_guard<std::mutex> lock(_allocMutex);
+    btCollisionDispatcher::releaseManifold(manifold);
+}
+
+void* SceneCollisionDispatcher::allocateCollisionAlgorithm(int size)
+{
+    std::lock_guard<std::mutex> lock(_allocMutex);
+    return btCollisionDispatcher::allocateCollisionAlgorithm(size);
+}
+
+void SceneCollisionDispatcher::freeCollisionAlgorithm(void* ptr)
+{
+    std::lock_guard<std::mutex> lock(_allocMutex);
+    btCollisionDispatcher::freeCollisionAlgorithm(ptr);
+}
+
+    }  /* namespace ove */
+}  /* namespace cinek */
@@ -0,0 +1,107 @@
+//
+//  SceneCollisionDispatcher.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#ifndef Overview_SceneCollisionDispatcher_hpp
+#define Overview_SceneCollisionDispatcher_hpp
+
+#include "SceneTypes.hpp"
+
+#include <bullet/btBulletCollisionCommon.h>
+
+#include <functional>
+#include <mutex>
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  Runs count jobs, invoking job(index) for each, and returns once all
+ *  have finished.  Typically wraps JobSystem::parallelFor.
+ */
+using SceneJobRunner =
+    std::function<void(uint32_t, const std::function<void(uint32_t)>&)>;
+
+/**
+ *  @class  SceneCollisionConfiguration
+ *  @brief  Bullet's default collision configuration, with convex algorithms
+ *          that can run on multiple threads.
+ *
+ *  Older Bullet versions share one simplex solver among all convex-convex
+ *  algorithms.  Here each algorithm owns its solver so that pairs can be
+ *  processed concurrently.
+ */
+class SceneCollisionConfiguration : public btDefaultCollisionConfiguration
+{
+public:
+    SceneCollisionConfiguration();
+    ~SceneCollisionConfiguration();
+
+    btCollisionAlgorithmCreateFunc* getCollisionAlgorithmCreateFunc
+    (
+        int proxyType0,
+        int proxyType1
+    ) override;
+
+private:
+    btCollisionAlgorithmCreateFunc* _convexConvexCreateFunc;
+};
+
+/**
+ *  @class  SceneCollisionDispatcher
+ *  @brief  Runs the narrow phase across threads using a SceneJobRunner.
+ *
+ *  Overlapping pairs are split into jobs, each processing a contiguous range
+ *  of the pair cache.  Pairs own their algorithms and manifolds, so jobs
+ *  only contend when allocating or releasing these (which is serialized.)
+ *  Collision shapes (i.e. those owned by the SceneDataContext) are read but
+ *  never modified during the narrow phase.
+ *
+ *  Without a runner, or with few pairs, pairs are processed serially.
+ *  Either way manifolds are then reordered to follow the pair cache, so
+ *  their order doesn't depend on the path taken or on how jobs were
+ *  scheduled.
+ */
+class SceneCollisionDispatcher : public btCollisionDispatcher
+{
+public:
+    SceneCollisionDispatcher(btCollisionConfiguration* config);
+
+    /**
+     *  @param  runner      Runs narrow phase jobs.  An empty runner disables
+     *                      threaded dispatch.
+     */
+    void setJobRunner(SceneJobRunner runner);
+
+    void dispatchAllCollisionPairs
+    (
+        btOverlappingPairCache* pairCache,
+        const btDispatcherInfo& dispatchInfo,
+        btDispatcher* dispatcher
+    ) override;
+
+    btPersistentManifold* getNewManifold
+    (
+        const btCollisionObject* body0,
+        const btCollisionObject* body1
+    ) override;
+    void releaseManifold(btPersistentManifold* manifold) override;
+    void* allocateCollisionAlgorithm(int size) override;
+    void freeCollisionAlgorithm(void* ptr) override;
+
+private:
+    void orderManifolds(btOverlappingPairCache* pairCache);
+
+    SceneJobRunner _jobRunner;
+    std::mutex _allocMutex;
+    btManifoldArray _pairManifolds;
+};
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#endif /* Overview_SceneCollisionDispatcher_hpp */
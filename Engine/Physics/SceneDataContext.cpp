@@ -24,14 +24,14 @@ namespace cinek {
     namespace ove {
 
 SceneDataContext::SceneDataContext(const InitParams& params) :
-    _triMeshPool(params.numTriMeshShapes),
-    _triMeshShapePool(params.numTriMeshShapes),
-    _cylinderShapePool(params.numCylinderShapes),
-    _boxShapePool(params.numBoxShapes),
-    _compoundShapePool(params.numBoxShapes + params.numCylinderShapes),
-    _bodyPool(params.numBodies),
-    _sceneBodyPool(params.numBodies),
-    _motionStatesPool(params.numBodies)
+    _triMeshPool("Fixed Body Hulls", kMemoryTagScene, params.numTriMeshShapes),
+    _triMeshShapePool("Triangle Mesh Shapes", kMemoryTagScene, params.numTriMeshShapes),
+    _cylinderShapePool("Cylinder Shapes", kMemoryTagScene, params.numCylinderShapes),
+    _boxShapePool("Box Shapes", kMemoryTagScene, params.numBoxShapes),
+    _compoundShapePool("Compound Shapes", kMemoryTagScene, params.numBoxShapes + params.numCylinderShapes),
+    _bodyPool("Collision Objects", kMemoryTagScene, params.numBodies),
+    _sceneBodyPool("Scene Bodies", kMemoryTagScene, params.numBodies),
+    _motionStatesPool("Motion States", kMemoryTagScene, params.numBodies)
 {
     _fixedBodyHulls.reserve(params.numTriMeshShapes);
 }
@@ -298,6 +298,8 @@ SceneBody* SceneDataContext::cloneBody
     */
     auto obj = _bodyPool.construct();
     obj->setCollisionShape(clonedShape);
+    obj->setCcdMotionThreshold(source->btBody->getCcdMotionThreshold());
+    obj->setCcdSweptSphereRadius(source->btBody->getCcdSweptSphereRadius());
     
     auto sceneObj = _sceneBodyPool.construct();
     sceneObj->btBody = obj;
@@ -14,7 +14,7 @@
 #include "SceneFixedBodyHull.hpp"
 #include "SceneMotionState.hpp"
 
-#include <cinek/objectpool.hpp>
+#include "Engine/TrackedObjectPool.hpp"
 
 #include <bullet/BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
 #include <bullet/BulletCollision/CollisionShapes/btBoxShape.h>
@@ -93,14 +93,14 @@ public:
     void freeMotionState(SceneMotionState* state);
     
 private:
-    ObjectPool<SceneFixedBodyHull> _triMeshPool;
-    ObjectPool<btBvhTriangleMeshShape> _triMeshShapePool;
-    ObjectPool<btCylinderShape> _cylinderShapePool;
-    ObjectPool<btBoxShape> _boxShapePool;
-    ObjectPool<btCompoundShape> _compoundShapePool;
-    ObjectPool<btCollisionObject> _bodyPool;
-    ObjectPool<SceneBody> _sceneBodyPool;
-    ObjectPool<SceneMotionState> _motionStatesPool;
+    TrackedObjectPool<SceneFixedBodyHull> _triMeshPool;
+    TrackedObjectPool<btBvhTriangleMeshShape> _triMeshShapePool;
+    TrackedObjectPool<btCylinderShape> _cylinderShapePool;
+    TrackedObjectPool<btBoxShape> _boxShapePool;
+    TrackedObjectPool<btCompoundShape> _compoundShapePool;
+    TrackedObjectPool<btCollisionObject> _bodyPool;
+    TrackedObjectPool<SceneBody> _sceneBodyPool;
+    TrackedObjectPool<SceneMotionState> _motionStatesPool;
     
     std::vector<SceneFixedBodyHull*> _fixedBodyHulls;
     
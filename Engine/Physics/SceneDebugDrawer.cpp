@@ -15,6 +15,8 @@
 
 #include <bgfx/bgfx.h>
 
+#include <algorithm>
+
 namespace cinek {
     namespace ove {
     
@@ -25,7 +27,9 @@ SceneDebugDrawer::SceneDebugDrawer() :
                btIDebugDraw::DBG_DrawAabb),
     _programs(nullptr),
     _uniforms(nullptr),
-    _camera(nullptr)
+    _camera(nullptr),
+    _recordingStatic(false),
+    _staticVB(BGFX_INVALID_HANDLE)
 {
     _lineBuffer.reserve(kLineBufferSize);
     _currentLineColor.setValue(0,0,0);
@@ -33,6 +37,9 @@ SceneDebugDrawer::SceneDebugDrawer() :
     
 SceneDebugDrawer::~SceneDebugDrawer()
 {
+    if (bgfx::isValid(_staticVB)) {
+        bgfx::destroyVertexBuffer(_staticVB);
+    }
 }
     
 void SceneDebugDrawer::drawLine
@@ -42,6 +49,34 @@ void SceneDebugDrawer::drawLine
     const btVector3& color1
 )
 {
+    if (_recordingStatic) {
+        //  there are only a few colors (i.e. wireframe and aabb)
+        auto batchIt = std::find_if(_staticBatches.begin(), _staticBatches.end(),
+            [&color1](const StaticLineBatch& batch) -> bool {
+                return batch.color == color1;
+            });
+        if (batchIt == _staticBatches.end()) {
+            StaticLineBatch batch;
+            batch.color = color1;
+            batch.firstVertex = 0;
+            batch.vertexCount = 0;
+            batchIt = _staticBatches.insert(batchIt, batch);
+        }
+        batchIt->vertexCount += 2;
+        _staticLineBatches.push_back((uint32_t)(batchIt - _staticBatches.begin()));
+        
+        gfx::Vector3 v;
+        v.x = from1.getX();
+        v.y = from1.getY();
+        v.z = from1.getZ();
+        _staticVertices.push_back(v);
+        v.x = to1.getX();
+        v.y = to1.getY();
+        v.z = to1.getZ();
+        _staticVertices.push_back(v);
+        return;
+    }
+    
     if (color1 != _currentLineColor || _lineBuffer.size() >= kLineBufferSize) {
         flushLines();
         _currentLineColor = color1;
@@ -117,16 +152,13 @@ void SceneDebugDrawer::flushLines()
 {
     CK_ASSERT_RETURN(_camera);
     
-    bgfx::setViewRect(_camera->viewIndex,
-        _camera->viewportRect.x, _camera->viewportRect.y,
-        _camera->viewportRect.w ,_camera->viewportRect.h);
+    if (_lineBuffer.empty())
+        return;
     
     if (_uniforms && _programs) {
         bgfx::TransientVertexBuffer linesTVB;
         bgfx::TransientIndexBuffer linesTIB;
         
-        gfx::Matrix4 mainTransform = gfx::Matrix4::kIdentity;
-        
          //  draw line buffer
         const bgfx::VertexDecl& vertexDecl =
                 gfx::VertexTypes::declaration(gfx::VertexTypes::kVPosition);
@@ -159,36 +191,105 @@ void SceneDebugDrawer::flushLines()
             *(sindices++) = vidx++;
         }
 
-        //  simple flat shader for lines
-        gfx::Color4 color;
-        color.r = _currentLineColor.getX();
-        color.g = _currentLineColor.getY();
-        color.b = _currentLineColor.getZ();
-        color.a = 0.50f;
-        
-        bgfx::setUniform((*_uniforms)[gfx::kNodeUniformColor], color);
-
-        bgfx::setViewTransform(_camera->viewIndex, _camera->viewMtx, _camera->projMtx);
-        bgfx::setTransform(mainTransform);
         bgfx::setVertexBuffer(&linesTVB, 0, (uint32_t)_lineBuffer.size() * 2);
         bgfx::setIndexBuffer(&linesTIB, 0, (uint32_t)_lineBuffer.size() * 2);
-
-        bgfx::setState(
-            BGFX_STATE_RGB_WRITE
-          | BGFX_STATE_ALPHA_WRITE
-          | BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA)
-          | BGFX_STATE_DEPTH_WRITE
-          | BGFX_STATE_DEPTH_TEST_LESS
-          | BGFX_STATE_PT_LINES
-          | BGFX_STATE_MSAA
-        );
-        
-        bgfx::submit(_camera->viewIndex, (*_programs)[gfx::kNodeProgramFlat]);
+        submitLines(_currentLineColor);
     }
     
     _lineBuffer.clear();
 }
 
+void SceneDebugDrawer::beginStaticLines()
+{
+    //  pending dynamic lines would otherwise mix with the static set
+    flushLines();
+    
+    _recordingStatic = true;
+    _staticVertices.clear();
+    _staticLineBatches.clear();
+    _staticBatches.clear();
+}
+
+void SceneDebugDrawer::endStaticLines()
+{
+    _recordingStatic = false;
+    
+    if (bgfx::isValid(_staticVB)) {
+        bgfx::destroyVertexBuffer(_staticVB);
+        _staticVB = BGFX_INVALID_HANDLE;
+    }
+    if (!_staticVertices.empty()) {
+        //  lines were recorded in draw order - place each color's lines
+        //  together, using vertexCount as the batch's write cursor
+        uint32_t firstVertex = 0;
+        for (auto& batch : _staticBatches) {
+            batch.firstVertex = firstVertex;
+            firstVertex += batch.vertexCount;
+            batch.vertexCount = 0;
+        }
+        const bgfx::Memory* mem = bgfx::alloc(
+            (uint32_t)(_staticVertices.size() * sizeof(gfx::Vector3)));
+        gfx::Vector3* vertices = reinterpret_cast<gfx::Vector3*>(mem->data);
+        for (size_t line = 0; line < _staticLineBatches.size(); ++line) {
+            StaticLineBatch& batch = _staticBatches[_staticLineBatches[line]];
+            gfx::Vector3* dest = vertices + batch.firstVertex + batch.vertexCount;
+            dest[0] = _staticVertices[line*2];
+            dest[1] = _staticVertices[line*2 + 1];
+            batch.vertexCount += 2;
+        }
+        _staticVB = bgfx::createVertexBuffer(mem,
+            gfx::VertexTypes::declaration(gfx::VertexTypes::kVPosition));
+    }
+    _staticVertices.clear();
+    _staticLineBatches.clear();
+}
+
+void SceneDebugDrawer::drawStaticLines()
+{
+    CK_ASSERT_RETURN(_camera);
+    
+    if (!bgfx::isValid(_staticVB) || !_uniforms || !_programs)
+        return;
+    
+    for (auto& batch : _staticBatches) {
+        bgfx::setVertexBuffer(_staticVB, batch.firstVertex, batch.vertexCount);
+        submitLines(batch.color);
+    }
+}
+
+void SceneDebugDrawer::submitLines(const btVector3& lineColor)
+{
+    bgfx::setViewRect(_camera->viewIndex,
+        _camera->viewportRect.x, _camera->viewportRect.y,
+        _camera->viewportRect.w ,_camera->viewportRect.h);
+    
+    gfx::Matrix4 mainTransform = gfx::Matrix4::kIdentity;
+    
+    //  simple flat shader for lines
+    gfx::Color4 color;
+    color.r = lineColor.getX();
+    color.g = lineColor.getY();
+    color.b = lineColor.getZ();
+    color.a = 0.50f;
+    
+    bgfx::setUniform((*_uniforms)[gfx::kNodeUniformColor], color);
+
+    bgfx::setViewTransform(_camera->viewIndex, _camera->viewMtx, _camera->projMtx);
+    bgfx::setTransform(mainTransform);
+
+    bgfx::setState(
+        BGFX_STATE_RGB_WRITE
+      | BGFX_STATE_ALPHA_WRITE
+      | BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA)
+      | BGFX_STATE_DEPTH_WRITE
+      | BGFX_STATE_DEPTH_TEST_LESS
+      | BGFX_STATE_PT_LINES
+      | BGFX_STATE_MSAA
+    );
+    
+    bgfx::submit(_camera->viewIndex, (*_programs)[gfx::kNodeProgramFlat]);
+}
+
 
 
     } /* namespace ove */
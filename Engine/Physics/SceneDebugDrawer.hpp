@@ -32,8 +32,25 @@ class SceneDebugDrawer : public btIDebugDraw
     const cinek::gfx::NodeRenderer::UniformMap* _uniforms;
     const cinek::gfx::Camera* _camera;
     
+    //  lines recorded between beginStaticLines and endStaticLines, grouped
+    //  by color so that each color is drawn once
+    struct StaticLineBatch
+    {
+        btVector3 color;
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+    };
+    bool _recordingStatic;
+    std::vector<gfx::Vector3> _staticVertices;
+    //  the batch of each recorded line
+    std::vector<uint32_t> _staticLineBatches;
+    std::vector<StaticLineBatch> _staticBatches;
+    bgfx::VertexBufferHandle _staticVB;
+    
     static constexpr int kLineBufferSize = 1024;
     
+    void submitLines(const btVector3& color);
+    
 public:
     SceneDebugDrawer();
     
@@ -79,6 +96,16 @@ public:
 
     virtual void flushLines();
     
+    /**
+     *  Lines drawn between beginStaticLines and endStaticLines are kept in
+     *  a vertex buffer and redrawn by drawStaticLines until the next
+     *  beginStaticLines.  Used for geometry that rarely changes, like
+     *  static collision shapes.
+     */
+    void beginStaticLines();
+    void endStaticLines();
+    void drawStaticLines();
+    
     void setup
     (
         const cinek::gfx::NodeRenderer::ProgramMap& programs,
@@ -0,0 +1,38 @@
+//
+//  SceneListener.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#ifndef Overview_SceneListener_hpp
+#define Overview_SceneListener_hpp
+
+#include "SceneTypes.hpp"
+
+namespace cinek {
+    namespace ove {
+
+//  Notified as bodies enter and leave a Scene, so that views of the Scene's
+//  bodies (i.e. editor outliners) can be maintained without iterating all
+//  bodies.  Called from whatever thread modifies the Scene.
+class SceneListener
+{
+public:
+    virtual ~SceneListener() {}
+
+    //  called after the body is attached with its initial categories
+    virtual void onSceneBodyAttached(SceneBody* body) = 0;
+
+    //  called before the body is detached
+    virtual void onSceneBodyDetached(SceneBody* body) = 0;
+
+    //  called after categories were added or removed from a body
+    virtual void onSceneBodyCategoriesChanged(SceneBody* body) = 0;
+};
+
+    } /* namespace ove */
+} /* namespace cinek */
+
+#endif /* Overview_SceneListener_hpp */
@@ -51,7 +51,9 @@ void SceneMotionState::setWorldTransform(const btTransform& worldTrans)
     
    worldTrans.getOpenGLMatrix(mtx.comp);
    
-   //TODO, mark node aabb is dirty for later aabb regeneration
+   //  world transform and aabb are regenerated on the next render graph
+   //  update
+   _gfxNode->markTransformDirty();
 }
  
 
@@ -25,6 +25,8 @@ public:
 
     virtual void setWorldTransform(const btTransform& worldTrans);
     
+    gfx::NodeHandle node() const { return _gfxNode; }
+    
 private:
     gfx::NodeHandle _gfxNode;
 };
@@ -13,6 +13,8 @@
 
 #include <bx/fpumath.h>
 
+#include <algorithm>
+
 namespace cinek {
     namespace ove {
     
@@ -46,6 +48,92 @@ template<> btVector3* loadVectorFromJSON(btVector3* vec, const JsonValue& vecObj
 }
 
 
+static void collectHullsFromJSON
+(
+    std::vector<int>& indices,
+    const JsonValue& node
+)
+{
+    auto hullsIt = node.FindMember("hulls");
+    if (hullsIt != node.MemberEnd() && hullsIt->value.IsArray() &&
+        !hullsIt->value.Empty()) {
+        indices.push_back(hullsIt->value[0U].GetInt());
+    }
+    auto childrenIt = node.FindMember("children");
+    if (childrenIt != node.MemberEnd() && childrenIt->value.IsArray()) {
+        for (auto it = childrenIt->value.Begin(); it != childrenIt->value.End(); ++it) {
+            collectHullsFromJSON(indices, *it);
+        }
+    }
+}
+
+void SceneObjectJsonLoader::stageHulls(const JsonValue& root)
+{
+    if (jsonHullsArrayIt == root.MemberEnd())
+        return;
+    auto nodesIt = root.FindMember("nodes");
+    if (nodesIt == root.MemberEnd())
+        return;
+    
+    auto& jsonHulls = jsonHullsArrayIt->value;
+    
+    std::vector<int> hullIndices;
+    collectHullsFromJSON(hullIndices, nodesIt->value);
+    std::sort(hullIndices.begin(), hullIndices.end());
+    hullIndices.erase(std::unique(hullIndices.begin(), hullIndices.end()),
+                      hullIndices.end());
+    
+    //  allocation from the context is serial.  the hull's own buffers serve
+    //  as staging for the parallel decode.
+    struct HullJob
+    {
+        SceneFixedBodyHull* hull;
+        const JsonValue* json;
+        float* vertices;
+        int* indices;
+    };
+    std::vector<HullJob> jobs;
+    
+    for (int hullIndex : hullIndices) {
+        if (hullIndex < 0 || hullIndex >= (int)jsonHulls.Size())
+            continue;
+        if (hullIndex >= hulls.size()) {
+            hulls.resize(hullIndex+1);
+        }
+        if (hulls[hullIndex])
+            continue;
+        
+        auto& jsonHull = jsonHulls[hullIndex];
+        const char* hullName = jsonHull["name"].GetString();
+        auto hull = context->acquireFixedBodyHull(hullName);
+        if (!hull) {
+            SceneFixedBodyHull::VertexIndexCount vertIdxCounts;
+            vertIdxCounts.numFaces = jsonHull["tris"].Size();
+            vertIdxCounts.numVertices = jsonHull["vertices"].Size();
+            hull = context->allocateFixedBodyHull(vertIdxCounts, hullName);
+            if (hull) {
+                jobs.push_back({
+                    hull,
+                    &jsonHull,
+                    hull->pullVertices(vertIdxCounts.numVertices),
+                    hull->pullTriangleIndices(vertIdxCounts.numFaces)
+                });
+            }
+        }
+        hulls[hullIndex] = hull;
+    }
+    
+    gfx::runJsonDecodeJobs((uint32_t)jobs.size(),
+        [&jobs](uint32_t index) {
+            auto& job = jobs[index];
+            loadSceneFixedBodyHullDataFromJSON(job.vertices, job.indices, *job.json);
+        });
+    
+    for (auto& job : jobs) {
+        job.hull->finalize();
+    }
+}
+
 btBvhTriangleMeshShape* SceneObjectJsonLoader::operator()
 (
     const JsonValue& jsonNode
@@ -116,23 +204,8 @@ SceneFixedBodyHull* loadSceneFixedBodyHullFromJSON
     hull = context.allocateFixedBodyHull(vertIdxCounts, name);
     if (hull) {
         float* vertices = hull->pullVertices(vertIdxCounts.numVertices);
-        JsonValue::ConstValueIterator jsonVertexIt = jsonVertices.Begin();
-        for (; jsonVertexIt != jsonVertices.End(); ++jsonVertexIt) {
-            loadVectorFromJSON<float>(vertices, *jsonVertexIt);
-            vertices += 3;
-        }
-       
         int* indices = hull->pullTriangleIndices(vertIdxCounts.numFaces);
-    
-        JsonValue::ConstValueIterator jsonTriIt = jsonTris.Begin();
-        for (; jsonTriIt != jsonTris.End(); ++jsonTriIt) {
-            const JsonValue& jsonIdxArray = *jsonTriIt;
-            CK_ASSERT(jsonIdxArray.IsArray() && jsonIdxArray.Size() == 3);
-            indices[0] = jsonIdxArray[0U].GetInt();
-            indices[1] = jsonIdxArray[1U].GetInt();
-            indices[2] = jsonIdxArray[2U].GetInt();
-            indices += 3;
-        }
+        loadSceneFixedBodyHullDataFromJSON(vertices, indices, root);
         
         hull->finalize();
     }
@@ -140,6 +213,33 @@ SceneFixedBodyHull* loadSceneFixedBodyHullFromJSON
     return hull;
 }
 
+void loadSceneFixedBodyHullDataFromJSON
+(
+    float* vertices,
+    int* indices,
+    const JsonValue& root
+)
+{
+    const JsonValue& jsonVertices = root["vertices"];
+    const JsonValue& jsonTris = root["tris"];
+    
+    JsonValue::ConstValueIterator jsonVertexIt = jsonVertices.Begin();
+    for (; jsonVertexIt != jsonVertices.End(); ++jsonVertexIt) {
+        loadVectorFromJSON<float>(vertices, *jsonVertexIt);
+        vertices += 3;
+    }
+
+    JsonValue::ConstValueIterator jsonTriIt = jsonTris.Begin();
+    for (; jsonTriIt != jsonTris.End(); ++jsonTriIt) {
+        const JsonValue& jsonIdxArray = *jsonTriIt;
+        CK_ASSERT(jsonIdxArray.IsArray() && jsonIdxArray.Size() == 3);
+        indices[0] = jsonIdxArray[0U].GetInt();
+        indices[1] = jsonIdxArray[1U].GetInt();
+        indices[2] = jsonIdxArray[2U].GetInt();
+        indices += 3;
+    }
+}
+
 
     
     } /* namespace ove */
@@ -26,6 +26,11 @@ struct SceneObjectJsonLoader
     
     std::vector<SceneFixedBodyHull*> hulls;
     
+    //  allocates hulls referenced by the document's nodes and decodes their
+    //  vertex and index data in parallel.  jsonHullsArrayIt must be set
+    //  prior to calling.  optional - unstaged hulls are loaded on demand.
+    void stageHulls(const JsonValue& root);
+    
     btBvhTriangleMeshShape* operator()(const JsonValue& jsonNode);
 };
 
@@ -35,6 +40,15 @@ SceneFixedBodyHull* loadSceneFixedBodyHullFromJSON
     const JsonValue& root
 );
 
+//  decodes hull vertices (3 floats each) and triangle indices into the
+//  supplied buffers, which must be sized for the hull's counts
+void loadSceneFixedBodyHullDataFromJSON
+(
+    float* vertices,
+    int* indices,
+    const JsonValue& root
+);
+
 //  supports double, float or btVector3
 template<typename ScalarType>
 ScalarType* loadVectorFromJSON(ScalarType* vec, const JsonValue& vecObj);
@@ -0,0 +1,338 @@
+//
+//  SceneQueryService.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#include "SceneQueryService.hpp"
+#include "Scene.hpp"
+#include "Engine/Profiler.hpp"
+#include "Engine/MemoryTracker.hpp"
+
+#include <bullet/BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+#include <bullet/BulletCollision/NarrowPhaseCollision/btRaycastCallback.h>
+#include <bullet/LinearMath/btAabbUtil2.h>
+
+#include <algorithm>
+
+namespace cinek {
+    namespace ove {
+
+//  collects a query's candidate bodies from the broadphase's trees.  the
+//  trees are traversed with btDbvt's own ray and box tests, which keep their
+//  stacks locally - btDbvtBroadphase::rayTest shares one stack, so it can't
+//  be run by several jobs at once
+class SceneQueryService::Candidates : public btDbvt::ICollide
+{
+public:
+    Candidates(FrameVector<Body>& bodies, short filterMask) :
+        _bodies(bodies),
+        _filterMask(filterMask)
+    {
+    }
+
+    void Process(const btDbvtNode* leaf)
+    {
+        auto proxy = reinterpret_cast<const btBroadphaseProxy*>(leaf->data);
+
+        //  queries belong to the default filter group, as with btCollisionWorld
+        if (!(proxy->m_collisionFilterGroup & _filterMask) ||
+            !(btBroadphaseProxy::DefaultFilter & proxy->m_collisionFilterMask))
+            return;
+
+        auto object = reinterpret_cast<const btCollisionObject*>(proxy->m_clientObject);
+        auto body = reinterpret_cast<const SceneBody*>(object->getUserPointer());
+        if (!body)
+            return;
+
+        _bodies.push_back({ body->entity, object, proxy });
+    }
+
+    void sort()
+    {
+        //  the broadphase's order depends on its tree, which depends on the
+        //  order bodies were added and moved
+        std::sort(_bodies.begin(), _bodies.end(),
+            [](const Body& b0, const Body& b1) -> bool {
+                return b0.entity < b1.entity;
+            });
+    }
+
+private:
+    FrameVector<Body>& _bodies;
+    short _filterMask;
+};
+
+SceneQueryService::SceneQueryService
+(
+    Scene& scene,
+    JobSystem* jobSystem
+) :
+    _scene(scene),
+    _jobSystem(jobSystem),
+    _nextTicket(1)
+{
+    CK_ASSERT(!_scene._queryService);
+    _scene._queryService = this;
+}
+
+SceneQueryService::~SceneQueryService()
+{
+    wait();
+    _scene._queryService = nullptr;
+}
+
+auto SceneQueryService::queueRayTest
+(
+    const btVector3& origin,
+    const btVector3& dir,
+    btScalar dist,
+    uint16_t includeFilters,
+    uint16_t excludeFilters
+)
+-> Ticket
+{
+    RayTest test;
+    test.ticket = _nextTicket++;
+    test.from = origin;
+    test.to = origin + dir * dist;
+    test.filterMask = (short)(includeFilters ^ excludeFilters);
+    test.entity = 0;
+    _queuedRayTests.push_back(test);
+    return test.ticket;
+}
+
+auto SceneQueryService::queueFrustumTest
+(
+    const btVector3& origin,
+    const btVector3 (&corners)[4],
+    btScalar dist,
+    uint16_t includeFilters,
+    uint16_t excludeFilters
+)
+-> Ticket
+{
+    _queuedFrustumTests.emplace_back();
+    FrustumTest& test = _queuedFrustumTests.back();
+    test.ticket = _nextTicket++;
+    test.filterMask = (short)(includeFilters ^ excludeFilters);
+
+    btVector3 forward = corners[0] + corners[1] + corners[2] + corners[3];
+    forward.normalize();
+    const btVector3 inside = origin + forward * (dist * btScalar(0.5));
+
+    //  sides, each oriented so that the pyramid's axis is inside
+    for (int i = 0; i < 4; ++i) {
+        Plane& plane = test.planes[i];
+        plane.normal = corners[i].cross(corners[(i + 1) % 4]);
+        plane.normal.normalize();
+        plane.d = -plane.normal.dot(origin);
+        if (plane.normal.dot(inside) + plane.d < 0) {
+            plane.normal = -plane.normal;
+            plane.d = -plane.d;
+        }
+    }
+    //  near and far
+    test.planes[4].normal = forward;
+    test.planes[4].d = -forward.dot(origin);
+    test.planes[5].normal = -forward;
+    test.planes[5].d = forward.dot(origin + forward * dist);
+
+    //  bounds of the apex and the far rectangle
+    test.aabbMin = origin;
+    test.aabbMax = origin;
+    for (int i = 0; i < 4; ++i) {
+        const btScalar depth = std::max(corners[i].dot(forward), btScalar(SIMD_EPSILON));
+        const btVector3 corner = origin + corners[i] * (dist / depth);
+        test.aabbMin.setMin(corner);
+        test.aabbMax.setMax(corner);
+    }
+
+    return test.ticket;
+}
+
+void SceneQueryService::dispatch()
+{
+    OVENGINE_PROFILE_ZONE("SceneQueryService::dispatch");
+
+    if (!_runningRayTests.empty() || !_runningFrustumTests.empty()) {
+        collect();
+    }
+
+    std::swap(_runningRayTests, _queuedRayTests);
+    _queuedRayTests.clear();
+    std::swap(_runningFrustumTests, _queuedFrustumTests);
+    _queuedFrustumTests.clear();
+
+    //  the running lists aren't modified until collected, so jobs may refer
+    //  to their elements
+    for (auto& test : _runningRayTests) {
+        RayTest* job = &test;
+        if (_jobSystem) {
+            _jobSystem->run([this, job]() { runRayTest(*job); }, &_counter);
+        }
+        else {
+            runRayTest(*job);
+        }
+    }
+    for (auto& test : _runningFrustumTests) {
+        FrustumTest* job = &test;
+        if (_jobSystem) {
+            _jobSystem->run([this, job]() { runFrustumTest(*job); }, &_counter);
+        }
+        else {
+            runFrustumTest(*job);
+        }
+    }
+}
+
+void SceneQueryService::collect()
+{
+    wait();
+
+    std::swap(_rayTests, _runningRayTests);
+    _runningRayTests.clear();
+    std::swap(_frustumTests, _runningFrustumTests);
+    _runningFrustumTests.clear();
+}
+
+void SceneQueryService::wait()
+{
+    if (_jobSystem) {
+        _jobSystem->wait(_counter);
+    }
+}
+
+bool SceneQueryService::rayTestResult
+(
+    Ticket ticket,
+    SceneRayTestResult& result
+)
+const
+{
+    auto it = std::find_if(_rayTests.begin(), _rayTests.end(),
+        [ticket](const RayTest& test) -> bool {
+            return test.ticket == ticket;
+        });
+    if (it == _rayTests.end())
+        return false;
+
+    result.body = it->entity ? _scene.findBody(it->entity) : nullptr;
+    result.normal = it->normal;
+    result.position = it->position;
+    return true;
+}
+
+auto SceneQueryService::frustumTestResult(Ticket ticket) const
+    -> const FrameVector<Entity>*
+{
+    auto it = std::find_if(_frustumTests.begin(), _frustumTests.end(),
+        [ticket](const FrustumTest& test) -> bool {
+            return test.ticket == ticket;
+        });
+    if (it == _frustumTests.end())
+        return nullptr;
+
+    return &it->entities;
+}
+
+void SceneQueryService::runRayTest(RayTest& test) const
+{
+    OVENGINE_PROFILE_ZONE("SceneQueryService::rayTest");
+    OVENGINE_MEMORY_TAG(kMemoryTagScene);
+
+    btTransform fromTransform, toTransform;
+    fromTransform.setIdentity();
+    fromTransform.setOrigin(test.from);
+    toTransform.setIdentity();
+    toTransform.setOrigin(test.to);
+
+    //  the Scene waits for this job before changing the broadphase
+    FrameVector<Body> bodies;
+    Candidates candidates(bodies, test.filterMask);
+    btDbvtBroadphase& broadphase = _scene._btBroadphase;
+    btDbvt::rayTest(broadphase.m_sets[0].m_root, test.from, test.to, candidates);
+    btDbvt::rayTest(broadphase.m_sets[1].m_root, test.from, test.to, candidates);
+    candidates.sort();
+
+    btCollisionWorld::ClosestRayResultCallback cb(test.from, test.to);
+    cb.m_flags |= btTriangleRaycastCallback::kF_FilterBackfaces;
+    cb.m_collisionFilterMask = test.filterMask;
+
+    const Body* hitBody = nullptr;
+
+    for (const Body& body : bodies) {
+        //  skip bodies whose bounds are beyond the closest hit so far
+        btScalar param = cb.m_closestHitFraction;
+        btVector3 normal;
+        if (!btRayAabb(test.from, test.to, body.proxy->m_aabbMin, body.proxy->m_aabbMax,
+                       param, normal))
+            continue;
+
+        //  the object is only read (and passed back through the callback)
+        btCollisionWorld::rayTestSingle(fromTransform, toTransform,
+            const_cast<btCollisionObject*>(body.object),
+            body.object->getCollisionShape(),
+            body.object->getWorldTransform(),
+            cb);
+        if (cb.m_collisionObject == body.object) {
+            hitBody = &body;
+        }
+    }
+
+    if (hitBody) {
+        test.entity = hitBody->entity;
+        test.normal = cb.m_hitNormalWorld;
+        test.position = cb.m_hitPointWorld;
+    }
+    else {
+        test.entity = 0;
+    }
+}
+
+void SceneQueryService::runFrustumTest(FrustumTest& test) const
+{
+    OVENGINE_PROFILE_ZONE("SceneQueryService::frustumTest");
+    OVENGINE_MEMORY_TAG(kMemoryTagScene);
+
+    //  candidates and results come from this thread's arena block.  the
+    //  Scene waits for this job before changing the broadphase
+    FrameVector<Body> bodies;
+    Candidates candidates(bodies, test.filterMask);
+    btDbvtBroadphase& broadphase = _scene._btBroadphase;
+    const ATTRIBUTE_ALIGNED16(btDbvtVolume) bounds =
+        btDbvtVolume::FromMM(test.aabbMin, test.aabbMax);
+    broadphase.m_sets[0].collideTV(broadphase.m_sets[0].m_root, bounds, candidates);
+    broadphase.m_sets[1].collideTV(broadphase.m_sets[1].m_root, bounds, candidates);
+    candidates.sort();
+
+    //  candidates are sorted, so entities are added in sorted order
+    test.entities = FrameVector<Entity>();
+
+    for (const Body& body : bodies) {
+        const btVector3& aabbMin = body.proxy->m_aabbMin;
+        const btVector3& aabbMax = body.proxy->m_aabbMax;
+
+        //  outside if the box's corner furthest along a plane's normal is
+        //  behind that plane
+        bool inside = true;
+        for (auto& plane : test.planes) {
+            btVector3 corner(
+                plane.normal.x() >= 0 ? aabbMax.x() : aabbMin.x(),
+                plane.normal.y() >= 0 ? aabbMax.y() : aabbMin.y(),
+                plane.normal.z() >= 0 ? aabbMax.z() : aabbMin.z());
+            if (plane.normal.dot(corner) + plane.d < 0) {
+                inside = false;
+                break;
+            }
+        }
+        if (inside) {
+            test.entities.push_back(body.entity);
+        }
+    }
+}
+
+    }  /* namespace ove */
+}  /* namespace cinek */
@@ -0,0 +1,175 @@
+//
+//  SceneQueryService.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#ifndef Overview_SceneQueryService_hpp
+#define Overview_SceneQueryService_hpp
+
+#include "SceneTypes.hpp"
+#include "Engine/JobSystem.hpp"
+#include "Engine/FrameArena.hpp"
+
+#include <bullet/LinearMath/btTransform.h>
+
+#include <vector>
+
+class btCollisionObject;
+class btCollisionShape;
+struct btBroadphaseProxy;
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  @class  SceneQueryService
+ *  @brief  Runs picking and selection queries against a Scene on job
+ *          threads, delivering results later in the frame.
+ *
+ *  Queries are queued and then launched together by dispatch.  Each
+ *  query's job finds its candidate bodies in the Scene's broadphase and
+ *  tests them, so dispatch does no work per body.  The Scene acts as a
+ *  fence: before changing its broadphase, or a body's shape or transform
+ *  (i.e. simulating, attaching, detaching or moving bodies), it waits for
+ *  running queries.  collect waits for the dispatched queries, and their
+ *  results are available until the next collect.
+ *
+ *  Candidates and frustum results are allocated from the current
+ *  FrameArena, so collect must be called once per frame (before the
+ *  arena's endFrame) to retire results from the prior frame.
+ *
+ *  Without a JobSystem, queries run within dispatch.
+ */
+class SceneQueryService
+{
+    CK_CLASS_NON_COPYABLE(SceneQueryService);
+
+public:
+    /** Identifies a query's result.  Zero is never issued. */
+    using Ticket = uint32_t;
+
+    SceneQueryService(Scene& scene, JobSystem* jobSystem);
+    ~SceneQueryService();
+
+    /**
+     *  Queues a query for the closest body along a ray.
+     *
+     *  @param  origin          Ray origin
+     *  @param  dir             Ray direction (normalized)
+     *  @param  dist            Ray length
+     *  @param  includeFilters  Filters to test against
+     *  @param  excludeFilters  Filters to skip
+     *  @return The query's ticket
+     */
+    Ticket queueRayTest(const btVector3& origin, const btVector3& dir,
+                        btScalar dist,
+                        uint16_t includeFilters,
+                        uint16_t excludeFilters);
+    /**
+     *  Queues a query for all bodies whose bounds intersect the pyramid from
+     *  origin through the given corner directions, i.e. a screen rectangle
+     *  selection.
+     *
+     *  @param  origin          The pyramid's apex (the camera position)
+     *  @param  corners         Directions to the rectangle's corners, in
+     *                          order around the rectangle
+     *  @param  dist            The pyramid's depth from origin
+     *  @param  includeFilters  Filters to test against
+     *  @param  excludeFilters  Filters to skip
+     *  @return The query's ticket
+     */
+    Ticket queueFrustumTest(const btVector3& origin,
+                            const btVector3 (&corners)[4],
+                            btScalar dist,
+                            uint16_t includeFilters,
+                            uint16_t excludeFilters);
+    /**
+     *  Starts queued queries.  Collects queries
+     *  dispatched earlier.
+     */
+    void dispatch();
+    /**
+     *  Waits for dispatched queries and makes their results available,
+     *  replacing results from the prior collect.
+     */
+    void collect();
+    /**
+     *  Waits for dispatched queries without collecting them.
+     */
+    void wait();
+    /**
+     *  @param  ticket          The ray query's ticket
+     *  @param  result          The hit, if any.  The body is looked up when
+     *                          called, so it's null if since detached
+     *  @return True if the ticket's result is available
+     */
+    bool rayTestResult(Ticket ticket, SceneRayTestResult& result) const;
+    /**
+     *  @param  ticket          The frustum query's ticket
+     *  @return Entities found, sorted, or null if the ticket's result isn't
+     *          available
+     */
+    const FrameVector<Entity>* frustumTestResult(Ticket ticket) const;
+
+private:
+    class Candidates;
+
+    struct Body
+    {
+        Entity entity;
+        const btCollisionObject* object;
+        const btBroadphaseProxy* proxy;
+    };
+
+    struct RayTest
+    {
+        Ticket ticket;
+        btVector3 from;
+        btVector3 to;
+        short filterMask;
+        Entity entity;
+        btVector3 normal;
+        btVector3 position;
+    };
+
+    struct Plane
+    {
+        btVector3 normal;
+        btScalar d;
+    };
+
+    struct FrustumTest
+    {
+        Ticket ticket;
+        Plane planes[6];
+        //  bounds the pyramid, for the broadphase query
+        btVector3 aabbMin;
+        btVector3 aabbMax;
+        short filterMask;
+        FrameVector<Entity> entities;
+    };
+
+    void runRayTest(RayTest& test) const;
+    void runFrustumTest(FrustumTest& test) const;
+
+    Scene& _scene;
+    JobSystem* _jobSystem;
+    JobSystem::Counter _counter;
+    Ticket _nextTicket;
+
+    //  queued, running and collected queries
+    std::vector<RayTest> _queuedRayTests;
+    std::vector<RayTest> _runningRayTests;
+    std::vector<RayTest> _rayTests;
+    std::vector<FrustumTest> _queuedFrustumTests;
+    std::vector<FrustumTest> _runningFrustumTests;
+    std::vector<FrustumTest> _frustumTests;
+};
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#endif /* Overview_SceneQueryService_hpp */
@@ -7,6 +7,7 @@
 //
 
 #include "SceneTypes.hpp"
+#include "Scene.hpp"
 #include "SceneFixedBodyHull.hpp"
 #include "SceneMotionState.hpp"
 
@@ -75,6 +76,7 @@ void SceneBody::setPosition
 )
 {
     //CK_ASSERT(this->btBody->isStaticOrKinematicObject());
+    waitForSceneQueries();
 
     btVector3 forward(0,0,1);
     
@@ -109,10 +111,13 @@ void SceneBody::setPosition
     if (this->motionState) {
         this->motionState->setWorldTransform(transform);
     }
+    wake();
 }
 
 void SceneBody::setTransform(const ckm::quat& basis, const ckm::vector3& pos)
 {
+    waitForSceneQueries();
+    
     btTransform& t = this->btBody->getWorldTransform();
     btQuaternion btq;
     t.setRotation(btFromCkm(btq, basis));
@@ -121,10 +126,13 @@ void SceneBody::setTransform(const ckm::quat& basis, const ckm::vector3& pos)
     //  updates the revision number, copy is trivial
     this->btBody->setWorldTransform(t);
     transformChanged = true;
+    wake();
 }
 
 void SceneBody::setTransformMatrix(const ckm::matrix4 &mtx)
 {
+    waitForSceneQueries();
+    
     btTransform& t = this->btBody->getWorldTransform();
     t.getBasis().setValue(mtx[0], mtx[4], mtx[8],
                           mtx[1], mtx[5], mtx[9],
@@ -137,6 +145,7 @@ void SceneBody::setTransformMatrix(const ckm::matrix4 &mtx)
     if (this->motionState) {
         this->motionState->setWorldTransform(t);
     }
+    wake();
 }
 
 void SceneBody::getTransform(ckm::quat& basis, ckm::vector3& pos) const
@@ -203,6 +212,8 @@ OVERVIEW_COMPONENT_PROPERTY_POINT3_IMPL(SceneBody, AngularVelocity)
 
 void SceneBody::setPosition(ckm::vector3 value)
 {
+    waitForSceneQueries();
+    
     btVector3 btPos;
     btFromCkm(btPos, value);
 
@@ -213,6 +224,7 @@ void SceneBody::setPosition(ckm::vector3 value)
     if (this->motionState) {
         this->motionState->setWorldTransform(transform);
     }
+    wake();
 }
 
 ckm::vector3 SceneBody::getPosition() const
@@ -225,6 +237,8 @@ ckm::vector3 SceneBody::getPosition() const
 
 void SceneBody::setRotation(ckm::quat value)
 {
+    waitForSceneQueries();
+    
     btQuaternion btq;
     btFromCkm(btq, value);
     btTransform& t = this->btBody->getWorldTransform();
@@ -233,6 +247,7 @@ void SceneBody::setRotation(ckm::quat value)
     if (this->motionState) {
         this->motionState->setWorldTransform(t);
     }
+    wake();
 }
 
 ckm::quat SceneBody::getRotation() const
@@ -252,9 +267,14 @@ ckm::vector3 SceneBody::getVelocity() const
 
 void SceneBody::setVelocity(ckm::vector3 v)
 {
+    const btVector3 prevVelocity = linearVelocity;
     btFromCkm(linearVelocity, v);
 
     velocityChanged = true;
+    //  controllers reset velocity every tick - don't wake resting bodies
+    if (linearVelocity != prevVelocity) {
+        wake();
+    }
 }
 
 ckm::vector3 SceneBody::getAngularVelocity() const
@@ -265,9 +285,43 @@ ckm::vector3 SceneBody::getAngularVelocity() const
 
 void SceneBody::setAngularVelocity(ckm::vector3 v)
 {
+    const btVector3 prevVelocity = angularVelocity;
     btFromCkm(angularVelocity, v);
     
     velocityChanged = true;
+    if (angularVelocity != prevVelocity) {
+        wake();
+    }
+}
+
+void SceneBody::wake()
+{
+    if (scene) {
+        scene->wakeBody(this);
+    }
+}
+
+void SceneBody::waitForSceneQueries()
+{
+    if (scene) {
+        scene->waitForQueries();
+    }
+}
+
+void SceneBody::setContinuousCollision
+(
+    btScalar motionThreshold,
+    btScalar sweptRadius
+)
+{
+    btBody->setCcdMotionThreshold(motionThreshold);
+    btBody->setCcdSweptSphereRadius(sweptRadius);
+}
+
+bool SceneBody::hasContinuousCollision() const
+{
+    return btBody->getCcdMotionThreshold() > 0 &&
+           btBody->getCcdSweptSphereRadius() > 0;
 }
 
     } /* namespace ove */
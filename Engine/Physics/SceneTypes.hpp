@@ -19,6 +19,7 @@
 
 class btTransform;
 class btCollisionObject;
+class btConvexShape;
 class btBvhTriangleMeshShape;
 
 namespace cinek {
@@ -89,6 +90,21 @@ public:
     void getTransformMatrix(ckm::matrix4& mtx) const;
     
     ckm::AABB<ckm::vector3> calcAABB() const;
+    
+    //  sleeping bodies are skipped by the Scene's simulation and their
+    //  collision bounds aren't refreshed.  setting a body's transform or
+    //  velocity wakes it
+    bool isAwake() const { return awakeIndex >= 0; }
+    void wake();
+    
+    //  bodies moving further than motionThreshold in a tick are swept
+    //  against the scene as a sphere of sweptRadius centered on their
+    //  shape, stopping short of the first surface hit rather than passing
+    //  through it.  velocity into that surface is removed.  a zero
+    //  threshold disables sweeps.  stored in the btCollisionObject's CCD
+    //  properties
+    void setContinuousCollision(btScalar motionThreshold, btScalar sweptRadius);
+    bool hasContinuousCollision() const;
 
 public:
     btCollisionObject* btBody = nullptr;
@@ -104,7 +120,31 @@ public:
     
 private:
     friend class Scene;
+    friend class SceneCharacterController;
+    //  called before changing the transform, which the scene's running
+    //  queries may be reading
+    void waitForSceneQueries();
+    
     uint32_t categoryMask = 0;
+    Scene* scene = nullptr;
+    int32_t awakeIndex = -1;
+    uint32_t sleepTicks = 0;
+    int32_t characterIndex = -1;
+};
+
+//  Properties of a body moved as a kinematic character (see
+//  Scene::attachCharacter.)  The character is an upright capsule.
+struct SceneCharacterParams
+{
+    btScalar radius;
+    //  distance between the capsule's end caps
+    btScalar height;
+    //  height of the capsule's center above the body's origin
+    btScalar centerHeight;
+    //  tallest ledge the character steps over (or down from)
+    btScalar stepHeight;
+    //  cosine of the steepest slope the character stands on
+    btScalar maxSlopeCos;
 };
    
 struct SceneRayTestResult
@@ -116,6 +156,40 @@ struct SceneRayTestResult
     btVector3 normal;
     btVector3 position;
 };
+
+struct SceneShapeCastHit
+{
+    SceneBody* body;
+    btVector3 normal;
+    btVector3 position;
+    //  fraction of the sweep from its start to end at the point of contact
+    btScalar fraction;
+};
+
+//  A change in contact between two bodies over a Scene::simulate tick.
+//  entityA is always less than entityB.
+struct SceneContact
+{
+    enum Phase
+    {
+        kBegin,
+        kPersist,
+        kEnd
+    };
+    
+    Entity entityA;
+    Entity entityB;
+    uint32_t categoryMaskA;
+    uint32_t categoryMaskB;
+    Phase phase;
+    
+    //  the deepest point of contact and the normal pointing from B to A.
+    //  kEnd contacts carry the values from their last touching tick.  pairs
+    //  with a body detached since the prior tick end on the next tick
+    btVector3 position;
+    btVector3 normal;
+    btScalar depth;
+};
       
     } /* namespace ove */
 } /* namespace cinek */
@@ -0,0 +1,315 @@
+//
+//  Profiler.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/7/16.
+//
+//
+
+#include "Profiler.hpp"
+#include "Debug.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace cinek {
+    namespace ove {
+
+struct Profiler::ThreadBuffer
+{
+    //  guards the ring and writeCount between the owning thread and the
+    //  main thread's drain.  uncontended except while draining
+    std::atomic_flag lock;
+    std::vector<Event> ring;
+    uint64_t writeCount;
+    //  owning thread only
+    uint32_t depth;
+    //  main thread only
+    uint64_t readCount;
+    char name[32];
+
+    ThreadBuffer(uint32_t capacity) :
+        ring(capacity),
+        writeCount(0),
+        depth(0),
+        readCount(0)
+    {
+        lock.clear();
+        name[0] = 0;
+    }
+};
+
+//  the calling thread's buffer, registered with the Profiler whose instance
+//  id is tlsProfilerId.  ids aren't reused, unlike addresses, so a buffer
+//  cached for a destroyed Profiler is never returned for a new one
+static thread_local uint64_t tlsProfilerId = 0;
+static thread_local void* tlsThreadBuffer = nullptr;
+
+std::atomic<Profiler*> Profiler::s_current(nullptr);
+std::atomic<uint64_t> Profiler::s_nextInstanceId(1);
+
+void Profiler::setCurrent(Profiler* profiler)
+{
+    s_current.store(profiler, std::memory_order_release);
+}
+
+Profiler::Profiler(const InitParams& params) :
+    _params(params),
+    _instanceId(s_nextInstanceId.fetch_add(1, std::memory_order_relaxed)),
+    _startTime(std::chrono::steady_clock::now()),
+    _enabled(true),
+    _threadCount(0),
+    _frameBeginNs(0),
+    _capturing(false),
+    _captureOverflowed(false)
+{
+    _params.eventsPerThread = std::max(_params.eventsPerThread, 1U);
+    _params.historyFrames = std::max(_params.historyFrames, 1U);
+    _params.threadLimit = std::min(_params.threadLimit, (uint32_t)UINT16_MAX);
+    _threads.resize(_params.threadLimit);
+}
+
+Profiler::~Profiler()
+{
+    Profiler* self = this;
+    s_current.compare_exchange_strong(self, nullptr);
+}
+
+uint64_t Profiler::now() const
+{
+    auto elapsed = std::chrono::steady_clock::now() - _startTime;
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+auto Profiler::threadBuffer() -> ThreadBuffer*
+{
+    if (tlsProfilerId == _instanceId)
+        return reinterpret_cast<ThreadBuffer*>(tlsThreadBuffer);
+
+    std::lock_guard<std::mutex> lock(_registerMutex);
+
+    uint32_t index = _threadCount.load(std::memory_order_relaxed);
+    if (index >= _params.threadLimit) {
+        return nullptr;
+    }
+
+    _threads[index].reset(new ThreadBuffer(_params.eventsPerThread));
+    snprintf(_threads[index]->name, sizeof(_threads[index]->name),
+             "Thread %u", index);
+    //  publish the buffer to the main thread's drain
+    _threadCount.store(index + 1, std::memory_order_release);
+
+    tlsProfilerId = _instanceId;
+    tlsThreadBuffer = _threads[index].get();
+    return _threads[index].get();
+}
+
+void Profiler::setThreadName(const char* name)
+{
+    ThreadBuffer* buffer = threadBuffer();
+    if (!buffer)
+        return;
+
+    while (buffer->lock.test_and_set(std::memory_order_acquire));
+    strncpy(buffer->name, name, sizeof(buffer->name)-1);
+    buffer->name[sizeof(buffer->name)-1] = 0;
+    buffer->lock.clear(std::memory_order_release);
+}
+
+uint32_t Profiler::threadCount() const
+{
+    return _threadCount.load(std::memory_order_acquire);
+}
+
+const char* Profiler::threadName(uint32_t threadIndex) const
+{
+    if (threadIndex >= threadCount())
+        return "";
+    return _threads[threadIndex]->name;
+}
+
+uint64_t Profiler::beginZone()
+{
+    ThreadBuffer* buffer = threadBuffer();
+    if (buffer) {
+        ++buffer->depth;
+    }
+    return now();
+}
+
+void Profiler::endZone(const char* name, uint64_t beginNs)
+{
+    uint64_t endNs = now();
+
+    ThreadBuffer* buffer = threadBuffer();
+    if (!buffer)
+        return;
+
+    CK_ASSERT(buffer->depth > 0);
+    --buffer->depth;
+
+    Event event;
+    event.name = name;
+    event.beginNs = beginNs;
+    event.endNs = endNs;
+    event.depth = (uint16_t)buffer->depth;
+    //  assigned when drained
+    event.threadIndex = 0;
+
+    while (buffer->lock.test_and_set(std::memory_order_acquire));
+    buffer->ring[buffer->writeCount % buffer->ring.size()] = event;
+    ++buffer->writeCount;
+    buffer->lock.clear(std::memory_order_release);
+}
+
+void Profiler::beginFrame()
+{
+    _frameBeginNs = now();
+}
+
+void Profiler::endFrame()
+{
+    _frames.push_back(Frame { _frameBeginNs, now() });
+    while (_frames.size() > _params.historyFrames) {
+        _frames.pop_front();
+    }
+
+    drain();
+
+    //  discard zones that ended before the oldest retained frame
+    uint64_t oldestNs = _frames.front().beginNs;
+    auto it = std::remove_if(_events.begin(), _events.end(),
+        [oldestNs](const Event& event) -> bool {
+            return event.endNs < oldestNs;
+        });
+    _events.erase(it, _events.end());
+}
+
+void Profiler::drain()
+{
+    const uint32_t count = threadCount();
+    for (uint32_t threadIndex = 0; threadIndex < count; ++threadIndex) {
+        ThreadBuffer& buffer = *_threads[threadIndex];
+        const uint64_t capacity = buffer.ring.size();
+
+        while (buffer.lock.test_and_set(std::memory_order_acquire));
+
+        //  zones overwritten since the last drain are lost
+        uint64_t first = buffer.readCount;
+        if (buffer.writeCount - first > capacity) {
+            first = buffer.writeCount - capacity;
+        }
+        for (uint64_t i = first; i < buffer.writeCount; ++i) {
+            Event event = buffer.ring[i % capacity];
+            event.threadIndex = (uint16_t)threadIndex;
+            _events.push_back(event);
+            if (_capturing) {
+                if (_capture.size() < _params.captureLimit) {
+                    _capture.push_back(event);
+                }
+                else {
+                    _captureOverflowed = true;
+                }
+            }
+        }
+        buffer.readCount = buffer.writeCount;
+
+        buffer.lock.clear(std::memory_order_release);
+    }
+}
+
+void Profiler::startCapture()
+{
+    _capture.clear();
+    _captureOverflowed = false;
+    _capturing = true;
+}
+
+bool Profiler::stopCapture(const char* path)
+{
+    if (!_capturing)
+        return false;
+
+    _capturing = false;
+
+    if (_captureOverflowed) {
+        OVENGINE_LOG_WARN("Profiler.stopCapture - capture limit of %u zones "
+                          "reached.  Later zones were dropped.\n",
+                          _params.captureLimit);
+    }
+
+    bool result = writeChromeTrace(path);
+    _capture.clear();
+    return result;
+}
+
+static void writeJsonString(FILE* fp, const char* str)
+{
+    fputc('"', fp);
+    for (; *str; ++str) {
+        char ch = *str;
+        if (ch == '"' || ch == '\\') {
+            fputc('\\', fp);
+            fputc(ch, fp);
+        }
+        else if ((unsigned char)ch >= 0x20) {
+            fputc(ch, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+bool Profiler::writeChromeTrace(const char* path) const
+{
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        OVENGINE_LOG_ERROR("Profiler.writeChromeTrace - failed to open %s\n", path);
+        return false;
+    }
+
+    //  complete ('X') events with microsecond timestamps, plus thread name
+    //  metadata
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", fp);
+
+    bool first = true;
+    const uint32_t count = threadCount();
+    for (uint32_t threadIndex = 0; threadIndex < count; ++threadIndex) {
+        fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                    "\"tid\":%u,\"args\":{\"name\":",
+                first ? "" : ",\n", threadIndex);
+        writeJsonString(fp, threadName(threadIndex));
+        fputs("}}", fp);
+        first = false;
+    }
+
+    for (auto& event : _capture) {
+        fprintf(fp, "%s{\"name\":", first ? "" : ",\n");
+        writeJsonString(fp, event.name);
+        fprintf(fp, ",\"cat\":\"ove\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+                    "\"ts\":%" PRIu64 ".%03u,\"dur\":%" PRIu64 ".%03u}",
+                event.threadIndex,
+                event.beginNs / 1000, (uint32_t)(event.beginNs % 1000),
+                (event.endNs - event.beginNs) / 1000,
+                (uint32_t)((event.endNs - event.beginNs) % 1000));
+        first = false;
+    }
+
+    fputs("\n]}\n", fp);
+
+    bool result = ferror(fp) == 0;
+    fclose(fp);
+
+    if (result) {
+        OVENGINE_LOG_INFO("Profiler - wrote %u zones to %s\n",
+                          (uint32_t)_capture.size(), path);
+    }
+    else {
+        OVENGINE_LOG_ERROR("Profiler.writeChromeTrace - failed to write %s\n", path);
+    }
+    return result;
+}
+
+    }  /* namespace ove */
+}  /* namespace cinek */
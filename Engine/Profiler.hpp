@@ -0,0 +1,231 @@
+//
+//  Profiler.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/7/16.
+//
+//
+
+#ifndef Overview_Profiler_hpp
+#define Overview_Profiler_hpp
+
+#include "Engine/EngineTypes.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  @class  Profiler
+ *  @brief  Records nested timing zones per thread.
+ *
+ *  Zones are recorded with OVENGINE_PROFILE_ZONE, which times the enclosing
+ *  scope.  Each thread writes completed zones to its own ring buffer.  Once
+ *  per frame (see endFrame), the main thread drains those buffers into a
+ *  short history used by the overlay, and into the capture if one is
+ *  running.  Captures are written as Chrome trace-event JSON, viewable in
+ *  chrome://tracing.
+ *
+ *  Zone names must be string literals (or otherwise outlive the profiler.)
+ *  Zones are recorded against the Profiler set by setCurrent.
+ */
+class Profiler
+{
+    CK_CLASS_NON_COPYABLE(Profiler);
+
+public:
+    struct InitParams
+    {
+        /** Zones buffered per thread between frames */
+        uint32_t eventsPerThread;
+        /** Maximum number of threads recording zones */
+        uint32_t threadLimit;
+        /** Number of frames retained for display */
+        uint32_t historyFrames;
+        /** Maximum zones held by a capture */
+        uint32_t captureLimit;
+    };
+
+    struct Event
+    {
+        const char* name;
+        uint64_t beginNs;
+        uint64_t endNs;
+        uint16_t depth;
+        uint16_t threadIndex;
+    };
+
+    struct Frame
+    {
+        uint64_t beginNs;
+        uint64_t endNs;
+    };
+
+    /**
+     *  @return The profiler zones are recorded against, or null
+     */
+    static Profiler* current() { return s_current.load(std::memory_order_acquire); }
+    /**
+     *  @param  profiler    The profiler to record zones against (or null)
+     */
+    static void setCurrent(Profiler* profiler);
+
+    Profiler(const InitParams& params);
+    ~Profiler();
+
+    /**
+     *  @return Nanoseconds elapsed since the profiler was created
+     */
+    uint64_t now() const;
+    /**
+     *  Names the calling thread in the overlay and captures.  The calling
+     *  thread is registered if not already.
+     *
+     *  @param  name        The thread's name (copied)
+     */
+    void setThreadName(const char* name);
+    /**
+     *  @param  enabled     False to ignore new zones
+     */
+    void setEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    /**
+     *  Used by ProfileZone.
+     *
+     *  @return The zone's begin timestamp
+     */
+    uint64_t beginZone();
+    /**
+     *  Used by ProfileZone.
+     *
+     *  @param  name        Zone name
+     *  @param  beginNs     The timestamp returned by beginZone
+     */
+    void endZone(const char* name, uint64_t beginNs);
+
+    /**
+     *  Marks the start of a frame.  Call from the main thread.
+     */
+    void beginFrame();
+    /**
+     *  Marks the end of a frame, and drains zones recorded by all threads.
+     *  Call from the main thread.
+     */
+    void endFrame();
+
+    /**
+     *  Starts collecting zones for export.  Clears any prior capture.
+     */
+    void startCapture();
+    /**
+     *  Stops collecting zones and writes them as a Chrome trace.
+     *
+     *  @param  path        The output file path
+     *  @return True if the file was written
+     */
+    bool stopCapture(const char* path);
+    bool isCapturing() const { return _capturing; }
+    uint32_t captureEventCount() const { return (uint32_t)_capture.size(); }
+
+    /**
+     *  @return Zones drained over the retained frames (unordered across
+     *          threads.)  Main thread only.
+     */
+    const std::vector<Event>& events() const { return _events; }
+    /**
+     *  @return Completed frames, oldest first.  Main thread only.
+     */
+    const std::deque<Frame>& frames() const { return _frames; }
+
+    uint32_t threadCount() const;
+    const char* threadName(uint32_t threadIndex) const;
+
+private:
+    struct ThreadBuffer;
+
+    ThreadBuffer* threadBuffer();
+    void drain();
+    bool writeChromeTrace(const char* path) const;
+
+    static std::atomic<Profiler*> s_current;
+    static std::atomic<uint64_t> s_nextInstanceId;
+
+    InitParams _params;
+    //  identifies this Profiler in threads' cached buffer registrations
+    const uint64_t _instanceId;
+    std::chrono::steady_clock::time_point _startTime;
+    std::atomic<bool> _enabled;
+
+    //  sized to the thread limit on creation.  buffers are allocated as
+    //  threads register
+    std::vector<std::unique_ptr<ThreadBuffer>> _threads;
+    std::atomic<uint32_t> _threadCount;
+    std::mutex _registerMutex;
+
+    uint64_t _frameBeginNs;
+    std::deque<Frame> _frames;
+    std::vector<Event> _events;
+
+    bool _capturing;
+    bool _captureOverflowed;
+    std::vector<Event> _capture;
+};
+
+/**
+ *  @class  ProfileZone
+ *  @brief  Records the lifetime of a scope as a profiler zone.
+ */
+class ProfileZone
+{
+    CK_CLASS_NON_COPYABLE(ProfileZone);
+
+public:
+    explicit ProfileZone(const char* name) :
+        _profiler(Profiler::current()),
+        _name(name),
+        _beginNs(0)
+    {
+        if (_profiler && !_profiler->enabled()) {
+            _profiler = nullptr;
+        }
+        if (_profiler) {
+            _beginNs = _profiler->beginZone();
+        }
+    }
+    ~ProfileZone()
+    {
+        if (_profiler) {
+            _profiler->endZone(_name, _beginNs);
+        }
+    }
+
+private:
+    Profiler* _profiler;
+    const char* _name;
+    uint64_t _beginNs;
+};
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+/** @cond */
+
+#define OVENGINE_PROFILE_CONCAT_(_a_, _b_) _a_##_b_
+#define OVENGINE_PROFILE_CONCAT(_a_, _b_) OVENGINE_PROFILE_CONCAT_(_a_, _b_)
+
+/** @endcond */
+
+/**
+ *  Times the enclosing scope as a profiler zone
+ */
+#define OVENGINE_PROFILE_ZONE(_name_) \
+    ::cinek::ove::ProfileZone OVENGINE_PROFILE_CONCAT(ovProfileZone_, __LINE__)(_name_)
+
+#endif /* Overview_Profiler_hpp */
@@ -9,6 +9,8 @@
 #include "RenderGraph.hpp"
 #include "Engine/EntityDatabase.hpp"
 #include "Engine/Debug.hpp"
+#include "Engine/Profiler.hpp"
+#include "Engine/MemoryTracker.hpp"
 #include "CKGfx/NodeRenderer.hpp"
 #include "CKGfx/Node.hpp"
 #include "CKGfx/AnimationController.hpp"
@@ -26,7 +28,9 @@ RenderGraph::RenderGraph
 ) :
     _animControllerPool(animCount),
     _nodeGraph(counts),
-    _renderTime(0)
+    _renderTime(0),
+    _renderNodeCounter("Render Entities", kMemoryTagRender, entityCount),
+    _animControllerCounter("Animation Controllers", kMemoryTagRender, animCount)
 {
     _pendingRenderNodes.reserve(entityCount);
     _removedRenderNodes.reserve(entityCount);
@@ -38,15 +42,46 @@ gfx::NodeHandle RenderGraph::cloneAndAddNode
 (
     Entity e,
     gfx::NodeHandle sourceNode,
-    void* context
+    void* context,
+    const char* sourceName
 )
 {
+    OVENGINE_MEMORY_TAG(kMemoryTagRender);
+    
     auto rootNode = _nodeGraph.root();
     if (!rootNode)
         return nullptr;
         
     auto clonedNode = _nodeGraph.clone(sourceNode);
     
+    initClonedNode(e, clonedNode);
+    
+    //  our pending node will be added during the update() call
+    auto parentNode = _nodeGraph.createObjectNode(e);
+    parentNode->setTransform(gfx::Matrix4::kIdentity);
+    _nodeGraph.addChildNodeToNode(clonedNode, parentNode);
+    _nodeGraph.addChildNodeToNode(parentNode, rootNode);
+    
+    uint32_t sourceId = 0;
+    if (sourceName) {
+        std::string key = sourceName;
+        auto it = _sourceIds.find(key);
+        if (it == _sourceIds.end()) {
+            _sourceNames.emplace_back(key);
+            it = _sourceIds.emplace(std::move(key), (uint32_t)_sourceNames.size()).first;
+        }
+        sourceId = it->second;
+    }
+    
+    _pendingRenderNodes.emplace_back(
+        Node{ e, parentNode, context, sourceId, clonedNode }
+    );
+    
+    return parentNode;
+}
+
+void RenderGraph::initClonedNode(Entity e, gfx::NodeHandle clonedNode)
+{
     struct VisitContext
     {
         RenderGraph* self;
@@ -61,6 +96,10 @@ gfx::NodeHandle RenderGraph::cloneAndAddNode
             cinek::gfx::AnimationController controller(node->armature()->animSet);
             
             auto animController = vc.self->_animControllerPool.add(std::move(controller));
+            if (!animController) {
+                vc.self->_animControllerCounter.exhausted();
+                return true;
+            }
             node->armature()->animController = animController;
             
             vc.self->addAnimNode(vc.e, animController);
@@ -68,30 +107,97 @@ gfx::NodeHandle RenderGraph::cloneAndAddNode
         }
         return true;
     });
-    
-    //  our pending node will be added during the update() call
-    auto parentNode = _nodeGraph.createObjectNode(e);
-    parentNode->setTransform(gfx::Matrix4::kIdentity);
-    _nodeGraph.addChildNodeToNode(clonedNode, parentNode);
-    _nodeGraph.addChildNodeToNode(parentNode, rootNode);
-    
-    _pendingRenderNodes.emplace_back(Node{ e, parentNode, context });
-    
-    return parentNode;
 }
 
 gfx::NodeHandle RenderGraph::setNodeEntity(Entity e, gfx::NodeHandle h)
 {
-    _pendingRenderNodes.emplace_back(Node{ e, h, nullptr });
+    _pendingRenderNodes.emplace_back(Node{ e, h, nullptr, 0, nullptr });
     return h;
 }
 
+std::string RenderGraph::makeSourceName
+(
+    const char* modelSetName,
+    const char* modelName
+)
+{
+    std::string name = modelSetName;
+    name += ':';
+    name += modelName;
+    return name;
+}
+
+const char* RenderGraph::sourceName(Entity e) const
+{
+    auto node = findRenderNode(e);
+    if (!node || !node->sourceId)
+        return nullptr;
+    return _sourceNames[node->sourceId - 1].c_str();
+}
+
+uint32_t RenderGraph::replaceSourceNode
+(
+    const char* sourceName,
+    gfx::NodeHandle newSource
+)
+{
+    CK_ASSERT_RETURN_VALUE(newSource, 0);
+    
+    auto it = _sourceIds.find(sourceName);
+    if (it == _sourceIds.end())
+        return 0;
+    
+    const uint32_t sourceId = it->second;
+    uint32_t count = 0;
+    for (auto& node : _renderNodes) {
+        if (node.sourceId == sourceId) {
+            patchClonedNode(node, newSource);
+            ++count;
+        }
+    }
+    for (auto& node : _pendingRenderNodes) {
+        if (node.sourceId == sourceId) {
+            patchClonedNode(node, newSource);
+            ++count;
+        }
+    }
+    return count;
+}
+
+void RenderGraph::patchClonedNode(Node& node, gfx::NodeHandle newSource)
+{
+    //  drop the animation controller created for the old clone - an entity
+    //  has at most one, created from its clone's armature
+    auto animIt = std::lower_bound(_animNodes.begin(), _animNodes.end(), node.entity,
+        [](const AnimNode& animNode, Entity e) -> bool {
+            return animNode.entity < e;
+        });
+    if (animIt != _animNodes.end() && animIt->entity == node.entity) {
+        _animNodes.erase(animIt);
+    }
+    
+    if (node.clone) {
+        _nodeGraph.detachNodeTree(node.clone);
+    }
+    
+    node.clone = _nodeGraph.clone(newSource);
+    
+    initClonedNode(node.entity, node.clone);
+    _nodeGraph.addChildNodeToNode(node.clone, node.gfxNode);
+}
+
 void RenderGraph::removeNode(Entity e)
 {
     _removedRenderNodes.emplace_back(e);
 }
 
 gfx::NodeHandle RenderGraph::findNode(Entity entity) const
+{
+    auto node = findRenderNode(entity);
+    return node ? node->gfxNode : nullptr;
+}
+
+auto RenderGraph::findRenderNode(Entity entity) const -> const Node*
 {
     //  search sorted active list first
     //  then check the pending list
@@ -101,14 +207,15 @@ gfx::NodeHandle RenderGraph::findNode(Entity entity) const
         [](const Node& node, Entity e) -> bool {
             return (node.entity < e);
         });
-    if (it == _renderNodes.end() || it->entity != entity) {
-        //  pending list is not sorted
-        it = std::find_if(_pendingRenderNodes.begin(), _pendingRenderNodes.end(),
-            [entity](const Node& node) -> bool {
-                return node.entity == entity;
-            });
-    }
-    return it != _renderNodes.end() ? it->gfxNode : nullptr;
+    if (it != _renderNodes.end() && it->entity == entity)
+        return &(*it);
+    
+    //  pending list is not sorted
+    it = std::find_if(_pendingRenderNodes.begin(), _pendingRenderNodes.end(),
+        [entity](const Node& node) -> bool {
+            return node.entity == entity;
+        });
+    return it != _pendingRenderNodes.end() ? &(*it) : nullptr;
 }
 
 gfx::AnimationControllerHandle RenderGraph::findAnimationController(Entity e) const
@@ -151,6 +258,7 @@ void RenderGraph::clear()
     _animNodes.clear();
     _renderNodes.clear();
     _removedRenderNodes.clear();
+    _transforms.clear();
     _nodeGraph.clearRoot();
 }
 
@@ -159,6 +267,9 @@ void RenderGraph::update
     CKTimeDelta dt
 )
 {
+    OVENGINE_PROFILE_ZONE("RenderGraph::update");
+    OVENGINE_MEMORY_TAG(kMemoryTagRender);
+    
     //  sort added nodes into active list first
     if (!_pendingRenderNodes.empty()) {
         _renderNodes.insert(_renderNodes.end(), _pendingRenderNodes.begin(), _pendingRenderNodes.end());
@@ -224,6 +335,12 @@ void RenderGraph::update
     }
 
     _removedRenderNodes.clear();
+    
+    _renderNodeCounter.setUsed((uint32_t)_renderNodes.size());
+    _animControllerCounter.setUsed((uint32_t)_animNodes.size());
+    
+    //  world transforms are resolved after nodes are added and removed
+    _transforms.update(_nodeGraph);
 
     _renderTime += dt;
 }
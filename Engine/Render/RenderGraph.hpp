@@ -10,8 +10,12 @@
 #define Overview_RenderGraph_hpp
 
 #include "Engine/EngineTypes.hpp"
+#include "Engine/MemoryTracker.hpp"
 #include "CKGfx/NodeGraph.hpp"
+#include "CKGfx/NodeTransformCache.hpp"
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace cinek {
@@ -43,10 +47,13 @@ public:
      *  @param  context     A context pointer associated with the Node (used
      *                      during prepare() when the preparation delegate is
      *                      called.)
+     *  @param  sourceName  Names the source node for replaceSourceNode (see
+     *                      makeSourceName), or null if never replaced
      *  @return A handle to the created Node within the NodeGraph
      */
     gfx::NodeHandle cloneAndAddNode(Entity e, gfx::NodeHandle sourceNode,
-                                    void* context);
+                                    void* context,
+                                    const char* sourceName=nullptr);
     /**
      *  @param  e           The entity (acts as a key)
      *  @param  h           The node handle (created from this RenderGraph's
@@ -70,12 +77,37 @@ public:
      *          mapped to a node.
      */
     gfx::NodeHandle findNode(Entity e) const;
+    /**
+     *  @param  modelSetName    The registered ModelSet name
+     *  @param  modelName       The model within the set
+     *  @return The source name of a model, passed to cloneAndAddNode
+     */
+    static std::string makeSourceName(const char* modelSetName,
+                                      const char* modelName);
+    /**
+     *  @param  e   The entity to lookup
+     *  @return The source name passed to cloneAndAddNode for the entity, or
+     *          null if none
+     */
+    const char* sourceName(Entity e) const;
+    /**
+     *  Replaces every clone of a named source node with a clone of a new
+     *  source node.  The entity's object node (and its transform) are
+     *  preserved.  Used when reloading model sets.
+     *
+     *  @param  sourceName  The source name passed to cloneAndAddNode
+     *  @param  newSource   The replacement source node
+     *  @return The number of clones patched
+     */
+    uint32_t replaceSourceNode(const char* sourceName,
+                               gfx::NodeHandle newSource);
     /**
      *  Clears the render graph to entity map.
      */
     void clear();
     /**
-     *  Updates the render graph
+     *  Updates the render graph, including world transforms for nodes
+     *  whose transforms changed since the last update.
      */
     void update(CKTimeDelta dt);
     /**
@@ -88,11 +120,25 @@ public:
     gfx::NodeGraph& nodeGraph() {
         return _nodeGraph;
     }
+    /**
+     *  @return World transforms and bounds of the graph's nodes as of the
+     *          last update()
+     */
+    const gfx::NodeTransformCache& transforms() const {
+        return _transforms;
+    }
     /**
      *  @param  e   The entity to retrieve
      *  @return The controller attached to the specified entity.
      */
     gfx::AnimationControllerHandle findAnimationController(Entity e) const;
+    /**
+     *  Invokes a delegate for every entity mapped to a node, including nodes
+     *  pending addition.  The delegate should have the following prototype:
+     *      fn(Entity entity, gfx::NodeHandle node)
+     */
+    template<typename Fn>
+    void iterateNodes(Fn fn) const;
 
 private:
     //  controller objects are referenced by the nodegraph and our own animation
@@ -106,6 +152,8 @@ private:
     };
 
     cinek::gfx::NodeGraph _nodeGraph;
+    //  declared after the node graph, since it holds node handles
+    gfx::NodeTransformCache _transforms;
     CKTimeDelta _renderTime;
 
     struct Node
@@ -113,8 +161,18 @@ private:
         Entity entity;
         gfx::NodeHandle gfxNode;
         void* context;
+        //  the source name's index + 1 (0 if unnamed) and the clone (a
+        //  child of gfxNode) if created through cloneAndAddNode
+        uint32_t sourceId;
+        gfx::NodeHandle clone;
     };
     
+    const Node* findRenderNode(Entity e) const;
+    
+    //  source names are interned, as many entities share a source
+    std::vector<std::string> _sourceNames;
+    std::unordered_map<std::string, uint32_t> _sourceIds;
+    
     //  pending node lists
     std::vector<Node> _pendingRenderNodes;
     std::vector<Entity> _removedRenderNodes;
@@ -122,9 +180,27 @@ private:
     //  nodes ordered by Entity
     std::vector<Node> _renderNodes;
     std::vector<AnimNode> _animNodes;
+    
+    //  occupancy against the limits supplied at construction, sampled
+    //  after each update
+    PoolCounter _renderNodeCounter;
+    PoolCounter _animControllerCounter;
 
     AnimNode* addAnimNode(Entity e, gfx::AnimationControllerHandle h);
+    void initClonedNode(Entity e, gfx::NodeHandle clonedNode);
+    void patchClonedNode(Node& node, gfx::NodeHandle newSource);
 };
+
+template<typename Fn>
+void RenderGraph::iterateNodes(Fn fn) const
+{
+    for (auto& node : _renderNodes) {
+        fn(node.entity, node.gfxNode);
+    }
+    for (auto& node : _pendingRenderNodes) {
+        fn(node.entity, node.gfxNode);
+    }
+}
     
     }   /* namesapce ove */
 }   /* namespace cinek */
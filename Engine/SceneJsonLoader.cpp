@@ -50,7 +50,8 @@ SceneJsonLoader::SceneJsonLoader
     _sceneContext(context),
     _gfxContext(gfxContext),
     _renderGraph(renderGraph),
-    _entityDb(entityDb)
+    _entityDb(entityDb),
+    _retainMeshSources(false)
 {
 }
 
@@ -68,6 +69,7 @@ SceneJsonLoader::SceneBodyList SceneJsonLoader::operator()
 
         gfx::NodeJsonLoader gfxJsonLoader;
         gfxJsonLoader.context = _gfxContext;
+        gfxJsonLoader.retainStagedMeshes = _retainMeshSources;
         gfxJsonLoader.jsonMeshes = jsonRoot.FindMember("meshes");
         gfxJsonLoader.jsonLights = jsonRoot.FindMember("lights");
         gfxJsonLoader.jsonMaterials = jsonRoot.FindMember("materials");
@@ -80,6 +82,11 @@ SceneJsonLoader::SceneBodyList SceneJsonLoader::operator()
             sceneObjJsonLoader.hulls.reserve(sceneObjJsonLoader.jsonHullsArrayIt->value.Size());
         }
         
+        //  decode meshes, animations and hulls in parallel before the
+        //  (serial) node traversal registers them
+        gfxJsonLoader.stageResources(jsonRoot);
+        sceneObjJsonLoader.stageHulls(jsonRoot);
+        
         const JsonValue& jsonNode = jsonNodesIt->value;
         
         Context context;
@@ -93,11 +100,28 @@ SceneJsonLoader::SceneBodyList SceneJsonLoader::operator()
         
         Node node = parseJsonNode(context, root, jsonNode);
         _renderGraph->nodeGraph().setRoot(node.gfxNodeHandle);
+        
+        _meshSources.clear();
+        if (_retainMeshSources) {
+            auto& meshes = gfxJsonLoader.meshes;
+            auto& staged = gfxJsonLoader.stagedMeshes;
+            for (size_t i = 0; i < meshes.size() && i < staged.size(); ++i) {
+                if (meshes[i].first && staged[i].format != gfx::VertexTypes::kInvalid) {
+                    _meshSources.emplace_back(meshes[i].first.resource(),
+                                              std::move(staged[i]));
+                }
+            }
+        }
     }
     
     return bodyList;
 }
 
+auto SceneJsonLoader::acquireMeshSources() -> MeshSourceList
+{
+    return std::move(_meshSources);
+}
+
 auto SceneJsonLoader::parseJsonNode
 (
     Context context,
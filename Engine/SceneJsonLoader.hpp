@@ -11,6 +11,7 @@
 
 #include "Engine/EngineTypes.hpp"
 #include "CKGfx/GfxTypes.hpp"
+#include "CKGfx/ModelJsonSerializer.hpp"
 
 #include <ckjson/jsontypes.hpp>
 #include <vector>
@@ -37,8 +38,20 @@ public:
     ~SceneJsonLoader();
     
     using SceneBodyList = std::vector<std::pair<SceneBody*, uint32_t>>;
+    using MeshSourceList = std::vector<std::pair<const gfx::Mesh*, gfx::MeshStaging>>;
     
     SceneBodyList operator()(const JsonValue& jsonRoot);
+    /**
+     *  When set, the CPU side data for meshes created by the next load is
+     *  kept for acquireMeshSources (used when capturing a SceneSnapshot.)
+     *
+     *  @param  retain  True to retain mesh data
+     */
+    void setRetainMeshSources(bool retain) { _retainMeshSources = retain; }
+    /**
+     *  @return Mesh data retained from the last load, keyed by Mesh
+     */
+    MeshSourceList acquireMeshSources();
     
 private:
     struct Node;
@@ -56,6 +69,8 @@ private:
     gfx::Context* _gfxContext;
     RenderGraph* _renderGraph;
     EntityDatabase* _entityDb;
+    bool _retainMeshSources;
+    MeshSourceList _meshSources;
 };
     
     } /* namespace ove */
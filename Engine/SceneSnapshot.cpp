@@ -0,0 +1,1081 @@
+//
+//  SceneSnapshot.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/2/16.
+//
+//
+
+#include "SceneSnapshot.hpp"
+#include "Debug.hpp"
+#include "AssetArchive.hpp"
+#include "AssetManifest.hpp"
+#include "EntityDatabase.hpp"
+#include "MappedFile.hpp"
+#include "StateHash.hpp"
+
+#include "Render/RenderGraph.hpp"
+#include "Physics/Scene.hpp"
+#include "Physics/SceneDataContext.hpp"
+#include "Physics/SceneMotionState.hpp"
+#include "Path/Pathfinder.hpp"
+
+#include "CKGfx/Context.hpp"
+#include "CKGfx/Texture.hpp"
+#include "CKGfx/Material.hpp"
+#include "CKGfx/Mesh.hpp"
+#include "CKGfx/Light.hpp"
+#include "CKGfx/Node.hpp"
+
+#include <bgfx/bgfx.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+namespace cinek {
+    namespace ove {
+
+////////////////////////////////////////////////////////////////////////////////
+//  File layout
+//
+//  Header
+//  Section[kSectionCount]
+//  Section data (each 16 byte aligned)
+//
+//  Record tables reference each other by index, strings by offset into the
+//  string section and bulk data (vertices, indices) by offset into the data
+//  section.
+//
+struct SceneSnapshot::Header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint32_t reserved;
+};
+
+struct SceneSnapshot::Section
+{
+    uint32_t offset;
+    uint32_t size;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct SceneSnapshot::TextureRecord
+{
+    uint32_t name;
+    uint32_t path;
+};
+
+struct SceneSnapshot::MaterialRecord
+{
+    uint32_t name;
+    uint32_t texture;
+    float diffuseColor[4];
+    float specularColor[4];
+    float specularPower;
+    float specularIntensity;
+};
+
+struct SceneSnapshot::MeshRecord
+{
+    uint32_t format;
+    uint32_t indexType;
+    uint32_t vertexOffset;
+    uint32_t vertexSize;
+    uint32_t indexOffset;
+    uint32_t indexSize;
+};
+
+struct SceneSnapshot::MeshElementRecord
+{
+    uint32_t mesh;
+    uint32_t material;
+};
+
+struct SceneSnapshot::LightRecord
+{
+    uint32_t type;
+    float ambientComp;
+    float diffuseComp;
+    uint32_t color;
+    float coeff[3];
+    float distance;
+    float cutoff;
+};
+
+struct SceneSnapshot::NodeRecord
+{
+    uint32_t parent;
+    uint32_t elementType;
+    float transform[16];
+    float obbMin[3];
+    float obbMax[3];
+    //  mesh: first MeshElementRecord, light: LightRecord index,
+    //  armature: animation set name, object: node id
+    uint32_t element;
+    uint32_t elementCount;
+};
+
+struct SceneSnapshot::HullRecord
+{
+    uint32_t name;
+    uint32_t vertexCount;
+    uint32_t faceCount;
+    uint32_t vertexOffset;
+    uint32_t indexOffset;
+};
+
+struct SceneSnapshot::EntityRecord
+{
+    uint32_t context;
+    uint32_t node;
+};
+
+struct SceneSnapshot::SourceRecord
+{
+    uint32_t path;
+    uint32_t reserved;
+    uint64_t hash;
+};
+
+struct SceneSnapshot::BodyRecord
+{
+    uint32_t entity;
+    uint32_t node;          // kNoIndex if the body's node isn't in the graph
+    uint32_t hull;
+    uint32_t categoryMask;
+    float localScaling[3];
+    float transform[16];    // used if node is kNoIndex
+};
+
+static const char kSnapshotMagic[4] = { 'O', 'V', 'S', 'S' };
+
+const uint32_t SceneSnapshot::kVersion;
+const uint32_t SceneSnapshot::kDataAlignment;
+const uint32_t SceneSnapshot::kNoIndex;
+
+////////////////////////////////////////////////////////////////////////////////
+
+class SceneSnapshot::Writer
+{
+public:
+    Writer() :
+        _sections(kSectionCount),
+        _counts(kSectionCount, 0)
+    {
+    }
+
+    template<typename Record>
+    uint32_t add(SectionType type, const Record& record)
+    {
+        auto& buffer = _sections[type];
+        auto offset = buffer.size();
+        buffer.resize(offset + sizeof(Record));
+        memcpy(buffer.data() + offset, &record, sizeof(Record));
+        return _counts[type]++;
+    }
+
+    uint32_t addString(const std::string& str)
+    {
+        if (str.empty())
+            return kNoIndex;
+
+        auto it = _strings.find(str);
+        if (it != _strings.end())
+            return it->second;
+
+        auto& buffer = _sections[kStrings];
+        uint32_t offset = (uint32_t)buffer.size();
+        buffer.insert(buffer.end(), str.begin(), str.end());
+        buffer.push_back(0);
+        ++_counts[kStrings];
+        _strings.emplace(str, offset);
+        return offset;
+    }
+
+    uint32_t addData(const void* data, size_t size)
+    {
+        auto& buffer = _sections[kData];
+        size_t offset = (buffer.size() + kDataAlignment - 1) & ~(size_t)(kDataAlignment - 1);
+        buffer.resize(offset + size);
+        if (size) {
+            memcpy(buffer.data() + offset, data, size);
+        }
+        _counts[kData] = 1;
+        return (uint32_t)offset;
+    }
+
+    void setBytes(SectionType type, std::vector<uint8_t> data)
+    {
+        _counts[type] = data.empty() ? 0 : 1;
+        _sections[type] = std::move(data);
+    }
+
+    bool write(const char* path) const
+    {
+        Header header;
+        memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+        header.version = kVersion;
+        header.sectionCount = kSectionCount;
+        header.reserved = 0;
+
+        Section table[kSectionCount];
+        uint32_t offset = sizeof(Header) + sizeof(table);
+        for (uint32_t i = 0; i < kSectionCount; ++i) {
+            offset = (offset + kDataAlignment - 1) & ~(kDataAlignment - 1);
+            table[i].offset = offset;
+            table[i].size = (uint32_t)_sections[i].size();
+            table[i].count = _counts[i];
+            table[i].reserved = 0;
+            offset += table[i].size;
+        }
+
+        FILE* fp = fopen(path, "wb");
+        if (!fp) {
+            OVENGINE_LOG_ERROR("SceneSnapshot.save - cannot create %s\n", path);
+            return false;
+        }
+
+        bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                  fwrite(table, sizeof(table), 1, fp) == 1;
+
+        const uint8_t padding[kDataAlignment] = { 0 };
+        for (uint32_t i = 0; ok && i < kSectionCount; ++i) {
+            long pos = ftell(fp);
+            if (pos < (long)table[i].offset) {
+                ok = fwrite(padding, table[i].offset - pos, 1, fp) == 1;
+            }
+            if (ok && !_sections[i].empty()) {
+                ok = fwrite(_sections[i].data(), _sections[i].size(), 1, fp) == 1;
+            }
+        }
+
+        fclose(fp);
+
+        if (!ok) {
+            OVENGINE_LOG_ERROR("SceneSnapshot.save - failed writing %s\n", path);
+            remove(path);
+        }
+        return ok;
+    }
+
+private:
+    std::vector<std::vector<uint8_t>> _sections;
+    std::vector<uint32_t> _counts;
+    std::unordered_map<std::string, uint32_t> _strings;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void collectSnapshotNodes
+(
+    const gfx::Node* node,
+    uint32_t parent,
+    std::vector<std::pair<const gfx::Node*, uint32_t>>& nodes
+)
+{
+    uint32_t index = (uint32_t)nodes.size();
+    nodes.emplace_back(node, parent);
+    for (auto child = node->firstChild(); child; child = child->nextSibling()) {
+        collectSnapshotNodes(child, index, nodes);
+    }
+}
+
+//  maps texture names (paths without extension) to their paths, using the
+//  same traversal as the AssetManifestLoader
+static void collectManifestTexturePaths
+(
+    std::unordered_map<std::string, std::string>& paths,
+    const JsonValue& object
+)
+{
+    for (auto it = object.MemberBegin(); it != object.MemberEnd(); ++it) {
+        auto& value = it->value;
+        if (!strcmp(it->name.GetString(), "textures") && value.IsArray()) {
+            for (auto texIt = value.Begin(); texIt != value.End(); ++texIt) {
+                if (!texIt->IsString())
+                    continue;
+                std::string path = texIt->GetString();
+                std::string name = path;
+                auto extpos = name.find_last_of('.');
+                if (extpos != std::string::npos) {
+                    name.erase(extpos);
+                }
+                paths.emplace(std::move(name), std::move(path));
+            }
+        }
+        else if (value.IsObject()) {
+            collectManifestTexturePaths(paths, value);
+        }
+    }
+}
+
+static void collectManifestModelSets
+(
+    std::vector<std::string>& paths,
+    const JsonValue& object
+)
+{
+    for (auto it = object.MemberBegin(); it != object.MemberEnd(); ++it) {
+        auto& value = it->value;
+        if (!strcmp(it->name.GetString(), "modelset") && value.IsString()) {
+            std::string path = value.GetString();
+            if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
+                paths.emplace_back(std::move(path));
+            }
+        }
+        else if (value.IsObject()) {
+            collectManifestModelSets(paths, value);
+        }
+    }
+}
+
+//  hashes a source file's contents, read from the archive if present as
+//  LoadFile would.  returns false if the file can't be read
+static bool hashSourceFile
+(
+    uint64_t& hash,
+    const char* path,
+    const AssetArchive* archive
+)
+{
+    MappedFile file;
+    if (archive) {
+        file = archive->openEntry(path);
+    }
+    if (!file) {
+        file = MappedFile(path);
+    }
+    if (!file)
+        return false;
+
+    StateHash contentHash;
+    contentHash.add(file.data(), file.size());
+    hash = contentHash.value();
+    return true;
+}
+
+static void copyMatrix(float* dest, const gfx::Matrix4& mtx)
+{
+    for (int i = 0; i < 16; ++i) {
+        dest[i] = mtx.comp[i];
+    }
+}
+
+static void copyMatrix(gfx::Matrix4& mtx, const float* src)
+{
+    for (int i = 0; i < 16; ++i) {
+        mtx.comp[i] = src[i];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SceneSnapshot::SceneSnapshot(const InitParams& params) :
+    _params(params)
+{
+}
+
+bool SceneSnapshot::save
+(
+    const char* path,
+    const SceneJsonLoader::MeshSourceList& meshSources,
+    const AssetManifest* manifest,
+    const char* manifestPath
+)
+{
+    auto& gfxContext = *_params.gfxContext;
+
+    Writer writer;
+
+    //  source files, checked on load
+    std::vector<std::string> sourcePaths;
+    sourcePaths.emplace_back(manifestPath);
+    if (manifest) {
+        collectManifestModelSets(sourcePaths, manifest->root());
+    }
+    for (auto& sourcePath : sourcePaths) {
+        SourceRecord record;
+        if (!hashSourceFile(record.hash, sourcePath.c_str(), _params.archive)) {
+            OVENGINE_LOG_ERROR("SceneSnapshot.save - cannot read source %s\n",
+                               sourcePath.c_str());
+            return false;
+        }
+        record.path = writer.addString(sourcePath);
+        record.reserved = 0;
+        writer.add(kSources, record);
+    }
+
+    std::unordered_map<std::string, std::string> texturePaths;
+    if (manifest) {
+        collectManifestTexturePaths(texturePaths, manifest->root());
+    }
+
+    std::unordered_map<const gfx::Mesh*, const gfx::MeshStaging*> meshSourceMap;
+    for (auto& source : meshSources) {
+        meshSourceMap.emplace(source.first, &source.second);
+    }
+
+    //  resource tables - populated as nodes reference them
+    std::unordered_map<const void*, uint32_t> textureIndices;
+    std::unordered_map<const void*, uint32_t> materialIndices;
+    std::unordered_map<const void*, uint32_t> meshIndices;
+    std::unordered_map<const void*, uint32_t> lightIndices;
+
+    auto textureIndex = [&](const gfx::TextureHandle& texture) -> uint32_t {
+        if (!texture)
+            return kNoIndex;
+        auto it = textureIndices.find(texture.resource());
+        if (it != textureIndices.end())
+            return it->second;
+
+        const char* name = gfxContext.resourceName(texture.resource());
+        if (!name) {
+            OVENGINE_LOG_WARN("SceneSnapshot.save - skipping unnamed texture\n");
+            return kNoIndex;
+        }
+        auto pathIt = texturePaths.find(name);
+        TextureRecord record;
+        record.name = writer.addString(name);
+        record.path = pathIt != texturePaths.end() ? writer.addString(pathIt->second)
+                                                   : kNoIndex;
+        uint32_t index = writer.add(kTextures, record);
+        textureIndices.emplace(texture.resource(), index);
+        return index;
+    };
+
+    auto materialIndex = [&](const gfx::MaterialHandle& material) -> uint32_t {
+        if (!material)
+            return kNoIndex;
+        auto it = materialIndices.find(material.resource());
+        if (it != materialIndices.end())
+            return it->second;
+
+        const char* name = gfxContext.resourceName(material.resource());
+        MaterialRecord record;
+        record.name = name ? writer.addString(name) : kNoIndex;
+        record.texture = textureIndex(material->diffuseTex);
+        record.diffuseColor[0] = material->diffuseColor.comp[0];
+        record.diffuseColor[1] = material->diffuseColor.comp[1];
+        record.diffuseColor[2] = material->diffuseColor.comp[2];
+        record.diffuseColor[3] = material->diffuseColor.comp[3];
+        record.specularColor[0] = material->specularColor.comp[0];
+        record.specularColor[1] = material->specularColor.comp[1];
+        record.specularColor[2] = material->specularColor.comp[2];
+        record.specularColor[3] = material->specularColor.comp[3];
+        record.specularPower = material->specularPower;
+        record.specularIntensity = material->specularIntensity;
+        uint32_t index = writer.add(kMaterials, record);
+        materialIndices.emplace(material.resource(), index);
+        return index;
+    };
+
+    auto meshIndex = [&](const gfx::MeshHandle& mesh) -> uint32_t {
+        if (!mesh)
+            return kNoIndex;
+        auto it = meshIndices.find(mesh.resource());
+        if (it != meshIndices.end())
+            return it->second;
+
+        auto sourceIt = meshSourceMap.find(mesh.resource());
+        if (sourceIt == meshSourceMap.end())
+            return kNoIndex;
+
+        auto& staging = *sourceIt->second;
+        MeshRecord record;
+        record.format = staging.format;
+        record.indexType = staging.indexType;
+        record.vertexSize = (uint32_t)staging.vertexData.size();
+        record.vertexOffset = writer.addData(staging.vertexData.data(), record.vertexSize);
+        record.indexSize = (uint32_t)staging.indexData.size();
+        record.indexOffset = writer.addData(staging.indexData.data(), record.indexSize);
+        uint32_t index = writer.add(kMeshes, record);
+        meshIndices.emplace(mesh.resource(), index);
+        return index;
+    };
+
+    auto lightIndex = [&](const gfx::LightHandle& light) -> uint32_t {
+        if (!light)
+            return kNoIndex;
+        auto it = lightIndices.find(light.resource());
+        if (it != lightIndices.end())
+            return it->second;
+
+        LightRecord record;
+        record.type = (uint32_t)light->type;
+        record.ambientComp = light->ambientComp;
+        record.diffuseComp = light->diffuseComp;
+        record.color = light->color;
+        record.coeff[0] = light->coeff.x;
+        record.coeff[1] = light->coeff.y;
+        record.coeff[2] = light->coeff.z;
+        record.distance = light->distance;
+        record.cutoff = light->cutoff;
+        uint32_t index = writer.add(kLights, record);
+        lightIndices.emplace(light.resource(), index);
+        return index;
+    };
+
+    //  node graph, parents before children
+    std::vector<std::pair<const gfx::Node*, uint32_t>> nodes;
+    auto root = _params.renderGraph->root();
+    if (root) {
+        collectSnapshotNodes(root.resource(), kNoIndex, nodes);
+    }
+
+    std::unordered_map<const gfx::Node*, uint32_t> nodeIndices;
+    nodeIndices.reserve(nodes.size());
+
+    uint32_t unsourcedMeshCount = 0;
+
+    for (auto& entry : nodes) {
+        const gfx::Node* node = entry.first;
+
+        NodeRecord record;
+        record.parent = entry.second;
+        record.elementType = node->elementType();
+        copyMatrix(record.transform, node->transform());
+        record.obbMin[0] = node->obb().min.x;
+        record.obbMin[1] = node->obb().min.y;
+        record.obbMin[2] = node->obb().min.z;
+        record.obbMax[0] = node->obb().max.x;
+        record.obbMax[1] = node->obb().max.y;
+        record.obbMax[2] = node->obb().max.z;
+        record.element = kNoIndex;
+        record.elementCount = 0;
+
+        switch (node->elementType()) {
+        case gfx::Node::kElementTypeMesh:
+            for (auto element = node->mesh(); element; element = element->next) {
+                MeshElementRecord elementRecord;
+                elementRecord.mesh = meshIndex(element->mesh);
+                elementRecord.material = materialIndex(element->material);
+                if (element->mesh && elementRecord.mesh == kNoIndex) {
+                    ++unsourcedMeshCount;
+                }
+                uint32_t index = writer.add(kMeshElements, elementRecord);
+                if (!record.elementCount) {
+                    record.element = index;
+                }
+                ++record.elementCount;
+            }
+            break;
+        case gfx::Node::kElementTypeLight:
+            record.element = lightIndex(node->light()->light);
+            break;
+        case gfx::Node::kElementTypeArmature: {
+                auto& animSet = node->armature()->animSet;
+                const char* name = animSet ? gfxContext.resourceName(animSet.resource())
+                                           : nullptr;
+                record.element = name ? writer.addString(name) : kNoIndex;
+            }
+            break;
+        case gfx::Node::kElementTypeObject:
+            record.element = node->objectNodeId();
+            break;
+        default:
+            break;
+        }
+
+        nodeIndices.emplace(node, writer.add(kNodes, record));
+    }
+
+    if (unsourcedMeshCount) {
+        OVENGINE_LOG_WARN("SceneSnapshot.save - %u meshes without source data "
+                          "will not be restored\n", unsourcedMeshCount);
+    }
+
+    //  entities from render nodes and bodies - sorted so that restored
+    //  entities (allocated in order) preserve relative ordering, keeping
+    //  scene container inserts at the tail
+    std::vector<Entity> entities;
+    std::unordered_map<Entity, const gfx::Node*> entityNodes;
+    _params.renderGraph->iterateNodes(
+        [&entities, &entityNodes](Entity entity, gfx::NodeHandle node) {
+            entities.push_back(entity);
+            entityNodes.emplace(entity, node.resource());
+        });
+    _params.scene->iterateBodies(SceneBody::kAllCategories,
+        [&entities](SceneBody* body, uint32_t) {
+            entities.push_back(body->entity);
+        });
+    std::sort(entities.begin(), entities.end());
+    entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+
+    std::unordered_map<Entity, uint32_t> entityIndices;
+    for (auto entity : entities) {
+        EntityRecord record;
+        record.context = cinek_entity_context(entity);
+        record.node = kNoIndex;
+        auto nodeIt = entityNodes.find(entity);
+        if (nodeIt != entityNodes.end()) {
+            auto indexIt = nodeIndices.find(nodeIt->second);
+            if (indexIt != nodeIndices.end()) {
+                record.node = indexIt->second;
+            }
+        }
+        entityIndices.emplace(entity, writer.add(kEntities, record));
+    }
+
+    //  bodies and their hulls
+    std::unordered_map<const SceneFixedBodyHull*, uint32_t> hullIndices;
+    uint32_t skippedBodyCount = 0;
+
+    _params.scene->iterateBodies(SceneBody::kAllCategories,
+        [&](SceneBody* body, uint32_t) {
+            auto hull = body->getFixedHull();
+            if (!hull) {
+                ++skippedBodyCount;
+                return;
+            }
+
+            auto hullIt = hullIndices.find(hull);
+            if (hullIt == hullIndices.end()) {
+                HullRecord record;
+                record.name = writer.addString(hull->name());
+                record.vertexCount = hull->vertexCount();
+                record.faceCount = hull->triangleCount();
+                record.vertexOffset = writer.addData(hull->vertexData(),
+                    sizeof(float) * 3 * hull->vertexCount());
+                record.indexOffset = writer.addData(hull->indexData(),
+                    sizeof(int) * 3 * hull->triangleCount());
+                hullIt = hullIndices.emplace(hull, writer.add(kHulls, record)).first;
+            }
+
+            BodyRecord record;
+            record.entity = entityIndices[body->entity];
+            record.node = kNoIndex;
+            record.hull = hullIt->second;
+            record.categoryMask = body->getCategoryMask();
+
+            const btVector3& scaling = body->btBody->getCollisionShape()->getLocalScaling();
+            record.localScaling[0] = (float)scaling.getX();
+            record.localScaling[1] = (float)scaling.getY();
+            record.localScaling[2] = (float)scaling.getZ();
+
+            ckm::matrix4 transform;
+            body->getTransformMatrix(transform);
+            for (int i = 0; i < 16; ++i) {
+                record.transform[i] = (float)transform.comp[i];
+            }
+
+            if (body->motionState) {
+                auto nodeIt = nodeIndices.find(body->motionState->node().resource());
+                if (nodeIt != nodeIndices.end()) {
+                    record.node = nodeIt->second;
+                }
+            }
+
+            writer.add(kBodies, record);
+        });
+
+    if (skippedBodyCount) {
+        OVENGINE_LOG_WARN("SceneSnapshot.save - %u bodies without hulls skipped\n",
+                          skippedBodyCount);
+    }
+
+    //  navigation mesh
+    std::vector<uint8_t> navMeshData;
+    if (_params.pathfinder && _params.pathfinder->saveNavMeshData(navMeshData)) {
+        writer.setBytes(kNavMesh, std::move(navMeshData));
+    }
+
+    return writer.write(path);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool SceneSnapshot::load(const char* path, const char* assetOwner)
+{
+    MappedFile file(path);
+    if (!file) {
+        return false;
+    }
+
+    const uint8_t* data = file.data();
+    const uint32_t size = file.size();
+
+    //  validate before instantiating anything
+    if (size < sizeof(Header) + sizeof(Section) * kSectionCount) {
+        OVENGINE_LOG_ERROR("SceneSnapshot.load - %s is truncated\n", path);
+        return false;
+    }
+    auto header = reinterpret_cast<const Header*>(data);
+    if (memcmp(header->magic, kSnapshotMagic, sizeof(kSnapshotMagic)) ||
+        header->version != kVersion ||
+        header->sectionCount != kSectionCount) {
+        OVENGINE_LOG_ERROR("SceneSnapshot.load - %s is not a compatible snapshot\n", path);
+        return false;
+    }
+    auto sections = reinterpret_cast<const Section*>(data + sizeof(Header));
+    for (uint32_t i = 0; i < kSectionCount; ++i) {
+        if ((uint64_t)sections[i].offset + sections[i].size > size ||
+            (sections[i].offset % kDataAlignment) != 0) {
+            OVENGINE_LOG_ERROR("SceneSnapshot.load - %s has an invalid section\n", path);
+            return false;
+        }
+    }
+
+    auto recordSizeValid = [sections](SectionType type, size_t recordSize) -> bool {
+        return (uint64_t)sections[type].count * recordSize == sections[type].size;
+    };
+    if (!recordSizeValid(kTextures, sizeof(TextureRecord)) ||
+        !recordSizeValid(kMaterials, sizeof(MaterialRecord)) ||
+        !recordSizeValid(kMeshes, sizeof(MeshRecord)) ||
+        !recordSizeValid(kMeshElements, sizeof(MeshElementRecord)) ||
+        !recordSizeValid(kLights, sizeof(LightRecord)) ||
+        !recordSizeValid(kNodes, sizeof(NodeRecord)) ||
+        !recordSizeValid(kHulls, sizeof(HullRecord)) ||
+        !recordSizeValid(kEntities, sizeof(EntityRecord)) ||
+        !recordSizeValid(kBodies, sizeof(BodyRecord)) ||
+        !recordSizeValid(kSources, sizeof(SourceRecord))) {
+        OVENGINE_LOG_ERROR("SceneSnapshot.load - %s has invalid record tables\n", path);
+        return false;
+    }
+
+    auto strings = reinterpret_cast<const char*>(data + sections[kStrings].offset);
+    const uint32_t stringsSize = sections[kStrings].size;
+    if (stringsSize && strings[stringsSize-1] != 0) {
+        OVENGINE_LOG_ERROR("SceneSnapshot.load - %s has an invalid string table\n", path);
+        return false;
+    }
+    auto stringValid = [stringsSize](uint32_t offset) -> bool {
+        return offset == kNoIndex || offset < stringsSize;
+    };
+    auto stringAt = [strings](uint32_t offset) -> const char* {
+        return offset != kNoIndex ? strings + offset : "";
+    };
+
+    //  a snapshot without sources can't be checked against them
+    auto sources = reinterpret_cast<const SourceRecord*>(data + sections[kSources].offset);
+    const uint32_t sourceCount = sections[kSources].count;
+    if (!sourceCount) {
+        OVENGINE_LOG_ERROR("SceneSnapshot.load - %s has no sources\n", path);
+        return false;
+    }
+    for (uint32_t i = 0; i < sourceCount; ++i) {
+        if (sources[i].path == kNoIndex || !stringValid(sources[i].path)) {
+            OVENGINE_LOG_ERROR("SceneSnapshot.load - %s has an invalid source\n", path);
+            return false;
+        }
+        uint64_t hash;
+        const char* sourcePath = stringAt(sources[i].path);
+        if (!hashSourceFile(hash, sourcePath, _params.archive) ||
+            hash != sources[i].hash) {
+            OVENGINE_LOG_INFO("SceneSnapshot.load - %s is out of date (%s)\n",
+                              path, sourcePath);
+            return false;
+        }
+    }
+
+    const uint8_t* blob = data + sections[kData].offset;
+    const uint32_t blobSize = sections[kData].size;
+    auto blobValid = [blobSize](uint32_t offset, uint64_t len) -> bool {
+        return offset + len <= blobSize;
+    };
+
+    auto textures = reinterpret_cast<const TextureRecord*>(data + sections[kTextures].offset);
+    auto materials = reinterpret_cast<const MaterialRecord*>(data + sections[kMaterials].offset);
+    auto meshes = reinterpret_cast<const MeshRecord*>(data + sections[kMeshes].offset);
+    auto meshElements = reinterpret_cast<const MeshElementRecord*>(data + sections[kMeshElements].offset);
+    auto lights = reinterpret_cast<const LightRecord*>(data + sections[kLights].offset);
+    auto nodes = reinterpret_cast<const NodeRecord*>(data + sections[kNodes].offset);
+    auto hulls = reinterpret_cast<const HullRecord*>(data + sections[kHulls].offset);
+    auto entities = reinterpret_cast<const EntityRecord*>(data + sections[kEntities].offset);
+    auto bodies = reinterpret_cast<const BodyRecord*>(data + sections[kBodies].offset);
+
+    const uint32_t textureCount = sections[kTextures].count;
+    const uint32_t materialCount = sections[kMaterials].count;
+    const uint32_t meshCount = sections[kMeshes].count;
+    const uint32_t meshElementCount = sections[kMeshElements].count;
+    const uint32_t lightCount = sections[kLights].count;
+    const uint32_t nodeCount = sections[kNodes].count;
+    const uint32_t hullCount = sections[kHulls].count;
+    const uint32_t entityCount = sections[kEntities].count;
+    const uint32_t bodyCount = sections[kBodies].count;
+
+    bool valid = true;
+    for (uint32_t i = 0; valid && i < textureCount; ++i) {
+        valid = stringValid(textures[i].name) && textures[i].name != kNoIndex &&
+                stringValid(textures[i].path);
+    }
+    for (uint32_t i = 0; valid && i < materialCount; ++i) {
+        valid = stringValid(materials[i].name) &&
+                (materials[i].texture == kNoIndex || materials[i].texture < textureCount);
+    }
+    for (uint32_t i = 0; valid && i < meshCount; ++i) {
+        valid = meshes[i].format < gfx::VertexTypes::kFormatLimit &&
+                blobValid(meshes[i].vertexOffset, meshes[i].vertexSize) &&
+                blobValid(meshes[i].indexOffset, meshes[i].indexSize);
+    }
+    for (uint32_t i = 0; valid && i < meshElementCount; ++i) {
+        valid = (meshElements[i].mesh == kNoIndex || meshElements[i].mesh < meshCount) &&
+                (meshElements[i].material == kNoIndex || meshElements[i].material < materialCount);
+    }
+    for (uint32_t i = 0; valid && i < nodeCount; ++i) {
+        auto& node = nodes[i];
+        //  the first node is the root, and parents precede their children
+        valid = (i == 0) ? node.parent == kNoIndex : node.parent < i;
+        if (!valid)
+            break;
+        switch (node.elementType) {
+        case gfx::Node::kElementTypeMesh:
+            valid = node.elementCount > 0 &&
+                    (uint64_t)node.element + node.elementCount <= meshElementCount;
+            break;
+        case gfx::Node::kElementTypeLight:
+            valid = node.element == kNoIndex || node.element < lightCount;
+            break;
+        case gfx::Node::kElementTypeArmature:
+            valid = stringValid(node.element);
+            break;
+        default:
+            break;
+        }
+    }
+    for (uint32_t i = 0; valid && i < hullCount; ++i) {
+        valid = stringValid(hulls[i].name) && hulls[i].name != kNoIndex &&
+                blobValid(hulls[i].vertexOffset, sizeof(float) * 3 * (uint64_t)hulls[i].vertexCount) &&
+                blobValid(hulls[i].indexOffset, sizeof(int) * 3 * (uint64_t)hulls[i].faceCount);
+    }
+    for (uint32_t i = 0; valid && i < entityCount; ++i) {
+        valid = entities[i].node == kNoIndex || entities[i].node < nodeCount;
+    }
+    for (uint32_t i = 0; valid && i < bodyCount; ++i) {
+        valid = bodies[i].entity < entityCount && bodies[i].hull < hullCount &&
+                (bodies[i].node == kNoIndex || bodies[i].node < nodeCount);
+    }
+    if (!valid) {
+        OVENGINE_LOG_ERROR("SceneSnapshot.load - %s has invalid references\n", path);
+        return false;
+    }
+
+    //  fix-up pass - records to resources
+    auto& gfxContext = *_params.gfxContext;
+    auto& nodeGraph = _params.renderGraph->nodeGraph();
+
+    std::vector<gfx::TextureHandle> textureHandles(textureCount);
+    for (uint32_t i = 0; i < textureCount; ++i) {
+        const char* name = stringAt(textures[i].name);
+        auto handle = gfxContext.findTexture(name);
+        if (!handle && textures[i].path != kNoIndex) {
+            gfx::Texture texture = gfx::Texture::loadTextureFromFile(stringAt(textures[i].path));
+            if (texture) {
+                handle = gfxContext.registerTexture(std::move(texture), name);
+            }
+        }
+        if (!handle) {
+            OVENGINE_LOG_WARN("SceneSnapshot.load - texture %s not found\n", name);
+        }
+        else if (assetOwner) {
+            gfxContext.addAssetOwner(assetOwner, gfx::ResourceType::kTexture, name);
+        }
+        textureHandles[i] = handle;
+    }
+
+    std::vector<gfx::MaterialHandle> materialHandles(materialCount);
+    for (uint32_t i = 0; i < materialCount; ++i) {
+        auto& record = materials[i];
+        const char* name = stringAt(record.name);
+        gfx::MaterialHandle handle;
+        if (name[0]) {
+            handle = gfxContext.findMaterial(name);
+        }
+        if (!handle) {
+            gfx::Material material;
+            if (record.texture != kNoIndex) {
+                material.diffuseTex = textureHandles[record.texture];
+            }
+            material.diffuseColor.comp[0] = record.diffuseColor[0];
+            material.diffuseColor.comp[1] = record.diffuseColor[1];
+            material.diffuseColor.comp[2] = record.diffuseColor[2];
+            material.diffuseColor.comp[3] = record.diffuseColor[3];
+            material.specularColor.comp[0] = record.specularColor[0];
+            material.specularColor.comp[1] = record.specularColor[1];
+            material.specularColor.comp[2] = record.specularColor[2];
+            material.specularColor.comp[3] = record.specularColor[3];
+            material.specularPower = record.specularPower;
+            material.specularIntensity = record.specularIntensity;
+            handle = gfxContext.registerMaterial(std::move(material), name);
+        }
+        materialHandles[i] = handle;
+    }
+
+    std::vector<gfx::MeshHandle> meshHandles(meshCount);
+    for (uint32_t i = 0; i < meshCount; ++i) {
+        auto& record = meshes[i];
+        gfx::Mesh mesh((gfx::VertexTypes::Format)record.format,
+                       (gfx::VertexTypes::Index)record.indexType,
+                       bgfx::copy(blob + record.vertexOffset, record.vertexSize),
+                       bgfx::copy(blob + record.indexOffset, record.indexSize),
+                       gfx::PrimitiveType::kTriangles);
+        meshHandles[i] = gfxContext.registerMesh(std::move(mesh));
+    }
+
+    std::vector<gfx::LightHandle> lightHandles(lightCount);
+    for (uint32_t i = 0; i < lightCount; ++i) {
+        auto& record = lights[i];
+        gfx::Light light;
+        light.type = (gfx::LightType)record.type;
+        light.ambientComp = record.ambientComp;
+        light.diffuseComp = record.diffuseComp;
+        light.color = record.color;
+        light.coeff.x = record.coeff[0];
+        light.coeff.y = record.coeff[1];
+        light.coeff.z = record.coeff[2];
+        light.distance = record.distance;
+        light.cutoff = record.cutoff;
+        lightHandles[i] = gfxContext.registerLight(std::move(light));
+    }
+
+    std::vector<gfx::NodeHandle> nodeHandles(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; ++i) {
+        auto& record = nodes[i];
+        gfx::NodeHandle node;
+        switch (record.elementType) {
+        case gfx::Node::kElementTypeMesh: {
+                node = nodeGraph.createMeshNode(record.elementCount);
+                auto element = node ? node->mesh() : nullptr;
+                for (uint32_t e = 0; element && e < record.elementCount; ++e) {
+                    auto& elementRecord = meshElements[record.element + e];
+                    if (elementRecord.mesh != kNoIndex) {
+                        element->mesh = meshHandles[elementRecord.mesh];
+                    }
+                    if (elementRecord.material != kNoIndex) {
+                        element->material = materialHandles[elementRecord.material];
+                    }
+                    element = element->next;
+                }
+            }
+            break;
+        case gfx::Node::kElementTypeLight:
+            node = nodeGraph.createLightNode();
+            if (node && record.element != kNoIndex) {
+                node->light()->light = lightHandles[record.element];
+            }
+            break;
+        case gfx::Node::kElementTypeArmature:
+            node = nodeGraph.createArmatureNode();
+            if (node && record.element != kNoIndex) {
+                const char* name = stringAt(record.element);
+                node->armature()->animSet = gfxContext.findAnimationSet(name);
+                if (!node->armature()->animSet) {
+                    OVENGINE_LOG_WARN("SceneSnapshot.load - animation set %s not found\n",
+                                      name);
+                }
+            }
+            break;
+        case gfx::Node::kElementTypeObject:
+            node = nodeGraph.createObjectNode(record.element);
+            break;
+        default:
+            node = nodeGraph.createObjectNode(0);
+            break;
+        }
+        if (!node) {
+            OVENGINE_LOG_ERROR("SceneSnapshot.load - out of nodes (%u of %u)\n",
+                               i, nodeCount);
+            return false;
+        }
+
+        copyMatrix(node->transform(), record.transform);
+        node->obb().min.x = record.obbMin[0];
+        node->obb().min.y = record.obbMin[1];
+        node->obb().min.z = record.obbMin[2];
+        node->obb().max.x = record.obbMax[0];
+        node->obb().max.y = record.obbMax[1];
+        node->obb().max.z = record.obbMax[2];
+
+        if (record.parent != kNoIndex) {
+            nodeGraph.addChildNodeToNode(node, nodeHandles[record.parent]);
+        }
+        nodeHandles[i] = node;
+    }
+    if (nodeCount) {
+        nodeGraph.setRoot(nodeHandles[0]);
+    }
+
+    std::vector<Entity> entityIds(entityCount);
+    for (uint32_t i = 0; i < entityCount; ++i) {
+        auto& record = entities[i];
+        auto context = (EntityContextType)record.context;
+        entityIds[i] = _params.entityDb->getStore(context).create(context);
+        if (record.node != kNoIndex) {
+            _params.renderGraph->setNodeEntity(entityIds[i], nodeHandles[record.node]);
+        }
+    }
+
+    auto& sceneData = *_params.sceneData;
+
+    std::vector<SceneFixedBodyHull*> hullPtrs(hullCount);
+    for (uint32_t i = 0; i < hullCount; ++i) {
+        auto& record = hulls[i];
+        const char* name = stringAt(record.name);
+        auto hull = sceneData.acquireFixedBodyHull(name);
+        if (!hull) {
+            SceneFixedBodyHull::VertexIndexCount counts;
+            counts.numVertices = record.vertexCount;
+            counts.numFaces = record.faceCount;
+            hull = sceneData.allocateFixedBodyHull(counts, name);
+            if (hull) {
+                memcpy(hull->pullVertices(counts.numVertices), blob + record.vertexOffset,
+                       sizeof(float) * 3 * counts.numVertices);
+                memcpy(hull->pullTriangleIndices(counts.numFaces), blob + record.indexOffset,
+                       sizeof(int) * 3 * counts.numFaces);
+                hull->finalize();
+            }
+        }
+        hullPtrs[i] = hull;
+    }
+
+    SceneBatch batch;
+    for (uint32_t i = 0; i < bodyCount; ++i) {
+        auto& record = bodies[i];
+        auto hull = hullPtrs[record.hull];
+        if (!hull)
+            continue;
+
+        btVector3 scaling(record.localScaling[0], record.localScaling[1],
+                          record.localScaling[2]);
+        auto shape = sceneData.allocateTriangleMeshShape(hull, scaling);
+
+        //  bodies whose nodes weren't part of the render graph get a detached
+        //  node to drive their motion state
+        gfx::NodeHandle node;
+        if (record.node != kNoIndex) {
+            node = nodeHandles[record.node];
+        }
+        else {
+            node = nodeGraph.createObjectNode(0);
+            if (node) {
+                copyMatrix(node->transform(), record.transform);
+            }
+        }
+
+        SceneDataContext::SceneBodyInitParams initParams(shape);
+        SceneBody* body = sceneData.allocateBody(initParams, node,
+                                                 entityIds[record.entity]);
+        if (body) {
+            batch.attach(body, record.categoryMask);
+        }
+    }
+    _params.scene->applyBatch(batch);
+
+    if (sections[kNavMesh].size && _params.pathfinder) {
+        if (!_params.pathfinder->loadNavMeshData(data + sections[kNavMesh].offset,
+                                                 sections[kNavMesh].size)) {
+            OVENGINE_LOG_ERROR("SceneSnapshot.load - failed to restore nav mesh\n");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+    }  /* namespace ove */
+}  /* namespace cinek */
@@ -0,0 +1,132 @@
+//
+//  SceneSnapshot.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/2/16.
+//
+//
+
+#ifndef Overview_SceneSnapshot_hpp
+#define Overview_SceneSnapshot_hpp
+
+#include "Engine/EngineTypes.hpp"
+#include "Engine/SceneJsonLoader.hpp"
+
+#include <vector>
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  @class  SceneSnapshot
+ *  @brief  Saves and restores a fully instantiated scene.
+ *
+ *  Loading a scene from JSON involves parsing the manifest, decoding meshes
+ *  and hulls, creating entities, attaching bodies and baking the navigation
+ *  mesh.  A snapshot captures the result of that process - the scene's
+ *  entities, render graph (topology, transforms and element data), scene
+ *  bodies and hulls, and the Detour navigation mesh - as flat record tables.
+ *  Restoring a snapshot is a single mapped read followed by fix-ups that
+ *  convert record indices to handles.
+ *
+ *  Snapshots record a content hash of each of the scene's source files (the
+ *  scene manifest and the model set manifests it references), read through
+ *  the asset archive if one is mounted.  A snapshot whose sources have
+ *  changed is rejected on load.  Textures aren't hashed, as snapshots
+ *  reference them by path and load them from their sources.
+ *
+ *  Snapshots are meant to be captured immediately after loading a scene.
+ *  Entity components other than render nodes and scene bodies are not
+ *  captured, nor are nodes whose meshes have no retained mesh source (i.e.
+ *  nodes cloned from model sets.)  Textures are referenced by name and
+ *  loaded from file if not already resident.
+ */
+class SceneSnapshot
+{
+    CK_CLASS_NON_COPYABLE(SceneSnapshot);
+
+public:
+    struct InitParams
+    {
+        SceneDataContext* sceneData;
+        gfx::Context* gfxContext;
+        RenderGraph* renderGraph;
+        EntityDatabase* entityDb;
+        Scene* scene;
+        Pathfinder* pathfinder;
+        //  searched before the file system for source files (optional)
+        AssetArchive* archive;
+    };
+
+    SceneSnapshot(const InitParams& params);
+
+    /**
+     *  Writes the current scene to a snapshot file.
+     *
+     *  @param  path        The snapshot file path
+     *  @param  meshSources Mesh data retained by the SceneJsonLoader
+     *  @param  manifest    The scene manifest, used to resolve texture paths
+     *                      and the model sets it references
+     *  @param  manifestPath The path the scene manifest was loaded from
+     *  @return True if successful
+     */
+    bool save(const char* path,
+              const SceneJsonLoader::MeshSourceList& meshSources,
+              const AssetManifest* manifest,
+              const char* manifestPath);
+    /**
+     *  Restores a scene from a snapshot file.  The snapshot is validated,
+     *  and its sources checked against their current contents, before
+     *  modifying any scene data.
+     *
+     *  @param  path        The snapshot file path
+     *  @param  assetOwner  Owner of the scene's textures for residency
+     *                      tracking (optional)
+     *  @return True if successful
+     */
+    bool load(const char* path, const char* assetOwner=nullptr);
+
+private:
+    struct Header;
+    struct Section;
+    struct SourceRecord;
+    struct TextureRecord;
+    struct MaterialRecord;
+    struct MeshRecord;
+    struct MeshElementRecord;
+    struct LightRecord;
+    struct NodeRecord;
+    struct HullRecord;
+    struct EntityRecord;
+    struct BodyRecord;
+    class Writer;
+
+    enum SectionType
+    {
+        kStrings,
+        kTextures,
+        kMaterials,
+        kMeshes,
+        kMeshElements,
+        kLights,
+        kNodes,
+        kHulls,
+        kEntities,
+        kBodies,
+        kNavMesh,
+        kSources,
+        kData,
+        kSectionCount
+    };
+
+    static const uint32_t kVersion = 2;
+    static const uint32_t kDataAlignment = 16;
+    static const uint32_t kNoIndex = 0xffffffff;
+
+    InitParams _params;
+};
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#endif /* Overview_SceneSnapshot_hpp */
@@ -48,6 +48,7 @@ void AssetService::loadManifest
         *_context.resourceFactory,
         taskCb
     );
+    task->setArchive(_context.archive);
     
     _context.taskScheduler->schedule(std::move(task), this);
 }
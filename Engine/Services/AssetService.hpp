@@ -26,6 +26,7 @@ struct AssetServiceContext
 {
     TaskScheduler* taskScheduler;
     AssetManfiestFactory* resourceFactory;
+    std::shared_ptr<AssetArchive> archive;      // optional
 };
     
 class AssetService
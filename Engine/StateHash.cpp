@@ -0,0 +1,70 @@
+//
+//  StateHash.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/9/16.
+//
+//
+
+#include "StateHash.hpp"
+
+#include "Engine/Physics/Scene.hpp"
+#include "Engine/Controller/NavSystem.hpp"
+#include "Engine/Controller/NavBody.hpp"
+
+namespace cinek {
+    namespace ove {
+
+void StateHash::add(const void* data, size_t size)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        _value = (_value ^ bytes[i]) * 1099511628211ULL;
+    }
+}
+
+static void hashVector(StateHash& hash, const btVector3& v)
+{
+    //  btVector3's fourth component is padding
+    hash.add(v.x());
+    hash.add(v.y());
+    hash.add(v.z());
+}
+
+void hashSimulationState
+(
+    StateHash& hash,
+    const Scene* scene,
+    const NavSystem* navSystem
+)
+{
+    if (scene) {
+        scene->iterateBodies(SceneBody::kAllCategories,
+            [&hash](SceneBody* body, uint32_t ) {
+                hash.add(body->entity);
+                hash.add(body->getCategoryMask());
+
+                ckm::matrix4 mtx;
+                body->getTransformMatrix(mtx);
+                for (int i = 0; i < 16; ++i) {
+                    hash.add(mtx[i]);
+                }
+                hashVector(hash, body->linearVelocity);
+                hashVector(hash, body->angularVelocity);
+            });
+    }
+
+    if (navSystem) {
+        navSystem->iterateBodies(
+            [&hash](const NavBody* body) {
+                hash.add(body->entity());
+                hash.add(body->state());
+                hash.add(&body->position(), sizeof(body->position()));
+                hash.add(&body->rotation(), sizeof(body->rotation()));
+                hash.add(body->speedScalar());
+            });
+    }
+}
+
+    }  /* namespace ove */
+}  /* namespace cinek */
@@ -0,0 +1,66 @@
+//
+//  StateHash.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/9/16.
+//
+//
+
+#ifndef Overview_StateHash_hpp
+#define Overview_StateHash_hpp
+
+#include "Engine/EngineTypes.hpp"
+
+#include <type_traits>
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  @class  StateHash
+ *  @brief  Accumulates a 64-bit FNV-1a hash of simulation state.
+ *
+ *  Values are hashed by their bytes, so floating point state hashes equal
+ *  only if bitwise equal.  Used by replays to detect where a run diverges
+ *  from its recording.
+ */
+class StateHash
+{
+public:
+    StateHash() : _value(14695981039346656037ULL) {}
+
+    void add(const void* data, size_t size);
+
+    template<typename T> void add(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Hashed values must be trivially copyable");
+        add(&value, sizeof(T));
+    }
+
+    uint64_t value() const { return _value; }
+
+private:
+    uint64_t _value;
+};
+
+/**
+ *  Hashes the state of simulated objects - Scene body transforms and
+ *  velocities, and NavBody path states and transforms.  Bodies are visited
+ *  in entity order, so the hash doesn't depend on attach order.
+ *
+ *  @param  hash        The hash to add to
+ *  @param  scene       The scene (optional)
+ *  @param  navSystem   The navigation system (optional)
+ */
+void hashSimulationState
+(
+    StateHash& hash,
+    const Scene* scene,
+    const NavSystem* navSystem
+);
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#endif /* Overview_StateHash_hpp */
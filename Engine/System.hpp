@@ -28,6 +28,9 @@ public:
     Body* findBody(Entity entity);
     const Body* findBody(Entity entity) const;
     
+    //  calls fn(const Body*) for each body in entity order
+    template<typename Fn> void iterateBodies(Fn fn) const;
+    
     //  framework
     void activate();
     void startFrame();
@@ -49,6 +52,15 @@ protected:
     ) const;
 
 };
+
+template<typename Body, typename Derived>
+template<typename Fn>
+void System<Body, Derived>::iterateBodies(Fn fn) const
+{
+    for (const Body* body : _bodies) {
+        fn(body);
+    }
+}
     
     } /* namespace ove */
 } /* namespace cinek */
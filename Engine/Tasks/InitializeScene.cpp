@@ -8,6 +8,7 @@
 
 #include "InitializeScene.hpp"
 #include "Engine/AssetManifest.hpp"
+#include "Engine/Profiler.hpp"
 
 namespace cinek {
     namespace ove {
@@ -49,6 +50,8 @@ SceneJsonLoader::SceneBodyList InitializeScene::acquireBodyList()
 
 void InitializeScene::onUpdate(uint32_t deltaTimeMs)
 {
+    OVENGINE_PROFILE_ZONE("InitializeScene");
+    
     _bodyList = _loader(_manifest->root());
     end();
 }
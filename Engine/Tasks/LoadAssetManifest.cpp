@@ -18,6 +18,12 @@ const UUID LoadAssetManifest::kUUID = {
     0xa1, 0x0c, 0xd7, 0xf2, 0xc6, 0x3c, 0xe0, 0x34
 };
         
+LoadAssetManifest::LoadAssetManifest(EndCallback cb) :
+    LoadFile(cb),
+    _factory(nullptr)
+{
+    setMode(Mode::kMapped);
+}
 
 LoadAssetManifest::LoadAssetManifest
 (
@@ -28,7 +34,7 @@ LoadAssetManifest::LoadAssetManifest
     LoadFile(name, cb),
     _factory(&factory)
 {
-
+    setMode(Mode::kMapped);
 }
     
 std::shared_ptr<AssetManifest> LoadAssetManifest::acquireManifest()
@@ -43,11 +49,20 @@ void LoadAssetManifest::onFileLoaded()
     if (idx != std::string::npos) {
         manifestName.erase(idx);
     }
-    _manifest = std::allocate_shared<AssetManifest>(
-                    std_allocator<AssetManifest>(),
-                    std::move(manifestName),
-                    std::move(_buffer)
-                );
+    if (mode() == Mode::kMapped) {
+        _manifest = std::allocate_shared<AssetManifest>(
+                        std_allocator<AssetManifest>(),
+                        std::move(manifestName),
+                        acquireMapping()
+                    );
+    }
+    else {
+        _manifest = std::allocate_shared<AssetManifest>(
+                        std_allocator<AssetManifest>(),
+                        std::move(manifestName),
+                        std::move(_buffer)
+                    );
+    }
     
     _loader = std::move(AssetManifestLoader(*_manifest.get(), *_factory));
     _loader.start([this](AssetManifestLoader::LoadResult r) {
@@ -25,7 +25,7 @@ class LoadAssetManifest : public LoadFile
 public:
     static const UUID kUUID;
     
-    LoadAssetManifest(EndCallback cb=0) : LoadFile(cb), _factory(nullptr) {}
+    LoadAssetManifest(EndCallback cb=0);
     LoadAssetManifest(std::string name, AssetManfiestFactory& factory,
                       EndCallback cb=0);
 
@@ -7,6 +7,10 @@
 //
 
 #include "LoadFile.hpp"
+#include "Engine/AssetArchive.hpp"
+#include "Engine/Profiler.hpp"
+
+#include <cstring>
 
 namespace cinek {
     namespace ove {
@@ -16,6 +20,15 @@ const UUID LoadFile::kUUID = {
     0xa6, 0xeb, 0x4b, 0x04, 0x3b, 0xc4, 0x2b, 0xba
 };
         
+LoadFile::LoadFile(EndCallback cb) :
+    Task(cb),
+    _mode(Mode::kStream),
+    _buffer(nullptr),
+    _size(0),
+    _file(nullptr),
+    _loadPending(false)
+{
+}
 
 LoadFile::LoadFile
 (
@@ -24,9 +37,11 @@ LoadFile::LoadFile
 ) :
     Task(cb),
     _name(std::move(name)),
+    _mode(Mode::kStream),
     _buffer(nullptr),
     _size(0),
-    _file(nullptr)
+    _file(nullptr),
+    _loadPending(false)
 {
 
 }
@@ -44,20 +59,75 @@ void LoadFile::close()
     }
 }
 
+bool LoadFile::openMapping()
+{
+    do
+    {
+        if (_archive) {
+            _mapping = _archive->openEntry(_name.c_str(),
+                                           MappedFile::Access::kCopyOnWrite);
+        }
+        if (!_mapping) {
+            _mapping = MappedFile(_name.c_str(),
+                                  MappedFile::Access::kCopyOnWrite);
+        }
+    }
+    while (!_mapping && retry(_name));
+    
+    return !!_mapping;
+}
+
+MappedFile LoadFile::acquireMapping()
+{
+    return std::move(_mapping);
+}
+
 void LoadFile::onBegin()
 {
+    OVENGINE_PROFILE_ZONE("LoadFile::begin");
+    
+    _loadPending = false;
+    
+    if (_mode == Mode::kMapped) {
+        if (openMapping()) {
+            _buffer = _mapping.data();
+            _size = _mapping.size();
+            _loadPending = true;
+        }
+        else {
+            fail();
+        }
+        return;
+    }
+    
+    MappedFile entry;
     do
     {
-        _file = ckio_open(_name.c_str(), kCKIO_Async | kCKIO_ReadFlag);
+        if (_archive) {
+            entry = _archive->openEntry(_name.c_str());
+        }
+        if (!entry) {
+            _file = ckio_open(_name.c_str(), kCKIO_Async | kCKIO_ReadFlag);
+        }
     }
-    while (!_file && retry(_name));
+    while (!entry && !_file && retry(_name));
     
-    if (_file) {
+    if (entry) {
+        //  archive entries are already resident - copy and complete on the
+        //  next update
+        uint8_t* buffer = acquireBuffer(entry.size());
+        memcpy(buffer, entry.data(), entry.size());
+        _buffer = buffer;
+        _size = entry.size();
+        _loadPending = true;
+    }
+    else if (_file) {
         uint32_t cnt = (uint32_t)ckio_get_info(_file, nullptr);
         if (cnt) {
-            _buffer = acquireBuffer(cnt);
+            uint8_t* buffer = acquireBuffer(cnt);
+            _buffer = buffer;
             _size = cnt;
-            ckio_read(_file, _buffer, _size);
+            ckio_read(_file, buffer, _size);
         }
     }
     else {
@@ -68,7 +138,13 @@ void LoadFile::onBegin()
 
 void LoadFile::onUpdate(uint32_t )
 {
-    if (_file) {
+    OVENGINE_PROFILE_ZONE("LoadFile::update");
+    
+    if (_loadPending) {
+        _loadPending = false;
+        onFileLoaded();
+    }
+    else if (_file) {
         ckio_status status = ckio_get_status(_file, nullptr);
         if (status == kCKIO_Success) {
             close();
@@ -9,12 +9,15 @@
 #ifndef Oveview_Task_LoadFile_hpp
 #define Oveview_Task_LoadFile_hpp
 
+#include "Engine/MappedFile.hpp"
+
 #include <cinek/allocator.hpp>
 #include <cinek/task.hpp>
 #include <ckio/file.h>
 
 #include <vector>
 #include <string>
+#include <memory>
 
 namespace cinek {
     namespace ove {
@@ -24,11 +27,29 @@ class LoadFile : public Task
 public:
     static const UUID kUUID;
     
-    LoadFile(EndCallback cb) : Task(cb), _file(nullptr) {}
+    //  kStream reads the file asynchronously into a buffer supplied by
+    //  acquireBuffer.  kMapped maps the file (or archive entry) copy-on-write
+    //  and exposes the mapped pages via buffer(), skipping acquireBuffer
+    //  altogether.  Parsers may modify the mapping in situ.
+    enum class Mode
+    {
+        kStream,
+        kMapped
+    };
+    
+    LoadFile(EndCallback cb);
     LoadFile(std::string name, EndCallback cb=0);
     virtual ~LoadFile();
     
     void setName(std::string name) { _name = name; }
+    void setMode(Mode mode) { _mode = mode; }
+    //  Entries found in the archive are loaded from it instead of the
+    //  filesystem
+    void setArchive(std::shared_ptr<AssetArchive> archive) {
+        _archive = std::move(archive);
+    }
+    
+    Mode mode() const { return _mode; }
     
     const uint8_t* buffer() const { return _buffer; }
     uint32_t size() const { return _size; }
@@ -46,14 +67,23 @@ protected:
     virtual uint8_t* acquireBuffer(uint32_t size) = 0;
     virtual bool retry(std::string& path) { return false; }
     
+    //  Transfers ownership of the mapping to the caller (kMapped only.)
+    //  buffer() remains valid only while the returned mapping is alive.
+    MappedFile acquireMapping();
+    
 private:
+    bool openMapping();
     void close();
     
     std::string _name;
-    uint8_t* _buffer;
+    Mode _mode;
+    const uint8_t* _buffer;
     uint32_t _size;
     
     ckio_handle *_file;
+    std::shared_ptr<AssetArchive> _archive;
+    MappedFile _mapping;
+    bool _loadPending;
 };
     
     }  /* namespace ove */
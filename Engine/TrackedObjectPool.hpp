@@ -0,0 +1,77 @@
+//
+//  TrackedObjectPool.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#ifndef Overview_TrackedObjectPool_hpp
+#define Overview_TrackedObjectPool_hpp
+
+#include "Engine/MemoryTracker.hpp"
+
+#include <cinek/objectpool.hpp>
+
+#include <utility>
+
+namespace cinek {
+    namespace ove {
+
+/**
+ *  @class  TrackedObjectPool
+ *  @brief  An ObjectPool that reports its occupancy to the MemoryTracker.
+ *
+ *  Has the same construct/destruct interface as ObjectPool.  The pool's
+ *  backing memory is accounted to the memory tag current at construction.
+ */
+template<typename T>
+class TrackedObjectPool
+{
+    CK_CLASS_NON_COPYABLE(TrackedObjectPool);
+
+public:
+    /**
+     *  @param  name        The pool's display name (copied)
+     *  @param  tag         The subsystem owning the pool
+     *  @param  capacity    The number of objects in the pool
+     */
+    TrackedObjectPool(const char* name, MemoryTag tag, uint32_t capacity) :
+        _counter(name, tag, capacity),
+        _pool(capacity)
+    {
+    }
+
+    template<typename... Args> T* construct(Args&&... args)
+    {
+        T* obj = _pool.construct(std::forward<Args>(args)...);
+        if (obj) {
+            _counter.acquired();
+        }
+        else {
+            _counter.exhausted();
+        }
+        return obj;
+    }
+
+    void destruct(T* obj)
+    {
+        if (obj) {
+            _counter.released();
+        }
+        _pool.destruct(obj);
+    }
+
+    bool verify(T* obj) { return _pool.verify(obj); }
+
+    PoolCounter::Stats stats() const { return _counter.stats(); }
+
+private:
+    PoolCounter _counter;
+    ObjectPool<T> _pool;
+};
+
+    }  /* namespace ove */
+}  /* namespace cinek */
+
+#endif /* Overview_TrackedObjectPool_hpp */
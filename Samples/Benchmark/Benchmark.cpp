@@ -0,0 +1,318 @@
+//
+//  Benchmark.cpp
+//  Benchmark
+//
+//  Created by Samir Sinha on 4/8/16.
+//
+//
+//  Headless benchmark runner.  Renders with bgfx's Noop renderer, so it
+//  runs without a window or GPU.  Run from the sample data directory:
+//
+//      Benchmark [--frames N] [--warmup N] [--timeout secs]
+//                [--output file.json] [scene ...]
+//
+//  Scenes default to the EnginePrototype sample scenes.  Results are written
+//  as JSON to stdout, or to the --output file.  A scene that fails to load
+//  within the timeout fails the run.
+//
+
+#include "SceneBenchmark.hpp"
+#include "SampleSystems.hpp"
+#include "Renderer.hpp"
+
+#include "Engine/JobSystem.hpp"
+#include "Engine/FrameArena.hpp"
+#include "Engine/MemoryTracker.hpp"
+
+#include "CKGfx/VertexTypes.hpp"
+#include "CKGfx/ShaderLibrary.hpp"
+#include "CKGfx/ModelJsonSerializer.hpp"
+
+#include <cinek/file.hpp>
+
+#include <bgfx/bgfx.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace cinek {
+
+struct BenchmarkOptions
+{
+    uint32_t frameCount;
+    uint32_t warmupFrames;
+    uint32_t loadTimeoutSecs;
+    const char* outputPath;
+    std::vector<std::string> scenes;
+};
+
+static bool parseOptions(BenchmarkOptions& options, int argc, char* argv[])
+{
+    options.frameCount = 600;
+    options.warmupFrames = 60;
+    options.loadTimeoutSecs = 120;
+    options.outputPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(arg, "--frames") && hasValue) {
+            options.frameCount = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(arg, "--warmup") && hasValue) {
+            options.warmupFrames = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(arg, "--timeout") && hasValue) {
+            options.loadTimeoutSecs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(arg, "--output") && hasValue) {
+            options.outputPath = argv[++i];
+        }
+        else if (arg[0] == '-') {
+            fprintf(stderr, "Usage: %s [--frames N] [--warmup N] [--timeout secs] "
+                            "[--output file.json] [scene ...]\n", argv[0]);
+            return false;
+        }
+        else {
+            options.scenes.emplace_back(arg);
+        }
+    }
+
+    if (options.scenes.empty()) {
+        options.scenes.emplace_back("scenes/cityblock.json");
+        options.scenes.emplace_back("scenes/apartment.json");
+    }
+    return options.frameCount > 0;
+}
+
+//  nearest-rank percentile of a sorted array
+template<typename T>
+static T percentile(const std::vector<T>& sorted, double pct)
+{
+    if (sorted.empty())
+        return T();
+    size_t rank = (size_t)(pct * 0.01 * sorted.size() + 0.5);
+    rank = std::min(std::max(rank, (size_t)1), sorted.size());
+    return sorted[rank - 1];
+}
+
+template<typename T>
+static void writeDistribution(FILE* fp, std::vector<T> values, double scale)
+{
+    std::sort(values.begin(), values.end());
+    double total = 0.0;
+    for (auto value : values) {
+        total += (double)value;
+    }
+    fprintf(fp, "{\"mean\":%.4f,\"p50\":%.4f,\"p90\":%.4f,\"p99\":%.4f,"
+                "\"min\":%.4f,\"max\":%.4f}",
+            values.empty() ? 0.0 : total * scale / values.size(),
+            (double)percentile(values, 50.0) * scale,
+            (double)percentile(values, 90.0) * scale,
+            (double)percentile(values, 99.0) * scale,
+            values.empty() ? 0.0 : (double)values.front() * scale,
+            values.empty() ? 0.0 : (double)values.back() * scale);
+}
+
+template<typename Fn>
+static void writeSampleDistribution
+(
+    FILE* fp,
+    const char* name,
+    const std::vector<SceneBenchmark::FrameSample>& samples,
+    double scale,
+    Fn fn
+)
+{
+    std::vector<uint64_t> values;
+    values.reserve(samples.size());
+    for (auto& sample : samples) {
+        values.push_back(fn(sample));
+    }
+    fprintf(fp, "\"%s\":", name);
+    writeDistribution(fp, std::move(values), scale);
+}
+
+static void writeSceneResult
+(
+    FILE* fp,
+    const std::string& scene,
+    const SceneBenchmark* benchmark
+)
+{
+    fprintf(fp, "{\"scene\":\"%s\",", scene.c_str());
+    if (!benchmark) {
+        fputs("\"error\":\"load failed or timed out\"}", fp);
+        return;
+    }
+
+    auto& samples = benchmark->samples();
+    const double kNsToMs = 1.0e-6;
+
+    fprintf(fp, "\"loadMs\":%.3f,\"bodies\":%u,\"frames\":%u,",
+            benchmark->loadNs() * kNsToMs, benchmark->bodyCount(),
+            (uint32_t)samples.size());
+
+    fputs("\"stagesMs\":{", fp);
+    for (uint32_t stage = 0; stage < SceneBenchmark::kStageCount; ++stage) {
+        if (stage) {
+            fputc(',', fp);
+        }
+        writeSampleDistribution(fp,
+            SceneBenchmark::stageName((SceneBenchmark::Stage)stage),
+            samples, kNsToMs,
+            [stage](const SceneBenchmark::FrameSample& sample) -> uint64_t {
+                return sample.stageNs[stage];
+            });
+    }
+    fputc(',', fp);
+    writeSampleDistribution(fp, "total", samples, kNsToMs,
+        [](const SceneBenchmark::FrameSample& sample) -> uint64_t {
+            uint64_t total = 0;
+            for (auto ns : sample.stageNs) {
+                total += ns;
+            }
+            return total;
+        });
+    fputs("},\"perFrame\":{", fp);
+
+    writeSampleDistribution(fp, "allocations", samples, 1.0,
+        [](const SceneBenchmark::FrameSample& sample) -> uint64_t {
+            return sample.allocCount;
+        });
+    fputc(',', fp);
+    writeSampleDistribution(fp, "allocatedBytes", samples, 1.0,
+        [](const SceneBenchmark::FrameSample& sample) -> uint64_t {
+            return sample.allocBytes;
+        });
+    fputc(',', fp);
+    writeSampleDistribution(fp, "draws", samples, 1.0,
+        [](const SceneBenchmark::FrameSample& sample) -> uint64_t {
+            return sample.renderStats.drawCount;
+        });
+    fputc(',', fp);
+    writeSampleDistribution(fp, "instancedDraws", samples, 1.0,
+        [](const SceneBenchmark::FrameSample& sample) -> uint64_t {
+            return sample.renderStats.instancedDrawCount;
+        });
+    fputc(',', fp);
+    writeSampleDistribution(fp, "meshElements", samples, 1.0,
+        [](const SceneBenchmark::FrameSample& sample) -> uint64_t {
+            return sample.renderStats.meshElementCount;
+        });
+    fputc(',', fp);
+    writeSampleDistribution(fp, "culledNodes", samples, 1.0,
+        [](const SceneBenchmark::FrameSample& sample) -> uint64_t {
+            return sample.renderStats.culledNodeCount;
+        });
+    fputs("}}", fp);
+}
+
+static int runBenchmarks(const BenchmarkOptions& options)
+{
+    const gfx::Rect viewRect = { 0, 0, 1280, 720 };
+
+    gfx::VertexTypes::initialize();
+    gfx::ShaderLibrary shaderLibrary;
+    gfx::NodeRenderer::ProgramMap shaderPrograms;
+    gfx::NodeRenderer::UniformMap shaderUniforms;
+
+    const std::vector<SampleShaderProgram> shaderConfigs =
+        SampleSystems::shaderPrograms();
+    registerShaders(shaderLibrary, shaderPrograms, shaderUniforms, shaderConfigs);
+
+    ove::FrameArena::InitParams frameArenaParams;
+    frameArenaParams.bytesPerThread = 256*1024;
+    frameArenaParams.threadLimit = 32;
+    ove::FrameArena frameArena(frameArenaParams);
+    ove::FrameArena::setCurrent(&frameArena);
+
+    ove::JobSystem::InitParams jobSystemParams;
+    jobSystemParams.workerCount = ove::JobSystem::defaultWorkerCount();
+    ove::JobSystem jobSystem(jobSystemParams);
+    gfx::setJsonDecodeJobRunner(
+        [&jobSystem](uint32_t count, const std::function<void(uint32_t)>& job) {
+            jobSystem.parallelFor(0, count, 1, job);
+        });
+
+    FILE* fp = stdout;
+    if (options.outputPath) {
+        fp = fopen(options.outputPath, "wb");
+        if (!fp) {
+            fprintf(stderr, "Failed to open %s\n", options.outputPath);
+            gfx::setJsonDecodeJobRunner(nullptr);
+            ove::FrameArena::setCurrent(nullptr);
+            return 1;
+        }
+    }
+
+    int result = 0;
+
+    //  allocation counts are zero unless built with OVE_MEMORY_TRACKING
+    fprintf(fp, "{\"renderer\":\"%s\",\"workers\":%u,\"warmupFrames\":%u,"
+                "\"heapTracking\":%s,\"results\":[\n",
+            bgfx::getRendererName(bgfx::getRendererType()),
+            jobSystem.workerCount(), options.warmupFrames,
+            ove::MemoryTracker::heapTracking() ? "true" : "false");
+
+    for (size_t i = 0; i < options.scenes.size(); ++i) {
+        auto& scene = options.scenes[i];
+
+        SceneBenchmark::InitParams params;
+        params.programs = &shaderPrograms;
+        params.uniforms = &shaderUniforms;
+        params.viewRect = viewRect;
+        params.jobSystem = &jobSystem;
+        params.loadTimeoutMs = options.loadTimeoutSecs * 1000;
+
+        SceneBenchmark benchmark(params);
+        bool loaded = benchmark.load(scene);
+        if (loaded) {
+            benchmark.run(options.warmupFrames, options.frameCount);
+        }
+        else {
+            result = 1;
+        }
+
+        writeSceneResult(fp, scene, loaded ? &benchmark : nullptr);
+        fputs(i + 1 < options.scenes.size() ? ",\n" : "\n", fp);
+    }
+
+    fputs("]}\n", fp);
+
+    if (fp != stdout) {
+        fclose(fp);
+    }
+
+    gfx::setJsonDecodeJobRunner(nullptr);
+    ove::FrameArena::setCurrent(nullptr);
+
+    return result;
+}
+
+}   /* namespace cinek */
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+    cinek::BenchmarkOptions options;
+    if (!cinek::parseOptions(options, argc, argv))
+        return 1;
+
+    cinek::file::setOpsStdio();
+
+    //  no window or platform data is needed by the Noop renderer
+    bgfx::init(bgfx::RendererType::Noop);
+    bgfx::reset(1280, 720, BGFX_RESET_NONE);
+
+    int result = cinek::runBenchmarks(options);
+
+    bgfx::shutdown();
+
+    return result;
+}
@@ -0,0 +1,266 @@
+//
+//  SceneBenchmark.cpp
+//  Benchmark
+//
+//  Created by Samir Sinha on 4/8/16.
+//
+//
+
+#include "SceneBenchmark.hpp"
+
+#include "SampleSystems.hpp"
+#include "ResourceFactory.hpp"
+
+#include "Engine/AssetManifest.hpp"
+#include "Engine/EntityDatabase.hpp"
+#include "Engine/Services/AssetService.hpp"
+#include "Engine/Services/EntityService.hpp"
+#include "Engine/Tasks/InitializeScene.hpp"
+#include "Engine/Physics/Scene.hpp"
+#include "Engine/Render/RenderGraph.hpp"
+#include "Engine/Path/Pathfinder.hpp"
+#include "Engine/Controller/NavSystem.hpp"
+#include "Engine/Debug.hpp"
+#include "Engine/MemoryTracker.hpp"
+#include "Engine/FrameArena.hpp"
+#include "Engine/JobSystem.hpp"
+
+#include "CKGfx/Context.hpp"
+
+#include <bgfx/bgfx.h>
+#include <bx/fpumath.h>
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace cinek {
+
+static uint64_t nowNs()
+{
+    auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t).count();
+}
+
+const char* SceneBenchmark::stageName(Stage stage)
+{
+    static const char* names[kStageCount] = {
+        "simulate",
+        "renderGraph",
+        "render",
+        "frame"
+    };
+    return names[stage];
+}
+
+SceneBenchmark::SceneBenchmark(const InitParams& params) :
+    _params(params),
+    _taskScheduler(64),
+    _stepDone(false),
+    _stepSucceeded(false),
+    _loadNs(0),
+    _bodyCount(0)
+{
+    //  matches the EnginePrototype sample's configuration
+    _gfxContext = allocate_unique<gfx::Context>(SampleSystems::gfxResourceParams());
+
+    _resourceFactory = allocate_unique<ove::ResourceFactory>(_gfxContext.get(),
+                                                             &_taskScheduler);
+
+    _systems = allocate_unique<SampleSystems>(_gfxContext.get(), params.jobSystem);
+
+    _camera.near = 0.1f;
+    _camera.far = 1000.0f;
+    _camera.fovDegrees = 60.0f;
+    _camera.worldMtx = gfx::Matrix4::kIdentity;
+    _camera.viewportRect = _params.viewRect;
+}
+
+SceneBenchmark::~SceneBenchmark()
+{
+    _taskScheduler.cancelAll(this);
+}
+
+bool SceneBenchmark::pumpUntil(const bool& done, const char* step)
+{
+    //  file and decode tasks complete on the scheduler; navigation mesh
+    //  generation completes on the pathfinder's simulation
+    const uint32_t kPumpMs = 16;
+    const uint64_t timeoutNs = (uint64_t)_params.loadTimeoutMs * 1000000;
+    const uint64_t startNs = nowNs();
+    while (!done) {
+        if (nowNs() - startNs >= timeoutNs) {
+            OVENGINE_LOG_ERROR("SceneBenchmark.load - %s timed out after %u ms\n",
+                               step, _params.loadTimeoutMs);
+            return false;
+        }
+        _taskScheduler.update(kPumpMs);
+        _systems->pathfinder()->simulate(kPumpMs * 0.001);
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+bool SceneBenchmark::load(const std::string& sceneManifestPath)
+{
+    //  declared before the asset service, which cancels its pending loads
+    //  when destroyed
+    std::shared_ptr<ove::AssetManifest> sceneManifest;
+    ove::EntityService entityService(_systems->entityDatabase());
+
+    ove::AssetService assetService({ &_taskScheduler, _resourceFactory.get() });
+
+    const uint64_t startNs = nowNs();
+
+    _stepDone = false;
+    _stepSucceeded = false;
+    assetService.loadManifest("entity.json",
+        [this, &entityService](std::shared_ptr<ove::AssetManifest> manifest) {
+            if (manifest) {
+                entityService.addDefinitions("entity", manifest);
+                _stepSucceeded = true;
+            }
+            _stepDone = true;
+        });
+    if (!pumpUntil(_stepDone, "entity.json"))
+        return false;
+    if (!_stepSucceeded) {
+        OVENGINE_LOG_ERROR("SceneBenchmark.load - failed to load entity.json\n");
+        return false;
+    }
+
+    _stepDone = false;
+    assetService.loadManifest(sceneManifestPath,
+        [this, &sceneManifest](std::shared_ptr<ove::AssetManifest> manifest) {
+            sceneManifest = std::move(manifest);
+            _stepDone = true;
+        });
+    if (!pumpUntil(_stepDone, sceneManifestPath.c_str()))
+        return false;
+    if (!sceneManifest) {
+        OVENGINE_LOG_ERROR("SceneBenchmark.load - failed to load %s\n",
+                           sceneManifestPath.c_str());
+        return false;
+    }
+
+    ove::Scene* scene = _systems->scene();
+    ove::SceneJsonLoader loader(_systems->sceneData(), _gfxContext.get(),
+                                _systems->renderGraph(), _systems->entityDatabase());
+    _stepDone = false;
+    _stepSucceeded = false;
+    _taskScheduler.schedule(ove::InitializeScene::create(sceneManifest, loader,
+        [this, scene](Task::State endState, Task& thisTask, void* ) {
+            if (endState == Task::State::kEnded) {
+                auto bodies = reinterpret_cast<ove::InitializeScene&>(thisTask).acquireBodyList();
+                ove::SceneBatch batch;
+                for (auto& body : bodies) {
+                    batch.attach(body.first, body.second);
+                }
+                scene->applyBatch(batch);
+                _bodyCount = (uint32_t)bodies.size();
+                _stepSucceeded = true;
+            }
+            _stepDone = true;
+        }),
+        this);
+    if (!pumpUntil(_stepDone, "scene initialization")) {
+        //  the task references the local loader
+        _taskScheduler.cancelAll(this);
+        return false;
+    }
+    if (!_stepSucceeded) {
+        OVENGINE_LOG_ERROR("SceneBenchmark.load - failed to initialize %s\n",
+                           sceneManifestPath.c_str());
+        return false;
+    }
+
+    //  navigation isn't required for the benchmark, so failure here only
+    //  leaves the nav system idle
+    _stepDone = false;
+    _systems->pathfinder()->generateFromScene(*scene,
+        [this](bool ) { _stepDone = true; });
+    if (!pumpUntil(_stepDone, "navigation mesh generation"))
+        return false;
+
+    _loadNs = nowNs() - startNs;
+    return true;
+}
+
+void SceneBenchmark::updateCamera(uint32_t frame, uint32_t frameCount)
+{
+    //  orbits the scene origin once over the run so that culling and draw
+    //  counts vary as they would with a moving camera
+    const float kRadius = 12.0f;
+    const float kHeight = 6.0f;
+    const float angle = (2.0f * bx::pi * frame) / (frameCount ? frameCount : 1);
+
+    float eye[3] = { kRadius * sinf(angle), kHeight, kRadius * cosf(angle) };
+    float at[3] = { 0.0f, 0.0f, 0.0f };
+
+    gfx::Matrix4 viewMtx;
+    bx::mtxLookAt(viewMtx, eye, at);
+    bx::mtxInverse(_camera.worldMtx, viewMtx);
+    _camera.update();
+}
+
+void SceneBenchmark::runFrame(CKTimeDelta dt, FrameSample& sample)
+{
+    uint64_t t0 = nowNs();
+
+    _systems->navSystem()->startFrame();
+    _systems->pathfinder()->simulate(dt);
+    _systems->navSystem()->simulate(dt);
+    _systems->scene()->simulate(dt);
+
+    uint64_t t1 = nowNs();
+
+    _systems->renderGraph()->update(dt);
+
+    uint64_t t2 = nowNs();
+
+    _renderer(*_params.programs, *_params.uniforms, _camera,
+              _systems->renderGraph()->transforms());
+
+    uint64_t t3 = nowNs();
+
+    //  the Noop renderer discards the frame, but submission and bgfx's
+    //  frame processing still run on the CPU
+    bgfx::frame();
+    _systems->entityDatabase()->gc();
+    if (ove::FrameArena::current()) {
+        ove::FrameArena::current()->endFrame();
+    }
+
+    uint64_t t4 = nowNs();
+
+    //  heap counts cover the interval since the previous frame's endFrame
+    ove::MemoryTracker::endFrame();
+    const auto heap = ove::MemoryTracker::heapTotals();
+
+    sample.stageNs[kStageSimulate] = t1 - t0;
+    sample.stageNs[kStageRenderGraph] = t2 - t1;
+    sample.stageNs[kStageRender] = t3 - t2;
+    sample.stageNs[kStageFrame] = t4 - t3;
+    sample.allocCount = heap.frameAllocCount;
+    sample.allocBytes = heap.frameAllocBytes;
+    sample.renderStats = _renderer.stats();
+}
+
+void SceneBenchmark::run(uint32_t warmupFrames, uint32_t frameCount)
+{
+    const CKTimeDelta kSecsPerSimFrame = 1/60.0;
+
+    _samples.clear();
+    _samples.reserve(frameCount);
+
+    FrameSample sample;
+    for (uint32_t frame = 0; frame < warmupFrames + frameCount; ++frame) {
+        updateCamera(frame, warmupFrames + frameCount);
+        runFrame(kSecsPerSimFrame, sample);
+        if (frame >= warmupFrames) {
+            _samples.push_back(sample);
+        }
+    }
+}
+
+}   /* namespace cinek */
@@ -0,0 +1,116 @@
+//
+//  SceneBenchmark.hpp
+//  Benchmark
+//
+//  Created by Samir Sinha on 4/8/16.
+//
+//
+
+#ifndef Overview_Benchmark_SceneBenchmark_hpp
+#define Overview_Benchmark_SceneBenchmark_hpp
+
+#include "Engine/EngineTypes.hpp"
+
+#include "CKGfx/GfxTypes.hpp"
+#include "CKGfx/Camera.hpp"
+#include "CKGfx/NodeRenderer.hpp"
+
+#include <cinek/allocator.hpp>
+#include <cinek/taskscheduler.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cinek {
+
+class SampleSystems;
+
+namespace ove {
+    struct ResourceFactory;
+}
+
+//  Loads a scene through the same manifest and scene loader path as the
+//  EnginePrototype sample, and runs fixed-step frames of simulation and
+//  render traversal against it.  Each SceneBenchmark owns its own graphics
+//  context and systems (see SampleSystems), so scenes are measured in
+//  isolation.
+class SceneBenchmark
+{
+    CK_CLASS_NON_COPYABLE(SceneBenchmark);
+
+public:
+    struct InitParams
+    {
+        const gfx::NodeRenderer::ProgramMap* programs;
+        const gfx::NodeRenderer::UniformMap* uniforms;
+        gfx::Rect viewRect;
+        //  (optional) runs the scene's narrow phase across threads
+        ove::JobSystem* jobSystem;
+        //  each loading step fails if not complete within this time
+        uint32_t loadTimeoutMs;
+    };
+
+    enum Stage
+    {
+        kStageSimulate,
+        kStageRenderGraph,
+        kStageRender,
+        kStageFrame,
+        kStageCount
+    };
+
+    static const char* stageName(Stage stage);
+
+    struct FrameSample
+    {
+        uint64_t stageNs[kStageCount];
+        uint64_t allocCount;
+        uint64_t allocBytes;
+        gfx::NodeRenderer::Stats renderStats;
+    };
+
+    SceneBenchmark(const InitParams& params);
+    ~SceneBenchmark();
+
+    //  loads entity templates followed by the scene manifest, and generates
+    //  its navigation mesh.  returns false if loading fails or times out.
+    bool load(const std::string& sceneManifestPath);
+    //  runs frames at a fixed timestep, discarding samples from the first
+    //  warmupFrames
+    void run(uint32_t warmupFrames, uint32_t frameCount);
+
+    uint64_t loadNs() const { return _loadNs; }
+    uint32_t bodyCount() const { return _bodyCount; }
+    const std::vector<FrameSample>& samples() const { return _samples; }
+
+private:
+    //  returns false if the step isn't done within the load timeout
+    bool pumpUntil(const bool& done, const char* step);
+    void updateCamera(uint32_t frame, uint32_t frameCount);
+    void runFrame(CKTimeDelta dt, FrameSample& sample);
+
+    InitParams _params;
+
+    unique_ptr<gfx::Context> _gfxContext;
+    TaskScheduler _taskScheduler;
+    unique_ptr<ove::ResourceFactory> _resourceFactory;
+
+    gfx::NodeRenderer _renderer;
+    gfx::Camera _camera;
+
+    unique_ptr<SampleSystems> _systems;
+
+    //  set by load callbacks.  members rather than locals, since callbacks
+    //  from a timed out step may run after load returns
+    bool _stepDone;
+    bool _stepSucceeded;
+
+    uint64_t _loadNs;
+    uint32_t _bodyCount;
+    std::vector<FrameSample> _samples;
+};
+
+}   /* namespace cinek */
+
+#endif /* Overview_Benchmark_SceneBenchmark_hpp */
@@ -14,6 +14,8 @@
 
 #include <SDL2/SDL_syswm.h>
 
+#include <cstring>
+
 #include <bgfx/bgfxplatform.h>
 #include <bgfx/bgfx.h>
 
@@ -21,10 +23,42 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+static SampleOptions parseSampleOptions(int argc, char* argv[])
+{
+    SampleOptions options;
+    options.recordPath = nullptr;
+    options.replayPath = nullptr;
+    options.headless = false;
+    options.archivePath = nullptr;
+    options.packPath = nullptr;
+    
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--record") && i+1 < argc) {
+            options.recordPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--replay") && i+1 < argc) {
+            options.replayPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--headless")) {
+            options.headless = true;
+        }
+        else if (!strcmp(argv[i], "--archive") && i+1 < argc) {
+            options.archivePath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--pack") && i+1 < argc) {
+            options.packPath = argv[++i];
+        }
+    }
+    
+    return options;
+}
+
 int OverviewMain(SDL_Window* window, int argc, char* argv[])
 {
     cinek::file::setOpsStdio();
     
+    SampleOptions options = parseSampleOptions(argc, argv);
+    
     int viewWidth;
     int viewHeight;
     
@@ -32,10 +66,16 @@ int OverviewMain(SDL_Window* window, int argc, char* argv[])
 
     //  renderer initialization
     //
-    bgfx::sdlSetWindow(window);
-    bgfx::init();
-
-    bgfx::reset(viewWidth, viewHeight, BGFX_RESET_VSYNC);
+    if (options.headless) {
+        //  frames aren't presented, so they run as fast as possible
+        bgfx::init(bgfx::RendererType::Noop);
+        bgfx::reset(viewWidth, viewHeight, BGFX_RESET_NONE);
+    }
+    else {
+        bgfx::sdlSetWindow(window);
+        bgfx::init();
+        bgfx::reset(viewWidth, viewHeight, BGFX_RESET_VSYNC);
+    }
     bgfx::setDebug(BGFX_DEBUG_TEXT /*|BGFX_DEBUG_STATS*/ );
     
     bgfx::setViewClear(0, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH,
@@ -45,7 +85,7 @@ int OverviewMain(SDL_Window* window, int argc, char* argv[])
     
     imGuiInit(window, 1);
 
-    int result = runSample(viewWidth, viewHeight, 2);
+    int result = runSample(viewWidth, viewHeight, 2, options);
     
     imGuiShutdown();
     
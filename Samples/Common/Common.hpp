@@ -11,6 +11,22 @@
 
 #include "Engine/EngineTypes.hpp"
 
-extern int runSample(int viewWidth, int viewHeight, int firstFreeViewId);
+//  command line options shared by the samples
+struct SampleOptions
+{
+    //  --record <path> : records the session for replay
+    const char* recordPath;
+    //  --replay <path> : replays a recorded session, then exits
+    const char* replayPath;
+    //  --headless : renders with bgfx's Noop renderer
+    bool headless;
+    //  --archive <path> : loads assets found in the archive from it
+    const char* archivePath;
+    //  --pack <path> : packs the files listed in archive.txt, then exits
+    const char* packPath;
+};
+
+extern int runSample(int viewWidth, int viewHeight, int firstFreeViewId,
+                     const SampleOptions& options);
 
 #endif /* Common_hpp */
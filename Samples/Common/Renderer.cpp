@@ -82,4 +82,13 @@ void registerShaders
                                 CKGFX_SHADERS_LIGHT_COUNT);
     uniforms[cinek::gfx::kNodeUniformColor] =
             bgfx::createUniform("u_color", bgfx::UniformType::Vec4, 1);
+    
+    uniforms[cinek::gfx::kNodeUniformClusterLightData] =
+            bgfx::createUniform("u_clusterLightData", bgfx::UniformType::Int1);
+    uniforms[cinek::gfx::kNodeUniformClusterGrid] =
+            bgfx::createUniform("u_clusterGrid", bgfx::UniformType::Int1);
+    uniforms[cinek::gfx::kNodeUniformClusterIndices] =
+            bgfx::createUniform("u_clusterIndices", bgfx::UniformType::Int1);
+    uniforms[cinek::gfx::kNodeUniformClusterParams] =
+            bgfx::createUniform("u_clusterParams", bgfx::UniformType::Vec4, 1);
 }
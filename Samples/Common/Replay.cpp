@@ -0,0 +1,457 @@
+//
+//  Replay.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/9/16.
+//
+//
+
+#include "Replay.hpp"
+
+#include <cinek/debug.h>
+
+#include <cstring>
+
+namespace cinek {
+    namespace input {
+
+    static const char kReplayMagic[4] = { 'O', 'V', 'R', 'P' };
+    static const uint32_t kReplayVersion = 2;
+
+    enum : uint8_t
+    {
+        kReplayChunkEnd     = 0,
+        kReplayChunkFrame   = 1
+    };
+
+    //  mouse and modifier state, as written to the stream
+    struct ReplayPolledInput
+    {
+        int32_t mx, my;
+        int32_t mdx, mdy;
+        int32_t mxWheel, myWheel;
+        uint32_t mbtn;
+        uint32_t keyModifiers;
+    };
+
+    struct ReplayKeyChange
+    {
+        uint16_t scancode;
+        uint8_t value;
+    };
+
+    template<typename T> static void writeValue(FILE* fp, const T& value)
+    {
+        fwrite(&value, sizeof(T), 1, fp);
+    }
+
+    template<typename T> static bool readValue(FILE* fp, T& value)
+    {
+        return fread(&value, sizeof(T), 1, fp) == 1;
+    }
+
+    //  only events consumed on playback are recorded.  everything else
+    //  reaches the simulation through the polled input state
+    static bool isEventReplayable(const SDL_Event& event)
+    {
+        switch (event.type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_TEXTINPUT:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEWHEEL:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    //  events are written field by field, since the SDL_Event layout (and
+    //  its padding) varies between SDL versions and platforms
+    static void writeEvent(FILE* fp, const SDL_Event& event)
+    {
+        writeValue(fp, (uint32_t)event.type);
+        switch (event.type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            writeValue(fp, (int32_t)event.key.keysym.sym);
+            writeValue(fp, (uint32_t)event.key.keysym.scancode);
+            writeValue(fp, (uint16_t)event.key.keysym.mod);
+            writeValue(fp, (uint8_t)event.key.state);
+            writeValue(fp, (uint8_t)event.key.repeat);
+            break;
+        case SDL_TEXTINPUT: {
+                uint8_t length = (uint8_t)strnlen(event.text.text,
+                                                  sizeof(event.text.text) - 1);
+                writeValue(fp, length);
+                fwrite(event.text.text, 1, length, fp);
+            }
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            writeValue(fp, (uint32_t)event.button.which);
+            writeValue(fp, (uint8_t)event.button.button);
+            writeValue(fp, (uint8_t)event.button.state);
+            writeValue(fp, (uint8_t)event.button.clicks);
+            writeValue(fp, (int32_t)event.button.x);
+            writeValue(fp, (int32_t)event.button.y);
+            break;
+        case SDL_MOUSEWHEEL:
+            writeValue(fp, (uint32_t)event.wheel.which);
+            writeValue(fp, (int32_t)event.wheel.x);
+            writeValue(fp, (int32_t)event.wheel.y);
+            break;
+        default:
+            break;
+        }
+    }
+
+    static bool readEvent(FILE* fp, SDL_Event& event)
+    {
+        memset(&event, 0, sizeof(event));
+
+        uint32_t type = 0;
+        if (!readValue(fp, type))
+            return false;
+        event.type = type;
+
+        switch (type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP: {
+                int32_t sym;
+                uint32_t scancode;
+                uint16_t mod;
+                uint8_t state, repeat;
+                if (!readValue(fp, sym) || !readValue(fp, scancode) ||
+                    !readValue(fp, mod) || !readValue(fp, state) ||
+                    !readValue(fp, repeat))
+                    return false;
+                event.key.keysym.sym = (SDL_Keycode)sym;
+                event.key.keysym.scancode = (SDL_Scancode)scancode;
+                event.key.keysym.mod = mod;
+                event.key.state = state;
+                event.key.repeat = repeat;
+            }
+            break;
+        case SDL_TEXTINPUT: {
+                uint8_t length;
+                if (!readValue(fp, length) || length >= sizeof(event.text.text))
+                    return false;
+                if (fread(event.text.text, 1, length, fp) != length)
+                    return false;
+                event.text.text[length] = 0;
+            }
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP: {
+                uint32_t which;
+                uint8_t button, state, clicks;
+                int32_t x, y;
+                if (!readValue(fp, which) || !readValue(fp, button) ||
+                    !readValue(fp, state) || !readValue(fp, clicks) ||
+                    !readValue(fp, x) || !readValue(fp, y))
+                    return false;
+                event.button.which = which;
+                event.button.button = button;
+                event.button.state = state;
+                event.button.clicks = clicks;
+                event.button.x = x;
+                event.button.y = y;
+            }
+            break;
+        case SDL_MOUSEWHEEL: {
+                uint32_t which;
+                int32_t x, y;
+                if (!readValue(fp, which) || !readValue(fp, x) || !readValue(fp, y))
+                    return false;
+                event.wheel.which = which;
+                event.wheel.x = x;
+                event.wheel.y = y;
+            }
+            break;
+        default:
+            //  not written by the recorder
+            return false;
+        }
+        return true;
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    ReplayRecorder::ReplayRecorder() :
+        _fp(nullptr),
+        _frameTimeMs(0)
+    {
+        memset(&_input, 0, sizeof(_input));
+    }
+
+    ReplayRecorder::~ReplayRecorder()
+    {
+        close();
+    }
+
+    bool ReplayRecorder::open(const char* path, const ReplayHeader& header)
+    {
+        close();
+
+        _fp = fopen(path, "wb");
+        if (!_fp) {
+            CK_LOG_ERROR("OverviewSample", "Replay: failed to create %s\n", path);
+            return false;
+        }
+
+        fwrite(kReplayMagic, sizeof(kReplayMagic), 1, _fp);
+        writeValue(_fp, kReplayVersion);
+        writeValue(_fp, header);
+
+        _lastKeystate.clear();
+        return true;
+    }
+
+    void ReplayRecorder::close()
+    {
+        if (!_fp)
+            return;
+
+        writeValue(_fp, kReplayChunkEnd);
+        fclose(_fp);
+        _fp = nullptr;
+    }
+
+    void ReplayRecorder::beginFrame(uint32_t frameTimeMs)
+    {
+        _frameTimeMs = frameTimeMs;
+        _tickHashes.clear();
+        _events.clear();
+    }
+
+    void ReplayRecorder::recordTick(uint64_t stateHash)
+    {
+        if (!_fp)
+            return;
+        _tickHashes.push_back(stateHash);
+    }
+
+    void ReplayRecorder::recordEvent(const SDL_Event& event)
+    {
+        if (!_fp)
+            return;
+        if (isEventReplayable(event)) {
+            _events.push_back(event);
+        }
+    }
+
+    void ReplayRecorder::recordInput(const InputState& state)
+    {
+        if (!_fp)
+            return;
+        _input = state;
+        _keystate.assign(state.keystate, state.keystate + state.keystateArraySize);
+    }
+
+    void ReplayRecorder::endFrame()
+    {
+        if (!_fp)
+            return;
+
+        writeValue(_fp, kReplayChunkFrame);
+        writeValue(_fp, _frameTimeMs);
+
+        writeValue(_fp, (uint16_t)_tickHashes.size());
+        fwrite(_tickHashes.data(), sizeof(uint64_t), _tickHashes.size(), _fp);
+
+        writeValue(_fp, (uint16_t)_events.size());
+        for (auto& event : _events) {
+            writeEvent(_fp, event);
+        }
+
+        ReplayPolledInput polled = {
+            _input.mx, _input.my,
+            _input.mdx, _input.mdy,
+            _input.mxWheel, _input.myWheel,
+            _input.mbtn,
+            (uint32_t)_input.keyModifiers
+        };
+        writeValue(_fp, polled);
+
+        _lastKeystate.resize(_keystate.size(), 0);
+        uint16_t changeCount = 0;
+        for (size_t i = 0; i < _keystate.size(); ++i) {
+            if (_keystate[i] != _lastKeystate[i]) {
+                ++changeCount;
+            }
+        }
+        writeValue(_fp, (uint16_t)_keystate.size());
+        writeValue(_fp, changeCount);
+        for (size_t i = 0; i < _keystate.size(); ++i) {
+            if (_keystate[i] != _lastKeystate[i]) {
+                writeValue(_fp, ReplayKeyChange { (uint16_t)i, _keystate[i] });
+            }
+        }
+        _lastKeystate.swap(_keystate);
+
+        if (ferror(_fp)) {
+            CK_LOG_ERROR("OverviewSample", "Replay: write failed.  Recording stopped.\n");
+            fclose(_fp);
+            _fp = nullptr;
+        }
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    ReplayPlayer::ReplayPlayer() :
+        _fp(nullptr),
+        _frameTimeMs(0),
+        _frameTick(0),
+        _frameIndex(0),
+        _tickIndex(0),
+        _divergenceCount(0)
+    {
+        memset(&_header, 0, sizeof(_header));
+        memset(&_input, 0, sizeof(_input));
+    }
+
+    ReplayPlayer::~ReplayPlayer()
+    {
+        close();
+    }
+
+    bool ReplayPlayer::open(const char* path)
+    {
+        close();
+
+        _fp = fopen(path, "rb");
+        if (!_fp) {
+            CK_LOG_ERROR("OverviewSample", "Replay: failed to open %s\n", path);
+            return false;
+        }
+
+        char magic[4];
+        uint32_t version = 0;
+        if (fread(magic, sizeof(magic), 1, _fp) != 1 ||
+            memcmp(magic, kReplayMagic, sizeof(magic)) != 0 ||
+            !readValue(_fp, version) || version != kReplayVersion ||
+            !readValue(_fp, _header)) {
+            CK_LOG_ERROR("OverviewSample", "Replay: %s is not a version %u replay\n",
+                         path, kReplayVersion);
+            close();
+            return false;
+        }
+
+        _keystate.clear();
+        _frameIndex = 0;
+        _tickIndex = 0;
+        _divergenceCount = 0;
+        return true;
+    }
+
+    void ReplayPlayer::close()
+    {
+        if (_fp) {
+            fclose(_fp);
+            _fp = nullptr;
+        }
+    }
+
+    bool ReplayPlayer::nextFrame()
+    {
+        if (!_fp)
+            return false;
+
+        if (!readFrame()) {
+            close();
+            return false;
+        }
+        ++_frameIndex;
+        return true;
+    }
+
+    bool ReplayPlayer::readFrame()
+    {
+        uint8_t chunk = kReplayChunkEnd;
+        if (!readValue(_fp, chunk) || chunk != kReplayChunkFrame)
+            return false;
+
+        uint16_t count = 0;
+        if (!readValue(_fp, _frameTimeMs) || !readValue(_fp, count))
+            return false;
+        _tickHashes.resize(count);
+        if (fread(_tickHashes.data(), sizeof(uint64_t), count, _fp) != count)
+            return false;
+        _frameTick = 0;
+
+        if (!readValue(_fp, count))
+            return false;
+        _events.resize(count);
+        for (auto& event : _events) {
+            if (!readEvent(_fp, event))
+                return false;
+        }
+
+        ReplayPolledInput polled;
+        if (!readValue(_fp, polled))
+            return false;
+        _input.mx = polled.mx;
+        _input.my = polled.my;
+        _input.mdx = polled.mdx;
+        _input.mdy = polled.mdy;
+        _input.mxWheel = polled.mxWheel;
+        _input.myWheel = polled.myWheel;
+        _input.mbtn = polled.mbtn;
+        _input.keyModifiers = (SDL_Keymod)polled.keyModifiers;
+
+        uint16_t keyCount = 0;
+        uint16_t changeCount = 0;
+        if (!readValue(_fp, keyCount) || !readValue(_fp, changeCount))
+            return false;
+        _keystate.resize(keyCount, 0);
+        for (uint16_t i = 0; i < changeCount; ++i) {
+            ReplayKeyChange change;
+            if (!readValue(_fp, change) || change.scancode >= keyCount)
+                return false;
+            _keystate[change.scancode] = change.value;
+        }
+        _input.keystate = _keystate.data();
+        _input.keystateArraySize = (int)_keystate.size();
+
+        return true;
+    }
+
+    void ReplayPlayer::diverged(const char* reason)
+    {
+        if (!_divergenceCount) {
+            CK_LOG_WARN("OverviewSample",
+                        "Replay: diverged at frame %u, tick %u (%s)\n",
+                        _frameIndex, _tickIndex, reason);
+        }
+        ++_divergenceCount;
+    }
+
+    bool ReplayPlayer::verifyTick(uint64_t stateHash)
+    {
+        bool result = true;
+        if (_frameTick >= _tickHashes.size()) {
+            diverged("extra tick");
+            result = false;
+        }
+        else if (_tickHashes[_frameTick] != stateHash) {
+            diverged("state hash mismatch");
+            result = false;
+        }
+        ++_frameTick;
+        ++_tickIndex;
+        return result;
+    }
+
+    bool ReplayPlayer::verifyFrameEnd()
+    {
+        if (_frameTick < _tickHashes.size()) {
+            diverged("missing ticks");
+            return false;
+        }
+        return true;
+    }
+
+    } /* namespace input */
+} /* namespace cinek */
@@ -0,0 +1,120 @@
+//
+//  Replay.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/9/16.
+//
+//
+
+#ifndef Overview_Replay_hpp
+#define Overview_Replay_hpp
+
+#include "Input.hpp"
+
+#include <SDL2/SDL_events.h>
+
+#include <cstdio>
+#include <vector>
+
+namespace cinek {
+    namespace input {
+
+    //  A replay is a binary stream of frames.  Each frame holds what the
+    //  sample loop consumed from outside the simulation: the frame time
+    //  (which determines the number of fixed-step ticks), the SDL events
+    //  ImGui consumes (written field by field, not as raw SDL_Events) and
+    //  polled input.  It also holds the simulation state hash after each
+    //  tick, which a replay compares against to find where it diverges.
+    //
+    //  Everything else - including ckmsg traffic, which is only generated
+    //  by the simulation and views - follows deterministically from these
+    //  inputs.
+    struct ReplayHeader
+    {
+        //  seeds the C runtime's random number generator
+        uint32_t seed;
+        uint32_t simFPS;
+        int32_t viewWidth;
+        int32_t viewHeight;
+    };
+
+    class ReplayRecorder
+    {
+    public:
+        ReplayRecorder();
+        ~ReplayRecorder();
+
+        bool open(const char* path, const ReplayHeader& header);
+        void close();
+        bool isOpen() const { return _fp != nullptr; }
+
+        void beginFrame(uint32_t frameTimeMs);
+        void recordTick(uint64_t stateHash);
+        void recordEvent(const SDL_Event& event);
+        void recordInput(const InputState& state);
+        //  writes the frame to the stream
+        void endFrame();
+
+    private:
+        FILE* _fp;
+        uint32_t _frameTimeMs;
+        std::vector<uint64_t> _tickHashes;
+        std::vector<SDL_Event> _events;
+        InputState _input;
+        //  keys are written as changes from the prior frame
+        std::vector<uint8_t> _keystate;
+        std::vector<uint8_t> _lastKeystate;
+    };
+
+    class ReplayPlayer
+    {
+    public:
+        ReplayPlayer();
+        ~ReplayPlayer();
+
+        bool open(const char* path);
+        void close();
+        const ReplayHeader& header() const { return _header; }
+
+        //  reads the next frame.  returns false at the end of the replay
+        bool nextFrame();
+
+        uint32_t frameTimeMs() const { return _frameTimeMs; }
+        const std::vector<SDL_Event>& events() const { return _events; }
+        //  the polled input state, with keystate pointing to the replay's
+        //  key array
+        const InputState& inputState() const { return _input; }
+
+        //  compares the hash after the frame's next tick with the recording.
+        //  returns false on a mismatch, or if the frame runs more ticks than
+        //  recorded
+        bool verifyTick(uint64_t stateHash);
+        //  returns false if the frame ran fewer ticks than recorded
+        bool verifyFrameEnd();
+
+        uint32_t frameIndex() const { return _frameIndex; }
+        uint32_t tickIndex() const { return _tickIndex; }
+        uint32_t divergenceCount() const { return _divergenceCount; }
+
+    private:
+        bool readFrame();
+        void diverged(const char* reason);
+
+        FILE* _fp;
+        ReplayHeader _header;
+        uint32_t _frameTimeMs;
+        std::vector<uint64_t> _tickHashes;
+        uint32_t _frameTick;
+        std::vector<SDL_Event> _events;
+        InputState _input;
+        std::vector<uint8_t> _keystate;
+
+        uint32_t _frameIndex;
+        uint32_t _tickIndex;
+        uint32_t _divergenceCount;
+    };
+
+    } /* namespace input */
+} /* namespace cinek */
+
+#endif /* Overview_Replay_hpp */
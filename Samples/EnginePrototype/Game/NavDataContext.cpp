@@ -18,8 +18,9 @@ template class ObjectPool<ove::NavBody>;
 template class ObjectPool<ove::NavSceneBodyTransform>;
 
 NavDataContext::NavDataContext(const InitParams& initParams) :
-    _navBodyPool(initParams.navBodyCount),
-    _navSceneBodyPool(initParams.navBodyCount)
+    _navBodyPool("Nav Bodies", ove::kMemoryTagNav, initParams.navBodyCount),
+    _navSceneBodyPool("Nav Body Transforms", ove::kMemoryTagNav,
+                      initParams.navBodyCount)
 {
 }
 
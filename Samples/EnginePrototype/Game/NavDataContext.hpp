@@ -13,7 +13,8 @@
 
 #include "Engine/Controller/NavBody.hpp"
 
-#include <cinek/objectpool.hpp>
+#include "Engine/TrackedObjectPool.hpp"
+
 #include <unordered_map>
 
 namespace cinek {
@@ -34,8 +35,8 @@ public:
     void freeBody(ove::NavBody* body);
     
 private:
-    ObjectPool<ove::NavBody> _navBodyPool;
-    ObjectPool<ove::NavSceneBodyTransform> _navSceneBodyPool;
+    ove::TrackedObjectPool<ove::NavBody> _navBodyPool;
+    ove::TrackedObjectPool<ove::NavSceneBodyTransform> _navSceneBodyPool;
     std::unordered_map<Entity, ove::NavSceneBodyTransform*> _transformMap;
 };
     
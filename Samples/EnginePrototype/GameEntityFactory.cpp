@@ -25,6 +25,8 @@
 
 #include <ckjson/json.hpp>
 
+#include <algorithm>
+
 namespace cinek {
 
 GameEntityFactory::GameEntityFactory
@@ -50,6 +52,24 @@ GameEntityFactory::GameEntityFactory
     _transformSystem(transformSystem)
 {
 }
+
+void GameEntityFactory::attachCharacter(ove::SceneBody* body)
+{
+    //  fit the capsule to the body's shape
+    btVector3 aabbMin, aabbMax;
+    body->btBody->getCollisionShape()->getAabb(btTransform::getIdentity(),
+                                               aabbMin, aabbMax);
+    const btVector3 dims = aabbMax - aabbMin;
+    
+    ove::SceneCharacterParams params;
+    params.radius = std::max(dims.x(), dims.z()) * btScalar(0.5);
+    params.height = std::max(dims.y() - params.radius * 2, btScalar(0));
+    params.centerHeight = (aabbMin.y() + aabbMax.y()) * btScalar(0.5);
+    params.stepHeight = std::min(dims.y() * btScalar(0.25), btScalar(0.35));
+    params.maxSlopeCos = btCos(btRadians(btScalar(45)));
+    
+    _scene->attachCharacter(body->entity, params);
+}
     
 void GameEntityFactory::onCustomComponentCreateFn
 (
@@ -74,7 +94,8 @@ void GameEntityFactory::onCustomComponentCreateFn
         
         if (modelHandle) {
             _renderGraph->cloneAndAddNode(entity,
-                modelHandle, nullptr);
+                modelHandle, nullptr,
+                ove::RenderGraph::makeSourceName(modelSetName, modelName).c_str());
         }
         else {
             CK_LOG_WARN("OverviewSample",
@@ -154,6 +175,15 @@ void GameEntityFactory::onCustomComponentCreateFn
             if (it != compTemplate.MemberEnd()) {
                 body->mass = ckm::scalar(it->value.GetDouble());
             }
+            //  fast movers (projectiles, vehicles) are swept each tick so
+            //  they don't pass through thin walls.  the sweep sphere fits
+            //  within the body, and sweeps start once the body moves more
+            //  than that radius per tick
+            it = compTemplate.FindMember("ccd");
+            if (it != compTemplate.MemberEnd() && it->value.IsBool() && it->value.GetBool()) {
+                btScalar radius = btScalar(std::min(std::min(dims.x, dims.y), dims.z)) * btScalar(0.5);
+                body->setContinuousCollision(radius, radius);
+            }
             
             uint32_t bodyCategories = 0;
             if (cinek_entity_context(entity) == kEntityStore_Staging) {
@@ -171,6 +201,7 @@ void GameEntityFactory::onCustomComponentCreateFn
             ove::NavBody* navBody = _navSystem->findBody(entity);
             if (navBody) {
                 navBody->setTransform(_navDataContext->allocateTransform(body, entity));
+                attachCharacter(body);
             }
         }
         else {
@@ -195,6 +226,7 @@ void GameEntityFactory::onCustomComponentCreateFn
             ove::SceneBody* sceneBody = _scene->findBody(entity);
             if (sceneBody) {
                 navBody->setTransform(_navDataContext->allocateTransform(sceneBody, entity));
+                attachCharacter(sceneBody);
             }
             _navSystem->attachBody(navBody);
         }
@@ -276,7 +308,8 @@ void GameEntityFactory::onCustomComponentEntityCloneFn
         CK_ASSERT_RETURN(gfxNode->firstChild() && !gfxNode->firstChild()->nextSibling());
         const gfx::Matrix4& mtx = gfxNode->transform();
         gfxNode = gfxNode->firstChildHandle();
-        gfxNode = _renderGraph->cloneAndAddNode(target, gfxNode, nullptr);
+        gfxNode = _renderGraph->cloneAndAddNode(target, gfxNode, nullptr,
+                                                _renderGraph->sourceName(origin));
         gfxNode->setTransform(mtx);
     }
     //  scene
@@ -290,6 +323,9 @@ void GameEntityFactory::onCustomComponentEntityCloneFn
     if (navBody) {
         ove::NavBody* clonedBody = _navDataContext->cloneBody(navBody, sceneBody, target);
         navBody = _navSystem->attachBody(clonedBody);
+        if (sceneBody) {
+            attachCharacter(sceneBody);
+        }
     }
     //  editor
     auto& identity = _entityDb->identityFromEntity(origin);
@@ -46,6 +46,9 @@ public:
     virtual void onCustomComponentEntityCloneFn(Entity target, Entity origin);
 
 private:
+    //  nav driven scene bodies are moved as characters
+    void attachCharacter(ove::SceneBody* body);
+    
     ove::EntityDatabase* _entityDb;
     gfx::Context* _gfxContext;
     ove::SceneDataContext* _sceneDataContext;
@@ -6,20 +6,26 @@
 //
 //
 
-#include "Engine/Physics/SceneDataContext.hpp"
 #include "Engine/Physics/Scene.hpp"
-#include "Engine/Physics/SceneDebugDrawer.hpp"
 #include "Engine/Render/RenderGraph.hpp"
 #include "Engine/EntityDatabase.hpp"
 #include "Engine/Path/Pathfinder.hpp"
 
 #include "Engine/Path/PathfinderDebug.hpp"
 #include "Engine/Controller/NavSystem.hpp"
-#include "Game/NavDataContext.hpp"
-#include "Game/TransformDataContext.hpp"
-#include "Engine/Controller/TransformSystem.hpp"
+#include "Engine/AssetReloader.hpp"
+#include "Engine/AssetArchive.hpp"
+#include "Engine/JobSystem.hpp"
+#include "Engine/Profiler.hpp"
+#include "Engine/MemoryTracker.hpp"
+#include "Engine/FrameArena.hpp"
+#include "Engine/StateHash.hpp"
 
-#include "GameEntityFactory.hpp"
+#include "CKGfx/ShaderLibrary.hpp"
+
+#include "UICore/UI.hpp"
+
+#include "SampleSystems.hpp"
 
 #include "Views/StartupView.hpp"
 #include "Views/LoadSceneView.hpp"
@@ -29,6 +35,7 @@
 
 #include <bgfx/bgfx.h>
 #include <bx/fpumath.h>
+#include <SDL2/SDL_keycode.h>
 #include <vector>
 
 namespace cinek {
@@ -36,11 +43,16 @@ namespace cinek {
 PrototypeApplication::PrototypeApplication
 (
     gfx::Context& gfxContext,
+    gfx::ShaderLibrary& shaderLibrary,
+    const std::vector<SampleShaderProgram>& shaderPrograms,
     const gfx::NodeRenderer::ProgramMap& programs,
     const gfx::NodeRenderer::UniformMap& uniforms,
-    NVGcontext* nvg
+    NVGcontext* nvg,
+    const char* archivePath
 ) :
     _gfxContext(&gfxContext),
+    _shaderLibrary(&shaderLibrary),
+    _shaderPrograms(shaderPrograms),
     _taskScheduler(64),
     _server(_messenger, { 64*1024, 64*1024 }),
     _client(_messenger, { 32*1024, 32*1024 }),
@@ -49,96 +61,88 @@ PrototypeApplication::PrototypeApplication
     _renderPrograms(programs),
     _renderUniforms(uniforms),
     _renderer(),
-    _nvg(nvg)
+    _nvg(nvg),
+    _profilerVisible(false),
+    _memoryPanelVisible(false)
 {
-    gfx::NodeElementCounts sceneElementCounts;
-    sceneElementCounts.meshNodeCount = 128;
-    sceneElementCounts.armatureNodeCount = 32;
-    sceneElementCounts.lightNodeCount = 8;
-    sceneElementCounts.objectNodeCount = 64;
-    sceneElementCounts.transformNodeCount = 64;
-    
-    _renderGraph = allocate_unique<cinek::ove::RenderGraph>(
-        sceneElementCounts,
-        1024,
-        256
-    );
+    //  created first so that job workers can register with it
+    ove::Profiler::InitParams profilerParams;
+    profilerParams.eventsPerThread = 4096;
+    profilerParams.threadLimit = 32;
+    profilerParams.historyFrames = 8;
+    profilerParams.captureLimit = 1024*1024;
+    _profiler = allocate_unique<ove::Profiler>(profilerParams);
+    ove::Profiler::setCurrent(_profiler.get());
+    _profiler->setThreadName("Main");
+    
+    //  also before the job system, so that workers can allocate transient
+    //  data from their own blocks
+    ove::FrameArena::InitParams frameArenaParams;
+    frameArenaParams.bytesPerThread = 256*1024;
+    frameArenaParams.threadLimit = 32;
+    _frameArena = allocate_unique<ove::FrameArena>(frameArenaParams);
+    ove::FrameArena::setCurrent(_frameArena.get());
+    
+    ove::JobSystem::InitParams jobSystemParams;
+    jobSystemParams.workerCount = ove::JobSystem::defaultWorkerCount();
+    _jobSystem = allocate_unique<ove::JobSystem>(jobSystemParams);
+    
+    //  model and scene decoding runs on the job system's workers
+    gfx::setJsonDecodeJobRunner(
+        [this](uint32_t count, const std::function<void(uint32_t)>& job) {
+            _jobSystem->parallelFor(0, count, 1, job);
+        });
+    
+    _systems = allocate_unique<SampleSystems>(_gfxContext, _jobSystem.get());
     
     _renderContext.programs = &_renderPrograms;
     _renderContext.uniforms = &_renderUniforms;
     _renderContext.frameRect = gfx::Rect { 0,0,0,0 };
     
-    std::vector<EntityStore::InitParams> entityStoreInitializers = {
-        //  default
-        cinek::EntityStore::InitParams {
-                16384
-        },
-        //  staging
-        cinek::EntityStore::InitParams {
-                1024
-        }
-    };
-    
-    ove::SceneDataContext::InitParams sceneDataInit;
-    sceneDataInit.numBodies = 256;
-    sceneDataInit.numTriMeshShapes = 32;
-    sceneDataInit.numCylinderShapes = 32;
-    sceneDataInit.numBoxShapes = 32;
-    
-    _sceneData = cinek::allocate_unique<ove::SceneDataContext>(sceneDataInit);
-    _sceneDbgDraw = cinek::allocate_unique<ove::SceneDebugDrawer>();
-    
-    ove::Scene::InitParams sceneInitParams;
-    sceneInitParams.staticLimit = 1024;
-    sceneInitParams.limits[ove::SceneBody::kSection] = 64;
-    sceneInitParams.limits[ove::SceneBody::kDynamic] = 1024;
-    sceneInitParams.limits[ove::SceneBody::kStaging] = 16;
-    
-    _scene = cinek::allocate_unique<ove::Scene>(sceneInitParams, _sceneDbgDraw.get());
-
-    _pathfinder = cinek::allocate_unique<ove::Pathfinder>();
-    _pathfinderDebug = cinek::allocate_unique<ove::PathfinderDebug>(64);
-    
-    NavDataContext::InitParams navDataInitParams;
-    navDataInitParams.navBodyCount = 128;
-    _navDataContext = cinek::allocate_unique<NavDataContext>(navDataInitParams);
-    
-    ove::NavSystem::InitParams navInitParams;
-    navInitParams.pathfinder = _pathfinder.get();
-    navInitParams.numBodies = navDataInitParams.navBodyCount;
-    _navSystem = cinek::allocate_unique<ove::NavSystem>(navInitParams);
-    
-    TransformDataContext::InitParams transformInitParams;
-    transformInitParams.setCount = 128;
-    transformInitParams.actionCount = transformInitParams.setCount * 2;
-    transformInitParams.sequenceCount = transformInitParams.actionCount * 8;
-    _transformDataContext = cinek::allocate_unique<TransformDataContext>(transformInitParams);
-    
-    ove::TransformSystem::InitParams transformSystemParams;
-    transformSystemParams.numBodies = 128;
-    _transformSystem = cinek::allocate_unique<ove::TransformSystem>(transformSystemParams);
-    _entityDb = allocate_unique<ove::EntityDatabase>(entityStoreInitializers);
-    
-    _componentFactory = allocate_unique<GameEntityFactory>(
-        _entityDb.get(),
-        _gfxContext,
-        _sceneData.get(),
-        _scene.get(),
-        _renderGraph.get(),
-        _navDataContext.get(),
-        _navSystem.get(),
-        _transformDataContext.get(),
-        _transformSystem.get()
-    );
-    _entityDb->setFactory(_componentFactory.get());
-
+    //  packed assets take precedence over loose files
+    if (archivePath) {
+        _assetArchive = ove::AssetArchive::open(archivePath);
+        _resourceFactory.mountArchive(_assetArchive);
+    }
+    
+    //  content hot-reload
+    ove::AssetReloader::InitParams reloaderParams;
+    reloaderParams.gfxContext = _gfxContext;
+    reloaderParams.shaderLibrary = _shaderLibrary;
+    reloaderParams.taskScheduler = &_taskScheduler;
+    reloaderParams.resourceFactory = &_resourceFactory;
+    reloaderParams.renderGraph = _systems->renderGraph();
+    _assetReloader = allocate_unique<ove::AssetReloader>(reloaderParams);
+    _assetReloader->setProgramsReloadedCallback(
+        [this](const std::vector<gfx::ShaderProgramId>& programIds) {
+            //  program handles change on reload - refresh the renderer's map
+            for (auto programId : programIds) {
+                for (auto& config : _shaderPrograms) {
+                    if (config.programId == programId) {
+                        _renderPrograms[config.programSlot] = _shaderLibrary->program(programId);
+                    }
+                }
+            }
+        });
+    for (auto& config : _shaderPrograms) {
+        _assetReloader->watchShader(config.vsBinaryPath);
+        _assetReloader->watchShader(config.fsBinaryPath);
+    }
+    _resourceFactory.setAssetReloader(_assetReloader.get());
+    
+    {
+        OVENGINE_MEMORY_TAG(ove::kMemoryTagPathfinder);
+        _pathfinderDebug = cinek::allocate_unique<ove::PathfinderDebug>(64);
+    }
     
     //  define the top-level states for this application
     _appContext = allocate_unique<ApplicationContext>();
     _appContext->nvg = _nvg;
-    _appContext->entityDatabase = _entityDb.get();
+    _appContext->entityDatabase = _systems->entityDatabase();
     _appContext->taskScheduler = &_taskScheduler;
+    _appContext->jobSystem = _jobSystem.get();
     _appContext->resourceFactory = &_resourceFactory;
+    _appContext->assetArchive = _assetArchive;
     _appContext->msgClientSender = &_clientSender;
     _appContext->gfxContext = _gfxContext;
     _appContext->renderContext = &_renderContext;
@@ -152,13 +156,13 @@ PrototypeApplication::PrototypeApplication
     //          containing these scene/render/ai system objects and respective
     //          data contexts.
     //
-    _appContext->renderGraph = _renderGraph.get();
-    _appContext->scene = _scene.get();
-    _appContext->sceneData = _sceneData.get();
-    _appContext->sceneDebugDrawer = _sceneDbgDraw.get();
-    _appContext->pathfinder = _pathfinder.get();
+    _appContext->renderGraph = _systems->renderGraph();
+    _appContext->scene = _systems->scene();
+    _appContext->sceneData = _systems->sceneData();
+    _appContext->sceneDebugDrawer = _systems->sceneDebugDrawer();
+    _appContext->pathfinder = _systems->pathfinder();
     _appContext->pathfinderDebug = _pathfinderDebug.get();
-    _appContext->navSystem = _navSystem.get();
+    _appContext->navSystem = _systems->navSystem();
     
     _viewStack.setFactory(
         [this](const std::string& viewName, ove::ViewController* )
@@ -177,7 +181,8 @@ PrototypeApplication::PrototypeApplication
             }
             else if (viewName == "LoadSceneView") {
                 return std::allocate_shared<LoadSceneView>(
-                std_allocator<LoadSceneView>(), _appContext.get());
+                std_allocator<LoadSceneView>(), _appContext.get(),
+                "scenes/apartment.json");
 
             }
             
@@ -189,25 +194,34 @@ PrototypeApplication::PrototypeApplication
 
 PrototypeApplication::~PrototypeApplication()
 {
+    gfx::setJsonDecodeJobRunner(nullptr);
+    ove::FrameArena::setCurrent(nullptr);
+    ove::Profiler::setCurrent(nullptr);
 }
     
 void PrototypeApplication::beginFrame()
 {
+    _profiler->beginFrame();
+    
+    OVENGINE_PROFILE_ZONE("beginFrame");
+    
     _server.receive();
     _client.receive();
     
     _viewStack.startFrame();
     
-    _navSystem->startFrame();
+    _systems->navSystem()->startFrame();
 }
 
 void PrototypeApplication::simulateFrame(CKTimeDelta dt)
 {
+    OVENGINE_PROFILE_ZONE("simulateFrame");
+    
     _viewStack.simulate(dt);
  
-    _pathfinder->simulate(dt);
-    _navSystem->simulate(dt);
-    _scene->simulate(dt);
+    _systems->pathfinder()->simulate(dt);
+    _systems->navSystem()->simulate(dt);
+    _systems->scene()->simulate(dt);
 }
 
 void PrototypeApplication::renderFrame
@@ -217,13 +231,37 @@ void PrototypeApplication::renderFrame
     const cinek::input::InputState& inputState
 )
 {
-    _taskScheduler.update(dt * 1000);
+    OVENGINE_PROFILE_ZONE("renderFrame");
+    
+    _assetReloader->update();
+    {
+        OVENGINE_PROFILE_ZONE("TaskScheduler::update");
+        _taskScheduler.update(dt * 1000);
+    }
     
     _renderContext.frameRect = viewRect;
  
-    _renderGraph->update(dt);
+    _systems->renderGraph()->update(dt);
+    
+    {
+        OVENGINE_PROFILE_ZONE("ViewStack::frameUpdate");
+        _viewStack.frameUpdate(dt, inputState);
+    }
     
-    _viewStack.frameUpdate(dt, inputState);
+    if (ImGui::IsKeyPressed(SDLK_BACKQUOTE)) {
+        _profilerVisible = !_profilerVisible;
+    }
+    if (_profilerVisible) {
+        _profilerOverlay.draw(*_profiler, &_profilerVisible);
+    }
+    //  ImGui's key array is indexed by keycode less the scancode bit (see
+    //  imGuiProcessEvent)
+    if (ImGui::IsKeyPressed(SDLK_F2 & ~SDLK_SCANCODE_MASK)) {
+        _memoryPanelVisible = !_memoryPanelVisible;
+    }
+    if (_memoryPanelVisible) {
+        _memoryPanel.draw(_gfxContext, _frameArena.get(), &_memoryPanelVisible);
+    }
         
     _gfxContext->update();
     
@@ -231,12 +269,29 @@ void PrototypeApplication::renderFrame
 
 void PrototypeApplication::endFrame()
 {
-    _viewStack.endFrame();
+    {
+        OVENGINE_PROFILE_ZONE("endFrame");
+        
+        _viewStack.endFrame();
 
-    _client.transmit();
-    _server.transmit();
+        _client.transmit();
+        _server.transmit();
 
-    _entityDb->gc();
+        _systems->entityDatabase()->gc();
+    }
+    
+    _profiler->endFrame();
+    ove::MemoryTracker::endFrame();
+    
+    //  no jobs are in flight between frames
+    _frameArena->endFrame();
+}
+
+uint64_t PrototypeApplication::simulationStateHash() const
+{
+    ove::StateHash hash;
+    ove::hashSimulationState(hash, _systems->scene(), _systems->navSystem());
+    return hash.value();
 }
 
 
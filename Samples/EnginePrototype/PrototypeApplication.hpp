@@ -11,9 +11,12 @@
 
 #include "GameTypes.hpp"
 #include "Common.hpp"
+#include "Renderer.hpp"
 #include "ResourceFactory.hpp"
 
 #include "UICore/UIEngine.hpp"
+#include "UICore/ProfilerOverlay.hpp"
+#include "UICore/MemoryPanel.hpp"
 
 #include "Engine/EntityDatabase.hpp"
 #include "Engine/Messages/Core.hpp"
@@ -35,7 +38,7 @@
 
 namespace cinek {
 
-class GameEntityFactory;
+class SampleSystems;
 struct ApplicationContext;
     
 class PrototypeApplication
@@ -44,9 +47,12 @@ public:
     PrototypeApplication
     (
         gfx::Context& gfxContext,
+        gfx::ShaderLibrary& shaderLibrary,
+        const std::vector<SampleShaderProgram>& shaderPrograms,
         const gfx::NodeRenderer::ProgramMap& programs,
         const gfx::NodeRenderer::UniformMap& uniforms,
-        NVGcontext* nvg
+        NVGcontext* nvg,
+        const char* archivePath
     );
     ~PrototypeApplication();
     
@@ -57,20 +63,29 @@ public:
         const cinek::input::InputState& inputState);
     void endFrame();
     
+    //  hash of simulated state, used to verify replays tick by tick
+    uint64_t simulationStateHash() const;
+    
 private:
     gfx::Context* _gfxContext;
+    gfx::ShaderLibrary* _shaderLibrary;
+    std::vector<SampleShaderProgram> _shaderPrograms;
     
     //  important - Application context must be destroyed after all objects
     //  below are destroyed.
     unique_ptr<ApplicationContext> _appContext;
     
     TaskScheduler _taskScheduler;
+    unique_ptr<ove::Profiler> _profiler;
+    unique_ptr<ove::FrameArena> _frameArena;
+    unique_ptr<ove::JobSystem> _jobSystem;
     
     ckmsg::Messenger _messenger;
     ove::MessageServer _server;
     ove::MessageClient _client;
     ove::MessageClientSender _clientSender;
 
+    std::shared_ptr<ove::AssetArchive> _assetArchive;
     ove::ResourceFactory _resourceFactory;
     
     gfx::NodeRenderer::ProgramMap _renderPrograms;
@@ -79,28 +94,20 @@ private:
     gfx::NodeRenderer _renderer;
     NVGcontext* _nvg;
     
-    unique_ptr<ove::RenderGraph> _renderGraph;
+    unique_ptr<SampleSystems> _systems;
     ove::RenderContext _renderContext;
     
-    unique_ptr<ove::EntityDatabase> _entityDb;
-    
-    unique_ptr<ove::SceneDataContext> _sceneData;
-    unique_ptr<ove::SceneDebugDrawer> _sceneDbgDraw;
-    unique_ptr<ove::Scene> _scene;
+    unique_ptr<ove::AssetReloader> _assetReloader;
     
-    unique_ptr<ove::Pathfinder> _pathfinder;
     unique_ptr<ove::PathfinderDebug> _pathfinderDebug;
     
-    unique_ptr<NavDataContext> _navDataContext;
-    unique_ptr<ove::NavSystem> _navSystem;
-    
-    unique_ptr<TransformDataContext> _transformDataContext;
-    unique_ptr<ove::TransformSystem> _transformSystem;
-    
-    unique_ptr<GameEntityFactory> _componentFactory;
-    
     
     ove::ViewStack _viewStack;
+    
+    uicore::ProfilerOverlay _profilerOverlay;
+    bool _profilerVisible;
+    uicore::MemoryPanel _memoryPanel;
+    bool _memoryPanelVisible;
 };
     
 }
@@ -10,6 +10,9 @@
 
 #include "Engine/Tasks/LoadTextureAsset.hpp"
 #include "Engine/Tasks/LoadAssetManifest.hpp"
+#include "Engine/AssetArchive.hpp"
+#include "Engine/AssetReloader.hpp"
+#include "Engine/MemoryTracker.hpp"
 
 #include "CKGfx/ModelJsonSerializer.hpp"
 
@@ -24,7 +27,8 @@ ResourceFactory::ResourceFactory
     TaskScheduler* scheduler
 ) :
     _gfxContext(context),
-    _scheduler(scheduler)
+    _scheduler(scheduler),
+    _reloader(nullptr)
 {
     _requests.reserve(4);
 }
@@ -35,11 +39,22 @@ ResourceFactory::~ResourceFactory()
         _scheduler->cancel(req.first);
     }
 }
+
+void ResourceFactory::mountArchive(std::shared_ptr<AssetArchive> archive)
+{
+    _archive = std::move(archive);
+}
+
+void ResourceFactory::setAssetReloader(AssetReloader* reloader)
+{
+    _reloader = reloader;
+}
     
 auto ResourceFactory::onAssetManifestRequest
 (
     AssetType assetType,
     const std::string& name,
+    const std::string& owner,
     std::function<void(const std::string&, LoadResult)> cb
 ) -> RequestId
 {
@@ -48,34 +63,60 @@ auto ResourceFactory::onAssetManifestRequest
     {
     case AssetType::kTexture:
         if (!_gfxContext->findTexture(name.c_str())) {
-            reqId = _scheduler->schedule(allocate_unique<LoadTextureAsset>(
+            auto task = allocate_unique<LoadTextureAsset>(
                 name,
-                [this](Task::State state, Task& t, void*) {
+                [this, owner](Task::State state, Task& t, void*) {
                     auto& task = static_cast<LoadTextureAsset&>(t);
                     if (state == Task::State::kEnded) {
-                        _gfxContext->registerTexture(task.acquireTexture(), task.acquireTextureName().c_str());
+                        OVENGINE_MEMORY_TAG(kMemoryTagGfx);
+                        auto textureName = task.acquireTextureName();
+                        _gfxContext->registerTexture(task.acquireTexture(), textureName.c_str());
+                        _gfxContext->addAssetOwner(owner.c_str(),
+                            gfx::ResourceType::kTexture, textureName.c_str());
+                        if (_reloader) {
+                            _reloader->watchTexture(task.name());
+                        }
                     }
                     requestFinished(t.id(), task.name(), state);
-                })
-            );
+                });
+            task->setArchive(_archive);
+            reqId = _scheduler->schedule(std::move(task));
+        }
+        else {
+            _gfxContext->addAssetOwner(owner.c_str(), gfx::ResourceType::kTexture,
+                name.c_str());
         }
         break;
     case AssetType::kModelSet:
         {
             if (!_gfxContext->findModelSet(name.c_str())) {
-                reqId = _scheduler->schedule(allocate_unique<LoadAssetManifest>(
+                auto task = allocate_unique<LoadAssetManifest>(
                     name,
                     *this,
-                    [this](Task::State state, Task& t, void*) {
+                    [this, owner](Task::State state, Task& t, void*) {
                         auto& task = static_cast<LoadAssetManifest&>(t);
                         if (state == Task::State::kEnded) {
+                            OVENGINE_MEMORY_TAG(kMemoryTagGfx);
                             auto manifest = task.acquireManifest();
                             auto modelSet = gfx::loadModelSetFromJSON(*_gfxContext, manifest->root());
                             _gfxContext->registerModelSet(std::move(modelSet), task.name().c_str());
+                            _gfxContext->addAssetOwner(owner.c_str(),
+                                gfx::ResourceType::kModelSet, task.name().c_str());
+                            //  the model set's materials now pin the textures
+                            //  its manifest requested
+                            _gfxContext->releaseAssetOwner(manifest->name().c_str());
+                            if (_reloader) {
+                                _reloader->watchModelSet(task.name());
+                            }
                         }
                         requestFinished(t.id(), task.name(), state);
-                    })
-                );
+                    });
+                task->setArchive(_archive);
+                reqId = _scheduler->schedule(std::move(task));
+            }
+            else {
+                _gfxContext->addAssetOwner(owner.c_str(), gfx::ResourceType::kModelSet,
+                    name.c_str());
             }
         }
         break;
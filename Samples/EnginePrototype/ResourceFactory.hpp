@@ -15,6 +15,7 @@
 
 #include <cinek/task.hpp>
 #include <vector>
+#include <memory>
 
 namespace cinek {
     class TaskScheduler;
@@ -32,11 +33,18 @@ struct ResourceFactory : public AssetManfiestFactory
     );
     
     virtual ~ResourceFactory();
+    
+    //  Assets present in the archive are loaded from it rather than from
+    //  individual files
+    void mountArchive(std::shared_ptr<AssetArchive> archive);
+    //  Loaded files are watched for changes by the reloader
+    void setAssetReloader(AssetReloader* reloader);
 
     //  AssetManifestFactory
     virtual RequestId onAssetManifestRequest(
         AssetType assetType,
         const std::string& name,
+        const std::string& owner,
         RequestCb cb) override;
     
     virtual void onAssetManifestRequestCancelled(RequestId reqId) override;
@@ -47,6 +55,8 @@ private:
 private:
     gfx::Context* _gfxContext;
     TaskScheduler *_scheduler;
+    std::shared_ptr<AssetArchive> _archive;
+    AssetReloader* _reloader;
     
     std::vector<std::pair<TaskId, RequestCb>> _requests;
 };
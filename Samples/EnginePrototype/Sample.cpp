@@ -9,6 +9,7 @@
 #include "Common.hpp"
 #include "Renderer.hpp"
 #include "Input.hpp"
+#include "Replay.hpp"
 
 #include "CKGfx/VertexTypes.hpp"
 #include "CKGfx/ShaderLibrary.hpp"
@@ -24,6 +25,7 @@
 #include <cinek/file.hpp>
 #include <cinek/allocator.hpp>
 #include <cinek/objectpool.hpp>
+#include <cinek/debug.h>
 
 #include <SDL2/SDL_timer.h>
 #include <SDL2/SDL_events.h>
@@ -34,11 +36,19 @@
 
 #include "UICore/UIEngine.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <unordered_map>
+#include <vector>
 
 #include "Engine/EngineTypes.hpp"
+#include "Engine/AssetArchive.hpp"
 
 #include "PrototypeApplication.hpp"
+#include "SampleSystems.hpp"
 
 
 
@@ -48,17 +58,6 @@
 //
 ////////////////////////////////////////////////////////////////////////////////
 
-enum
-{
-    kShaderProgramStdMesh       = 0x00000001,
-    kShaderProgramBoneMesh      = 0x00000002,
-    kShaderProgramBoneColorMesh = 0x00000003,
-    kShaderProgramFlat          = 0x00000004,
-    kShaderProgramColorMesh     = 0x00000005,
-    kShaderProgramColor         = 0x00000006,
-    kShaderProgramDiffuse       = 0x00000007
-};
-
 NVGcontext* createNVGcontext(int viewId)
 {
     NVGcontext* nvg = nvgCreate(1, viewId);
@@ -68,8 +67,78 @@ NVGcontext* createNVGcontext(int viewId)
 }
 
 
-int runSample(int viewWidth, int viewHeight, int firstFreeViewId)
+//  packs the files listed in archive.txt (one path per line, relative to the
+//  data directory) into an archive mountable with --archive
+static int packSampleArchive(const char* path)
 {
+    FILE* fp = fopen("archive.txt", "rt");
+    if (!fp) {
+        CK_LOG_WARN("OverviewSample", "Pack: cannot open archive.txt\n");
+        return 1;
+    }
+    
+    std::vector<std::string> sources;
+    char line[512];
+    while (fgets(line, sizeof(line), fp)) {
+        size_t len = strcspn(line, "\r\n");
+        line[len] = 0;
+        if (len > 0 && line[0] != '#') {
+            sources.emplace_back(line);
+        }
+    }
+    fclose(fp);
+    
+    if (!cinek::ove::AssetArchive::pack(path, sources))
+        return 1;
+    
+    CK_LOG_WARN("OverviewSample", "Pack: %zu files written to %s\n",
+                sources.size(), path);
+    return 0;
+}
+
+//  logs replay results and frame costs, for comparing engine builds
+static void reportReplay
+(
+    const cinek::input::ReplayPlayer& player,
+    std::vector<double> frameCostsMs
+)
+{
+    double totalMs = 0.0;
+    for (double costMs : frameCostsMs) {
+        totalMs += costMs;
+    }
+    std::sort(frameCostsMs.begin(), frameCostsMs.end());
+    
+    auto percentile = [&frameCostsMs](double pct) -> double {
+        if (frameCostsMs.empty())
+            return 0.0;
+        size_t index = (size_t)(pct * 0.01 * (frameCostsMs.size() - 1) + 0.5);
+        return frameCostsMs[index];
+    };
+    
+    CK_LOG_INFO("OverviewSample",
+                "Replay: %u frames, %u ticks, %u divergences\n"
+                "Replay: frame ms mean %.3f, p50 %.3f, p99 %.3f, max %.3f\n",
+                player.frameIndex(), player.tickIndex(), player.divergenceCount(),
+                frameCostsMs.empty() ? 0.0 : totalMs / frameCostsMs.size(),
+                percentile(50.0), percentile(99.0),
+                frameCostsMs.empty() ? 0.0 : frameCostsMs.back());
+}
+
+int runSample
+(
+    int viewWidth,
+    int viewHeight,
+    int firstFreeViewId,
+    const SampleOptions& options
+)
+{
+    if (options.packPath) {
+        return packSampleArchive(options.packPath);
+    }
+    
+    int result = 0;
+    
     NVGcontext* nvg = nvgCreate(1, firstFreeViewId);
     bgfx::setViewSeq(1, true);
     ++firstFreeViewId;
@@ -77,6 +146,47 @@ int runSample(int viewWidth, int viewHeight, int firstFreeViewId)
     //  nvg destruction should occur after the below scope's objects have been
     //  lost
     {
+        const double kSimFPS = 60.0;
+        
+        //  Record and replay.  Replays use the recording's view size and
+        //  random seed so that view dependent logic (picking) and random
+        //  numbers match, and present ImGui with the recorded mouse and
+        //  modifier state instead of the live SDL state.
+        cinek::input::ReplayRecorder recorder;
+        cinek::input::ReplayPlayer player;
+        cinek::input::ReplayHeader replayHeader;
+        const bool replaying = options.replayPath != nullptr;
+        bool running = true;
+        
+        if (replaying) {
+            if (player.open(options.replayPath)) {
+                replayHeader = player.header();
+                if (replayHeader.simFPS != (uint32_t)kSimFPS) {
+                    CK_LOG_WARN("OverviewSample",
+                                "Replay: recorded at %u ticks per second\n",
+                                replayHeader.simFPS);
+                }
+                viewWidth = replayHeader.viewWidth;
+                viewHeight = replayHeader.viewHeight;
+                bgfx::reset(viewWidth, viewHeight,
+                            options.headless ? BGFX_RESET_NONE : BGFX_RESET_VSYNC);
+            }
+            else {
+                running = false;
+                result = 1;
+            }
+        }
+        else {
+            replayHeader.seed = (uint32_t)time(nullptr);
+            replayHeader.simFPS = (uint32_t)kSimFPS;
+            replayHeader.viewWidth = viewWidth;
+            replayHeader.viewHeight = viewHeight;
+            if (options.recordPath) {
+                recorder.open(options.recordPath, replayHeader);
+            }
+        }
+        srand(replayHeader.seed);
+        
         //  GFX
         cinek::gfx::Rect viewRect = { 0, 0, viewWidth, viewHeight };
         cinek::gfx::VertexTypes::initialize();
@@ -84,83 +194,52 @@ int runSample(int viewWidth, int viewHeight, int firstFreeViewId)
         cinek::gfx::NodeRenderer::ProgramMap shaderPrograms;
         cinek::gfx::NodeRenderer::UniformMap shaderUniforms;
         
-        registerShaders(
-            shaderLibrary, shaderPrograms, shaderUniforms, {
-                {
-                    cinek::gfx::kNodeProgramMeshUV, kShaderProgramStdMesh,
-                    "bin/vs_std_uv.bin",
-                    "bin/fs_std_tex.bin"
-                },
-                {
-                    cinek::gfx::kNodeProgramBoneMeshUV, kShaderProgramBoneMesh,
-                    "bin/vs_bone_uv.bin",
-                    "bin/fs_std_tex.bin"
-                },
-                {
-                    cinek::gfx::kNodeProgramBoneMeshColor, kShaderProgramBoneColorMesh,
-                    "bin/vs_bone_col.bin",
-                    "bin/fs_std_col.bin"
-                },
-                {
-                    cinek::gfx::kNodeProgramFlat, kShaderProgramFlat,
-                    "bin/vs_flat_pos.bin",
-                    "bin/fs_flat_col.bin"
-                },
-                {
-                    cinek::gfx::kNodeProgramMeshColor, kShaderProgramColorMesh,
-                    "bin/vs_std_flat.bin",
-                    "bin/fs_std_col.bin"
-                },
-                {
-                    cinek::gfx::kNodeProgramColor, kShaderProgramColor,
-                    "bin/vs_basic_col.bin",
-                    "bin/fs_flat_col.bin"
-                },
-                {
-                    cinek::gfx::kNodeProgramDiffuse, kShaderProgramDiffuse,
-                    "bin/vs_basic_uv.bin",
-                    "bin/fs_flat_tex.bin"
-                }
-            });
+        const std::vector<SampleShaderProgram> shaderConfigs =
+            cinek::SampleSystems::shaderPrograms();
+        registerShaders(shaderLibrary, shaderPrograms, shaderUniforms, shaderConfigs);
 
-        cinek::gfx::Context::ResourceInitParams gfxInitParams;
-        
-        gfxInitParams.numMeshes = 1024;
-        gfxInitParams.numMaterials = 1024;
-        gfxInitParams.numTextures = 256;
-        gfxInitParams.numAnimations = 256;
-        gfxInitParams.numLights = 64;
-        gfxInitParams.numModelSets = 64;
-        
-        cinek::gfx::Context gfxContext(gfxInitParams);
+        cinek::gfx::Context gfxContext(cinek::SampleSystems::gfxResourceParams());
         
         //  Application
         //
-        cinek::PrototypeApplication controller(gfxContext, shaderPrograms, shaderUniforms,
-                                               nvg);
+        cinek::PrototypeApplication controller(gfxContext,
+                                               shaderLibrary, shaderConfigs,
+                                               shaderPrograms, shaderUniforms,
+                                               nvg, options.archivePath);
 
-        const double kSimFPS = 60.0;
         const CKTimeDelta kSecsPerSimFrame = 1/kSimFPS;
         
         CKTime simTime = 0.0;
         CKTime lagSecsSim = 0.0;
         
         uint32_t systemTimeMs = SDL_GetTicks();
-        bool running = true;
         
         cinek::input::InputState polledInputState;
         
+        std::vector<double> replayFrameCostsMs;
+        
         while (running) {
-            uint32_t nextSystemTimeMs = SDL_GetTicks();
-            int32_t frameTimeMs = nextSystemTimeMs - systemTimeMs;
-            systemTimeMs = nextSystemTimeMs;
+            int32_t frameTimeMs;
+            if (replaying) {
+                if (!player.nextFrame())
+                    break;
+                frameTimeMs = player.frameTimeMs();
+            }
+            else {
+                uint32_t nextSystemTimeMs = SDL_GetTicks();
+                frameTimeMs = nextSystemTimeMs - systemTimeMs;
+                systemTimeMs = nextSystemTimeMs;
+                
+                //  TODO: Lag should not be incremented while Sim is Paused
+                if (frameTimeMs > 100) {
+                    frameTimeMs = 100;
+                }
+                recorder.beginFrame(frameTimeMs);
+            }
             
-            controller.beginFrame();
+            uint64_t frameStartCounter = SDL_GetPerformanceCounter();
             
-            //  TODO: Lag should not be incremented while Sim is Paused
-            if (frameTimeMs > 100) {
-                frameTimeMs = 100;
-            }
+            controller.beginFrame();
             
             CKTimeDelta frameTime = frameTimeMs*0.001;
             lagSecsSim += frameTime;
@@ -172,6 +251,13 @@ int runSample(int viewWidth, int viewHeight, int firstFreeViewId)
             while (lagSecsSim >= kSecsPerSimFrame)
             {
                 controller.simulateFrame(kSecsPerSimFrame);
+                
+                if (replaying) {
+                    player.verifyTick(controller.simulationStateHash());
+                }
+                else if (recorder.isOpen()) {
+                    recorder.recordTick(controller.simulationStateHash());
+                }
 
                 lagSecsSim -= kSecsPerSimFrame;
                 simTime += kSecsPerSimFrame;
@@ -181,8 +267,28 @@ int runSample(int viewWidth, int viewHeight, int firstFreeViewId)
             //
             //  SIMULATION END
             ////////////////////////////////////////////////////////////////////////
-
-            {
+            
+            if (replaying) {
+                player.verifyFrameEnd();
+                
+                //  the recorded state already includes the events' effects
+                polledInputState = player.inputState();
+                
+                ImGuiFrameInput uiInput;
+                uiInput.displayWidth = viewWidth;
+                uiInput.displayHeight = viewHeight;
+                uiInput.mouseX = polledInputState.mx;
+                uiInput.mouseY = polledInputState.my;
+                uiInput.mouseButtons = polledInputState.mbtn;
+                uiInput.keyModifiers = polledInputState.keyModifiers;
+                uiInput.deltaTime = (float)frameTime;
+                imGuiSetFrameInput(&uiInput);
+                
+                for (SDL_Event event : player.events()) {
+                    imGuiProcessEvent(&event);
+                }
+            }
+            else {
                 int mx, my;
     
                 //  handle Mouse UI, which is polled per frame instead of set per event.
@@ -201,12 +307,15 @@ int runSample(int viewWidth, int viewHeight, int firstFreeViewId)
                 while (SDL_PollEvent(&event)) {
                     flags |= cinek::input::processSDLEvent(polledInputState, event);
                     imGuiProcessEvent(&event);
+                    recorder.recordEvent(event);
                 }
                 if (flags & cinek::input::kPollSDLEvent_Quit)
                     running = false;
                 
                 polledInputState.keystate = SDL_GetKeyboardState(&polledInputState.keystateArraySize);
                 polledInputState.keyModifiers = SDL_GetModState();
+                
+                recorder.recordInput(polledInputState);
             }
             
             //  pixel ratio may change if for some reason we have different framebuffer
@@ -222,13 +331,29 @@ int runSample(int viewWidth, int viewHeight, int firstFreeViewId)
             
             controller.endFrame();
             
+            recorder.endFrame();
+            
             bgfx::frame();
+            
+            if (replaying) {
+                uint64_t frameCounter = SDL_GetPerformanceCounter() - frameStartCounter;
+                replayFrameCostsMs.push_back(
+                    frameCounter * 1000.0 / SDL_GetPerformanceFrequency());
+            }
+        }
+        
+        if (replaying) {
+            imGuiSetFrameInput(nullptr);
+            reportReplay(player, std::move(replayFrameCostsMs));
+            if (player.divergenceCount()) {
+                result = 1;
+            }
         }
     }
     
     nvgDelete(nvg);
     
-    return 0;
+    return result;
 }
 
 
@@ -0,0 +1,214 @@
+//
+//  SampleSystems.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#include "SampleSystems.hpp"
+#include "GameEntityFactory.hpp"
+#include "Game/NavDataContext.hpp"
+#include "Game/TransformDataContext.hpp"
+
+#include "Engine/Physics/SceneDataContext.hpp"
+#include "Engine/Physics/Scene.hpp"
+#include "Engine/Physics/SceneDebugDrawer.hpp"
+#include "Engine/Render/RenderGraph.hpp"
+#include "Engine/EntityDatabase.hpp"
+#include "Engine/Path/Pathfinder.hpp"
+#include "Engine/Controller/NavSystem.hpp"
+#include "Engine/Controller/TransformSystem.hpp"
+#include "Engine/JobSystem.hpp"
+#include "Engine/MemoryTracker.hpp"
+
+namespace cinek {
+
+enum
+{
+    kShaderProgramStdMesh       = 0x00000001,
+    kShaderProgramBoneMesh      = 0x00000002,
+    kShaderProgramBoneColorMesh = 0x00000003,
+    kShaderProgramFlat          = 0x00000004,
+    kShaderProgramColorMesh     = 0x00000005,
+    kShaderProgramColor         = 0x00000006,
+    kShaderProgramDiffuse       = 0x00000007,
+    kShaderProgramStdMeshInst   = 0x00000008,
+    kShaderProgramColorMeshInst = 0x00000009
+};
+
+gfx::Context::ResourceInitParams SampleSystems::gfxResourceParams()
+{
+    gfx::Context::ResourceInitParams gfxInitParams;
+    
+    gfxInitParams.numMeshes = 1024;
+    gfxInitParams.numMaterials = 1024;
+    gfxInitParams.numTextures = 256;
+    gfxInitParams.numAnimations = 256;
+    gfxInitParams.numLights = 64;
+    gfxInitParams.numModelSets = 64;
+    gfxInitParams.residencyBudget = 128 * 1024 * 1024;
+    
+    return gfxInitParams;
+}
+
+std::vector<SampleShaderProgram> SampleSystems::shaderPrograms()
+{
+    return {
+        {
+            gfx::kNodeProgramMeshUV, kShaderProgramStdMesh,
+            "bin/vs_std_uv.bin",
+            "bin/fs_std_tex.bin"
+        },
+        {
+            gfx::kNodeProgramBoneMeshUV, kShaderProgramBoneMesh,
+            "bin/vs_bone_uv.bin",
+            "bin/fs_std_tex.bin"
+        },
+        {
+            gfx::kNodeProgramBoneMeshColor, kShaderProgramBoneColorMesh,
+            "bin/vs_bone_col.bin",
+            "bin/fs_std_col.bin"
+        },
+        {
+            gfx::kNodeProgramFlat, kShaderProgramFlat,
+            "bin/vs_flat_pos.bin",
+            "bin/fs_flat_col.bin"
+        },
+        {
+            gfx::kNodeProgramMeshColor, kShaderProgramColorMesh,
+            "bin/vs_std_flat.bin",
+            "bin/fs_std_col.bin"
+        },
+        {
+            gfx::kNodeProgramColor, kShaderProgramColor,
+            "bin/vs_basic_col.bin",
+            "bin/fs_flat_col.bin"
+        },
+        {
+            gfx::kNodeProgramDiffuse, kShaderProgramDiffuse,
+            "bin/vs_basic_uv.bin",
+            "bin/fs_flat_tex.bin"
+        },
+        {
+            gfx::kNodeProgramMeshUVInstanced, kShaderProgramStdMeshInst,
+            "bin/vs_std_uv_inst.bin",
+            "bin/fs_std_tex.bin"
+        },
+        {
+            gfx::kNodeProgramMeshColorInstanced, kShaderProgramColorMeshInst,
+            "bin/vs_std_flat_inst.bin",
+            "bin/fs_std_col.bin"
+        }
+    };
+}
+
+SampleSystems::SampleSystems
+(
+    gfx::Context* gfxContext,
+    ove::JobSystem* jobSystem
+)
+{
+    gfx::NodeElementCounts sceneElementCounts;
+    sceneElementCounts.meshNodeCount = 128;
+    sceneElementCounts.armatureNodeCount = 32;
+    sceneElementCounts.lightNodeCount = 8;
+    sceneElementCounts.objectNodeCount = 64;
+    sceneElementCounts.transformNodeCount = 64;
+    
+    {
+        OVENGINE_MEMORY_TAG(ove::kMemoryTagRender);
+        _renderGraph = allocate_unique<ove::RenderGraph>(
+            sceneElementCounts,
+            1024,
+            256
+        );
+    }
+    
+    std::vector<EntityStore::InitParams> entityStoreInitializers = {
+        //  default
+        EntityStore::InitParams {
+                16384
+        },
+        //  staging
+        EntityStore::InitParams {
+                1024
+        }
+    };
+    
+    ove::SceneDataContext::InitParams sceneDataInit;
+    sceneDataInit.numBodies = 256;
+    sceneDataInit.numTriMeshShapes = 32;
+    sceneDataInit.numCylinderShapes = 32;
+    sceneDataInit.numBoxShapes = 32;
+    
+    ove::Scene::InitParams sceneInitParams;
+    sceneInitParams.staticLimit = 1024;
+    sceneInitParams.limits[ove::SceneBody::kSection] = 64;
+    sceneInitParams.limits[ove::SceneBody::kDynamic] = 1024;
+    sceneInitParams.limits[ove::SceneBody::kStaging] = 16;
+    if (jobSystem) {
+        sceneInitParams.jobRunner =
+            [jobSystem](uint32_t count, const std::function<void(uint32_t)>& job) {
+                jobSystem->parallelFor(0, count, 1, job);
+            };
+    }
+    
+    {
+        OVENGINE_MEMORY_TAG(ove::kMemoryTagScene);
+        _sceneData = allocate_unique<ove::SceneDataContext>(sceneDataInit);
+        _sceneDbgDraw = allocate_unique<ove::SceneDebugDrawer>();
+        _scene = allocate_unique<ove::Scene>(sceneInitParams, _sceneDbgDraw.get());
+    }
+
+    {
+        OVENGINE_MEMORY_TAG(ove::kMemoryTagPathfinder);
+        _pathfinder = allocate_unique<ove::Pathfinder>();
+    }
+    
+    NavDataContext::InitParams navDataInitParams;
+    navDataInitParams.navBodyCount = 128;
+    
+    ove::NavSystem::InitParams navInitParams;
+    navInitParams.pathfinder = _pathfinder.get();
+    navInitParams.numBodies = navDataInitParams.navBodyCount;
+    
+    {
+        OVENGINE_MEMORY_TAG(ove::kMemoryTagNav);
+        _navDataContext = allocate_unique<NavDataContext>(navDataInitParams);
+        _navSystem = allocate_unique<ove::NavSystem>(navInitParams);
+    }
+    
+    TransformDataContext::InitParams transformInitParams;
+    transformInitParams.setCount = 128;
+    transformInitParams.actionCount = transformInitParams.setCount * 2;
+    transformInitParams.sequenceCount = transformInitParams.actionCount * 8;
+    _transformDataContext = allocate_unique<TransformDataContext>(transformInitParams);
+    
+    ove::TransformSystem::InitParams transformSystemParams;
+    transformSystemParams.numBodies = 128;
+    _transformSystem = allocate_unique<ove::TransformSystem>(transformSystemParams);
+    {
+        OVENGINE_MEMORY_TAG(ove::kMemoryTagEntity);
+        _entityDb = allocate_unique<ove::EntityDatabase>(entityStoreInitializers);
+    }
+    
+    _componentFactory = allocate_unique<GameEntityFactory>(
+        _entityDb.get(),
+        gfxContext,
+        _sceneData.get(),
+        _scene.get(),
+        _renderGraph.get(),
+        _navDataContext.get(),
+        _navSystem.get(),
+        _transformDataContext.get(),
+        _transformSystem.get()
+    );
+    _entityDb->setFactory(_componentFactory.get());
+}
+
+SampleSystems::~SampleSystems()
+{
+}
+
+}   /* namespace cinek */
@@ -0,0 +1,68 @@
+//
+//  SampleSystems.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#ifndef Prototype_Game_SampleSystems_hpp
+#define Prototype_Game_SampleSystems_hpp
+
+#include "GameTypes.hpp"
+#include "Renderer.hpp"
+
+#include "CKGfx/Context.hpp"
+
+#include <cinek/allocator.hpp>
+
+#include <vector>
+
+namespace cinek {
+
+class GameEntityFactory;
+
+//  Creates the simulation and render systems used by the EnginePrototype
+//  sample, so that the sample and the Benchmark run with an identical
+//  configuration.  Also supplies the sample's graphics limits and shader
+//  programs.
+class SampleSystems
+{
+    CK_CLASS_NON_COPYABLE(SampleSystems);
+
+public:
+    static gfx::Context::ResourceInitParams gfxResourceParams();
+    static std::vector<SampleShaderProgram> shaderPrograms();
+
+    //  jobSystem is optional, and runs the scene's narrow phase if supplied
+    SampleSystems(gfx::Context* gfxContext, ove::JobSystem* jobSystem);
+    ~SampleSystems();
+
+    ove::RenderGraph* renderGraph() const { return _renderGraph.get(); }
+    ove::EntityDatabase* entityDatabase() const { return _entityDb.get(); }
+    ove::SceneDataContext* sceneData() const { return _sceneData.get(); }
+    ove::SceneDebugDrawer* sceneDebugDrawer() const { return _sceneDbgDraw.get(); }
+    ove::Scene* scene() const { return _scene.get(); }
+    ove::Pathfinder* pathfinder() const { return _pathfinder.get(); }
+    ove::NavSystem* navSystem() const { return _navSystem.get(); }
+    ove::TransformSystem* transformSystem() const { return _transformSystem.get(); }
+
+private:
+    //  destroyed in reverse order, so the factory and systems go before the
+    //  entity database and render graph
+    unique_ptr<ove::RenderGraph> _renderGraph;
+    unique_ptr<ove::EntityDatabase> _entityDb;
+    unique_ptr<ove::SceneDataContext> _sceneData;
+    unique_ptr<ove::SceneDebugDrawer> _sceneDbgDraw;
+    unique_ptr<ove::Scene> _scene;
+    unique_ptr<ove::Pathfinder> _pathfinder;
+    unique_ptr<NavDataContext> _navDataContext;
+    unique_ptr<ove::NavSystem> _navSystem;
+    unique_ptr<TransformDataContext> _transformDataContext;
+    unique_ptr<ove::TransformSystem> _transformSystem;
+    unique_ptr<GameEntityFactory> _componentFactory;
+};
+
+}   /* namespace cinek */
+
+#endif /* Prototype_Game_SampleSystems_hpp */
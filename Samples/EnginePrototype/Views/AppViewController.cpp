@@ -17,7 +17,8 @@ AppViewController::AppViewController
     ApplicationContext* context
 ) :
     _appContext(context),
-    _assetService({ context->taskScheduler, context->resourceFactory }),
+    _assetService({ context->taskScheduler, context->resourceFactory,
+                    context->assetArchive }),
     _entityService( context->entityDatabase ),
     _pathfinder( context->pathfinder ),
     _pathfinderDebug( context->pathfinderDebug )
@@ -23,9 +23,11 @@ struct ApplicationContext
 {
     NVGcontext* nvg;
     TaskScheduler* taskScheduler;
+    ove::JobSystem* jobSystem;
     
     ove::MessageClientSender* msgClientSender;
     ove::AssetManfiestFactory* resourceFactory;
+    std::shared_ptr<ove::AssetArchive> assetArchive;
     ove::EntityDatabase* entityDatabase;
     gfx::Context* gfxContext;
     ove::SceneDebugDrawer* sceneDebugDrawer;
@@ -36,6 +38,9 @@ struct ApplicationContext
     ove::Pathfinder* pathfinder;
     ove::PathfinderDebug* pathfinderDebug;
     ove::NavSystem* navSystem;
+    
+    //  owns the assets of the currently loaded scene
+    std::string sceneAssetOwner;
 };
 
 class AppViewController : public ove::ViewController
@@ -82,6 +87,9 @@ protected:
     gfx::Context& gfxContext() {
         return *_appContext->gfxContext;
     }
+    ApplicationContext& appContext() {
+        return *_appContext;
+    }
 
 private:
     ApplicationContext* _appContext;
@@ -22,13 +22,15 @@
 
 #include "UICore/UI.hpp"
 
-#include <cinek/memorystack.hpp>
 #include <ckjson/json.hpp>
 #include <ckm/math.hpp>
 
 #include <bx/fpumath.h>
 #include <bgfx/bgfx.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include "EditorComponents.inl"
 
 namespace cinek {
@@ -120,99 +122,6 @@ bool EditorUIVariant::isAllocated() const
     return (_type & 0x80000000) != 0;
 }
 
-struct EditorView::SceneTreeNode
-{
-    enum class Type
-    {
-        kEntity,
-        kGroup
-    };
-    const char* name;
-    Type type;
-    Entity entity;
-    
-    SceneTreeNode* parent;
-    SceneTreeNode* nextSibling;
-    SceneTreeNode* prevSibling;
-    SceneTreeNode* firstChild;
-};
-
-class EditorView::SceneTree
-{
-public:
-    using Node = SceneTreeNode;
-    
-    SceneTree(int nodeCount, const Allocator& allocator) :
-        _nodeStack(nodeCount * sizeof(Node), allocator),
-        _stringStack(nodeCount * 32),
-        _root(nullptr)
-    {
-    }
-    
-    Node* root() { return _root; }
-    const Node* root() const { return _root; }
-    
-    void reset()
-    {
-        _nodeStack.reset();
-        _stringStack.reset();
-        
-        _root = allocateNode("Root", Node::Type::kGroup);
-    }
-    
-    void addScene(const ove::Scene& scene)
-    {
-        Node* node = appendChild(_root, "Bodies", Node::Type::kGroup);
-        if (node) {
-            scene.iterateBodies(ove::SceneBody::kAllCategories,
-                [this, node](ove::SceneBody* body, uint32_t mask) {
-                    if (!body->checkFlags(ove::SceneBody::kIsStaging)) {
-                        Node* child = appendChild(node, "Entity", Node::Type::kEntity);
-                        if (child) {
-                            child->entity = body->entity;
-                        }
-                    }
-                });
-        }
-    }
-    
-private:
-    MemoryStack _nodeStack;
-    CStringStack _stringStack;
-    Node* _root;
-    
-    Node* allocateNode(const char* name, Node::Type type)
-    {
-        Node* node = reinterpret_cast<Node*>(_nodeStack.allocate(sizeof(Node)));
-        if (node) {
-            memset(node, 0, sizeof(*node));
-            
-            node->name = _stringStack.create(name);
-            node->type = type;
-        }
-        return node;
-    }
-    
-    Node* appendChild(Node* parent, const char* name, Node::Type type)
-    {
-        Node* node = allocateNode(name, type);
-        if (node) {
-            if (parent->firstChild) {
-                Node* oldTail = parent->firstChild->prevSibling;
-                parent->firstChild->prevSibling = node;
-                oldTail->nextSibling = node;
-                node->prevSibling = oldTail;
-            }
-            else {
-                parent->firstChild = node;
-                node->prevSibling = node;   //  tail as our head's prev sibling
-            }
-            node->parent = parent;
-        }
-        return node;
-    }
-};
-
 EditorView::EntityCategory::EntityCategory(int cnt, int maxstrlen) :
     strstack(cnt*maxstrlen*2),
     size(cnt)
@@ -228,7 +137,9 @@ EditorView::EditorView
     GameViewContext* gameContext
 ) :
     GameState(gameContext),
-    _activeEntity(0)
+    _activeEntity(0),
+    _marqueeTicket(0),
+    _marqueeActive(false)
 {
 }
 
@@ -316,6 +227,9 @@ void EditorView::createUIData()
     if (!entityService().isEntityValid(_activeEntity)) {
         _activeEntity = 0;
     }
+    _selectedEntities.clear();
+    _marqueeTicket = 0;
+    _marqueeActive = false;
     
     //  first pass, enumerate categories
     entityService().enumerateDefinitions(
@@ -397,13 +311,14 @@ void EditorView::createUIData()
         }
     );
     
-    //  scene tree building
-    _sceneTree = allocate_unique<SceneTree>(_allocator, 1024, _allocator);
-    rebuildSceneTree(*_sceneTree);
+    //  scene outliner, maintained from scene events from here on
+    _sceneOutliner = allocate_unique<SceneOutliner>(_allocator, scene(), entityService());
     
     //  default UI status
     _uiStatus.cameraOption = UIStatus::kCamera_Perspective;
     _uiStatus.cameraDirection = UIStatus::kCameraDirection_Current;
+    _uiStatus.outlinerFilter[0] = 0;
+    _uiStatus.outlinerCategory = SceneOutliner::kCategory_All;
     _uiTransformStatus.system = UITransformStatus::kSystem_Global;
     _uiTransformStatus.mode = UITransformStatus::Mode::kTransform_Location;
     _uiTransformStatus.option = UITransformStatus::kTransform_Free;
@@ -411,13 +326,7 @@ void EditorView::createUIData()
 
 void EditorView::destroyUIData()
 {
-    _sceneTree = nullptr;
-}
-
-void EditorView::rebuildSceneTree(cinek::EditorView::SceneTree &tree)
-{
-    _sceneTree->reset();
-    _sceneTree->addScene(scene());
+    _sceneOutliner = nullptr;
 }
 
 void EditorView::setActiveEntity(Entity entity)
@@ -430,6 +339,62 @@ void EditorView::setActiveEntity(Entity entity)
     snprintf(_uiStatus.entityStatus.id, sizeof(_uiStatus.entityStatus.id), "%" PRIu64, entity);
 }
 
+void EditorView::queueMarqueeSelection()
+{
+    //  ignore rectangles too small to be anything but a click
+    const float kMinMarqueeSize = 4.0f;
+    
+    const gfx::Rect& viewport = camera().viewportRect;
+    const float x0 = std::min(_marqueeStart.x, _marqueeEnd.x) - viewport.x;
+    const float y0 = std::min(_marqueeStart.y, _marqueeEnd.y) - viewport.y;
+    const float x1 = std::max(_marqueeStart.x, _marqueeEnd.x) - viewport.x;
+    const float y1 = std::max(_marqueeStart.y, _marqueeEnd.y) - viewport.y;
+    
+    if (x1 - x0 < kMinMarqueeSize || y1 - y0 < kMinMarqueeSize)
+        return;
+    
+    //  corners in order around the rectangle
+    const float screenCorners[4][2] = {
+        { x0, y0 }, { x1, y0 }, { x1, y1 }, { x0, y1 }
+    };
+    btVector3 corners[4];
+    for (int i = 0; i < 4; ++i) {
+        gfx::Vector3 dir = camera().worldRayFromScreenCoordinate(
+            (int32_t)screenCorners[i][0], (int32_t)screenCorners[i][1]);
+        corners[i] = ove::btFromGfx(dir);
+    }
+    
+    gfx::Vector3 cameraPos = camera().worldPosition();
+    _marqueeTicket = sceneQueries().queueFrustumTest(ove::btFromGfx(cameraPos),
+        corners, 100.0f,
+        ove::SceneBody::kAllFilter,
+        ove::SceneBody::kStagingFilter);
+}
+
+void EditorView::updateMarqueeSelection()
+{
+    if (!_marqueeTicket)
+        return;
+    
+    const ove::FrameVector<Entity>* entities = sceneQueries().frustumTestResult(_marqueeTicket);
+    if (!entities)
+        return;
+    
+    _marqueeTicket = 0;
+    _selectedEntities.clear();
+    
+    for (auto entity : *entities) {
+        //  entity must be selectable
+        const ove::SceneBody* body = scene().findBody(entity);
+        if (body && !body->checkFlags(ove::SceneBody::kIsSection)) {
+            _selectedEntities.push_back(entity);
+        }
+    }
+    if (!_selectedEntities.empty()) {
+        setActiveEntity(_selectedEntities.front());
+    }
+}
+
 void EditorView::updateMainUI(UIStatus& status, float width, float height)
 {
     const ImVec2 kDesktopPad { 10, 10 };
@@ -545,7 +510,7 @@ void EditorView::updateMainUI(UIStatus& status, float width, float height)
     //  SCENE GRAPH UI
     ImGui::SetNextWindowPos(kSceneTreePos, ImGuiSetCond_FirstUseEver);
     if (ImGui::Begin("Scene", nullptr, kSceneTreeDims, 0.3f)) {
-        updateSceneTreeUI(_sceneTree->root());
+        updateSceneOutlinerUI(status);
     }
     ImGui::End();
     
@@ -554,6 +519,8 @@ void EditorView::updateMainUI(UIStatus& status, float width, float height)
     updatePropertiesUI(status.entityStatus, kPropsDims.x, kPropsDims.y);
     
     //  handle events from the frame window
+    updateMarqueeSelection();
+    
     if (!ImGui::IsMouseHoveringAnyWindow()) {
         auto& sceneHitResult = sceneRayTestResult();
         
@@ -562,12 +529,27 @@ void EditorView::updateMainUI(UIStatus& status, float width, float height)
                 //  set the active entity (entity must be selectable)
                 if (!sceneHitResult.body->checkFlags(ove::SceneBody::kIsSection)) {
                     setActiveEntity(sceneHitResult.body->entity);
+                    _selectedEntities.assign(1, sceneHitResult.body->entity);
                 }
             }
+            //  dragging from here selects by marquee
+            _marqueeActive = true;
+            _marqueeStart = { io.MousePos.x, io.MousePos.y };
+            _marqueeEnd = _marqueeStart;
         }
     
     }
     
+    if (_marqueeActive) {
+        if (ImGui::IsMouseDown(0)) {
+            _marqueeEnd = { io.MousePos.x, io.MousePos.y };
+        }
+        else {
+            _marqueeActive = false;
+            queueMarqueeSelection();
+        }
+    }
+    
     //  handle shortcuts
     if (io.KeyShift) {
         if (ImGui::IsKeyPressed(SDLK_TAB)) {
@@ -586,36 +568,44 @@ void EditorView::updateMainUI(UIStatus& status, float width, float height)
     }
 }
 
-void EditorView::updateSceneTreeUI(const SceneTreeNode *node)
+void EditorView::updateSceneOutlinerUI(UIStatus& status)
 {
-    if (!node)
-        return;
-    
-    bool open = false;
-    
-    if (node->type == SceneTreeNode::Type::kGroup) {
-        open = ImGui::TreeNode(node->name);
-    }
-    else if (node->type == SceneTreeNode::Type::kEntity) {
-        auto& name = entityService().identityFromEntity(node->entity);
+    ImGui::PushItemWidth(-1);
+    ImGui::InputText("##Filter", status.outlinerFilter, sizeof(status.outlinerFilter));
+    ImGui::Combo("##Category", &status.outlinerCategory, "All\0Sections\0Dynamic\0Fixed\0\0");
+    ImGui::PopItemWidth();
+    
+    _sceneOutliner->setFilter(status.outlinerFilter,
+        static_cast<SceneOutliner::CategoryFilter>(status.outlinerCategory));
+    _sceneOutliner->refresh();
+    
+    ImGui::Text("%u of %u bodies", _sceneOutliner->filteredCount(),
+                _sceneOutliner->entityCount());
+    
+    //  only rows within the scrolled region are emitted
+    ImGui::BeginChild("##Bodies");
+    ImGuiListClipper clipper(_sceneOutliner->filteredCount(),
+                             ImGui::GetTextLineHeightWithSpacing());
+    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+        Entity entity = _sceneOutliner->filteredEntity(i);
+        auto& name = entityService().identityFromEntity(entity);
         const char* nameptr = "<Entity>";
         if (!name.empty()) {
             nameptr = name.c_str();
         }
-        open = ImGui::TreeNode(node, "%s %" PRIx64 , nameptr, node->entity);
-    }
-    
-    if (open) {
-
-        for (const SceneTreeNode* child = node->firstChild;
-                                  child;
-                                  child = child->nextSibling) {
+        char label[64];
+        snprintf(label, sizeof(label), "%s %" PRIx64, nameptr, entity);
         
-        
-            updateSceneTreeUI(child);
+        bool selected = entity == _activeEntity ||
+            std::find(_selectedEntities.begin(), _selectedEntities.end(), entity)
+                != _selectedEntities.end();
+        if (ImGui::Selectable(label, selected)) {
+            setActiveEntity(entity);
+            _selectedEntities.assign(1, entity);
         }
-        ImGui::TreePop();
     }
+    clipper.End();
+    ImGui::EndChild();
 }
 
 void EditorView::updatePropertiesUI(UIEntityStatus& status, float w, float h)
@@ -645,6 +635,7 @@ void EditorView::updatePropertiesUI(UIEntityStatus& status, float w, float h)
                 ImGui::NextColumn();
                 if (ImGui::InputText("##Name", status.name, sizeof(status.name))) {
                     entityService().linkIdentityToEntity(status.entity, status.name);
+                    _sceneOutliner->onEntityRenamed(status.entity);
                 }
                 ImGui::NextColumn();
                 ImGui::Columns(1);
@@ -747,6 +738,39 @@ void EditorView::renderOverlay()
         }
     }
     
+    //  selected entities other than the active one
+    for (auto entity : _selectedEntities) {
+        if (entity == _activeEntity)
+            continue;
+        const ove::SceneBody* selectedBody = scene().findBody(entity);
+        if (!selectedBody)
+            continue;
+        
+        const float kMarkerRadius = 6.0f;
+        
+        ckm::vector3 ckpos = selectedBody->getPosition();
+        gfx::Vector4 pos { ckpos.x, ckpos.y, ckpos.z, 1.0f };
+        bool isPosOnscreen;
+        gfx::Vector2 screenPos = camera.worldToScreenCoordinates(pos, &isPosOnscreen);
+        if (isPosOnscreen) {
+            nvgBeginPath(nvg);
+            nvgCircle(nvg, screenPos.x, screenPos.y, kMarkerRadius);
+            nvgStrokeColor(nvg, nvgRGBA(255,255,0,255));
+            nvgStroke(nvg);
+        }
+    }
+    
+    //  marquee
+    if (_marqueeActive) {
+        nvgBeginPath(nvg);
+        nvgRect(nvg, std::min(_marqueeStart.x, _marqueeEnd.x),
+                std::min(_marqueeStart.y, _marqueeEnd.y),
+                std::abs(_marqueeEnd.x - _marqueeStart.x),
+                std::abs(_marqueeEnd.y - _marqueeStart.y));
+        nvgStrokeColor(nvg, nvgRGBA(255,255,255,192));
+        nvgStroke(nvg);
+    }
+    
     nvgRestore(nvg);
 }
 
@@ -1210,8 +1234,6 @@ void EditorView::setIdleState()
         [this]() {
             _uiStatus.displayMainUI = true;
             _uiStatus.addEntityTemplate.reset();
-            
-            rebuildSceneTree(*_sceneTree);
         };
     
     state.frameUpdateFn =
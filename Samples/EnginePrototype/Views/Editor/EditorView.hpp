@@ -11,6 +11,7 @@
 
 #include "Engine/ViewController.hpp"
 #include "Engine/ViewStack.hpp"
+#include "Engine/Physics/SceneQueryService.hpp"
 #include "CKGfx/RenderTarget.hpp"
 #include "CKGfx/Texture.hpp"
 #include "CKGfx/Mesh.hpp"
@@ -18,6 +19,7 @@
 
 #include "GameViewContext.hpp"
 #include "FreeCameraController.hpp"
+#include "SceneOutliner.hpp"
 
 #include <cinek/allocator.hpp>
 #include <cinek/cstringstack.hpp>
@@ -131,19 +133,26 @@ private:
     };
     std::vector<std::pair<std::string, EntityCategory>> _entityCategories;
     
-    class SceneTree;
-    struct SceneTreeNode;
-    unique_ptr<SceneTree> _sceneTree;
-    void rebuildSceneTree(SceneTree& tree);
+    unique_ptr<SceneOutliner> _sceneOutliner;
     
     Entity _activeEntity;       // the currently active entity (ui props, etc.)
     Entity _stagedEntity;       // a pending entity used for adding to scenes
     
+    //  marquee selection - the rectangle is tested against the scene on
+    //  job threads, and results arrive a frame or two after release
+    std::vector<Entity> _selectedEntities;
+    ove::SceneQueryService::Ticket _marqueeTicket;
+    bool _marqueeActive;
+    gfx::Vector2 _marqueeStart;
+    gfx::Vector2 _marqueeEnd;
+    
     void createUIData();
     void renderOverlay();
     void destroyUIData();
     
     void setActiveEntity(Entity entity);
+    void queueMarqueeSelection();
+    void updateMarqueeSelection();
     
 private:
     EditorUIVariantMap _uiVariantMap;
@@ -180,12 +189,15 @@ private:
             kCameraDirection_YZXNeg
         };
         int cameraDirection;
+        
+        char outlinerFilter[32];
+        int outlinerCategory;
     };
     
     UIStatus _uiStatus;
     
     void updateMainUI(UIStatus& status, float width, float height);
-    void updateSceneTreeUI(const SceneTreeNode* node);
+    void updateSceneOutlinerUI(UIStatus& status);
     void updatePropertiesUI(UIEntityStatus& status, float width, float height);
     void endFrameMainUI(UIStatus& status);
 
@@ -0,0 +1,358 @@
+//
+//  SceneOutliner.cpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#include "SceneOutliner.hpp"
+#include "Engine/Physics/Scene.hpp"
+#include "Engine/Services/EntityService.hpp"
+#include "Engine/Profiler.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iterator>
+
+namespace cinek {
+
+static void lowercase(std::string& out, const char* str)
+{
+    out.clear();
+    for (; *str; ++str) {
+        out.push_back((char)std::tolower((unsigned char)*str));
+    }
+}
+
+//  the unique trigrams in str, sorted
+static void trigramsFromString
+(
+    std::vector<uint32_t>& trigrams,
+    const std::string& str
+)
+{
+    trigrams.clear();
+    for (size_t i = 2; i < str.size(); ++i) {
+        trigrams.push_back((uint32_t)(uint8_t)str[i-2]
+            | (uint32_t)(uint8_t)str[i-1] << 8
+            | (uint32_t)(uint8_t)str[i] << 16);
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+SceneOutliner::SceneOutliner
+(
+    ove::Scene& scene,
+    const ove::EntityService& entityService
+) :
+    _scene(scene),
+    _entityService(entityService),
+    _filterCategory(kCategory_All),
+    _filterChanged(true),
+    _filterNarrowed(false)
+{
+    //  the scene's bodies are sorted by entity
+    _scene.iterateBodies(ove::SceneBody::kAllCategories,
+        [this](ove::SceneBody* body, uint32_t) {
+            if (isListed(body)) {
+                Row row;
+                row.entity = body->entity;
+                row.categoryMask = body->getCategoryMask();
+                lowercase(row.name, _entityService.identityFromEntity(body->entity).c_str());
+                queueTrigrams(_trigramsAdded, row.name, row.entity);
+                _rows.push_back(std::move(row));
+            }
+        });
+    indexNames();
+
+    _scene.addListener(this);
+}
+
+SceneOutliner::~SceneOutliner()
+{
+    _scene.removeListener(this);
+}
+
+void SceneOutliner::refresh()
+{
+    OVENGINE_PROFILE_ZONE("SceneOutliner::refresh");
+
+    if (!_changed.empty()) {
+        applyChanges();
+    }
+    if (_filterChanged) {
+        applyFilter();
+    }
+}
+
+void SceneOutliner::setFilter(const char* name, CategoryFilter category)
+{
+    std::string filterName;
+    lowercase(filterName, name);
+    if (category == _filterCategory && filterName == _filterName)
+        return;
+
+    const bool narrowed = category == _filterCategory &&
+        filterName.find(_filterName) != std::string::npos;
+
+    _filterNarrowed = narrowed && !_filterChanged;
+    _filterChanged = true;
+    _filterName = std::move(filterName);
+    _filterCategory = category;
+}
+
+void SceneOutliner::onEntityRenamed(Entity entity)
+{
+    _changed.push_back(entity);
+}
+
+void SceneOutliner::onSceneBodyAttached(ove::SceneBody* body)
+{
+    _changed.push_back(body->entity);
+}
+
+void SceneOutliner::onSceneBodyDetached(ove::SceneBody* body)
+{
+    _changed.push_back(body->entity);
+}
+
+void SceneOutliner::onSceneBodyCategoriesChanged(ove::SceneBody* body)
+{
+    _changed.push_back(body->entity);
+}
+
+void SceneOutliner::queueTrigrams
+(
+    std::vector<TrigramEntity>& queue,
+    const std::string& name,
+    Entity entity
+)
+{
+    trigramsFromString(_nameTrigrams, name);
+    for (auto trigram : _nameTrigrams) {
+        queue.emplace_back(trigram, entity);
+    }
+}
+
+bool SceneOutliner::isListed(const ove::SceneBody* body) const
+{
+    //  staged bodies are previews of entities being added
+    return !body->checkFlags(ove::SceneBody::kIsStaging);
+}
+
+auto SceneOutliner::findRow(Entity entity) const -> const Row*
+{
+    auto it = std::lower_bound(_rows.begin(), _rows.end(), entity,
+        [](const Row& row, Entity e) -> bool {
+            return row.entity < e;
+        });
+    if (it == _rows.end() || it->entity != entity)
+        return nullptr;
+    return &(*it);
+}
+
+bool SceneOutliner::matchesFilter(const Row& row) const
+{
+    switch (_filterCategory) {
+    case kCategory_Sections:
+        if (!(row.categoryMask & ove::SceneBody::kIsSection))
+            return false;
+        break;
+    case kCategory_Dynamic:
+        if (!(row.categoryMask & ove::SceneBody::kIsDynamic))
+            return false;
+        break;
+    case kCategory_Fixed:
+        if (row.categoryMask & (ove::SceneBody::kIsSection | ove::SceneBody::kIsDynamic))
+            return false;
+        break;
+    default:
+        break;
+    }
+
+    return _filterName.empty() || row.name.find(_filterName) != std::string::npos;
+}
+
+void SceneOutliner::applyChanges()
+{
+    std::sort(_changed.begin(), _changed.end());
+    _changed.erase(std::unique(_changed.begin(), _changed.end()), _changed.end());
+
+    //  merge changed entities into the rows, looking up each entity's
+    //  current state.  bodies detached since the event are dropped
+    _scratch.clear();
+    _scratch.reserve(_rows.size() + _changed.size());
+
+    std::string name;
+    auto rowIt = _rows.begin();
+    for (auto entity : _changed) {
+        for (; rowIt != _rows.end() && rowIt->entity < entity; ++rowIt) {
+            _scratch.push_back(std::move(*rowIt));
+        }
+        const Row* oldRow = nullptr;
+        if (rowIt != _rows.end() && rowIt->entity == entity) {
+            oldRow = &(*rowIt);
+            ++rowIt;
+        }
+        const ove::SceneBody* body = _scene.findBody(entity);
+        const bool listed = body && isListed(body);
+        if (listed) {
+            lowercase(name, _entityService.identityFromEntity(entity).c_str());
+        }
+        //  reindex names that were added, removed or renamed
+        if (oldRow && (!listed || oldRow->name != name)) {
+            queueTrigrams(_trigramsRemoved, oldRow->name, entity);
+        }
+        if (listed && (!oldRow || oldRow->name != name)) {
+            queueTrigrams(_trigramsAdded, name, entity);
+        }
+        if (listed) {
+            _scratch.push_back({ entity, body->getCategoryMask(), name });
+        }
+    }
+    std::move(rowIt, _rows.end(), std::back_inserter(_scratch));
+
+    std::swap(_rows, _scratch);
+    indexNames();
+
+    //  a pending filter change rebuilds the filtered rows anyway
+    if (!_filterChanged) {
+        filterChanges();
+    }
+    _changed.clear();
+}
+
+void SceneOutliner::indexNames()
+{
+    //  removals are applied first, so a renamed entity's shared trigrams
+    //  are removed and then added back.  both the queues (once sorted) and
+    //  the index's lists are ordered by entity, so each list is updated in
+    //  a single pass
+    std::sort(_trigramsRemoved.begin(), _trigramsRemoved.end());
+    for (auto it = _trigramsRemoved.begin(); it != _trigramsRemoved.end(); ) {
+        const Trigram trigram = it->first;
+        auto indexIt = _trigrams.find(trigram);
+        if (indexIt == _trigrams.end()) {
+            CK_ASSERT(false);
+            for (; it != _trigramsRemoved.end() && it->first == trigram; ++it) {}
+            continue;
+        }
+        auto out = indexIt->second.begin();
+        for (auto entity : indexIt->second) {
+            for (; it != _trigramsRemoved.end() && it->first == trigram
+                   && it->second < entity; ++it) {}
+            if (it != _trigramsRemoved.end() && it->first == trigram
+                && it->second == entity)
+                continue;
+            *(out++) = entity;
+        }
+        indexIt->second.erase(out, indexIt->second.end());
+        if (indexIt->second.empty()) {
+            _trigrams.erase(indexIt);
+        }
+        for (; it != _trigramsRemoved.end() && it->first == trigram; ++it) {}
+    }
+    _trigramsRemoved.clear();
+
+    std::sort(_trigramsAdded.begin(), _trigramsAdded.end());
+    for (auto it = _trigramsAdded.begin(); it != _trigramsAdded.end(); ) {
+        const Trigram trigram = it->first;
+        auto& entities = _trigrams[trigram];
+        const size_t count = entities.size();
+        for (; it != _trigramsAdded.end() && it->first == trigram; ++it) {
+            entities.push_back(it->second);
+        }
+        std::inplace_merge(entities.begin(), entities.begin() + count, entities.end());
+    }
+    _trigramsAdded.clear();
+}
+
+void SceneOutliner::filterChanges()
+{
+    //  changed entities are sorted - merge those that match into the
+    //  filtered rows, dropping those that no longer do
+    _filteredScratch.clear();
+    _filteredScratch.reserve(_filtered.size() + _changed.size());
+
+    auto filteredIt = _filtered.begin();
+    for (auto entity : _changed) {
+        for (; filteredIt != _filtered.end() && *filteredIt < entity; ++filteredIt) {
+            _filteredScratch.push_back(*filteredIt);
+        }
+        if (filteredIt != _filtered.end() && *filteredIt == entity) {
+            ++filteredIt;
+        }
+        const Row* row = findRow(entity);
+        if (row && matchesFilter(*row)) {
+            _filteredScratch.push_back(entity);
+        }
+    }
+    _filteredScratch.insert(_filteredScratch.end(), filteredIt, _filtered.end());
+
+    std::swap(_filtered, _filteredScratch);
+}
+
+void SceneOutliner::applyFilter()
+{
+    if (_filterNarrowed) {
+        _filtered.erase(std::remove_if(_filtered.begin(), _filtered.end(),
+            [this](Entity entity) -> bool {
+                const Row* row = findRow(entity);
+                return !row || !matchesFilter(*row);
+            }),
+            _filtered.end());
+    }
+    else if (_filterName.size() >= 3) {
+        //  candidates have every trigram in the filter.  intersecting from
+        //  the shortest list keeps the intermediate results small
+        std::vector<const std::vector<Entity>*> lists;
+        trigramsFromString(_nameTrigrams, _filterName);
+        for (auto trigram : _nameTrigrams) {
+            auto it = _trigrams.find(trigram);
+            if (it == _trigrams.end()) {
+                lists.clear();
+                break;
+            }
+            lists.push_back(&it->second);
+        }
+        std::sort(lists.begin(), lists.end(),
+            [](const std::vector<Entity>* l0, const std::vector<Entity>* l1) -> bool {
+                return l0->size() < l1->size();
+            });
+
+        _filtered.clear();
+        _filteredScratch.clear();
+        if (!lists.empty()) {
+            _filteredScratch = *lists.front();
+            for (size_t i = 1; i < lists.size() && !_filteredScratch.empty(); ++i) {
+                std::set_intersection(_filteredScratch.begin(), _filteredScratch.end(),
+                    lists[i]->begin(), lists[i]->end(),
+                    std::back_inserter(_filtered));
+                std::swap(_filtered, _filteredScratch);
+                _filtered.clear();
+            }
+        }
+        //  trigrams don't ensure the filter appears in order
+        for (auto entity : _filteredScratch) {
+            const Row* row = findRow(entity);
+            if (row && matchesFilter(*row)) {
+                _filtered.push_back(entity);
+            }
+        }
+    }
+    else {
+        _filtered.clear();
+        for (auto& row : _rows) {
+            if (matchesFilter(row)) {
+                _filtered.push_back(row.entity);
+            }
+        }
+    }
+    _filterChanged = false;
+    _filterNarrowed = false;
+}
+
+} /* namespace cinek */
@@ -0,0 +1,123 @@
+//
+//  SceneOutliner.hpp
+//  EnginePrototype
+//
+//  Created by Samir Sinha on 4/10/16.
+//
+//
+
+#ifndef Prototype_Game_SceneOutliner_hpp
+#define Prototype_Game_SceneOutliner_hpp
+
+#include "Engine/EngineTypes.hpp"
+#include "Engine/Physics/SceneListener.hpp"
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace cinek {
+
+//  The editor's list of scene bodies.  Rows are kept sorted by entity and
+//  updated from Scene events rather than rebuilt from the Scene, and a
+//  filtered subset is maintained for display so that the UI only needs to
+//  emit visible rows.
+//
+//  Events only mark entities as changed.  refresh resolves changed entities
+//  against the Scene once per frame, so bodies attached and detached in the
+//  same frame (or attached in bulk) cost a single merge.  Only the changed
+//  entities are tested against the active filter.
+//
+//  Names are indexed by trigram, so a name filter of three or more
+//  characters only tests entities with all of the filter's trigrams.
+class SceneOutliner : public ove::SceneListener
+{
+    CK_CLASS_NON_COPYABLE(SceneOutliner);
+
+public:
+    //  scene body categories to list
+    enum CategoryFilter
+    {
+        kCategory_All,
+        kCategory_Sections,
+        kCategory_Dynamic,
+        kCategory_Fixed,
+        kCategory_Count
+    };
+
+    //  adds itself as a listener to the scene
+    SceneOutliner(ove::Scene& scene, const ove::EntityService& entityService);
+    ~SceneOutliner();
+
+    //  applies changes since the last refresh, and updates the filtered rows
+    //  if needed
+    void refresh();
+
+    //  name is matched case insensitively against entity identities.  an
+    //  empty name matches all rows
+    void setFilter(const char* name, CategoryFilter category);
+    //  reindexes the entity's name on the next refresh
+    void onEntityRenamed(Entity entity);
+
+    uint32_t entityCount() const { return (uint32_t)_rows.size(); }
+    uint32_t filteredCount() const { return (uint32_t)_filtered.size(); }
+    Entity filteredEntity(uint32_t index) const { return _filtered[index]; }
+
+    void onSceneBodyAttached(ove::SceneBody* body) override;
+    void onSceneBodyDetached(ove::SceneBody* body) override;
+    void onSceneBodyCategoriesChanged(ove::SceneBody* body) override;
+
+private:
+    struct Row
+    {
+        Entity entity;
+        uint32_t categoryMask;
+        //  the entity's identity in lowercase
+        std::string name;
+    };
+
+    //  three characters packed into the low 24 bits
+    using Trigram = uint32_t;
+    using TrigramEntity = std::pair<Trigram, Entity>;
+
+    void queueTrigrams(std::vector<TrigramEntity>& queue,
+                       const std::string& name,
+                       Entity entity);
+    bool isListed(const ove::SceneBody* body) const;
+    const Row* findRow(Entity entity) const;
+    bool matchesFilter(const Row& row) const;
+    void applyChanges();
+    void indexNames();
+    void filterChanges();
+    void applyFilter();
+
+    ove::Scene& _scene;
+    const ove::EntityService& _entityService;
+
+    std::vector<Row> _rows;
+    std::vector<Entity> _changed;
+    std::vector<Row> _scratch;
+
+    //  sorted entities whose names contain each trigram
+    std::unordered_map<Trigram, std::vector<Entity>> _trigrams;
+    //  index updates gathered while applying changes
+    std::vector<TrigramEntity> _trigramsRemoved;
+    std::vector<TrigramEntity> _trigramsAdded;
+    std::vector<Trigram> _nameTrigrams;
+
+    //  sorted entities matching the filter
+    std::vector<Entity> _filtered;
+    std::vector<Entity> _filteredScratch;
+    //  lowercase
+    std::string _filterName;
+    CategoryFilter _filterCategory;
+    bool _filterChanged;
+    //  set when the name filter contains the one last applied, so that
+    //  matches are a subset of the current filtered rows
+    bool _filterNarrowed;
+};
+
+} /* namespace cinek */
+
+#endif /* Prototype_Game_SceneOutliner_hpp */
@@ -17,6 +17,8 @@
 #include "Engine/Render/RenderGraph.hpp"
 #include "Engine/Render/RenderContext.hpp"
 #include "Engine/AssetManifest.hpp"
+#include "Engine/Profiler.hpp"
+#include "Engine/MemoryTracker.hpp"
 
 #include "CKGfx/Context.hpp"
 #include "CKGfx/Light.hpp"
@@ -36,10 +38,14 @@ namespace cinek {
 
 GameView::GameView(ApplicationContext* api) :
     AppViewController(api),
+    _viewToSceneRayTestTicket(0),
     _gameMode(GameMode::kNone)
 {
+    _sceneQueries = allocate_unique<ove::SceneQueryService>(*api->scene, api->jobSystem);
+    
     _gameViewContext.camera = &_camera;
     _gameViewContext.screenRayTestResult = &_viewToSceneRayTestResult;
+    _gameViewContext.sceneQueries = _sceneQueries.get();
     _gameViewContext.pathfinder = api->pathfinder;
     _gameViewContext.pathfinderDebug = api->pathfinderDebug;
     _gameViewContext.navSystem = api->navSystem;
@@ -139,20 +145,33 @@ void GameView::frameUpdateView
 
         gfx::Vector3 dir = _camera.worldRayFromScreenCoordinate(vx, vy);
         
-        _viewToSceneRayTestResult = scene().rayTestClosest(
+        //  use the hit from the last frame's ray while this frame's ray
+        //  runs alongside rendering
+        if (!_sceneQueries->rayTestResult(_viewToSceneRayTestTicket,
+                                          _viewToSceneRayTestResult)) {
+            _viewToSceneRayTestResult.clear();
+        }
+        _viewToSceneRayTestTicket = _sceneQueries->queueRayTest(
             ove::btFromGfx(cameraPos), ove::btFromGfx(dir), 100.0f,
             ove::SceneBody::kAllFilter,
             ove::SceneBody::kStagingFilter);
     }
     else {
         _viewToSceneRayTestResult.clear();
+        _viewToSceneRayTestTicket = 0;
     }
     
+    _sceneQueries->dispatch();
+    
     //  RENDER SCENE
     const ove::RenderContext& rc = renderContext();
-    _renderer(*rc.programs, *rc.uniforms,
-            _camera,
-            renderGraph().root());
+    {
+        OVENGINE_PROFILE_ZONE("NodeRenderer");
+        OVENGINE_MEMORY_TAG(ove::kMemoryTagGfx);
+        _renderer(*rc.programs, *rc.uniforms,
+                _camera,
+                renderGraph().transforms());
+    }
     
     sceneDebug().setup(*rc.programs, *rc.uniforms, _camera);
     
@@ -172,6 +191,10 @@ void GameView::frameUpdateView
 
 void GameView::onViewEndFrame(ove::ViewStack& stateController)
 {
+    //  before entities are collected, which may free shapes read by queries.
+    //  also retires results allocated from the prior frame's arena buffer
+    _sceneQueries->collect();
+    
     _viewStack.endFrame();
 }
 
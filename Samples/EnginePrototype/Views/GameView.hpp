@@ -12,6 +12,7 @@
 #include "Views/AppViewController.hpp"
 #include "Engine/ViewStack.hpp"
 #include "Engine/Physics/SceneTypes.hpp"
+#include "Engine/Physics/SceneQueryService.hpp"
 #include "CKGfx/Camera.hpp"
 
 #include "GameViewContext.hpp"
@@ -46,6 +47,9 @@ private:
     gfx::NodeRenderer _renderer;
     gfx::Camera _camera;
     ove::SceneRayTestResult _viewToSceneRayTestResult;
+    //  picking runs a frame behind, on the job system
+    unique_ptr<ove::SceneQueryService> _sceneQueries;
+    ove::SceneQueryService::Ticket _viewToSceneRayTestTicket;
     
     ove::ViewStack _viewStack;
     
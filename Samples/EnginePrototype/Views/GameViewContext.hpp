@@ -41,6 +41,7 @@ struct GameViewContext
     gfx::Camera* camera;
     
     ove::SceneRayTestResult* screenRayTestResult;
+    ove::SceneQueryService* sceneQueries;
     ove::Scene* scene;
     ove::EntityService* entityService;
     ove::AssetService* assetService;
@@ -62,6 +63,7 @@ public:
     const GameInterface& game() const { return *_context->game; }
     gfx::Camera& camera() { return *_context->camera; };
     ove::Scene& scene() { return *_context->scene; }
+    ove::SceneQueryService& sceneQueries() { return *_context->sceneQueries; }
     ove::EntityService& entityService() { return *_context->entityService; }
     ove::AssetService& assetSevice() { return *_context->assetService; }
     ove::Pathfinder& pathfinder() { return *_context->pathfinder; }
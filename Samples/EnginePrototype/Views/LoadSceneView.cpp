@@ -14,27 +14,58 @@
 #include "Engine/Path/Pathfinder.hpp"
 #include "Engine/ViewStack.hpp"
 
+#include "CKGfx/Context.hpp"
+
 #include <cinek/taskscheduler.hpp>
 
 namespace cinek {
 
-LoadSceneView::LoadSceneView(ApplicationContext* context) :
+//  the manifest name (path sans extension) owns the scene's assets, as named
+//  by LoadAssetManifest
+static std::string assetOwnerFromPath(const std::string& path)
+{
+    auto idx = path.rfind('.');
+    return idx != std::string::npos ? path.substr(0, idx) : path;
+}
+
+LoadSceneView::LoadSceneView
+(
+    ApplicationContext* context,
+    std::string scenePath
+) :
     AppViewController(context),
     _currentTask(kLoadStart),
     _nextTask(kLoadStart),
+    _scenePath(std::move(scenePath)),
+    //  a snapshot of the loaded scene, used if its sources are unchanged
+    _snapshotPath(assetOwnerFromPath(_scenePath) + ".snapshot"),
     _loader(context->sceneData,
             context->gfxContext,
             context->renderGraph,
-            context->entityDatabase)
+            context->entityDatabase),
+    _snapshot({ context->sceneData,
+                context->gfxContext,
+                context->renderGraph,
+                context->entityDatabase,
+                context->scene,
+                context->pathfinder,
+                context->assetArchive.get() })
 {
 }
 
 
 void LoadSceneView::onViewAdded(ove::ViewStack& stateController)
 {
+    //  assets from a previously loaded scene are no longer referenced and
+    //  can be evicted if the new scene needs the room
+    if (!appContext().sceneAssetOwner.empty()) {
+        gfxContext().releaseAssetOwner(appContext().sceneAssetOwner.c_str());
+        appContext().sceneAssetOwner.clear();
+    }
+    
     //  load scene
     _currentTask = kLoadStart;
-    _nextTask = kLoadManifest;
+    _nextTask = kLoadSnapshot;
 }
    
 void LoadSceneView::onViewRemoved(ove::ViewStack& stateController)
@@ -60,10 +91,25 @@ void LoadSceneView::frameUpdateView
     
         _currentTask = _nextTask;
         switch (_currentTask) {
+            case kLoadSnapshot:
+                appContext().sceneAssetOwner = assetOwnerFromPath(_scenePath);
+                if (_snapshot.load(_snapshotPath.c_str(),
+                                   appContext().sceneAssetOwner.c_str())) {
+                    _nextTask = kLoadSuccess;
+                }
+                else {
+                    //  retain decoded meshes so that the scene can be
+                    //  snapshotted once loaded
+                    _loader.setRetainMeshSources(true);
+                    _nextTask = kLoadManifest;
+                }
+                break;
+                
             case kLoadManifest:
-                assetService().loadManifest("scenes/apartment.json",
+                assetService().loadManifest(_scenePath,
                     [this](std::shared_ptr<ove::AssetManifest> manifest) {
                         _manifest = std::move(manifest);
+                        appContext().sceneAssetOwner = _manifest->name();
                         _nextTask = kLoadScene;
                     });
                 break;
@@ -74,9 +120,11 @@ void LoadSceneView::frameUpdateView
                         if (endState == Task::State::kEnded) {
                             auto bodies = reinterpret_cast<ove::InitializeScene&>(thisTask).acquireBodyList();
                             
+                            ove::SceneBatch batch;
                             for (auto& body : bodies) {
-                                scene().attachBody(body.first, body.second);
+                                batch.attach(body.first, body.second);
                             }
+                            scene().applyBatch(batch);
                             _nextTask = kLoadPaths;
                         }
                         else {
@@ -90,9 +138,16 @@ void LoadSceneView::frameUpdateView
                 //  generates pathfinding data from current scene
                 pathfinder().generateFromScene(scene(), 
                     [this](bool success) {
-                        _nextTask = success ? kLoadSuccess : kLoadError;
+                        _nextTask = success ? kSaveSnapshot : kLoadError;
                     });
                 break;
+            case kSaveSnapshot:
+                //  failing to save only affects the next load's time
+                _snapshot.save(_snapshotPath.c_str(), _loader.acquireMeshSources(),
+                               _manifest.get(), _scenePath.c_str());
+                _loader.setRetainMeshSources(false);
+                _nextTask = kLoadSuccess;
+                break;
             case kLoadError:
                 break;
             case kLoadSuccess:
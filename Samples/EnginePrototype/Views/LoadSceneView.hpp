@@ -11,8 +11,10 @@
 
 #include "AppViewController.hpp"
 #include "Engine/SceneJsonLoader.hpp"
+#include "Engine/SceneSnapshot.hpp"
 #include "GameViewContext.hpp"
 
+#include <string>
 #include <vector>
 
 namespace cinek {
@@ -20,7 +22,8 @@ namespace cinek {
 class LoadSceneView : public AppViewController
 {
 public:
-    LoadSceneView(ApplicationContext* appContext);
+    //  scenePath is the scene manifest to load
+    LoadSceneView(ApplicationContext* appContext, std::string scenePath);
 
 private:
     //  ViewController
@@ -38,9 +41,11 @@ private:
     enum State
     {
         kLoadStart,
+        kLoadSnapshot,
         kLoadManifest,
         kLoadScene,
         kLoadPaths,
+        kSaveSnapshot,
         kLoadError,
         kLoadSuccess
     };
@@ -48,8 +53,12 @@ private:
     State _currentTask;
     State _nextTask;
     
+    std::string _scenePath;
+    std::string _snapshotPath;
+    
     std::shared_ptr<ove::AssetManifest> _manifest;
     ove::SceneJsonLoader _loader;
+    ove::SceneSnapshot _snapshot;
 };
 
 }   /* namespace cinek */
@@ -45,7 +45,8 @@ enum
 };
 
 
-int runSample(int viewWidth, int viewHeight, int firstFreeViewId)
+int runSample(int viewWidth, int viewHeight, int firstFreeViewId,
+              const SampleOptions& )
 {
     //  GFX
     cinek::Allocator allocator;
@@ -75,6 +76,7 @@ int runSample(int viewWidth, int viewHeight, int firstFreeViewId)
     gfxInitParams.numTextures = 256;
     gfxInitParams.numAnimations = 256;
     gfxInitParams.numLights = 64;
+    gfxInitParams.residencyBudget = 0;
     
     cinek::gfx::Context gfxContext(gfxInitParams);
     
@@ -0,0 +1,229 @@
+//
+//  MemoryPanel.cpp
+//  Overview
+//
+//  Created by Samir Sinha on 4/10/16.
+//  Copyright © 2016 Cinekine. All rights reserved.
+//
+
+#include "MemoryPanel.hpp"
+#include "UI.hpp"
+
+#include "CKGfx/Context.hpp"
+
+#include <algorithm>
+
+namespace cinek {
+    namespace uicore {
+
+static const ImVec4 kExhaustedColor = ImVec4(1.0f, 0.35f, 0.35f, 1.0f);
+
+static double bytesToKB(int64_t bytes)
+{
+    return (double)bytes / 1024.0;
+}
+
+MemoryPanel::MemoryPanel()
+{
+}
+
+void MemoryPanel::draw
+(
+    const gfx::Context* gfxContext,
+    const ove::FrameArena* frameArena,
+    bool* opened
+)
+{
+    if (!ImGui::Begin("Memory", opened, ImVec2(640, 480), 0.75f)) {
+        ImGui::End();
+        return;
+    }
+
+    if (ImGui::CollapsingHeader("Heap", nullptr, true, true)) {
+        drawHeap();
+    }
+    if (ImGui::CollapsingHeader("Pools", nullptr, true, true)) {
+        drawPools();
+    }
+    if (frameArena && ImGui::CollapsingHeader("Frame Arena", nullptr, true, true)) {
+        drawFrameArena(*frameArena);
+    }
+    if (gfxContext && ImGui::CollapsingHeader("Graphics Pools", nullptr, true, true)) {
+        drawGfxPools(*gfxContext);
+    }
+
+    ImGui::End();
+}
+
+void MemoryPanel::drawHeap()
+{
+    if (!ove::MemoryTracker::heapTracking()) {
+        ImGui::Text("Heap tracking is disabled (build with OVE_MEMORY_TRACKING=1)");
+        return;
+    }
+
+    ImGui::Columns(5, "HeapTags");
+    ImGui::Text("Tag");
+    ImGui::NextColumn();
+    ImGui::Text("Current (KB)");
+    ImGui::NextColumn();
+    ImGui::Text("Peak (KB)");
+    ImGui::NextColumn();
+    ImGui::Text("Allocs/Frame");
+    ImGui::NextColumn();
+    ImGui::Text("KB/Frame");
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    for (int tag = 0; tag < ove::kMemoryTagCount; ++tag) {
+        auto stats = ove::MemoryTracker::heapStats((ove::MemoryTag)tag);
+        ImGui::Text("%s", ove::memoryTagName((ove::MemoryTag)tag));
+        ImGui::NextColumn();
+        ImGui::Text("%.1f", bytesToKB(stats.currentBytes));
+        ImGui::NextColumn();
+        ImGui::Text("%.1f", bytesToKB(stats.highWaterBytes));
+        ImGui::NextColumn();
+        ImGui::Text("%u", stats.frameAllocCount);
+        ImGui::NextColumn();
+        ImGui::Text("%.1f", bytesToKB(stats.frameAllocBytes));
+        ImGui::NextColumn();
+    }
+
+    auto totals = ove::MemoryTracker::heapTotals();
+    ImGui::Separator();
+    ImGui::Text("Total");
+    ImGui::NextColumn();
+    ImGui::Text("%.1f", bytesToKB(totals.currentBytes));
+    ImGui::NextColumn();
+    ImGui::NextColumn();
+    ImGui::Text("%u", totals.frameAllocCount);
+    ImGui::NextColumn();
+    ImGui::Text("%.1f", bytesToKB(totals.frameAllocBytes));
+    ImGui::NextColumn();
+
+    ImGui::Columns(1);
+}
+
+void MemoryPanel::drawPools()
+{
+    _pools.clear();
+    ove::MemoryTracker::enumeratePools(
+        [this](const ove::PoolCounter::Stats& stats) {
+            _pools.push_back(stats);
+        });
+    //  group by subsystem
+    std::stable_sort(_pools.begin(), _pools.end(),
+        [](const ove::PoolCounter::Stats& s0, const ove::PoolCounter::Stats& s1) -> bool {
+            return s0.tag < s1.tag;
+        });
+
+    ImGui::Columns(6, "PoolStats");
+    ImGui::Text("Pool");
+    ImGui::NextColumn();
+    ImGui::Text("Used");
+    ImGui::NextColumn();
+    ImGui::Text("Peak");
+    ImGui::NextColumn();
+    ImGui::Text("Capacity");
+    ImGui::NextColumn();
+    ImGui::Text("Acquires/Frame");
+    ImGui::NextColumn();
+    ImGui::Text("Exhausted");
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    for (auto& pool : _pools) {
+        if (pool.exhaustedCount) {
+            ImGui::TextColored(kExhaustedColor, "%s", pool.name);
+        }
+        else {
+            ImGui::Text("%s", pool.name);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", ove::memoryTagName(pool.tag));
+        }
+        ImGui::NextColumn();
+        ImGui::Text("%u", pool.used);
+        ImGui::NextColumn();
+        ImGui::Text("%u", pool.highWater);
+        ImGui::NextColumn();
+        if (pool.capacity) {
+            ImGui::Text("%u", pool.capacity);
+        }
+        else {
+            ImGui::Text("-");
+        }
+        ImGui::NextColumn();
+        ImGui::Text("%u", pool.frameAcquires);
+        ImGui::NextColumn();
+        ImGui::Text("%u", pool.exhaustedCount);
+        ImGui::NextColumn();
+    }
+
+    ImGui::Columns(1);
+}
+
+void MemoryPanel::drawFrameArena(const ove::FrameArena& frameArena)
+{
+    auto stats = frameArena.stats();
+    ImGui::Text("Last frame: %.1f KB of %.1f KB", bytesToKB((int64_t)stats.frameBytes),
+                bytesToKB((int64_t)stats.capacity));
+    ImGui::Text("Peak frame: %.1f KB", bytesToKB((int64_t)stats.peakFrameBytes));
+    ImGui::Text("Peak thread: %.1f KB", bytesToKB((int64_t)stats.peakThreadBytes));
+    if (stats.overflowCount) {
+        ImGui::TextColored(kExhaustedColor, "Heap overflows: %u", stats.overflowCount);
+    }
+    else {
+        ImGui::Text("Heap overflows: 0");
+    }
+}
+
+void MemoryPanel::drawGfxPools(const gfx::Context& gfxContext)
+{
+    ImGui::Columns(6, "GfxPoolStats");
+    ImGui::Text("Pool");
+    ImGui::NextColumn();
+    ImGui::Text("Live");
+    ImGui::NextColumn();
+    ImGui::Text("High");
+    ImGui::NextColumn();
+    ImGui::Text("Registered");
+    ImGui::NextColumn();
+    ImGui::Text("Capacity");
+    ImGui::NextColumn();
+    ImGui::Text("Exhausted");
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    for (auto& pool : gfxContext.poolStats()) {
+        if (pool.exhaustedCount) {
+            ImGui::TextColored(kExhaustedColor, "%s", pool.name);
+        }
+        else {
+            ImGui::Text("%s", pool.name);
+        }
+        ImGui::NextColumn();
+        ImGui::Text("%u", pool.liveCount);
+        ImGui::NextColumn();
+        ImGui::Text("%u", pool.highWaterCount);
+        ImGui::NextColumn();
+        ImGui::Text("%u", pool.registeredCount);
+        ImGui::NextColumn();
+        ImGui::Text("%u", pool.capacity);
+        ImGui::NextColumn();
+        ImGui::Text("%u", pool.exhaustedCount);
+        ImGui::NextColumn();
+    }
+
+    ImGui::Columns(1);
+
+    auto residency = gfxContext.residencyStats();
+    ImGui::Text("Resident: %u assets, %.1f KB (budget %.1f KB), %u evicted",
+                residency.residentCount,
+                bytesToKB((int64_t)residency.residentBytes),
+                bytesToKB((int64_t)residency.budgetBytes),
+                residency.evictedCount);
+}
+
+    } /* namespace uicore */
+} /* namespace cinek */
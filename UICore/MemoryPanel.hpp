@@ -0,0 +1,49 @@
+//
+//  MemoryPanel.hpp
+//  Overview
+//
+//  Created by Samir Sinha on 4/10/16.
+//  Copyright © 2016 Cinekine. All rights reserved.
+//
+
+#ifndef Overview_UI_MemoryPanel_hpp
+#define Overview_UI_MemoryPanel_hpp
+
+#include "Engine/MemoryTracker.hpp"
+#include "Engine/FrameArena.hpp"
+
+#include <vector>
+
+namespace cinek {
+    namespace gfx {
+        class Context;
+    }
+    namespace uicore {
+
+//  ImGui window showing heap usage by memory tag, occupancy of the engine's
+//  pools, frame arena usage and registration counts of the graphics
+//  context's pools.  Pools that have run out are highlighted.
+class MemoryPanel
+{
+public:
+    MemoryPanel();
+
+    //  call between imGuiNewFrame and imGuiRender.  gfxContext and
+    //  frameArena are optional
+    void draw(const gfx::Context* gfxContext,
+              const ove::FrameArena* frameArena,
+              bool* opened=nullptr);
+
+private:
+    void drawHeap();
+    void drawPools();
+    void drawFrameArena(const ove::FrameArena& frameArena);
+    void drawGfxPools(const gfx::Context& gfxContext);
+
+    std::vector<ove::PoolCounter::Stats> _pools;
+};
+
+    } /* namespace uicore */
+} /* namespace cinek */
+
+#endif /* Overview_UI_MemoryPanel_hpp */
@@ -0,0 +1,220 @@
+//
+//  ProfilerOverlay.cpp
+//  Overview
+//
+//  Created by Samir Sinha on 4/7/16.
+//  Copyright © 2016 Cinekine. All rights reserved.
+//
+
+#include "ProfilerOverlay.hpp"
+#include "UI.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cinek {
+    namespace uicore {
+
+static const float kTimelineRowHeight = 16.0f;
+static const uint32_t kTotalsLimit = 16;
+
+static double nsToMs(uint64_t ns)
+{
+    return (double)ns / 1000000.0;
+}
+
+static ImU32 zoneColor(const char* name)
+{
+    //  zones with the same name share a hue
+    uint32_t hash = 2166136261U;
+    for (const char* ch = name; *ch; ++ch) {
+        hash = (hash ^ (uint8_t)*ch) * 16777619U;
+    }
+    return ImColor::HSV((hash % 360) / 360.0f, 0.55f, 0.75f);
+}
+
+ProfilerOverlay::ProfilerOverlay() :
+    _capturePath("profile.json"),
+    _paused(false),
+    _zoom(1.0f),
+    _frame { 0, 0 }
+{
+}
+
+void ProfilerOverlay::draw(ove::Profiler& profiler, bool* opened)
+{
+    if (!ImGui::Begin("Profiler", opened, ImVec2(720, 360), 0.75f)) {
+        ImGui::End();
+        return;
+    }
+
+    if (!_paused) {
+        snapshotFrame(profiler);
+    }
+
+    ImGui::Text("Frame %.3f ms", nsToMs(_frame.endNs - _frame.beginNs));
+    ImGui::SameLine();
+    ImGui::Checkbox("Pause", &_paused);
+    ImGui::SameLine();
+    if (profiler.isCapturing()) {
+        if (ImGui::Button("Stop Capture")) {
+            profiler.stopCapture(_capturePath.c_str());
+        }
+        ImGui::SameLine();
+        ImGui::Text("%u zones", profiler.captureEventCount());
+    }
+    else if (ImGui::Button("Capture")) {
+        profiler.startCapture();
+    }
+
+    ImGui::SliderFloat("Zoom", &_zoom, 1.0f, 32.0f, "%.1fx", 2.0f);
+
+    drawTimeline(profiler);
+
+    ImGui::Separator();
+
+    drawTotals();
+
+    ImGui::End();
+}
+
+void ProfilerOverlay::snapshotFrame(const ove::Profiler& profiler)
+{
+    auto& frames = profiler.frames();
+    if (frames.empty())
+        return;
+
+    _frame = frames.back();
+
+    //  zones overlapping the frame, including worker zones that straddle
+    //  frame boundaries
+    _events.clear();
+    for (auto& event : profiler.events()) {
+        if (event.endNs >= _frame.beginNs && event.beginNs <= _frame.endNs) {
+            _events.push_back(event);
+        }
+    }
+
+    //  totals are summed over zones of the same name.  recursive zones are
+    //  counted at every level
+    _totals.clear();
+    for (auto& event : _events) {
+        auto it = std::find_if(_totals.begin(), _totals.end(),
+            [&event](const ZoneTotal& total) -> bool {
+                return total.name == event.name
+                    || !strcmp(total.name, event.name);
+            });
+        if (it == _totals.end()) {
+            _totals.push_back(ZoneTotal { event.name, 0, 0 });
+            it = _totals.end() - 1;
+        }
+        it->totalNs += event.endNs - event.beginNs;
+        ++it->count;
+    }
+    std::sort(_totals.begin(), _totals.end(),
+        [](const ZoneTotal& a, const ZoneTotal& b) -> bool {
+            return a.totalNs > b.totalNs;
+        });
+}
+
+void ProfilerOverlay::drawTimeline(const ove::Profiler& profiler)
+{
+    const uint64_t frameNs = std::max(_frame.endNs - _frame.beginNs, (uint64_t)1);
+    const uint32_t threadCount = profiler.threadCount();
+
+    //  rows per thread are its deepest zone + 1
+    std::vector<uint32_t> threadDepths(threadCount, 0);
+    for (auto& event : _events) {
+        if (event.threadIndex < threadCount) {
+            threadDepths[event.threadIndex] =
+                std::max(threadDepths[event.threadIndex], (uint32_t)event.depth + 1);
+        }
+    }
+
+    float height = 0.0f;
+    for (uint32_t depth : threadDepths) {
+        if (depth) {
+            height += (depth + 1) * kTimelineRowHeight;
+        }
+    }
+
+    ImGui::BeginChild("Timeline", ImVec2(0, std::min(height + 24.0f, 200.0f)),
+                      true, ImGuiWindowFlags_HorizontalScrollbar);
+
+    const float width = ImGui::GetContentRegionAvailWidth() * _zoom;
+    const float nsToPixels = width / (float)frameNs;
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const ImU32 textColor = ImColor(255, 255, 255);
+    const ImU32 labelColor = ImColor(192, 192, 192);
+
+    float y = origin.y;
+    for (uint32_t threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+        if (!threadDepths[threadIndex])
+            continue;
+
+        drawList->AddText(ImVec2(origin.x, y), labelColor,
+                          profiler.threadName(threadIndex));
+        y += kTimelineRowHeight;
+
+        for (auto& event : _events) {
+            if (event.threadIndex != threadIndex)
+                continue;
+
+            uint64_t beginNs = std::max(event.beginNs, _frame.beginNs);
+            uint64_t endNs = std::min(event.endNs, _frame.endNs);
+            ImVec2 a(origin.x + (beginNs - _frame.beginNs) * nsToPixels,
+                     y + event.depth * kTimelineRowHeight);
+            ImVec2 b(std::max(origin.x + (endNs - _frame.beginNs) * nsToPixels,
+                              a.x + 1.0f),
+                     a.y + kTimelineRowHeight - 1.0f);
+
+            drawList->AddRectFilled(a, b, zoneColor(event.name));
+
+            //  label zones wide enough to fit their name
+            ImVec2 textSize = ImGui::CalcTextSize(event.name);
+            if (b.x - a.x > textSize.x + 4.0f) {
+                drawList->AddText(ImVec2(a.x + 2.0f, a.y), textColor, event.name);
+            }
+            if (ImGui::IsMouseHoveringRect(a, b)) {
+                ImGui::SetTooltip("%s\n%.3f ms", event.name,
+                                  nsToMs(event.endNs - event.beginNs));
+            }
+        }
+
+        y += threadDepths[threadIndex] * kTimelineRowHeight;
+    }
+
+    //  reserve the drawn area for layout and scrolling
+    ImGui::Dummy(ImVec2(width, y - origin.y));
+
+    ImGui::EndChild();
+}
+
+void ProfilerOverlay::drawTotals()
+{
+    ImGui::Columns(3, "ZoneTotals");
+    ImGui::Text("Zone");
+    ImGui::NextColumn();
+    ImGui::Text("Total (ms)");
+    ImGui::NextColumn();
+    ImGui::Text("Calls");
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    uint32_t count = std::min((uint32_t)_totals.size(), kTotalsLimit);
+    for (uint32_t i = 0; i < count; ++i) {
+        auto& total = _totals[i];
+        ImGui::Text("%s", total.name);
+        ImGui::NextColumn();
+        ImGui::Text("%.3f", nsToMs(total.totalNs));
+        ImGui::NextColumn();
+        ImGui::Text("%u", total.count);
+        ImGui::NextColumn();
+    }
+
+    ImGui::Columns(1);
+}
+
+    } /* namespace uicore */
+} /* namespace cinek */
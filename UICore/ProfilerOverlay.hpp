@@ -0,0 +1,58 @@
+//
+//  ProfilerOverlay.hpp
+//  Overview
+//
+//  Created by Samir Sinha on 4/7/16.
+//  Copyright © 2016 Cinekine. All rights reserved.
+//
+
+#ifndef Overview_UI_ProfilerOverlay_hpp
+#define Overview_UI_ProfilerOverlay_hpp
+
+#include "Engine/Profiler.hpp"
+
+#include <string>
+#include <vector>
+
+namespace cinek {
+    namespace uicore {
+
+//  ImGui window showing the profiler's most recent frame as a per-thread
+//  timeline, plus zone totals for that frame.  The window also starts and
+//  stops captures.
+class ProfilerOverlay
+{
+public:
+    ProfilerOverlay();
+
+    //  captures are written to this path when stopped
+    void setCapturePath(std::string path) { _capturePath = std::move(path); }
+
+    //  call between imGuiNewFrame and imGuiRender.
+    void draw(ove::Profiler& profiler, bool* opened=nullptr);
+
+private:
+    struct ZoneTotal
+    {
+        const char* name;
+        uint64_t totalNs;
+        uint32_t count;
+    };
+
+    void snapshotFrame(const ove::Profiler& profiler);
+    void drawTimeline(const ove::Profiler& profiler);
+    void drawTotals();
+
+    std::string _capturePath;
+    bool _paused;
+    float _zoom;
+
+    ove::Profiler::Frame _frame;
+    std::vector<ove::Profiler::Event> _events;
+    std::vector<ZoneTotal> _totals;
+};
+
+    } /* namespace uicore */
+} /* namespace cinek */
+
+#endif /* Overview_UI_ProfilerOverlay_hpp */
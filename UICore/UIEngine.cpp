@@ -38,6 +38,8 @@ static SDL_Window*  g_Window = NULL;
 static double       g_Time = 0.0f;
 static bool         g_MousePressed[3] = { false, false, false };
 static float        g_MouseWheel = 0.0f;
+static ImGuiFrameInput g_FrameInput;
+static bool         g_HasFrameInput = false;
 
 // BGFX Data
 union ImGuiBGFXTextureLink
@@ -216,6 +218,18 @@ void imGuiShutdown()
 }
 
 
+void imGuiSetFrameInput(const ImGuiFrameInput* input)
+{
+    g_HasFrameInput = input != NULL;
+    if (input)
+        g_FrameInput = *input;
+}
+
+static int imGuiKeyModifiers()
+{
+    return g_HasFrameInput ? g_FrameInput.keyModifiers : (int)SDL_GetModState();
+}
+
 void imGuiNewFrame()
 {
     if (!bgfx::isValid(g_FontTexture)) {
@@ -224,26 +238,39 @@ void imGuiNewFrame()
 
     ImGuiIO& io = ImGui::GetIO();
 
-    // Setup display size (every frame to accommodate for window resizing)
-    int w, h;
-    SDL_GetWindowSize(g_Window, &w, &h);
-    io.DisplaySize = ImVec2((float)w, (float)h);
-    io.DisplayFramebufferScale = ImVec2(1.0f, 1.0f);
-
-    // Setup time step
-    Uint32  time = SDL_GetTicks();
-    double current_time = time / 1000.0;
-    io.DeltaTime = g_Time > 0.0 ? (float)(current_time - g_Time) : (float)(1.0f / 60.0f);
-    g_Time = current_time;
-
-    // Setup inputs
-    // (we already got mouse wheel, keyboard keys & characters from SDL_PollEvent())
-    int mx, my;
-    Uint32 mouseMask = SDL_GetMouseState(&mx, &my);
-    if (SDL_GetWindowFlags(g_Window) & SDL_WINDOW_MOUSE_FOCUS)
-        io.MousePos = ImVec2((float)mx, (float)my);   // Mouse position, in pixels (set to -1,-1 if no mouse / on another screen, etc.)
+    Uint32 mouseMask;
+    if (g_HasFrameInput)
+    {
+        // Replayed input - nothing is read from SDL or the window
+        io.DisplaySize = ImVec2((float)g_FrameInput.displayWidth, (float)g_FrameInput.displayHeight);
+        io.DisplayFramebufferScale = ImVec2(1.0f, 1.0f);
+        io.DeltaTime = g_FrameInput.deltaTime > 0.0f ? g_FrameInput.deltaTime : (float)(1.0f / 60.0f);
+        io.MousePos = ImVec2((float)g_FrameInput.mouseX, (float)g_FrameInput.mouseY);
+        mouseMask = g_FrameInput.mouseButtons;
+    }
     else
-        io.MousePos = ImVec2(-1, -1);
+    {
+        // Setup display size (every frame to accommodate for window resizing)
+        int w, h;
+        SDL_GetWindowSize(g_Window, &w, &h);
+        io.DisplaySize = ImVec2((float)w, (float)h);
+        io.DisplayFramebufferScale = ImVec2(1.0f, 1.0f);
+
+        // Setup time step
+        Uint32  time = SDL_GetTicks();
+        double current_time = time / 1000.0;
+        io.DeltaTime = g_Time > 0.0 ? (float)(current_time - g_Time) : (float)(1.0f / 60.0f);
+        g_Time = current_time;
+
+        // Setup inputs
+        // (we already got mouse wheel, keyboard keys & characters from SDL_PollEvent())
+        int mx, my;
+        mouseMask = SDL_GetMouseState(&mx, &my);
+        if (SDL_GetWindowFlags(g_Window) & SDL_WINDOW_MOUSE_FOCUS)
+            io.MousePos = ImVec2((float)mx, (float)my);   // Mouse position, in pixels (set to -1,-1 if no mouse / on another screen, etc.)
+        else
+            io.MousePos = ImVec2(-1, -1);
+    }
 
     io.MouseDown[0] = g_MousePressed[0] || (mouseMask & SDL_BUTTON(SDL_BUTTON_LEFT)) != 0;      // If a mouse press event came, always pass it as "mouse held this frame", so we don't miss click-release events that are shorter than 1 frame.
     io.MouseDown[1] = g_MousePressed[1] || (mouseMask & SDL_BUTTON(SDL_BUTTON_RIGHT)) != 0;
@@ -291,9 +318,10 @@ bool imGuiProcessEvent(SDL_Event* event)
     {
         int key = event->key.keysym.sym & ~SDLK_SCANCODE_MASK;
         io.KeysDown[key] = (event->type == SDL_KEYDOWN);
-        io.KeyShift = ((SDL_GetModState() & KMOD_SHIFT) != 0);
-        io.KeyCtrl = ((SDL_GetModState() & KMOD_CTRL) != 0);
-        io.KeyAlt = ((SDL_GetModState() & KMOD_ALT) != 0);
+        int keyModifiers = imGuiKeyModifiers();
+        io.KeyShift = ((keyModifiers & KMOD_SHIFT) != 0);
+        io.KeyCtrl = ((keyModifiers & KMOD_CTRL) != 0);
+        io.KeyAlt = ((keyModifiers & KMOD_ALT) != 0);
         return true;
     }
     }
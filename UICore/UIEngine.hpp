@@ -22,11 +22,29 @@
 #ifndef Overview_UI_Engine_hpp
 #define Overview_UI_Engine_hpp
 
+#include <cstdint>
+
 struct SDL_Window;
 typedef union SDL_Event SDL_Event;
 
+// Input supplied by the caller instead of polled from SDL and the window, so
+// that replays present ImGui with recorded state.
+struct ImGuiFrameInput
+{
+    int displayWidth;
+    int displayHeight;
+    int mouseX;
+    int mouseY;
+    uint32_t mouseButtons;      // SDL_BUTTON masks
+    int keyModifiers;           // SDL_Keymod
+    float deltaTime;            // seconds
+};
+
 bool imGuiInit(SDL_Window *window, int viewId);
 void imGuiShutdown();
+// Overrides polled input for following frames and events.  Pass null to
+// resume polling SDL.
+void imGuiSetFrameInput(const ImGuiFrameInput* input);
 void imGuiNewFrame();
 bool imGuiProcessEvent(SDL_Event* event);
 void imGuiRender();